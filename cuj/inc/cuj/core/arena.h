@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include <cuj/common.h>
+#include <cuj/utils/uncopyable.h>
+
+CUJ_NAMESPACE_BEGIN(cuj::core)
+
+// bump allocator owning core ir nodes. all nodes are destroyed and their
+// memory is released at once when the arena dies
+class Arena : public Uncopyable
+{
+public:
+
+    Arena() = default;
+
+    ~Arena();
+
+    template<typename T, typename...Args>
+    T *create(Args &&...args);
+
+    size_t get_node_count() const;
+
+    // bytes requested from the system allocator
+    size_t get_reserved_bytes() const;
+
+private:
+
+    struct Destructor
+    {
+        void      (*destroy)(void *);
+        void       *object;
+        Destructor *next;
+    };
+
+    static constexpr size_t CHUNK_SIZE = 16 * 1024;
+
+    void *allocate(size_t bytes, size_t alignment);
+
+    std::vector<Box<std::byte[]>> chunks_;
+
+    std::byte *chunk_cur_ = nullptr;
+    std::byte *chunk_end_ = nullptr;
+
+    // in reverse order of creation
+    Destructor *destructors_ = nullptr;
+
+    size_t node_count_     = 0;
+    size_t reserved_bytes_ = 0;
+};
+
+template<typename T, typename...Args>
+T *Arena::create(Args &&...args)
+{
+    auto ret = new(allocate(sizeof(T), alignof(T)))
+        T(std::forward<Args>(args)...);
+    ++node_count_;
+
+    if constexpr(!std::is_trivially_destructible_v<T>)
+    {
+        destructors_ = new(allocate(sizeof(Destructor), alignof(Destructor)))
+            Destructor{
+                [](void *p) { static_cast<T *>(p)->~T(); }, ret, destructors_
+            };
+    }
+
+    return ret;
+}
+
+CUJ_NAMESPACE_END(cuj::core)
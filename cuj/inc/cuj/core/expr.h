@@ -23,6 +23,14 @@ struct ArrayAddrToFirstElemAddr;
 struct Binary;
 struct Unary;
 struct CallFunc;
+struct Select;
+struct VectorBroadcast;
+struct VectorExtract;
+struct VectorInsert;
+struct VectorShuffle;
+struct VectorReduce;
+struct VectorLoad;
+struct AtomicOperation;
 
 using Expr = Variant<
     FuncArgAddr,
@@ -40,7 +48,15 @@ using Expr = Variant<
     ArrayAddrToFirstElemAddr,
     Binary,
     Unary,
-    CallFunc>;
+    CallFunc,
+    Select,
+    VectorBroadcast,
+    VectorExtract,
+    VectorInsert,
+    VectorShuffle,
+    VectorReduce,
+    VectorLoad,
+    AtomicOperation>;
 
 struct FuncArgAddr
 {
@@ -57,7 +73,7 @@ struct LocalAllocAddr
 struct Load
 {
     const Type *val_type;
-    RC<Expr>    src_addr;
+    Expr       *src_addr;
 };
 
 struct Immediate
@@ -88,15 +104,15 @@ struct ArithmeticCast
 {
     const Type *dst_type;
     const Type *src_type;
-    RC<Expr>    src_val;
+    Expr       *src_val;
 };
 
 struct PointerOffset
 {
     const Type *ptr_type;
     const Type *offset_type;
-    RC<Expr>    ptr_val;
-    RC<Expr>    offset_val;
+    Expr       *ptr_val;
+    Expr       *offset_val;
     bool        negative;
 };
 
@@ -104,38 +120,38 @@ struct ClassPointerToMemberPointer
 {
     const Type *class_ptr_type;
     const Type *member_ptr_type;
-    RC<Expr>    class_ptr;
+    Expr       *class_ptr;
     size_t      member_index;
 };
 
 struct DerefClassPointer
 {
     const Type *class_ptr_type;
-    RC<Expr>    class_ptr;
+    Expr       *class_ptr;
 };
 
 struct DerefArrayPointer
 {
     const Type *array_ptr_type;
-    RC<Expr>    array_ptr;
+    Expr       *array_ptr;
 };
 
 struct SaveClassIntoLocalAlloc
 {
     const Type *class_ptr_type;
-    RC<Expr>    class_val;
+    Expr       *class_val;
 };
 
 struct SaveArrayIntoLocalAlloc
 {
     const Type *array_ptr_type;
-    RC<Expr>    array_val;
+    Expr       *array_val;
 };
 
 struct ArrayAddrToFirstElemAddr
 {
     const Type *array_ptr_type;
-    RC<Expr>    array_ptr;
+    Expr       *array_ptr;
 };
 
 struct Binary
@@ -164,8 +180,8 @@ struct Binary
     };
 
     Op          op;
-    RC<Expr>    lhs;
-    RC<Expr>    rhs;
+    Expr       *lhs;
+    Expr       *rhs;
     const Type *lhs_type;
     const Type *rhs_type;
 };
@@ -180,7 +196,7 @@ struct Unary
     };
 
     Op          op;
-    RC<Expr>    val;
+    Expr       *val;
     const Type *val_type;
 };
 
@@ -190,7 +206,124 @@ struct CallFunc
     size_t         contexted_func_index = 0;
     Intrinsic      intrinsic            = Intrinsic::None;
 
-    std::vector<RC<Expr>> args;
+    std::vector<Expr *> args;
+};
+
+// cond ? true_val : false_val without branching. values can be of any type.
+// cond is a bool, or a mask selecting between elements of vector values
+struct Select
+{
+    const Type *val_type;
+    const Type *cond_type;
+    Expr       *cond;
+    Expr       *true_val;
+    Expr       *false_val;
+};
+
+struct VectorBroadcast
+{
+    const Type *vector_type;
+    Expr       *scalar;
+};
+
+struct VectorExtract
+{
+    const Type *vector_type;
+    const Type *index_type;
+    Expr       *vector;
+    Expr       *index;
+};
+
+struct VectorInsert
+{
+    const Type *vector_type;
+    const Type *index_type;
+    Expr       *vector;
+    Expr       *index;
+    Expr       *element;
+};
+
+// result[i] = indices[i] < n ? lhs[indices[i]] : rhs[indices[i] - n],
+// where n is the size of lhs. the result has indices.size() elements
+struct VectorShuffle
+{
+    const Type          *vector_type;
+    const Type          *src_type;
+    Expr                *lhs;
+    Expr                *rhs;
+    std::vector<int32_t> indices;
+};
+
+struct VectorReduce
+{
+    enum class Op
+    {
+        Add,
+        Mul,
+        Min,
+        Max,
+        BitwiseAnd,
+        BitwiseOr,
+        BitwiseXOr,
+    };
+
+    Op          op;
+    const Type *vector_type;
+    Expr       *vector;
+};
+
+// loads a vector from consecutive elements. aligned requires the address
+// to be aligned to the size of the vector
+struct VectorLoad
+{
+    const Type *vector_type;
+    const Type *elem_ptr_type;
+    Expr       *elem_ptr;
+    bool        aligned;
+};
+
+enum class MemoryOrder : uint8_t
+{
+    Relaxed,
+    Acquire,
+    Release,
+    AcqRel,
+    SeqCst,
+};
+
+// threads an atomic operation is atomic with respect to.
+// only the ptx backend distinguishes between them
+enum class MemoryScope : uint8_t
+{
+    Block,
+    Device,
+    System,
+};
+
+// atomically replaces *ptr with op(*ptr, val) and returns the old value.
+// CompareExchange replaces *ptr with val only if it equals cmp
+struct AtomicOperation
+{
+    enum class Op
+    {
+        Add,
+        Sub,
+        Min,
+        Max,
+        BitwiseAnd,
+        BitwiseOr,
+        BitwiseXOr,
+        Exchange,
+        CompareExchange,
+    };
+
+    Op          op;
+    MemoryOrder order;
+    MemoryScope scope;
+    const Type *val_type;
+    Expr       *ptr;
+    Expr       *val;
+    Expr       *cmp = nullptr;
 };
 
 CUJ_NAMESPACE_END(cuj::core)
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cuj/core/arena.h>
 #include <cuj/core/stat.h>
 
 CUJ_NAMESPACE_BEGIN(cuj::core)
@@ -27,7 +28,10 @@ struct Func
     Argument              return_type;
 
     std::vector<const Type *> local_alloc_types;
-    RC<Block>                 root_block;
+    Block                    *root_block = nullptr;
+
+    // owns all statements and expressions of this function
+    Box<Arena> arena = newBox<Arena>();
 };
 
 CUJ_NAMESPACE_END(cuj::core)
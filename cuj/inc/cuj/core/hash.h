@@ -0,0 +1,106 @@
+#pragma once
+
+#include <string_view>
+
+#include <cuj/core/prog.h>
+
+CUJ_NAMESPACE_BEGIN(cuj::core)
+
+// deterministic structural hash of core ir.
+// types are hashed by structure instead of by address, so the same program
+// recorded in different processes produces the same value
+class Hasher
+{
+public:
+
+    void hash(const Prog &prog);
+
+    // hash the given function together with all functions reachable from it.
+    // names generated by dsl are ignored, so structurally identical functions
+    // recorded in different modules produce the same value
+    void hash_canonical(const Prog &prog, size_t func_index);
+
+    void hash(const Func &func);
+
+    void hash(const Type *type);
+
+    void hash(const Stat &stat);
+
+    void hash(const Expr &expr);
+
+    void hash_bytes(const void *data, size_t bytes);
+
+    // when not nullptr, all hashed bytes are also appended to recorder.
+    // comparing recorded bytes tells hash collisions from equal inputs
+    void set_recorder(std::string *recorder);
+
+    void hash_string(std::string_view str);
+
+    template<typename T> requires std::is_trivially_copyable_v<T>
+    void hash_value(const T &value);
+
+    uint64_t get_hash() const;
+
+    std::string get_hash_str() const;
+
+private:
+
+    void hash(const Store &store);
+    void hash(const Block &block);
+    void hash(const Return &ret);
+    void hash(const If &if_s);
+    void hash(const Loop &loop);
+    void hash(const Break &break_s);
+    void hash(const Continue &continue_s);
+    void hash(const Switch &switch_s);
+    void hash(const CallFuncStat &call);
+    void hash(const VectorStore &store);
+
+    void hash(const FuncArgAddr &expr);
+    void hash(const LocalAllocAddr &expr);
+    void hash(const Load &expr);
+    void hash(const Immediate &expr);
+    void hash(const NullPtr &expr);
+    void hash(const ArithmeticCast &expr);
+    void hash(const PointerOffset &expr);
+    void hash(const ClassPointerToMemberPointer &expr);
+    void hash(const DerefClassPointer &expr);
+    void hash(const DerefArrayPointer &expr);
+    void hash(const SaveClassIntoLocalAlloc &expr);
+    void hash(const SaveArrayIntoLocalAlloc &expr);
+    void hash(const ArrayAddrToFirstElemAddr &expr);
+    void hash(const Binary &expr);
+    void hash(const Unary &expr);
+    void hash(const CallFunc &expr);
+    void hash(const Select &expr);
+    void hash(const VectorBroadcast &expr);
+    void hash(const VectorExtract &expr);
+    void hash(const VectorInsert &expr);
+    void hash(const VectorShuffle &expr);
+    void hash(const VectorReduce &expr);
+    void hash(const VectorLoad &expr);
+    void hash(const AtomicOperation &expr);
+
+    void hash_func_index(size_t index);
+
+    uint64_t     state_    = 0xcbf29ce484222325ull;
+    std::string *recorder_ = nullptr;
+
+    // recursive structs are numbered in order of first occurrence
+    std::map<const Type *, size_t> type_ids_;
+
+    // contextless callees are identified by their index in the program
+    std::map<const Func *, size_t> func_ids_;
+
+    // prog func index -> order of discovery in canonical mode
+    bool                     canonical_ = false;
+    std::map<size_t, size_t> canonical_func_ids_;
+};
+
+template<typename T> requires std::is_trivially_copyable_v<T>
+void Hasher::hash_value(const T &value)
+{
+    hash_bytes(&value, sizeof(T));
+}
+
+CUJ_NAMESPACE_END(cuj::core)
@@ -0,0 +1,478 @@
+#pragma once
+
+#include <algorithm>
+
+CUJ_NAMESPACE_BEGIN(cuj::core)
+
+template<typename Derived>
+void Visitor<Derived>::visit(const Stat &stat)
+{
+    derived().on_stat(stat);
+    stat.match([&](auto &_s) { derived().visit(_s); });
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const Store &store)
+{
+    derived().on_store(store);
+    derived().visit(store.dst_addr);
+    derived().visit(store.val);
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const Block &block)
+{
+    derived().on_block(block);
+    for(auto s : block.stats)
+        derived().visit(*s);
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const Return &ret)
+{
+    derived().on_return(ret);
+    derived().visit(ret.val);
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const If &if_s)
+{
+    derived().on_if(if_s);
+    derived().visit(*if_s.calc_cond);
+    derived().visit(if_s.cond);
+    derived().visit(*if_s.then_body);
+    if(if_s.else_body)
+        derived().visit(*if_s.else_body);
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const Loop &loop)
+{
+    derived().on_loop(loop);
+    derived().visit(*loop.body);
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const Break &break_s)
+{
+    derived().on_break(break_s);
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const Continue &continue_s)
+{
+    derived().on_continue(continue_s);
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const Switch &switch_s)
+{
+    derived().on_switch(switch_s);
+    derived().visit(switch_s.value);
+    for(auto &b : switch_s.branches)
+    {
+        derived().visit(b.cond);
+        derived().visit(*b.body);
+    }
+    if(switch_s.default_body)
+        derived().visit(*switch_s.default_body);
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const CallFuncStat &call)
+{
+    derived().on_call_func_stat(call);
+    derived().visit(call.call_expr);
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const VectorStore &store)
+{
+    derived().on_vector_store(store);
+    derived().visit(store.elem_ptr);
+    derived().visit(store.val);
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const Expr &expr)
+{
+    derived().on_expr(expr);
+    expr.match([&](auto &_e) { derived().visit(_e); });
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const FuncArgAddr &expr)
+{
+    derived().on_func_arg_addr(expr);
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const LocalAllocAddr &expr)
+{
+    derived().on_local_alloc_addr(expr);
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const Load &expr)
+{
+    derived().on_load(expr);
+    derived().visit(*expr.src_addr);
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const Immediate &expr)
+{
+    derived().on_immediate(expr);
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const NullPtr &expr)
+{
+    derived().on_nullptr(expr);
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const ArithmeticCast &expr)
+{
+    derived().on_arithmetic_cast(expr);
+    derived().visit(*expr.src_val);
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const PointerOffset &expr)
+{
+    derived().on_pointer_offset(expr);
+    derived().visit(*expr.ptr_val);
+    derived().visit(*expr.offset_val);
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const ClassPointerToMemberPointer &expr)
+{
+    derived().on_class_ptr_to_member_ptr(expr);
+    derived().visit(*expr.class_ptr);
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const DerefClassPointer &expr)
+{
+    derived().on_deref_class_ptr(expr);
+    derived().visit(*expr.class_ptr);
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const DerefArrayPointer &expr)
+{
+    derived().on_deref_array_ptr(expr);
+    derived().visit(*expr.array_ptr);
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const SaveClassIntoLocalAlloc &expr)
+{
+    derived().on_save_class_into_local_alloc(expr);
+    derived().visit(*expr.class_val);
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const SaveArrayIntoLocalAlloc &expr)
+{
+    derived().on_save_array_into_local_alloc(expr);
+    derived().visit(*expr.array_val);
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const ArrayAddrToFirstElemAddr &expr)
+{
+    derived().on_array_ptr_to_first_elem_ptr(expr);
+    derived().visit(*expr.array_ptr);
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const Binary &expr)
+{
+    derived().on_binary(expr);
+    derived().visit(*expr.lhs);
+    derived().visit(*expr.rhs);
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const Unary &expr)
+{
+    derived().on_unary(expr);
+    derived().visit(*expr.val);
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const CallFunc &expr)
+{
+    derived().on_call_func(expr);
+    for(auto arg : expr.args)
+        derived().visit(*arg);
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const Select &expr)
+{
+    derived().on_select(expr);
+    derived().visit(*expr.cond);
+    derived().visit(*expr.true_val);
+    derived().visit(*expr.false_val);
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const VectorBroadcast &expr)
+{
+    derived().on_vector_broadcast(expr);
+    derived().visit(*expr.scalar);
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const VectorExtract &expr)
+{
+    derived().on_vector_extract(expr);
+    derived().visit(*expr.vector);
+    derived().visit(*expr.index);
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const VectorInsert &expr)
+{
+    derived().on_vector_insert(expr);
+    derived().visit(*expr.vector);
+    derived().visit(*expr.index);
+    derived().visit(*expr.element);
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const VectorShuffle &expr)
+{
+    derived().on_vector_shuffle(expr);
+    derived().visit(*expr.lhs);
+    derived().visit(*expr.rhs);
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const VectorReduce &expr)
+{
+    derived().on_vector_reduce(expr);
+    derived().visit(*expr.vector);
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const VectorLoad &expr)
+{
+    derived().on_vector_load(expr);
+    derived().visit(*expr.elem_ptr);
+}
+
+template<typename Derived>
+void Visitor<Derived>::visit(const AtomicOperation &expr)
+{
+    derived().on_atomic_operation(expr);
+    derived().visit(*expr.ptr);
+    derived().visit(*expr.val);
+    if(expr.cmp)
+        derived().visit(*expr.cmp);
+}
+
+template<typename Derived>
+void Rewriter<Derived>::rewrite(Func &func)
+{
+    derived().rewrite(*func.root_block);
+}
+
+template<typename Derived>
+void Rewriter<Derived>::rewrite(Block &block)
+{
+    for(auto s : block.stats)
+        derived().rewrite(*s);
+    std::erase_if(block.stats, [](const Stat *s)
+    {
+        auto b = s->as_if<Block>();
+        return b && b->stats.empty();
+    });
+}
+
+template<typename Derived>
+void Rewriter<Derived>::rewrite(Stat &stat)
+{
+    rewrite_children(stat);
+    derived().rewrite_stat(stat);
+}
+
+template<typename Derived>
+void Rewriter<Derived>::rewrite(Expr &expr)
+{
+    rewrite_children(expr);
+    derived().rewrite_expr(expr);
+}
+
+template<typename Derived>
+void Rewriter<Derived>::rewrite_children(Stat &stat)
+{
+    stat.match(
+        [&](Store &s)
+    {
+        derived().rewrite(s.dst_addr);
+        derived().rewrite(s.val);
+    },
+        [&](Block &s)
+    {
+        derived().rewrite(s);
+    },
+        [&](Return &s)
+    {
+        derived().rewrite(s.val);
+    },
+        [&](If &s)
+    {
+        derived().rewrite(*s.calc_cond);
+        derived().rewrite(s.cond);
+        derived().rewrite(*s.then_body);
+        if(s.else_body)
+            derived().rewrite(*s.else_body);
+    },
+        [&](Loop &s)
+    {
+        derived().rewrite(*s.body);
+    },
+        [&](Switch &s)
+    {
+        derived().rewrite(s.value);
+        for(auto &b : s.branches)
+            derived().rewrite(*b.body);
+        if(s.default_body)
+            derived().rewrite(*s.default_body);
+    },
+        [&](CallFuncStat &s)
+    {
+        for(auto arg : s.call_expr.args)
+            derived().rewrite(*arg);
+    },
+        [&](VectorStore &s)
+    {
+        derived().rewrite(s.elem_ptr);
+        derived().rewrite(s.val);
+    },
+        [](auto &) { });
+}
+
+template<typename Derived>
+void Rewriter<Derived>::rewrite_children(Expr &expr)
+{
+    expr.match(
+        [&](Load &e)
+    {
+        derived().rewrite(*e.src_addr);
+    },
+        [&](ArithmeticCast &e)
+    {
+        derived().rewrite(*e.src_val);
+    },
+        [&](PointerOffset &e)
+    {
+        derived().rewrite(*e.ptr_val);
+        derived().rewrite(*e.offset_val);
+    },
+        [&](ClassPointerToMemberPointer &e)
+    {
+        derived().rewrite(*e.class_ptr);
+    },
+        [&](DerefClassPointer &e)
+    {
+        derived().rewrite(*e.class_ptr);
+    },
+        [&](DerefArrayPointer &e)
+    {
+        derived().rewrite(*e.array_ptr);
+    },
+        [&](SaveClassIntoLocalAlloc &e)
+    {
+        derived().rewrite(*e.class_val);
+    },
+        [&](SaveArrayIntoLocalAlloc &e)
+    {
+        derived().rewrite(*e.array_val);
+    },
+        [&](ArrayAddrToFirstElemAddr &e)
+    {
+        derived().rewrite(*e.array_ptr);
+    },
+        [&](Binary &e)
+    {
+        derived().rewrite(*e.lhs);
+        derived().rewrite(*e.rhs);
+    },
+        [&](Unary &e)
+    {
+        derived().rewrite(*e.val);
+    },
+        [&](CallFunc &e)
+    {
+        for(auto arg : e.args)
+            derived().rewrite(*arg);
+    },
+        [&](Select &e)
+    {
+        derived().rewrite(*e.cond);
+        derived().rewrite(*e.true_val);
+        derived().rewrite(*e.false_val);
+    },
+        [&](VectorBroadcast &e)
+    {
+        derived().rewrite(*e.scalar);
+    },
+        [&](VectorExtract &e)
+    {
+        derived().rewrite(*e.vector);
+        derived().rewrite(*e.index);
+    },
+        [&](VectorInsert &e)
+    {
+        derived().rewrite(*e.vector);
+        derived().rewrite(*e.index);
+        derived().rewrite(*e.element);
+    },
+        [&](VectorShuffle &e)
+    {
+        derived().rewrite(*e.lhs);
+        derived().rewrite(*e.rhs);
+    },
+        [&](VectorReduce &e)
+    {
+        derived().rewrite(*e.vector);
+    },
+        [&](VectorLoad &e)
+    {
+        derived().rewrite(*e.elem_ptr);
+    },
+        [&](AtomicOperation &e)
+    {
+        derived().rewrite(*e.ptr);
+        derived().rewrite(*e.val);
+        if(e.cmp)
+            derived().rewrite(*e.cmp);
+    },
+        [](auto &) { });
+}
+
+template<typename Node, typename F>
+void visit_call_funcs(const Node &node, F &&func)
+{
+    class CallFuncVisitor : public Visitor<CallFuncVisitor>
+    {
+    public:
+
+        explicit CallFuncVisitor(F &f) : f_(f) { }
+
+        void on_call_func(const CallFunc &call) { f_(call); }
+
+    private:
+
+        F &f_;
+    };
+    CallFuncVisitor(func).visit(node);
+}
+
+CUJ_NAMESPACE_END(cuj::core)
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cuj/core/prog.h>
+
+CUJ_NAMESPACE_BEGIN(cuj::core)
+
+struct OptimizationStatistics
+{
+    uint64_t merged_exprs   = 0; // repeated pure expressions replaced by a load
+    uint64_t removed_stores = 0; // stores into locals which are never read
+    uint64_t removed_stats  = 0; // statements after return, break or continue
+};
+
+// locals and arguments whose address is used by anything other than a direct
+// load or store. the others can't be changed through pointers or by calls
+struct AddressTakenSlots
+{
+    std::vector<bool> locals;
+    std::vector<bool> args;
+};
+
+AddressTakenSlots find_address_taken_slots(const Func &func);
+
+// cheap cleanups done on core ir before it is lowered:
+//   1. statements following return/break/continue in the same block are removed
+//   2. pure expressions evaluated again while their operands are unchanged
+//      are computed once into a new local
+//   3. stores into locals which are never read are removed
+// optimized functions are copies. prog and its functions are not modified.
+// calls between optimized functions are redirected to the copies
+Prog optimize(
+    const Prog                &prog,
+    const std::vector<size_t> &func_indices,
+    OptimizationStatistics    *statistics = nullptr);
+
+Prog optimize(const Prog &prog, OptimizationStatistics *statistics = nullptr);
+
+CUJ_NAMESPACE_END(cuj::core)
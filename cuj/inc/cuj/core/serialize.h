@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cuj/core/prog.h>
+
+CUJ_NAMESPACE_BEGIN(cuj::core)
+
+// version of the binary format. programs written by other versions are rejected
+constexpr uint32_t SERIALIZED_PROG_VERSION = 3;
+
+// encode prog into a compact binary format.
+// types of all type sets are merged into one table, and every node only refers
+// to nodes written before it, so expressions shared by several nodes are
+// written once
+std::vector<uint8_t> serialize(const Prog &prog);
+
+// decode a program produced by serialize in a single front-to-back pass.
+// data can point directly into a memory-mapped file. all types of the result
+// are placed in its global type set
+Prog deserialize(const void *data, size_t bytes);
+
+CUJ_NAMESPACE_END(cuj::core)
@@ -13,6 +13,7 @@ struct Break;
 struct Continue;
 struct Switch;
 struct CallFuncStat;
+struct VectorStore;
 
 using Stat = Variant<
     Store,
@@ -23,7 +24,8 @@ using Stat = Variant<
     Break,
     Continue,
     Switch,
-    CallFuncStat>;
+    CallFuncStat,
+    VectorStore>;
 
 struct Store
 {
@@ -33,7 +35,7 @@ struct Store
 
 struct Block
 {
-    std::vector<RC<Stat>> stats;
+    std::vector<Stat *> stats;
 };
 
 struct Return
@@ -44,15 +46,15 @@ struct Return
 
 struct If
 {
-    RC<Block> calc_cond;
+    Block    *calc_cond;
     Expr      cond;
-    RC<Stat>  then_body;
-    RC<Stat>  else_body;
+    Stat     *then_body;
+    Stat     *else_body = nullptr;
 };
 
 struct Loop
 {
-    RC<Block> body;
+    Block *body;
 };
 
 struct Break
@@ -70,13 +72,13 @@ struct Switch
     struct Branch
     {
         Immediate cond;
-        RC<Block> body;
+        Block    *body;
         bool      fallthrough = false;
     };
 
     Expr                value;
     std::vector<Branch> branches;
-    RC<Block>           default_body;
+    Block              *default_body = nullptr;
 };
 
 struct CallFuncStat
@@ -84,4 +86,14 @@ struct CallFuncStat
     CallFunc call_expr;
 };
 
+// stores a vector into consecutive elements. see VectorLoad
+struct VectorStore
+{
+    const Type *vector_type;
+    const Type *elem_ptr_type;
+    Expr        elem_ptr;
+    Expr        val;
+    bool        aligned;
+};
+
 CUJ_NAMESPACE_END(cuj::core)
@@ -72,12 +72,14 @@ constexpr Builtin arithmetic_to_builtin_v = ArithmeticToBuiltinType<T>::value;
 struct Struct;
 struct Array;
 struct Pointer;
+struct Vector;
 
 using Type = Variant<
     Builtin,
     Struct,
     Array,
-    Pointer>;
+    Pointer,
+    Vector>;
 
 struct Struct
 {
@@ -107,10 +109,26 @@ struct Pointer
     bool operator==(const Pointer &rhs) const;
 };
 
+// fixed-width simd vector of an arithmetic builtin.
+// vectors of bool are masks produced by comparisons
+struct Vector
+{
+    const Type *element = nullptr;
+    size_t      size    = 0;
+
+    std::strong_ordering operator<=>(const Vector &rhs) const;
+
+    bool operator==(const Vector &rhs) const;
+};
+
+// types recorded by dsl are keyed by their c++ type. types read from a
+// serialized program are keyed by their position in its type table
+using TypeKey = Variant<std::type_index, size_t>;
+
 struct TypeSet
 {
-    std::map<std::type_index, RC<Type>>     index_to_type;
-    std::map<const Type *, std::type_index> type_to_index;
+    std::map<TypeKey, RC<Type>>     index_to_type;
+    std::map<const Type *, TypeKey> type_to_index;
 };
 
 inline bool is_floating_point(core::Builtin builtin)
@@ -139,4 +157,12 @@ inline bool is_signed(core::Builtin builtin)
     }
 }
 
+// builtin of an arithmetic type, or of the elements of a vector type
+inline Builtin get_element_builtin(const Type *type)
+{
+    if(auto vec = type->as_if<Vector>())
+        return vec->element->as<Builtin>();
+    return type->as<Builtin>();
+}
+
 CUJ_NAMESPACE_END(cuj::core)
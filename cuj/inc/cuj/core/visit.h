@@ -1,11 +1,14 @@
 #pragma once
 
-#include <functional>
-
 #include <cuj/core/prog.h>
 
 CUJ_NAMESPACE_BEGIN(cuj::core)
 
+// pre-order traversal of core ir with static dispatch.
+// derive as 'class X : public Visitor<X>' and define the on_xxx hooks of
+// interested nodes. hooks are called before children are visited.
+// expressions shared by multiple parents are visited once per parent
+template<typename Derived>
 class Visitor
 {
 public:
@@ -20,6 +23,7 @@ public:
     void visit(const Continue     &continue_s);
     void visit(const Switch       &switch_s);
     void visit(const CallFuncStat &call);
+    void visit(const VectorStore  &store);
 
     void visit(const Expr                        &expr);
     void visit(const FuncArgAddr                 &expr);
@@ -38,35 +42,94 @@ public:
     void visit(const Binary                      &expr);
     void visit(const Unary                       &expr);
     void visit(const CallFunc                    &expr);
+    void visit(const Select                      &expr);
+    void visit(const VectorBroadcast             &expr);
+    void visit(const VectorExtract               &expr);
+    void visit(const VectorInsert                &expr);
+    void visit(const VectorShuffle               &expr);
+    void visit(const VectorReduce                &expr);
+    void visit(const VectorLoad                  &expr);
+    void visit(const AtomicOperation             &expr);
+
+    void on_stat          (const Stat         &) { }
+    void on_store         (const Store        &) { }
+    void on_block         (const Block        &) { }
+    void on_return        (const Return       &) { }
+    void on_if            (const If           &) { }
+    void on_loop          (const Loop         &) { }
+    void on_break         (const Break        &) { }
+    void on_continue      (const Continue     &) { }
+    void on_switch        (const Switch       &) { }
+    void on_call_func_stat(const CallFuncStat &) { }
+    void on_vector_store  (const VectorStore  &) { }
+
+    void on_expr                       (const Expr                        &) { }
+    void on_func_arg_addr              (const FuncArgAddr                 &) { }
+    void on_local_alloc_addr           (const LocalAllocAddr              &) { }
+    void on_load                       (const Load                        &) { }
+    void on_immediate                  (const Immediate                   &) { }
+    void on_nullptr                    (const NullPtr                     &) { }
+    void on_arithmetic_cast            (const ArithmeticCast              &) { }
+    void on_pointer_offset             (const PointerOffset               &) { }
+    void on_class_ptr_to_member_ptr    (const ClassPointerToMemberPointer &) { }
+    void on_deref_class_ptr            (const DerefClassPointer           &) { }
+    void on_deref_array_ptr            (const DerefArrayPointer           &) { }
+    void on_save_class_into_local_alloc(const SaveClassIntoLocalAlloc     &) { }
+    void on_save_array_into_local_alloc(const SaveArrayIntoLocalAlloc     &) { }
+    void on_array_ptr_to_first_elem_ptr(const ArrayAddrToFirstElemAddr    &) { }
+    void on_binary                     (const Binary                      &) { }
+    void on_unary                      (const Unary                       &) { }
+    void on_call_func                  (const CallFunc                    &) { }
+    void on_select                     (const Select                      &) { }
+    void on_vector_broadcast           (const VectorBroadcast             &) { }
+    void on_vector_extract             (const VectorExtract               &) { }
+    void on_vector_insert              (const VectorInsert                &) { }
+    void on_vector_shuffle             (const VectorShuffle               &) { }
+    void on_vector_reduce              (const VectorReduce                &) { }
+    void on_vector_load                (const VectorLoad                  &) { }
+    void on_atomic_operation           (const AtomicOperation             &) { }
+
+private:
+
+    Derived &derived() { return *static_cast<Derived *>(this); }
+};
+
+// post-order traversal of mutable core ir.
+// derive as 'class X : public Rewriter<X>' and define rewrite_expr/rewrite_stat.
+// they are called after all children of the node are rewritten and may
+// replace the node in place, e.g. 'expr = Immediate{ ... }'. new child nodes
+// should be allocated from the arena of the rewritten function.
+// statements replaced with empty blocks are removed from their parent block
+template<typename Derived>
+class Rewriter
+{
+public:
+
+    void rewrite(Func &func);
 
-    std::function<void(const Stat &)>         on_stat;
-    std::function<void(const Store &)>        on_store;
-    std::function<void(const Block &)>        on_block;
-    std::function<void(const Return &)>       on_return;
-    std::function<void(const If &)>           on_if;
-    std::function<void(const Loop &)>         on_loop;
-    std::function<void(const Break &)>        on_break;
-    std::function<void(const Continue &)>     on_continue;
-    std::function<void(const Switch &)>       on_switch;
-    std::function<void(const CallFuncStat &)> on_call_func_stat;
-    
-    std::function<void(const Expr                        &)> on_expr;
-    std::function<void(const FuncArgAddr                 &)> on_func_arg_addr;
-    std::function<void(const LocalAllocAddr              &)> on_local_alloc_addr;
-    std::function<void(const Load                        &)> on_load;
-    std::function<void(const Immediate                   &)> on_immediate;
-    std::function<void(const NullPtr                     &)> on_nullptr;
-    std::function<void(const ArithmeticCast              &)> on_arithmetic_cast;
-    std::function<void(const PointerOffset               &)> on_pointer_offset;
-    std::function<void(const ClassPointerToMemberPointer &)> on_class_ptr_to_member_ptr;
-    std::function<void(const DerefClassPointer           &)> on_deref_class_ptr;
-    std::function<void(const DerefArrayPointer           &)> on_deref_array_ptr;
-    std::function<void(const SaveClassIntoLocalAlloc     &)> on_save_class_into_local_alloc;
-    std::function<void(const SaveArrayIntoLocalAlloc     &)> on_save_array_into_local_alloc;
-    std::function<void(const ArrayAddrToFirstElemAddr    &)> on_array_ptr_to_first_elem_ptr;
-    std::function<void(const Binary                      &)> on_binary;
-    std::function<void(const Unary                       &)> on_unary;
-    std::function<void(const CallFunc                    &)> on_call_func;
+    void rewrite(Block &block);
+
+    void rewrite(Stat &stat);
+
+    void rewrite(Expr &expr);
+
+    void rewrite_stat(Stat &) { }
+
+    void rewrite_expr(Expr &) { }
+
+private:
+
+    Derived &derived() { return *static_cast<Derived *>(this); }
+
+    void rewrite_children(Stat &stat);
+
+    void rewrite_children(Expr &expr);
 };
 
+// calls func with every CallFunc in the given node
+template<typename Node, typename F>
+void visit_call_funcs(const Node &node, F &&func);
+
 CUJ_NAMESPACE_END(cuj::core)
+
+#include <cuj/core/impl/visit.inl>
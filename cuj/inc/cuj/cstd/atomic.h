@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cuj/dsl/dsl.h>
+
+CUJ_NAMESPACE_BEGIN(cuj::cstd)
+
+using MemoryOrder = core::MemoryOrder;
+using MemoryScope = core::MemoryScope;
+
+namespace atomic_detail
+{
+
+    template<typename T>
+    T atomic_operation(
+        core::AtomicOperation::Op op,
+        MemoryOrder               order,
+        MemoryScope               scope,
+        const ptr<T>             &dst,
+        const T                  &val,
+        const T                  *cmp = nullptr)
+    {
+        static_assert(
+            sizeof(typename T::RawType) == 4 || sizeof(typename T::RawType) == 8,
+            "atomic operations require 32 or 64 bit values");
+
+        auto func_ctx = dsl::FunctionContext::get_func_context();
+        auto type_ctx = func_ctx->get_type_context();
+        return T::_from_expr(core::AtomicOperation{
+            .op       = op,
+            .order    = order,
+            .scope    = scope,
+            .val_type = type_ctx->get_type<T>(),
+            .ptr      = dsl::newNode<core::Expr>(dst._load()),
+            .val      = dsl::newNode<core::Expr>(val._load()),
+            .cmp      = cmp ? dsl::newNode<core::Expr>(cmp->_load()) : nullptr
+        });
+    }
+
+} // namespace atomic_detail
+
+// each of the following functions atomically updates *dst and returns its old
+// value. scope is ignored by the native backend
+
+template<typename T> requires dsl::is_cuj_arithmetic_v<T>
+T atomic_add(
+    const ptr<T>                  &dst,
+    const std::type_identity_t<T> &val,
+    MemoryOrder                    order = MemoryOrder::SeqCst,
+    MemoryScope                    scope = MemoryScope::Device)
+{
+    return atomic_detail::atomic_operation(
+        core::AtomicOperation::Op::Add, order, scope, dst, val);
+}
+
+template<typename T> requires dsl::is_cuj_arithmetic_v<T>
+T atomic_sub(
+    const ptr<T>                  &dst,
+    const std::type_identity_t<T> &val,
+    MemoryOrder                    order = MemoryOrder::SeqCst,
+    MemoryScope                    scope = MemoryScope::Device)
+{
+    return atomic_detail::atomic_operation(
+        core::AtomicOperation::Op::Sub, order, scope, dst, val);
+}
+
+template<typename T> requires dsl::is_cuj_arithmetic_v<T>
+T atomic_min(
+    const ptr<T>                  &dst,
+    const std::type_identity_t<T> &val,
+    MemoryOrder                    order = MemoryOrder::SeqCst,
+    MemoryScope                    scope = MemoryScope::Device)
+{
+    return atomic_detail::atomic_operation(
+        core::AtomicOperation::Op::Min, order, scope, dst, val);
+}
+
+template<typename T> requires dsl::is_cuj_arithmetic_v<T>
+T atomic_max(
+    const ptr<T>                  &dst,
+    const std::type_identity_t<T> &val,
+    MemoryOrder                    order = MemoryOrder::SeqCst,
+    MemoryScope                    scope = MemoryScope::Device)
+{
+    return atomic_detail::atomic_operation(
+        core::AtomicOperation::Op::Max, order, scope, dst, val);
+}
+
+template<typename T> requires dsl::is_cuj_arithmetic_v<T>
+T atomic_and(
+    const ptr<T>                  &dst,
+    const std::type_identity_t<T> &val,
+    MemoryOrder                    order = MemoryOrder::SeqCst,
+    MemoryScope                    scope = MemoryScope::Device)
+{
+    static_assert(std::is_integral_v<typename T::RawType>);
+    return atomic_detail::atomic_operation(
+        core::AtomicOperation::Op::BitwiseAnd, order, scope, dst, val);
+}
+
+template<typename T> requires dsl::is_cuj_arithmetic_v<T>
+T atomic_or(
+    const ptr<T>                  &dst,
+    const std::type_identity_t<T> &val,
+    MemoryOrder                    order = MemoryOrder::SeqCst,
+    MemoryScope                    scope = MemoryScope::Device)
+{
+    static_assert(std::is_integral_v<typename T::RawType>);
+    return atomic_detail::atomic_operation(
+        core::AtomicOperation::Op::BitwiseOr, order, scope, dst, val);
+}
+
+template<typename T> requires dsl::is_cuj_arithmetic_v<T>
+T atomic_xor(
+    const ptr<T>                  &dst,
+    const std::type_identity_t<T> &val,
+    MemoryOrder                    order = MemoryOrder::SeqCst,
+    MemoryScope                    scope = MemoryScope::Device)
+{
+    static_assert(std::is_integral_v<typename T::RawType>);
+    return atomic_detail::atomic_operation(
+        core::AtomicOperation::Op::BitwiseXOr, order, scope, dst, val);
+}
+
+template<typename T> requires dsl::is_cuj_arithmetic_v<T>
+T atomic_exchange(
+    const ptr<T>                  &dst,
+    const std::type_identity_t<T> &val,
+    MemoryOrder                    order = MemoryOrder::SeqCst,
+    MemoryScope                    scope = MemoryScope::Device)
+{
+    return atomic_detail::atomic_operation(
+        core::AtomicOperation::Op::Exchange, order, scope, dst, val);
+}
+
+// stores desired into *dst only if it equals expected. values are compared
+// bitwise, so 0.0f and -0.0f are different
+template<typename T> requires dsl::is_cuj_arithmetic_v<T>
+T atomic_compare_exchange(
+    const ptr<T>                  &dst,
+    const std::type_identity_t<T> &expected,
+    const std::type_identity_t<T> &desired,
+    MemoryOrder                    order = MemoryOrder::SeqCst,
+    MemoryScope                    scope = MemoryScope::Device)
+{
+    return atomic_detail::atomic_operation(
+        core::AtomicOperation::Op::CompareExchange,
+        order, scope, dst, desired, &expected);
+}
+
+CUJ_NAMESPACE_END(cuj::cstd)
@@ -64,22 +64,15 @@ f32 max(f32 a, f32 b);
 f64 min(f64 a, f64 b);
 f64 max(f64 a, f64 b);
 
+// branch-free. both a and b are evaluated
+
 template<typename T> requires dsl::is_cuj_var_v<T>
 T select(
     const boolean &cond,
     const T       &a,
     const T       &b)
 {
-    T ret;
-    $if(cond)
-    {
-        ret = a;
-    }
-    $else
-    {
-        ret = b;
-    };
-    return ret;
+    return dsl::select(cond, a, b);
 }
 
 template<typename T>
@@ -88,16 +81,7 @@ T select(
     const dsl::var<T> &a,
     const dsl::var<T> &b)
 {
-    T ret;
-    $if(cond)
-    {
-        ret = a;
-    }
-    $else
-    {
-        ret = b;
-    };
-    return ret;
+    return dsl::select<dsl::var<T>>(cond, a, b);
 }
 
 template<typename T>
@@ -106,18 +90,7 @@ ref<T> select(
     const ref<T>  &a,
     const ref<T>  &b)
 {
-    var pa = a.address();
-    var pb = b.address();
-    ptr<T> pr;
-    $if(cond)
-    {
-        pr = pa;
-    }
-    $else
-    {
-        pr = pb;
-    };
-    return *pr;
+    return *dsl::select(cond, a.address(), b.address());
 }
 
 CUJ_NAMESPACE_END(cuj::cstd)
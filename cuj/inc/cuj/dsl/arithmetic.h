@@ -1,6 +1,8 @@
 #pragma once
 
-#include <cuj/core/expr.h>
+#include <optional>
+
+#include <cuj/core/stat.h>
 #include <cuj/dsl/variable_forward.h>
 
 CUJ_NAMESPACE_BEGIN(cuj::dsl)
@@ -8,7 +10,28 @@ CUJ_NAMESPACE_BEGIN(cuj::dsl)
 template<typename T> requires std::is_arithmetic_v<T>
 class Arithmetic
 {
-    size_t alloc_index_;
+    struct Uninit { };
+
+    explicit Arithmetic(Uninit) { }
+
+    // a temp value is stored into alloc_index_ only when needed
+    mutable size_t     alloc_index_ = 0;
+    mutable TempValue *temp_        = nullptr;
+
+    // value known at record time. only valid in the block it was stored in
+    std::optional<T>   known_value_;
+    const core::Block *known_block_   = nullptr;
+    mutable bool       address_taken_ = false;
+
+    void init_temp(core::Expr expr);
+
+    void set_known_value(std::optional<T> value);
+
+    std::optional<Arithmetic> fold(
+        core::Binary::Op op, const Arithmetic &rhs) const;
+
+    std::optional<Arithmetic<bool>> fold_compare(
+        core::Binary::Op op, const Arithmetic &rhs) const;
 
 public:
 
@@ -30,6 +53,8 @@ public:
 
     Arithmetic(Arithmetic &&other) noexcept;
 
+    ~Arithmetic();
+
     Arithmetic &operator=(const Arithmetic &other);
 
     template<typename U> requires is_cuj_arithmetic_v<U>
@@ -70,9 +95,12 @@ public:
 
     static Arithmetic _from_expr(core::Expr expr);
 
-    core::Load _load() const;
+    // loads the value, or gives its immediate when it is known at record time
+    core::Expr _load() const;
 
     core::LocalAllocAddr _addr() const;
+
+    std::optional<T> _known_value() const;
 };
 
 template<typename T>
@@ -10,7 +10,7 @@ class ref<Arithmetic<T>>
 {
     Pointer<Arithmetic<T>> addr_;
 
-    ref() = default;
+    explicit ref(const Pointer<Arithmetic<T>> &addr) : addr_(addr) { }
 
 public:
 
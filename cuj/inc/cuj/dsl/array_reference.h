@@ -10,7 +10,7 @@ class ref<Array<T, N>>
 {
     Pointer<Array<T, N>> addr_;
 
-    ref() = default;
+    explicit ref(const Pointer<Array<T, N>> &addr) : addr_(addr) { }
 
 public:
 
@@ -13,9 +13,11 @@
 #include <cuj/dsl/pointer_reference.h>
 #include <cuj/dsl/reference.h>
 #include <cuj/dsl/return.h>
+#include <cuj/dsl/select.h>
 #include <cuj/dsl/switch.h>
 #include <cuj/dsl/type_context.h>
 #include <cuj/dsl/variable.h>
+#include <cuj/dsl/vector.h>
 #include <cuj/gen/gen.h>
 
 #include <cuj/dsl/impl/arithmetic.inl>
@@ -29,8 +31,10 @@
 #include <cuj/dsl/impl/pointer.inl>
 #include <cuj/dsl/impl/pointer_reference.inl>
 #include <cuj/dsl/impl/return.inl>
+#include <cuj/dsl/impl/select.inl>
 #include <cuj/dsl/impl/switch.inl>
 #include <cuj/dsl/impl/type_context.inl>
+#include <cuj/dsl/impl/vector.inl>
 
 CUJ_NAMESPACE_BEGIN(cuj)
 
@@ -50,6 +54,19 @@ using f64 = dsl::Arithmetic<double>;
 using boolean = dsl::Arithmetic<bool>;
 using char_t = dsl::Arithmetic<char>;
 
+using f32x4 = dsl::Vector<float, 4>;
+using f32x8 = dsl::Vector<float, 8>;
+using f64x2 = dsl::Vector<double, 2>;
+using f64x4 = dsl::Vector<double, 4>;
+
+using i32x4 = dsl::Vector<int32_t, 4>;
+using i32x8 = dsl::Vector<int32_t, 8>;
+using u32x4 = dsl::Vector<uint32_t, 4>;
+using u32x8 = dsl::Vector<uint32_t, 8>;
+
+using boolx4 = dsl::Vector<bool, 4>;
+using boolx8 = dsl::Vector<bool, 8>;
+
 using dsl::Function;
 using dsl::Module;
 using dsl::ScopedModule;
@@ -60,10 +77,13 @@ using dsl::ref;
 using dsl::ptr;
 using dsl::num;
 using dsl::arr;
+using dsl::vec;
 using dsl::cxx;
 
 using dsl::function;
 using dsl::kernel;
 using dsl::declare;
 
+using dsl::select;
+
 CUJ_NAMESPACE_END(cuj)
@@ -80,6 +80,23 @@ namespace function_detail
 
 } // namespace function_detail
 
+// value of a pure expression. it is stored into a local only when the
+// expression can no longer be used in place
+struct TempValue
+{
+    const core::Type *type;
+    core::Expr        expr;
+    core::Block      *block;
+    size_t            stat_index; // statements in block before the value
+    size_t            epoch;
+    size_t            alloc_index   = 0;
+    size_t            store_order   = 0;
+    bool              materialized  = false;
+    bool              store_pending = false;
+    bool              used          = false;
+    bool              alive         = true;
+};
+
 class FunctionContext :
     public Uncopyable, public std::enable_shared_from_this<FunctionContext>
 {
@@ -109,14 +126,21 @@ public:
 
     const core::Func::Argument &get_return() const;
 
-    void append_statement(RC<core::Stat> stat);
+    void append_statement(core::Stat *stat);
 
     void append_statement(core::Stat stat);
 
-    void push_block(RC<core::Block> block);
+    void push_block(core::Block *block);
 
     void pop_block();
 
+    // called when the function body has been recorded
+    void finish_recording();
+
+    const core::Block *get_current_block() const;
+
+    bool is_constant_folding_enabled() const;
+
     TypeContext *get_type_context();
 
     Module *get_module() const;
@@ -125,22 +149,61 @@ public:
 
     size_t get_index_in_module() const;
 
+    // used by module when it reorders its functions
+    void remap_function_indices(const std::vector<size_t> &old_to_new);
+
     size_t alloc_local_var(const core::Type *type);
 
+    TempValue *create_temp_value(const core::Type *type, core::Expr expr);
+
+    // returns nullptr if the value must be loaded from its local
+    const core::Expr *use_temp_value(TempValue *value);
+
+    size_t materialize_temp_value(TempValue *value);
+
+    // gives a local for a value which is about to be overwritten
+    size_t overwrite_temp_value(TempValue *value);
+
     RC<FunctionContext> clone_with_module(Module *mod);
 
     RC<const core::Func> get_core_func() const;
 
+    // allocates a core ir node owned by this function
+    template<typename T, typename...Args>
+    T *create_node(Args &&...args);
+
 private:
 
+    void insert_pending_stores(
+        core::Block *block, const std::vector<TempValue *> &values);
+
     RC<core::Func>  func_;
     RC<TypeContext> type_context_;
 
     size_t                       index_in_module_;
     Module                      *module_;
-    std::stack<RC<core::Block>>  blocks_;
+    std::stack<core::Block *>    blocks_;
+
+    // bumped whenever a statement is recorded or the current block changes
+    size_t                                 epoch_ = 0;
+    size_t                                 store_count_ = 0;
+    std::stack<std::vector<TempValue *>>   block_temp_values_;
 };
 
+template<typename T, typename...Args>
+T *FunctionContext::create_node(Args &&...args)
+{
+    return func_->arena->create<T>(std::forward<Args>(args)...);
+}
+
+// allocates a core ir node in the function being recorded
+template<typename T, typename...Args>
+T *newNode(Args &&...args)
+{
+    return FunctionContext::get_func_context()->create_node<T>(
+        std::forward<Args>(args)...);
+}
+
 template<typename Ret, typename...Args>
 class Function<Ret(Args...)>
 {
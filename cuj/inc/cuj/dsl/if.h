@@ -9,13 +9,13 @@ class IfBuilder : public Uncopyable
 {
     struct ThenUnit
     {
-        RC<core::Block> cond_calc;
-        core::Expr      cond;
-        RC<core::Stat>  body;
+        core::Block *cond_calc;
+        core::Expr   cond;
+        core::Stat  *body;
     };
 
     std::vector<ThenUnit> then_units_;
-    RC<core::Stat>        else_body_;
+    core::Stat           *else_body_ = nullptr;
 
 public:
 
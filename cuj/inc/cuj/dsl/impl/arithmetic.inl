@@ -1,11 +1,130 @@
 #pragma once
 
+#include <limits>
+
 #include <cuj/dsl/arithmetic.h>
 #include <cuj/dsl/function.h>
 #include <cuj/dsl/pointer.h>
 
 CUJ_NAMESPACE_BEGIN(cuj::dsl)
 
+namespace arithmetic_detail
+{
+
+    // folding follows the semantics of the generated code. anything that
+    // traps or is poison there is left to the target
+
+    template<typename T>
+    std::optional<T> fold_binary(core::Binary::Op op, T a, T b)
+    {
+        using Op = core::Binary::Op;
+
+        if constexpr(std::is_same_v<T, bool>)
+        {
+            switch(op)
+            {
+            case Op::BitwiseAnd: return a && b;
+            case Op::BitwiseOr:  return a || b;
+            case Op::BitwiseXOr: return a != b;
+            default:             return std::nullopt;
+            }
+        }
+        else if constexpr(std::is_integral_v<T>)
+        {
+            // integer arithmetic wraps around
+            using U = std::common_type_t<std::make_unsigned_t<T>, unsigned>;
+            const U ua = static_cast<U>(a), ub = static_cast<U>(b);
+            switch(op)
+            {
+            case Op::Add: return static_cast<T>(ua + ub);
+            case Op::Sub: return static_cast<T>(ua - ub);
+            case Op::Mul: return static_cast<T>(ua * ub);
+            case Op::Div:
+            case Op::Mod:
+                if(b == 0)
+                    return std::nullopt;
+                if constexpr(std::is_signed_v<T>)
+                {
+                    if(b == -1 && a == (std::numeric_limits<T>::min)())
+                        return std::nullopt;
+                }
+                return static_cast<T>(op == Op::Div ? a / b : a % b);
+            case Op::LeftShift:
+            case Op::RightShift:
+                if(ub >= sizeof(T) * 8)
+                    return std::nullopt;
+                return static_cast<T>(
+                    op == Op::LeftShift ? (ua << ub) : (ua >> ub));
+            case Op::BitwiseAnd: return static_cast<T>(ua & ub);
+            case Op::BitwiseOr:  return static_cast<T>(ua | ub);
+            case Op::BitwiseXOr: return static_cast<T>(ua ^ ub);
+            default:             return std::nullopt;
+            }
+        }
+        else
+        {
+            switch(op)
+            {
+            case Op::Add: return a + b;
+            case Op::Sub: return a - b;
+            case Op::Mul: return a * b;
+            case Op::Div: return a / b;
+            default:      return std::nullopt;
+            }
+        }
+    }
+
+    template<typename T>
+    std::optional<bool> fold_compare(core::Binary::Op op, T a, T b)
+    {
+        using Op = core::Binary::Op;
+        switch(op)
+        {
+        case Op::Equal:        return a == b;
+        case Op::Less:         return a < b;
+        case Op::LessEqual:    return a <= b;
+        case Op::Greater:      return a > b;
+        case Op::GreaterEqual: return a >= b;
+        case Op::NotEqual:
+            // float comparisons are ordered
+            if constexpr(std::is_floating_point_v<T>)
+                return a < b || a > b;
+            else
+                return a != b;
+        default:
+            return std::nullopt;
+        }
+    }
+
+    template<typename To, typename From>
+    std::optional<To> fold_cast(From v)
+    {
+        constexpr bool is_from_int = std::is_integral_v<From>;
+        constexpr bool is_to_int = std::is_integral_v<To>;
+
+        if constexpr(std::is_same_v<From, char> || std::is_same_v<To, char>)
+            return std::nullopt;
+        else if constexpr(std::is_same_v<From, bool>)
+            return static_cast<To>(v ? 1 : 0);
+        else if constexpr(std::is_same_v<To, bool>)
+            return std::nullopt;
+        else if constexpr(is_from_int && is_to_int)
+        {
+            // integers are extended according to the signedness of To
+            if constexpr(sizeof(To) <= sizeof(From) ||
+                         std::is_signed_v<To> == std::is_signed_v<From>)
+                return static_cast<To>(v);
+            else
+                return std::nullopt;
+        }
+        else if constexpr(!is_to_int)
+            return static_cast<To>(v);
+        else
+            return std::nullopt;
+    }
+
+} // namespace arithmetic_detail
+
 template<typename T> requires std::is_arithmetic_v<T>
 Arithmetic<T>::Arithmetic()
 {
@@ -18,72 +137,81 @@ Arithmetic<T>::Arithmetic()
 
 template<typename T> requires std::is_arithmetic_v<T>
 Arithmetic<T>::Arithmetic(T immediate_value)
-    : Arithmetic()
 {
-    core::Store store = {
-        .dst_addr = _addr(),
-        .val = core::Immediate{
-            .value = immediate_value
-        }
-    };
-    auto func_ctx = FunctionContext::get_func_context();
-    func_ctx->append_statement(newRC<core::Stat>(std::move(store)));
+    init_temp(core::Immediate{ .value = immediate_value });
+    set_known_value(immediate_value);
 }
 
 template<typename T> requires std::is_arithmetic_v<T>
 Arithmetic<T>::Arithmetic(const Arithmetic &other)
-    : Arithmetic()
 {
-    *this = other;
+    init_temp(other._load());
+    set_known_value(other._known_value());
 }
 
 template<typename T> requires std::is_arithmetic_v<T>
 template<typename U> requires (!std::is_same_v<T, U>)
 Arithmetic<T>::Arithmetic(const Arithmetic<U> &other)
-    : Arithmetic()
+    : Arithmetic(other.template as<Arithmetic>())
 {
-    *this = other.template as<Arithmetic>();
+    
 }
 
 template<typename T> requires std::is_arithmetic_v<T>
 template<typename U> requires (!std::is_same_v<T, U>)
 Arithmetic<T>::Arithmetic(const ref<Arithmetic<U>> &other)
-    : Arithmetic()
+    : Arithmetic(other.template as<Arithmetic>())
 {
-    *this = other.template as<Arithmetic>();
+    
 }
 
 template<typename T> requires std::is_arithmetic_v<T>
 Arithmetic<T>::Arithmetic(const ref<Arithmetic<T>> &ref)
-    : Arithmetic()
+    : Arithmetic(_from_expr(ref._load()))
 {
-    *this = Arithmetic::_from_expr(ref._load());
+    
 }
 
 template<typename T> requires std::is_arithmetic_v<T>
 Arithmetic<T>::Arithmetic(Arithmetic &&other) noexcept
-    : alloc_index_(other.alloc_index_)
+    : alloc_index_(other.alloc_index_),
+      temp_(other.temp_),
+      known_value_(other.known_value_),
+      known_block_(other.known_block_),
+      address_taken_(other.address_taken_)
 {
-    
+    other.temp_ = nullptr;
+}
+
+template<typename T> requires std::is_arithmetic_v<T>
+Arithmetic<T>::~Arithmetic()
+{
+    if(temp_)
+        temp_->alive = false;
 }
 
 template<typename T> requires std::is_arithmetic_v<T>
 Arithmetic<T> &Arithmetic<T>::operator=(const Arithmetic &other)
 {
-    if(other.alloc_index_ == alloc_index_)
+    if(this == &other)
         return *this;
-    auto type = FunctionContext::get_func_context()
-        ->get_type_context()->get_type<Arithmetic>();
-    auto load = core::Load{
-        .val_type = type,
-        .src_addr = newBox<core::Expr>(other._addr())
-    };
+    if(!temp_ && !other.temp_ && other.alloc_index_ == alloc_index_)
+        return *this;
+
+    auto func_ctx = FunctionContext::get_func_context();
+    auto val = other._load();
+    if(temp_)
+    {
+        alloc_index_ = func_ctx->overwrite_temp_value(temp_);
+        temp_ = nullptr;
+    }
+
     auto store = core::Store{
         .dst_addr = _addr(),
-        .val      = load
+        .val      = std::move(val)
     };
-    auto func_ctx = FunctionContext::get_func_context();
-    func_ctx->append_statement(newRC<core::Stat>(std::move(store)));
+    func_ctx->append_statement(newNode<core::Stat>(std::move(store)));
+    set_known_value(other._known_value());
     return *this;
 }
 
@@ -92,6 +220,11 @@ template<typename U> requires is_cuj_arithmetic_v<U>
 U Arithmetic<T>::as() const
 {
     using URaw = typename U::RawType;
+    if(auto value = _known_value())
+    {
+        if(auto result = arithmetic_detail::fold_cast<URaw>(*value))
+            return U(*result);
+    }
     auto src_type = FunctionContext::get_func_context()
         ->get_type_context()->get_type<Arithmetic>();
     auto dst_type = FunctionContext::get_func_context()
@@ -99,7 +232,7 @@ U Arithmetic<T>::as() const
     core::ArithmeticCast cast = {
         .dst_type = dst_type,
         .src_type = src_type,
-        .src_val  = newRC<core::Expr>(_load())
+        .src_val  = newNode<core::Expr>(_load())
     };
     return U::_from_expr(cast);
 }
@@ -108,11 +241,21 @@ template<typename T> requires std::is_arithmetic_v<T>
 Arithmetic<T> Arithmetic<T>::operator-() const
 {
     static_assert(!std::is_same_v<T, bool>);
+    if(auto value = _known_value())
+    {
+        if constexpr(std::is_integral_v<T>)
+        {
+            using U = std::common_type_t<std::make_unsigned_t<T>, unsigned>;
+            return Arithmetic(static_cast<T>(U(0) - static_cast<U>(*value)));
+        }
+        else
+            return Arithmetic(-*value);
+    }
     auto type_ctx = FunctionContext::get_func_context()->get_type_context();
     auto type = type_ctx->get_type<Arithmetic>();
     core::Unary unary = {
         .op       = core::Unary::Op::Neg,
-        .val      = newRC<core::Expr>(_load()),
+        .val      = newNode<core::Expr>(_load()),
         .val_type = type
     };
     return _from_expr(unary);
@@ -122,12 +265,14 @@ template<typename T> requires std::is_arithmetic_v<T>
 Arithmetic<T> Arithmetic<T>::operator+(const Arithmetic &rhs) const
 {
     static_assert(!std::is_same_v<T, bool>);
+    if(auto folded = fold(core::Binary::Op::Add, rhs))
+        return std::move(*folded);
     auto type_ctx = FunctionContext::get_func_context()->get_type_context();
     auto type = type_ctx->get_type<Arithmetic>();
     core::Binary binary = {
         .op       = core::Binary::Op::Add,
-        .lhs      = newRC<core::Expr>(_load()),
-        .rhs      = newRC<core::Expr>(rhs._load()),
+        .lhs      = newNode<core::Expr>(_load()),
+        .rhs      = newNode<core::Expr>(rhs._load()),
         .lhs_type = type,
         .rhs_type = type
     };
@@ -138,12 +283,14 @@ template<typename T> requires std::is_arithmetic_v<T>
 Arithmetic<T> Arithmetic<T>::operator-(const Arithmetic &rhs) const
 {
     static_assert(!std::is_same_v<T, bool>);
+    if(auto folded = fold(core::Binary::Op::Sub, rhs))
+        return std::move(*folded);
     auto type_ctx = FunctionContext::get_func_context()->get_type_context();
     auto type = type_ctx->get_type<Arithmetic>();
     core::Binary binary = {
         .op       = core::Binary::Op::Sub,
-        .lhs      = newRC<core::Expr>(_load()),
-        .rhs      = newRC<core::Expr>(rhs._load()),
+        .lhs      = newNode<core::Expr>(_load()),
+        .rhs      = newNode<core::Expr>(rhs._load()),
         .lhs_type = type,
         .rhs_type = type
     };
@@ -154,12 +301,14 @@ template<typename T> requires std::is_arithmetic_v<T>
 Arithmetic<T> Arithmetic<T>::operator*(const Arithmetic &rhs) const
 {
     static_assert(!std::is_same_v<T, bool>);
+    if(auto folded = fold(core::Binary::Op::Mul, rhs))
+        return std::move(*folded);
     auto type_ctx = FunctionContext::get_func_context()->get_type_context();
     auto type = type_ctx->get_type<Arithmetic>();
     core::Binary binary = {
         .op       = core::Binary::Op::Mul,
-        .lhs      = newRC<core::Expr>(_load()),
-        .rhs      = newRC<core::Expr>(rhs._load()),
+        .lhs      = newNode<core::Expr>(_load()),
+        .rhs      = newNode<core::Expr>(rhs._load()),
         .lhs_type = type,
         .rhs_type = type
     };
@@ -170,12 +319,14 @@ template<typename T> requires std::is_arithmetic_v<T>
 Arithmetic<T> Arithmetic<T>::operator/(const Arithmetic &rhs) const
 {
     static_assert(!std::is_same_v<T, bool>);
+    if(auto folded = fold(core::Binary::Op::Div, rhs))
+        return std::move(*folded);
     auto type_ctx = FunctionContext::get_func_context()->get_type_context();
     auto type = type_ctx->get_type<Arithmetic>();
     core::Binary binary = {
         .op       = core::Binary::Op::Div,
-        .lhs      = newRC<core::Expr>(_load()),
-        .rhs      = newRC<core::Expr>(rhs._load()),
+        .lhs      = newNode<core::Expr>(_load()),
+        .rhs      = newNode<core::Expr>(rhs._load()),
         .lhs_type = type,
         .rhs_type = type
     };
@@ -187,12 +338,14 @@ Arithmetic<T> Arithmetic<T>::operator%(const Arithmetic &rhs) const
 {
     static_assert(!std::is_same_v<T, bool>);
     static_assert(std::is_integral_v<T>);
+    if(auto folded = fold(core::Binary::Op::Mod, rhs))
+        return std::move(*folded);
     auto type_ctx = FunctionContext::get_func_context()->get_type_context();
     auto type = type_ctx->get_type<Arithmetic>();
     core::Binary binary = {
         .op       = core::Binary::Op::Mod,
-        .lhs      = newRC<core::Expr>(_load()),
-        .rhs      = newRC<core::Expr>(rhs._load()),
+        .lhs      = newNode<core::Expr>(_load()),
+        .rhs      = newNode<core::Expr>(rhs._load()),
         .lhs_type = type,
         .rhs_type = type
     };
@@ -202,12 +355,14 @@ Arithmetic<T> Arithmetic<T>::operator%(const Arithmetic &rhs) const
 template<typename T> requires std::is_arithmetic_v<T>
 Arithmetic<bool> Arithmetic<T>::operator==(const Arithmetic &rhs) const
 {
+    if(auto folded = fold_compare(core::Binary::Op::Equal, rhs))
+        return std::move(*folded);
     auto type = FunctionContext::get_func_context()
         ->get_type_context()->get_type<Arithmetic>();
     return Arithmetic<bool>::_from_expr(core::Binary{
         .op       = core::Binary::Op::Equal,
-        .lhs      = newRC<core::Expr>(_load()),
-        .rhs      = newRC<core::Expr>(rhs._load()),
+        .lhs      = newNode<core::Expr>(_load()),
+        .rhs      = newNode<core::Expr>(rhs._load()),
         .lhs_type = type,
         .rhs_type = type
     });
@@ -216,12 +371,14 @@ Arithmetic<bool> Arithmetic<T>::operator==(const Arithmetic &rhs) const
 template<typename T> requires std::is_arithmetic_v<T>
 Arithmetic<bool> Arithmetic<T>::operator!=(const Arithmetic &rhs) const
 {
+    if(auto folded = fold_compare(core::Binary::Op::NotEqual, rhs))
+        return std::move(*folded);
     auto type = FunctionContext::get_func_context()
         ->get_type_context()->get_type<Arithmetic>();
     return Arithmetic<bool>::_from_expr(core::Binary{
         .op       = core::Binary::Op::NotEqual,
-        .lhs      = newRC<core::Expr>(_load()),
-        .rhs      = newRC<core::Expr>(rhs._load()),
+        .lhs      = newNode<core::Expr>(_load()),
+        .rhs      = newNode<core::Expr>(rhs._load()),
         .lhs_type = type,
         .rhs_type = type
     });
@@ -230,12 +387,14 @@ Arithmetic<bool> Arithmetic<T>::operator!=(const Arithmetic &rhs) const
 template<typename T> requires std::is_arithmetic_v<T>
 Arithmetic<bool> Arithmetic<T>::operator<(const Arithmetic &rhs) const
 {
+    if(auto folded = fold_compare(core::Binary::Op::Less, rhs))
+        return std::move(*folded);
     auto type = FunctionContext::get_func_context()
         ->get_type_context()->get_type<Arithmetic>();
     return Arithmetic<bool>::_from_expr(core::Binary{
         .op       = core::Binary::Op::Less,
-        .lhs      = newRC<core::Expr>(_load()),
-        .rhs      = newRC<core::Expr>(rhs._load()),
+        .lhs      = newNode<core::Expr>(_load()),
+        .rhs      = newNode<core::Expr>(rhs._load()),
         .lhs_type = type,
         .rhs_type = type
     });
@@ -244,12 +403,14 @@ Arithmetic<bool> Arithmetic<T>::operator<(const Arithmetic &rhs) const
 template<typename T> requires std::is_arithmetic_v<T>
 Arithmetic<bool> Arithmetic<T>::operator<=(const Arithmetic &rhs) const
 {
+    if(auto folded = fold_compare(core::Binary::Op::LessEqual, rhs))
+        return std::move(*folded);
     auto type = FunctionContext::get_func_context()
         ->get_type_context()->get_type<Arithmetic>();
     return Arithmetic<bool>::_from_expr(core::Binary{
         .op       = core::Binary::Op::LessEqual,
-        .lhs      = newRC<core::Expr>(_load()),
-        .rhs      = newRC<core::Expr>(rhs._load()),
+        .lhs      = newNode<core::Expr>(_load()),
+        .rhs      = newNode<core::Expr>(rhs._load()),
         .lhs_type = type,
         .rhs_type = type
     });
@@ -258,12 +419,14 @@ Arithmetic<bool> Arithmetic<T>::operator<=(const Arithmetic &rhs) const
 template<typename T> requires std::is_arithmetic_v<T>
 Arithmetic<bool> Arithmetic<T>::operator>(const Arithmetic &rhs) const
 {
+    if(auto folded = fold_compare(core::Binary::Op::Greater, rhs))
+        return std::move(*folded);
     auto type = FunctionContext::get_func_context()
         ->get_type_context()->get_type<Arithmetic>();
     return Arithmetic<bool>::_from_expr(core::Binary{
         .op       = core::Binary::Op::Greater,
-        .lhs      = newRC<core::Expr>(_load()),
-        .rhs      = newRC<core::Expr>(rhs._load()),
+        .lhs      = newNode<core::Expr>(_load()),
+        .rhs      = newNode<core::Expr>(rhs._load()),
         .lhs_type = type,
         .rhs_type = type
     });
@@ -272,12 +435,14 @@ Arithmetic<bool> Arithmetic<T>::operator>(const Arithmetic &rhs) const
 template<typename T> requires std::is_arithmetic_v<T>
 Arithmetic<bool> Arithmetic<T>::operator>=(const Arithmetic &rhs) const
 {
+    if(auto folded = fold_compare(core::Binary::Op::GreaterEqual, rhs))
+        return std::move(*folded);
     auto type = FunctionContext::get_func_context()
         ->get_type_context()->get_type<Arithmetic>();
     return Arithmetic<bool>::_from_expr(core::Binary{
         .op       = core::Binary::Op::GreaterEqual,
-        .lhs      = newRC<core::Expr>(_load()),
-        .rhs      = newRC<core::Expr>(rhs._load()),
+        .lhs      = newNode<core::Expr>(_load()),
+        .rhs      = newNode<core::Expr>(rhs._load()),
         .lhs_type = type,
         .rhs_type = type
     });
@@ -323,12 +488,14 @@ template<typename T> requires std::is_arithmetic_v<T>
 Arithmetic<T> Arithmetic<T>::operator>>(const Arithmetic &rhs) const
 {
     static_assert(std::is_integral_v<T> && !std::is_signed_v<T>);
+    if(auto folded = fold(core::Binary::Op::RightShift, rhs))
+        return std::move(*folded);
     auto type = FunctionContext::get_func_context()
         ->get_type_context()->get_type<Arithmetic>();
     return Arithmetic::_from_expr(core::Binary{
         .op       = core::Binary::Op::RightShift,
-        .lhs      = newRC<core::Expr>(this->_load()),
-        .rhs      = newRC<core::Expr>(rhs._load()),
+        .lhs      = newNode<core::Expr>(this->_load()),
+        .rhs      = newNode<core::Expr>(rhs._load()),
         .lhs_type = type,
         .rhs_type = type
     });
@@ -338,12 +505,14 @@ template<typename T> requires std::is_arithmetic_v<T>
 Arithmetic<T> Arithmetic<T>::operator<<(const Arithmetic &rhs) const
 {
     static_assert(std::is_integral_v<T>);
+    if(auto folded = fold(core::Binary::Op::LeftShift, rhs))
+        return std::move(*folded);
     auto type = FunctionContext::get_func_context()
         ->get_type_context()->get_type<Arithmetic>();
     return Arithmetic::_from_expr(core::Binary{
         .op       = core::Binary::Op::LeftShift,
-        .lhs      = newRC<core::Expr>(this->_load()),
-        .rhs      = newRC<core::Expr>(rhs._load()),
+        .lhs      = newNode<core::Expr>(this->_load()),
+        .rhs      = newNode<core::Expr>(rhs._load()),
         .lhs_type = type,
         .rhs_type = type
     });
@@ -353,12 +522,14 @@ template<typename T> requires std::is_arithmetic_v<T>
 Arithmetic<T> Arithmetic<T>::operator&(const Arithmetic &rhs) const
 {
     static_assert(std::is_integral_v<T>);
+    if(auto folded = fold(core::Binary::Op::BitwiseAnd, rhs))
+        return std::move(*folded);
     auto type = FunctionContext::get_func_context()
         ->get_type_context()->get_type<Arithmetic>();
     return Arithmetic::_from_expr(core::Binary{
         .op       = core::Binary::Op::BitwiseAnd,
-        .lhs      = newRC<core::Expr>(this->_load()),
-        .rhs      = newRC<core::Expr>(rhs._load()),
+        .lhs      = newNode<core::Expr>(this->_load()),
+        .rhs      = newNode<core::Expr>(rhs._load()),
         .lhs_type = type,
         .rhs_type = type
     });
@@ -368,12 +539,14 @@ template<typename T> requires std::is_arithmetic_v<T>
 Arithmetic<T> Arithmetic<T>::operator|(const Arithmetic &rhs) const
 {
     static_assert(std::is_integral_v<T>);
+    if(auto folded = fold(core::Binary::Op::BitwiseOr, rhs))
+        return std::move(*folded);
     auto type = FunctionContext::get_func_context()
         ->get_type_context()->get_type<Arithmetic>();
     return Arithmetic::_from_expr(core::Binary{
         .op       = core::Binary::Op::BitwiseOr,
-        .lhs      = newRC<core::Expr>(this->_load()),
-        .rhs      = newRC<core::Expr>(rhs._load()),
+        .lhs      = newNode<core::Expr>(this->_load()),
+        .rhs      = newNode<core::Expr>(rhs._load()),
         .lhs_type = type,
         .rhs_type = type
     });
@@ -383,12 +556,14 @@ template<typename T> requires std::is_arithmetic_v<T>
 Arithmetic<T> Arithmetic<T>::operator^(const Arithmetic &rhs) const
 {
     static_assert(std::is_integral_v<T>);
+    if(auto folded = fold(core::Binary::Op::BitwiseXOr, rhs))
+        return std::move(*folded);
     auto type = FunctionContext::get_func_context()
         ->get_type_context()->get_type<Arithmetic>();
     return Arithmetic::_from_expr(core::Binary{
         .op       = core::Binary::Op::BitwiseXOr,
-        .lhs      = newRC<core::Expr>(this->_load()),
-        .rhs      = newRC<core::Expr>(rhs._load()),
+        .lhs      = newNode<core::Expr>(this->_load()),
+        .rhs      = newNode<core::Expr>(rhs._load()),
         .lhs_type = type,
         .rhs_type = type
     });
@@ -397,11 +572,18 @@ Arithmetic<T> Arithmetic<T>::operator^(const Arithmetic &rhs) const
 template<typename T> requires std::is_arithmetic_v<T>
 Arithmetic<T> Arithmetic<T>::operator~() const
 {
+    if(auto value = _known_value())
+    {
+        if constexpr(std::is_same_v<T, bool>)
+            return Arithmetic(!*value);
+        else
+            return Arithmetic(static_cast<T>(~*value));
+    }
     auto type = FunctionContext::get_func_context()
         ->get_type_context()->get_type<Arithmetic>();
     return Arithmetic::_from_expr(core::Unary{
         .op       = core::Unary::Op::BitwiseNot,
-        .val      = newRC<core::Expr>(_load()),
+        .val      = newNode<core::Expr>(_load()),
         .val_type = type
     });
 }
@@ -409,51 +591,158 @@ Arithmetic<T> Arithmetic<T>::operator~() const
 template<typename T> requires std::is_arithmetic_v<T>
 Pointer<Arithmetic<T>> Arithmetic<T>::address() const
 {
-    Pointer<Arithmetic> ret;
-    core::Store store = {
-        .dst_addr = ret._addr(),
-        .val      = _addr()
-    };
-    auto func_ctx = FunctionContext::get_func_context();
-    func_ctx->append_statement(std::move(store));
-    return ret;
+    // stores through the pointer are invisible to record-time folding
+    address_taken_ = true;
+    return Pointer<Arithmetic>::_from_expr(_addr());
 }
 
 template<typename T> requires std::is_arithmetic_v<T>
 Arithmetic<T> Arithmetic<T>::_from_expr(core::Expr expr)
 {
-    Arithmetic ret;
-    core::Store store = {
-        .dst_addr = ret._addr(),
-        .val      = std::move(expr)
-    };
-    auto func_ctx = FunctionContext::get_func_context();
-    func_ctx->append_statement(newRC<core::Stat>(std::move(store)));
+    std::optional<T> known_value;
+    if(auto imm = expr.as_if<core::Immediate>())
+    {
+        if(auto value = imm->value.as_if<T>())
+            known_value = *value;
+    }
+
+    Arithmetic ret(Uninit{});
+    ret.init_temp(std::move(expr));
+    ret.set_known_value(known_value);
     return ret;
 }
 
 template<typename T> requires std::is_arithmetic_v<T>
-core::Load Arithmetic<T>::_load() const
+core::Expr Arithmetic<T>::_load() const
 {
-    auto type = FunctionContext::get_func_context()
-        ->get_type_context()->get_type<Arithmetic>();
+    if(auto value = _known_value())
+        return core::Immediate{ .value = *value };
+    auto func_ctx = FunctionContext::get_func_context();
+    if(temp_)
+    {
+        if(auto expr = func_ctx->use_temp_value(temp_))
+            return *expr;
+    }
+    auto type = func_ctx->get_type_context()->get_type<Arithmetic>();
     return core::Load{
         .val_type = type,
-        .src_addr = newRC<core::Expr>(_addr())
+        .src_addr = newNode<core::Expr>(_addr())
     };
 }
 
 template<typename T> requires std::is_arithmetic_v<T>
 core::LocalAllocAddr Arithmetic<T>::_addr() const
 {
-    auto type = FunctionContext::get_func_context()
-        ->get_type_context()->get_type<Arithmetic>();
+    auto func_ctx = FunctionContext::get_func_context();
+    if(temp_)
+    {
+        alloc_index_ = func_ctx->materialize_temp_value(temp_);
+        temp_ = nullptr;
+    }
+    auto type = func_ctx->get_type_context()->get_type<Arithmetic>();
     return core::LocalAllocAddr{
         .alloc_type  = type,
         .alloc_index = alloc_index_
     };
 }
 
+template<typename T> requires std::is_arithmetic_v<T>
+void Arithmetic<T>::init_temp(core::Expr expr)
+{
+    auto func_ctx = FunctionContext::get_func_context();
+    auto type = func_ctx->get_type_context()->get_type<Arithmetic>();
+    temp_ = func_ctx->create_temp_value(type, std::move(expr));
+}
+
+template<typename T> requires std::is_arithmetic_v<T>
+std::optional<T> Arithmetic<T>::_known_value() const
+{
+    if(!known_value_ || address_taken_)
+        return std::nullopt;
+    auto func_ctx = FunctionContext::get_func_context();
+    if(known_block_ != func_ctx->get_current_block())
+        return std::nullopt;
+    return known_value_;
+}
+
+template<typename T> requires std::is_arithmetic_v<T>
+void Arithmetic<T>::set_known_value(std::optional<T> value)
+{
+    // a value stored in a nested block is unknown once the block is left, and
+    // a loop body never sees values stored before it
+    auto func_ctx = FunctionContext::get_func_context();
+    if(value && !address_taken_ && func_ctx->is_constant_folding_enabled())
+    {
+        known_value_ = value;
+        known_block_ = func_ctx->get_current_block();
+    }
+    else
+        known_value_.reset();
+}
+
+template<typename T> requires std::is_arithmetic_v<T>
+std::optional<Arithmetic<T>> Arithmetic<T>::fold(
+    core::Binary::Op op, const Arithmetic &rhs) const
+{
+    using Op = core::Binary::Op;
+
+    const auto a = _known_value(), b = rhs._known_value();
+    if(a && b)
+    {
+        if(auto result = arithmetic_detail::fold_binary(op, *a, *b))
+            return Arithmetic(*result);
+        return std::nullopt;
+    }
+
+    if constexpr(std::is_integral_v<T> && !std::is_same_v<T, bool>)
+    {
+        if(b)
+        {
+            if(*b == 0 && (op == Op::Add || op == Op::Sub ||
+                           op == Op::LeftShift || op == Op::RightShift ||
+                           op == Op::BitwiseOr || op == Op::BitwiseXOr))
+                return Arithmetic(*this);
+            if(*b == 1 && (op == Op::Mul || op == Op::Div))
+                return Arithmetic(*this);
+            if(*b == 0 && (op == Op::Mul || op == Op::BitwiseAnd))
+                return Arithmetic(T(0));
+        }
+        if(a)
+        {
+            if(*a == 0 && (op == Op::Add ||
+                           op == Op::BitwiseOr || op == Op::BitwiseXOr))
+                return Arithmetic(rhs);
+            if(*a == 1 && op == Op::Mul)
+                return Arithmetic(rhs);
+            if(*a == 0 && (op == Op::Mul || op == Op::BitwiseAnd ||
+                           op == Op::LeftShift || op == Op::RightShift))
+                return Arithmetic(T(0));
+        }
+    }
+    else if constexpr(std::is_floating_point_v<T>)
+    {
+        // x + 0 is not an identity for x = -0
+        if(b && *b == 1 && (op == Op::Mul || op == Op::Div))
+            return Arithmetic(*this);
+        if(a && *a == 1 && op == Op::Mul)
+            return Arithmetic(rhs);
+    }
+
+    return std::nullopt;
+}
+
+template<typename T> requires std::is_arithmetic_v<T>
+std::optional<Arithmetic<bool>> Arithmetic<T>::fold_compare(
+    core::Binary::Op op, const Arithmetic &rhs) const
+{
+    const auto a = _known_value(), b = rhs._known_value();
+    if(!a || !b)
+        return std::nullopt;
+    if(auto result = arithmetic_detail::fold_compare(op, *a, *b))
+        return Arithmetic<bool>(*result);
+    return std::nullopt;
+}
+
 template<typename T>
 Arithmetic<T> operator+(T lhs, const Arithmetic<T> &rhs)
 {
@@ -522,11 +811,13 @@ Arithmetic<bool> operator>=(T lhs, const Arithmetic<T> &rhs)
 
 inline Arithmetic<bool> operator!(const Arithmetic<bool> &val)
 {
+    if(auto value = val._known_value())
+        return Arithmetic<bool>(!*value);
     auto type = FunctionContext::get_func_context()
         ->get_type_context()->get_type<Arithmetic<bool>>();
     return Arithmetic<bool>::_from_expr(core::Unary{
         .op       = core::Unary::Op::Not,
-        .val      = newRC<core::Expr>(val._load()),
+        .val      = newNode<core::Expr>(val._load()),
         .val_type = type
     });
 }
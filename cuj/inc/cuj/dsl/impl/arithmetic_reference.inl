@@ -9,14 +9,16 @@ CUJ_NAMESPACE_BEGIN(cuj::dsl)
 
 template<typename T> requires std::is_arithmetic_v<T>
 ref<Arithmetic<T>>::ref(const Arithmetic<T> &var)
+    : addr_(var.address())
 {
-    addr_ = var.address();
+    
 }
 
 template<typename T> requires std::is_arithmetic_v<T>
 ref<Arithmetic<T>>::ref(const ref &ref)
+    : addr_(ref.address())
 {
-    addr_ = ref.address();
+    
 }
 
 template<typename T> requires std::is_arithmetic_v<T>
@@ -62,7 +64,7 @@ U ref<Arithmetic<T>>::as() const
     core::ArithmeticCast cast = {
         .dst_type = dst_type ,
         .src_type = src_type,
-        .src_val  = newRC<core::Expr>(_load())
+        .src_val  = newNode<core::Expr>(_load())
     };
     return U::_from_expr(cast);
 }
@@ -75,7 +77,7 @@ Arithmetic<T> ref<Arithmetic<T>>::operator-() const
     auto type = type_ctx->get_type<Arithmetic<T>>();
     core::Unary unary = {
         .op       = core::Unary::Op::Neg,
-        .val      = newRC<core::Expr>(_load()),
+        .val      = newNode<core::Expr>(_load()),
         .val_type = type
     };
     return Arithmetic<T>::_from_expr(unary);
@@ -89,8 +91,8 @@ Arithmetic<T> ref<Arithmetic<T>>::operator+(const Arithmetic<T> &rhs) const
     auto type = type_ctx->get_type<Arithmetic<T>>();
     core::Binary binary = {
         .op       = core::Binary::Op::Add,
-        .lhs      = newRC<core::Expr>(_load()),
-        .rhs      = newRC<core::Expr>(rhs._load()),
+        .lhs      = newNode<core::Expr>(_load()),
+        .rhs      = newNode<core::Expr>(rhs._load()),
         .lhs_type = type,
         .rhs_type = type
     };
@@ -105,8 +107,8 @@ Arithmetic<T> ref<Arithmetic<T>>::operator-(const Arithmetic<T> &rhs) const
     auto type = type_ctx->get_type<Arithmetic<T>>();
     core::Binary binary = {
         .op       = core::Binary::Op::Sub,
-        .lhs      = newRC<core::Expr>(_load()),
-        .rhs      = newRC<core::Expr>(rhs._load()),
+        .lhs      = newNode<core::Expr>(_load()),
+        .rhs      = newNode<core::Expr>(rhs._load()),
         .lhs_type = type,
         .rhs_type = type
     };
@@ -121,8 +123,8 @@ Arithmetic<T> ref<Arithmetic<T>>::operator*(const Arithmetic<T> &rhs) const
     auto type = type_ctx->get_type<Arithmetic<T>>();
     core::Binary binary = {
         .op       = core::Binary::Op::Mul,
-        .lhs      = newRC<core::Expr>(_load()),
-        .rhs      = newRC<core::Expr>(rhs._load()),
+        .lhs      = newNode<core::Expr>(_load()),
+        .rhs      = newNode<core::Expr>(rhs._load()),
         .lhs_type = type,
         .rhs_type = type
     };
@@ -137,8 +139,8 @@ Arithmetic<T> ref<Arithmetic<T>>::operator/(const Arithmetic<T> &rhs) const
     auto type = type_ctx->get_type<Arithmetic<T>>();
     core::Binary binary = {
         .op       = core::Binary::Op::Div,
-        .lhs      = newRC<core::Expr>(_load()),
-        .rhs      = newRC<core::Expr>(rhs._load()),
+        .lhs      = newNode<core::Expr>(_load()),
+        .rhs      = newNode<core::Expr>(rhs._load()),
         .lhs_type = type,
         .rhs_type = type
     };
@@ -154,8 +156,8 @@ Arithmetic<T> ref<Arithmetic<T>>::operator%(const Arithmetic<T> &rhs) const
     auto type = type_ctx->get_type<Arithmetic<T>>();
     core::Binary binary = {
         .op       = core::Binary::Op::Mod,
-        .lhs      = newRC<core::Expr>(_load()),
-        .rhs      = newRC<core::Expr>(rhs._load()),
+        .lhs      = newNode<core::Expr>(_load()),
+        .rhs      = newNode<core::Expr>(rhs._load()),
         .lhs_type = type,
         .rhs_type = type
     };
@@ -169,8 +171,8 @@ Arithmetic<bool> ref<Arithmetic<T>>::operator==(const Arithmetic<T> &rhs) const
         ->get_type_context()->get_type<Arithmetic<T>>();
     return Arithmetic<bool>::_from_expr(core::Binary{
         .op       = core::Binary::Op::Equal,
-        .lhs      = newRC<core::Expr>(_load()),
-        .rhs      = newRC<core::Expr>(rhs._load()),
+        .lhs      = newNode<core::Expr>(_load()),
+        .rhs      = newNode<core::Expr>(rhs._load()),
         .lhs_type = type,
         .rhs_type = type
     });
@@ -183,8 +185,8 @@ Arithmetic<bool> ref<Arithmetic<T>>::operator!=(const Arithmetic<T> &rhs) const
         ->get_type_context()->get_type<Arithmetic<T>>();
     return Arithmetic<bool>::_from_expr(core::Binary{
         .op       = core::Binary::Op::NotEqual,
-        .lhs      = newRC<core::Expr>(_load()),
-        .rhs      = newRC<core::Expr>(rhs._load()),
+        .lhs      = newNode<core::Expr>(_load()),
+        .rhs      = newNode<core::Expr>(rhs._load()),
         .lhs_type = type,
         .rhs_type = type
     });
@@ -197,8 +199,8 @@ Arithmetic<bool> ref<Arithmetic<T>>::operator<(const Arithmetic<T> &rhs) const
         ->get_type_context()->get_type<Arithmetic<T>>();
     return Arithmetic<bool>::_from_expr(core::Binary{
         .op       = core::Binary::Op::Less,
-        .lhs      = newRC<core::Expr>(_load()),
-        .rhs      = newRC<core::Expr>(rhs._load()),
+        .lhs      = newNode<core::Expr>(_load()),
+        .rhs      = newNode<core::Expr>(rhs._load()),
         .lhs_type = type,
         .rhs_type = type
     });
@@ -211,8 +213,8 @@ Arithmetic<bool> ref<Arithmetic<T>>::operator<=(const Arithmetic<T> &rhs) const
         ->get_type_context()->get_type<Arithmetic<T>>();
     return Arithmetic<bool>::_from_expr(core::Binary{
         .op       = core::Binary::Op::LessEqual,
-        .lhs      = newRC<core::Expr>(_load()),
-        .rhs      = newRC<core::Expr>(rhs._load()),
+        .lhs      = newNode<core::Expr>(_load()),
+        .rhs      = newNode<core::Expr>(rhs._load()),
         .lhs_type = type,
         .rhs_type = type
     });
@@ -225,8 +227,8 @@ Arithmetic<bool> ref<Arithmetic<T>>::operator>(const Arithmetic<T> &rhs) const
         ->get_type_context()->get_type<Arithmetic<T>>();
     return Arithmetic<bool>::_from_expr(core::Binary{
         .op       = core::Binary::Op::Greater,
-        .lhs      = newRC<core::Expr>(_load()),
-        .rhs      = newRC<core::Expr>(rhs._load()),
+        .lhs      = newNode<core::Expr>(_load()),
+        .rhs      = newNode<core::Expr>(rhs._load()),
         .lhs_type = type,
         .rhs_type = type
     });
@@ -239,8 +241,8 @@ Arithmetic<bool> ref<Arithmetic<T>>::operator>=(const Arithmetic<T> &rhs) const
         ->get_type_context()->get_type<Arithmetic<T>>();
     return Arithmetic<bool>::_from_expr(core::Binary{
         .op       = core::Binary::Op::GreaterEqual,
-        .lhs      = newRC<core::Expr>(_load()),
-        .rhs      = newRC<core::Expr>(rhs._load()),
+        .lhs      = newNode<core::Expr>(_load()),
+        .rhs      = newNode<core::Expr>(rhs._load()),
         .lhs_type = type,
         .rhs_type = type
     });
@@ -254,8 +256,8 @@ Arithmetic<T> ref<Arithmetic<T>>::operator>>(const Arithmetic<T> &rhs) const
         ->get_type_context()->get_type<Arithmetic<T>>();
     return Arithmetic<T>::_from_expr(core::Binary{
         .op       = core::Binary::Op::RightShift,
-        .lhs      = newRC<core::Expr>(this->_load()),
-        .rhs      = newRC<core::Expr>(rhs._load()),
+        .lhs      = newNode<core::Expr>(this->_load()),
+        .rhs      = newNode<core::Expr>(rhs._load()),
         .lhs_type = type,
         .rhs_type = type
     });
@@ -269,8 +271,8 @@ Arithmetic<T> ref<Arithmetic<T>>::operator<<(const Arithmetic<T> &rhs) const
         ->get_type_context()->get_type<Arithmetic<T>>();
     return Arithmetic<T>::_from_expr(core::Binary{
         .op       = core::Binary::Op::LeftShift,
-        .lhs      = newRC<core::Expr>(this->_load()),
-        .rhs      = newRC<core::Expr>(rhs._load()),
+        .lhs      = newNode<core::Expr>(this->_load()),
+        .rhs      = newNode<core::Expr>(rhs._load()),
         .lhs_type = type,
         .rhs_type = type
     });
@@ -284,8 +286,8 @@ Arithmetic<T> ref<Arithmetic<T>>::operator&(const Arithmetic<T> &rhs) const
         ->get_type_context()->get_type<Arithmetic<T>>();
     return Arithmetic<T>::_from_expr(core::Binary{
         .op       = core::Binary::Op::BitwiseAnd,
-        .lhs      = newRC<core::Expr>(this->_load()),
-        .rhs      = newRC<core::Expr>(rhs._load()),
+        .lhs      = newNode<core::Expr>(this->_load()),
+        .rhs      = newNode<core::Expr>(rhs._load()),
         .lhs_type = type,
         .rhs_type = type
     });
@@ -299,8 +301,8 @@ Arithmetic<T> ref<Arithmetic<T>>::operator|(const Arithmetic<T> &rhs) const
         ->get_type_context()->get_type<Arithmetic<T>>();
     return Arithmetic<T>::_from_expr(core::Binary{
         .op       = core::Binary::Op::BitwiseOr,
-        .lhs      = newRC<core::Expr>(this->_load()),
-        .rhs      = newRC<core::Expr>(rhs._load()),
+        .lhs      = newNode<core::Expr>(this->_load()),
+        .rhs      = newNode<core::Expr>(rhs._load()),
         .lhs_type = type,
         .rhs_type = type
     });
@@ -314,8 +316,8 @@ Arithmetic<T> ref<Arithmetic<T>>::operator^(const Arithmetic<T> &rhs) const
         ->get_type_context()->get_type<Arithmetic<T>>();
     return Arithmetic<T>::_from_expr(core::Binary{
         .op       = core::Binary::Op::BitwiseXOr,
-        .lhs      = newRC<core::Expr>(this->_load()),
-        .rhs      = newRC<core::Expr>(rhs._load()),
+        .lhs      = newNode<core::Expr>(this->_load()),
+        .rhs      = newNode<core::Expr>(rhs._load()),
         .lhs_type = type,
         .rhs_type = type
     });
@@ -328,7 +330,7 @@ Arithmetic<T> ref<Arithmetic<T>>::operator~() const
         ->get_type_context()->get_type<Arithmetic<T>>();
     return Arithmetic<T>::_from_expr(core::Unary{
         .op       = core::Unary::Op::BitwiseNot,
-        .val      = newRC<core::Expr>(_load()),
+        .val      = newNode<core::Expr>(_load()),
         .val_type = type
     });
 }
@@ -336,9 +338,7 @@ Arithmetic<T> ref<Arithmetic<T>>::operator~() const
 template<typename T> requires std::is_arithmetic_v<T>
 Pointer<Arithmetic<T>> ref<Arithmetic<T>>::address() const
 {
-    Pointer<Arithmetic<T>> ret;
-    ret = addr_;
-    return ret;
+    return addr_;
 }
 
 template<typename T> requires std::is_arithmetic_v<T>
@@ -348,16 +348,14 @@ core::Load ref<Arithmetic<T>>::_load() const
         ->get_type<Arithmetic<T>>();
     return core::Load{
         .val_type = type,
-        .src_addr = newRC<core::Expr>(addr_._load())
+        .src_addr = newNode<core::Expr>(addr_._load())
     };
 }
 
 template<typename T> requires std::is_arithmetic_v<T>
 ref<Arithmetic<T>> ref<Arithmetic<T>>::_from_ptr(const Pointer<Arithmetic<T>> &ptr)
 {
-    ref ret;
-    ret.addr_ = ptr;
-    return ret;
+    return ref(ptr);
 }
 
 template<typename T>
@@ -432,7 +430,7 @@ inline Arithmetic<bool> operator!(const ref<Arithmetic<bool>> &val)
         ->get_type_context()->get_type<Arithmetic<bool>>();
     return Arithmetic<bool>::_from_expr(core::Unary{
         .op       = core::Unary::Op::Not,
-        .val      = newRC<core::Expr>(val._load()),
+        .val      = newNode<core::Expr>(val._load()),
         .val_type = type
     });
 }
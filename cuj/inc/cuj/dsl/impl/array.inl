@@ -83,7 +83,7 @@ core::ArrayAddrToFirstElemAddr Array<T, N>::_first_elem_addr() const
     auto arr_ptr_type = type_ctx->get_type<Pointer<Array>>();
     return core::ArrayAddrToFirstElemAddr{
         .array_ptr_type = arr_ptr_type,
-        .array_ptr      = newRC<core::Expr>(core::LocalAllocAddr{
+        .array_ptr      = newNode<core::Expr>(core::LocalAllocAddr{
             .alloc_type  = type(),
             .alloc_index = alloc_index_
         })
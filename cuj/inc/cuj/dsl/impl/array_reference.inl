@@ -71,16 +71,14 @@ core::ArrayAddrToFirstElemAddr ref<Array<T, N>>::_first_elem_addr() const
     auto arr_ptr_type = type_ctx->get_type<Pointer<Array<T, N>>>();
     return core::ArrayAddrToFirstElemAddr{
         .array_ptr_type = arr_ptr_type,
-        .array_ptr      = newRC<core::Expr>(addr_._load())
+        .array_ptr      = newNode<core::Expr>(addr_._load())
     };
 }
 
 template<typename T, size_t N>
 ref<Array<T, N>> ref<Array<T, N>>::_from_ptr(const Pointer<Array<T, N>> &ptr)
 {
-    ref ret;
-    ret.addr_ = ptr;
-    return ret;
+    return ref(ptr);
 }
 
 CUJ_NAMESPACE_END(cuj::dsl)
@@ -21,7 +21,7 @@ namespace class_detail
         core::ClassPointerToMemberPointer class_to_member = {
             .class_ptr_type  = class_ptr_type,
             .member_ptr_type = member_ptr_type,
-            .class_ptr       = newRC<core::Expr>(class_ptr._load()),
+            .class_ptr       = newNode<core::Expr>(class_ptr._load()),
             .member_index    = member_index
         };
         return Pointer<M>::_from_expr(std::move(class_to_member));
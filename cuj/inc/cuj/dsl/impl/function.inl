@@ -115,7 +115,11 @@ void Function<Ret(Args...)>::define_impl(F &&body_func)
 
     FunctionContext &func_ctx = *context_;
     FunctionContext::push_func_context(&func_ctx);
-    CUJ_SCOPE_EXIT{ FunctionContext::pop_func_context(); };
+    CUJ_SCOPE_EXIT
+    {
+        func_ctx.finish_recording();
+        FunctionContext::pop_func_context();
+    };
 
     PointerTempVarContext ptr_temp_ctx;
     PointerTempVarContext::push_context(&ptr_temp_ctx);
@@ -123,16 +127,15 @@ void Function<Ret(Args...)>::define_impl(F &&body_func)
 
     auto type_ctx = func_ctx.get_type_context();
 
-    std::tuple<Pointer<arg_to_var_t<Args>>...> arg_pointers;
-    foreach_type_indexed<Args...>([&]<typename Arg, int Idx>
+    auto arg_pointers = [&]<int...Is>(std::integer_sequence<int, Is...>)
     {
-        using Var = arg_to_var_t<Arg>;
-        core::FuncArgAddr addr = {
-            .addr_type = type_ctx->get_type<Pointer<Var>>(),
-            .arg_index = Idx
+        return std::tuple<Pointer<arg_to_var_t<Args>>...>{
+            Pointer<arg_to_var_t<Args>>::_from_expr(core::FuncArgAddr{
+                .addr_type = type_ctx->get_type<Pointer<arg_to_var_t<Args>>>(),
+                .arg_index = Is
+            })...
         };
-        std::get<Idx>(arg_pointers) = Pointer<Var>::_from_expr(addr);
-    });
+    }(std::make_integer_sequence<int, sizeof...(Args)>());
 
     std::tuple<Args...> args = deref_arg_pointers<std::tuple<Args...>>(
         arg_pointers, std::make_integer_sequence<int, sizeof...(Args)>());
@@ -165,7 +168,7 @@ void Function<Ret(Args...)>::define_impl(F &&body_func)
                 .return_type = class_type,
                 .val         = core::DerefClassPointer{
                     .class_ptr_type = class_ptr_type,
-                    .class_ptr      = newRC<core::Expr>(ret.address()._load())
+                    .class_ptr      = newNode<core::Expr>(ret.address()._load())
                 }
             };
             func_ctx.append_statement(std::move(ret_stat));
@@ -178,7 +181,7 @@ void Function<Ret(Args...)>::define_impl(F &&body_func)
                 .return_type = arr_type,
                 .val         = core::DerefArrayPointer{
                     .array_ptr_type = arr_ptr_type,
-                    .array_ptr      = newRC<core::Expr>(ret.address()._load())
+                    .array_ptr      = newNode<core::Expr>(ret.address()._load())
                 }
             };
             func_ctx.append_statement(std::move(ret_stat));
@@ -259,27 +262,27 @@ Ret Function<Ret(Args...)>::operator()(Args...args)
 
         if constexpr(is_cuj_ref_v<Arg>)
         {
-            call.args.push_back(newRC<core::Expr>(arg.address()._load()));
+            call.args.push_back(newNode<core::Expr>(arg.address()._load()));
         }
         else if constexpr(is_cuj_class_v<Arg>)
         {
             core::DerefClassPointer deref_class = {
                 .class_ptr_type = type_ctx->get_type<Pointer<Arg>>(),
-                .class_ptr      = newRC<core::Expr>(arg.address()._load())
+                .class_ptr      = newNode<core::Expr>(arg.address()._load())
             };
-            call.args.push_back(newRC<core::Expr>(std::move(deref_class)));
+            call.args.push_back(newNode<core::Expr>(std::move(deref_class)));
         }
         else if constexpr(is_cuj_array_v<Arg>)
         {
             core::DerefArrayPointer deref_array = {
                 .array_ptr_type = type_ctx->get_type<Pointer<Arg>>(),
-                .array_ptr      = newRC<core::Expr>(arg.address()._load())
+                .array_ptr      = newNode<core::Expr>(arg.address()._load())
             };
-            call.args.push_back(newRC<core::Expr>(std::move(deref_array)));
+            call.args.push_back(newNode<core::Expr>(std::move(deref_array)));
         }
         else
         {
-            call.args.push_back(newRC<core::Expr>(arg._load()));
+            call.args.push_back(newNode<core::Expr>(arg._load()));
         }
     });
 
@@ -21,7 +21,7 @@ inline IfBuilder::~IfBuilder()
         last_stat->then_body = then_units_[i].body;
         if(i < then_units_.size() - 1)
         {
-            last_stat->else_body = newRC<core::Stat>(core::If{});
+            last_stat->else_body = newNode<core::Stat>(core::If{});
             last_stat = &last_stat->else_body->as<core::If>();
         }
     }
@@ -38,7 +38,7 @@ IfBuilder &IfBuilder::operator*(F &&cond_func)
     assert(then_units_.empty() || then_units_.back().body);
     assert(!else_body_);
     auto func = FunctionContext::get_func_context();
-    auto cond_calc = newRC<core::Block>();
+    auto cond_calc = newNode<core::Block>();
     Arithmetic<bool> cond;
     {
         func->push_block(cond_calc);
@@ -55,13 +55,13 @@ IfBuilder &IfBuilder::operator/(F &&then_func)
 {
     assert(!then_units_.empty() && !then_units_.back().body);
     auto func = FunctionContext::get_func_context();
-    auto block = newRC<core::Block>();
+    auto block = newNode<core::Block>();
     {
         func->push_block(block);
         CUJ_SCOPE_EXIT{ func->pop_block(); };
         std::forward<F>(then_func)();
     }
-    then_units_.back().body = newRC<core::Stat>(std::move(*block));
+    then_units_.back().body = newNode<core::Stat>(std::move(*block));
     return *this;
 }
 
@@ -70,13 +70,13 @@ void IfBuilder::operator-(F &&else_func)
 {
     assert(!then_units_.empty() && then_units_.back().body && !else_body_);
     auto func = FunctionContext::get_func_context();
-    auto block = newRC<core::Block>();
+    auto block = newNode<core::Block>();
     {
         func->push_block(block);
         CUJ_SCOPE_EXIT{ func->pop_block(); };
         std::forward<F>(else_func)();
     }
-    else_body_ = newRC<core::Stat>(std::move(*block));
+    else_body_ = newNode<core::Stat>(std::move(*block));
 }
 
 CUJ_NAMESPACE_END(cuj::dsl)
@@ -11,13 +11,13 @@ template<typename F>
 void LoopBuilder::operator+(F &&body_func)
 {
     auto func = FunctionContext::get_func_context();
-    auto block = newRC<core::Block>();
+    auto block = newNode<core::Block>();
     {
         func->push_block(block);
         CUJ_SCOPE_EXIT{ func->pop_block(); };
         std::forward<F>(body_func)();
     }
-    func->append_statement(newRC<core::Stat>(core::Loop{
+    func->append_statement(newNode<core::Stat>(core::Loop{
         .body = std::move(block)
     }));
 }
@@ -27,7 +27,7 @@ template<typename F>
 WhileBuilder::WhileBuilder(F &&cond_func)
 {
     auto func = FunctionContext::get_func_context();
-    cond_block_ = newRC<core::Block>();
+    cond_block_ = newNode<core::Block>();
     {
         func->push_block(cond_block_);
         CUJ_SCOPE_EXIT{ func->pop_block(); };
@@ -39,22 +39,22 @@ template<typename F>
 void WhileBuilder::operator+(F &&body_func)
 {
     auto func = FunctionContext::get_func_context();
-    auto body = newRC<core::Block>();
+    auto body = newNode<core::Block>();
     {
         func->push_block(body);
         CUJ_SCOPE_EXIT{ func->pop_block(); };
         std::forward<F>(body_func)();
     }
     std::vector body_stats = {
-        newRC<core::Stat>(core::If{
+        newNode<core::Stat>(core::If{
             .calc_cond = std::move(cond_block_),
             .cond      = std::move(cond_),
-            .then_body = newRC<core::Stat>(std::move(*body)),
-            .else_body = newRC<core::Stat>(core::Break{})
+            .then_body = newNode<core::Stat>(std::move(*body)),
+            .else_body = newNode<core::Stat>(core::Break{})
         })
     };
     func->append_statement(core::Loop{
-        .body = newRC<core::Block>(core::Block{
+        .body = newNode<core::Block>(core::Block{
             .stats = std::move(body_stats)
         })
     });
@@ -63,13 +63,13 @@ void WhileBuilder::operator+(F &&body_func)
 inline void _add_break_statement()
 {
     FunctionContext::get_func_context()
-        ->append_statement(newRC<core::Stat>(core::Break{}));
+        ->append_statement(newNode<core::Stat>(core::Break{}));
 }
 
 inline void _add_continue_statement()
 {
     FunctionContext::get_func_context()
-        ->append_statement(newRC<core::Stat>(core::Continue{}));
+        ->append_statement(newNode<core::Stat>(core::Continue{}));
 }
 
 CUJ_NAMESPACE_END(cuj::dsl)
@@ -24,48 +24,60 @@ Pointer<T>::Pointer()
 
 template<typename T>
 Pointer<T>::Pointer(std::nullptr_t)
-    : Pointer()
 {
-    core::Store store = {
-        .dst_addr = _addr(),
-        .val      = core::NullPtr{ type() }
-    };
-
-    auto func_ctx = FunctionContext::get_func_context();
-    func_ctx->append_statement(std::move(store));
+    static_assert(is_cuj_var_v<T> || std::is_same_v<T, CujVoid>);
+    init_temp(core::NullPtr{ type() });
 }
 
 template<typename T>
 Pointer<T>::Pointer(const ref<Pointer<T>> &ref)
-    : Pointer()
+    : Pointer(_from_expr(ref._load()))
 {
-    *this = Pointer::_from_expr(ref._load());
+    
 }
 
 template<typename T>
 Pointer<T>::Pointer(const Pointer &other)
-    : Pointer()
 {
-    *this = other;
+    static_assert(is_cuj_var_v<T> || std::is_same_v<T, CujVoid>);
+    init_temp(other._load());
 }
 
 template<typename T>
 Pointer<T>::Pointer(Pointer &&other) noexcept
-    : alloc_index_(other.alloc_index_)
+    : alloc_index_(other.alloc_index_), temp_(other.temp_)
 {
     static_assert(is_cuj_var_v<T> || std::is_same_v<T, CujVoid>);
+    other.temp_ = nullptr;
+}
+
+template<typename T>
+Pointer<T>::~Pointer()
+{
+    if(temp_)
+        temp_->alive = false;
 }
 
 template<typename T>
 Pointer<T> &Pointer<T>::operator=(const Pointer &other)
 {
-    if(other.alloc_index_ == alloc_index_)
+    if(this == &other)
         return *this;
+    if(!temp_ && !other.temp_ && other.alloc_index_ == alloc_index_)
+        return *this;
+
+    auto func_ctx = FunctionContext::get_func_context();
+    auto val = other._load();
+    if(temp_)
+    {
+        alloc_index_ = func_ctx->overwrite_temp_value(temp_);
+        temp_ = nullptr;
+    }
+
     core::Store store = {
         .dst_addr = _addr(),
-        .val      = other._load()
+        .val      = std::move(val)
     };
-    auto func_ctx = FunctionContext::get_func_context();
     func_ctx->append_statement(std::move(store));
     return *this;
 }
@@ -82,8 +94,8 @@ Pointer<T> Pointer<T>::operator+(const Arithmetic<U> &rhs) const
     core::PointerOffset ptr_offset = {
         .ptr_type    = type(),
         .offset_type = type_ctx->get_type<Arithmetic<U>>(),
-        .ptr_val     = newRC<core::Expr>(_load()),
-        .offset_val  = newRC<core::Expr>(rhs._load()),
+        .ptr_val     = newNode<core::Expr>(_load()),
+        .offset_val  = newNode<core::Expr>(rhs._load()),
         .negative    = false
     };
 
@@ -102,8 +114,8 @@ Pointer<T> Pointer<T>::operator-(const Arithmetic<U> &rhs) const
     core::PointerOffset ptr_offset = {
         .ptr_type    = type(),
         .offset_type = type_ctx->get_type<Arithmetic<U>>(),
-        .ptr_val     = newRC<core::Expr>(_load()),
-        .offset_val  = newRC<core::Expr>(rhs._load()),
+        .ptr_val     = newNode<core::Expr>(_load()),
+        .offset_val  = newNode<core::Expr>(rhs._load()),
         .negative    = true
     };
 
@@ -150,8 +162,8 @@ Pointer<T> Pointer<T>::operator+(const ref<Arithmetic<U>> &rhs) const
     core::PointerOffset ptr_offset = {
         .ptr_type    = type(),
         .offset_type = type_ctx->get_type<Arithmetic<U>>(),
-        .ptr_val     = newRC<core::Expr>(_load()),
-        .offset_val  = newRC<core::Expr>(rhs._load()),
+        .ptr_val     = newNode<core::Expr>(_load()),
+        .offset_val  = newNode<core::Expr>(rhs._load()),
         .negative    = false
     };
 
@@ -170,8 +182,8 @@ Pointer<T> Pointer<T>::operator-(const ref<Arithmetic<U>> &rhs) const
     core::PointerOffset ptr_offset = {
         .ptr_type    = type(),
         .offset_type = type_ctx->get_type<Arithmetic<U>>(),
-        .ptr_val     = newRC<core::Expr>(_load()),
-        .offset_val  = newRC<core::Expr>(rhs._load()),
+        .ptr_val     = newNode<core::Expr>(_load()),
+        .offset_val  = newNode<core::Expr>(rhs._load()),
         .negative    = true
     };
 
@@ -206,14 +218,7 @@ Pointer<T> operator+(const ref<Arithmetic<U>> &lhs, const Pointer<T> &rhs)
 template<typename T>
 Pointer<Pointer<T>> Pointer<T>::address() const
 {
-    Pointer<Pointer> ret;
-    core::Store store = {
-        .dst_addr = ret._addr(),
-        .val      = _addr()
-    };
-    auto func_ctx = FunctionContext::get_func_context();
-    func_ctx->append_statement(std::move(store));
-    return ret;
+    return Pointer<Pointer>::_from_expr(_addr());
 }
 
 template<typename T>
@@ -241,19 +246,20 @@ add_reference_t<T> *Pointer<T>::operator->() const
 template<typename T>
 Pointer<T> Pointer<T>::_from_expr(core::Expr expr)
 {
-    Pointer ret;
-    core::Store store = {
-        .dst_addr = ret._addr(),
-        .val      = expr
-    };
-    auto func_ctx = FunctionContext::get_func_context();
-    func_ctx->append_statement(std::move(store));
+    Pointer ret(Uninit{});
+    ret.init_temp(std::move(expr));
     return ret;
 }
 
 template<typename T>
 core::LocalAllocAddr Pointer<T>::_addr() const
 {
+    if(temp_)
+    {
+        alloc_index_ = FunctionContext::get_func_context()
+            ->materialize_temp_value(temp_);
+        temp_ = nullptr;
+    }
     return core::LocalAllocAddr{
         .alloc_type  = type(),
         .alloc_index = alloc_index_
@@ -261,12 +267,25 @@ core::LocalAllocAddr Pointer<T>::_addr() const
 }
 
 template<typename T>
-core::Load Pointer<T>::_load() const
+core::Expr Pointer<T>::_load() const
 {
+    if(temp_)
+    {
+        auto func_ctx = FunctionContext::get_func_context();
+        if(auto expr = func_ctx->use_temp_value(temp_))
+            return *expr;
+    }
     return core::Load{
         .val_type = type(),
-        .src_addr = newRC<core::Expr>(_addr())
+        .src_addr = newNode<core::Expr>(_addr())
     };
 }
 
+template<typename T>
+void Pointer<T>::init_temp(core::Expr expr)
+{
+    temp_ = FunctionContext::get_func_context()
+        ->create_temp_value(type(), std::move(expr));
+}
+
 CUJ_NAMESPACE_END(cuj::dsl)
@@ -9,14 +9,16 @@ CUJ_NAMESPACE_BEGIN(cuj::dsl)
 
 template<typename T>
 ref<Pointer<T>>::ref(const Pointer<T> &ptr)
+    : addr_(ptr.address())
 {
-    addr_ = ptr.address();
+    
 }
 
 template<typename T>
 ref<Pointer<T>>::ref(const ref &ref)
+    : addr_(ref.address())
 {
-    addr_ = ref.address();
+    
 }
 
 template<typename T>
@@ -120,9 +122,7 @@ add_reference_t<T> ref<Pointer<T>>::operator[](const ref<Arithmetic<U>> &rhs) co
 template<typename T>
 Pointer<Pointer<T>> ref<Pointer<T>>::address() const
 {
-    Pointer<Pointer<T>> ret;
-    ret = addr_;
-    return ret;
+    return addr_;
 }
 
 template<typename T>
@@ -154,16 +154,14 @@ core::Load ref<Pointer<T>>::_load() const
         ->get_type<Pointer<T>>();
     return core::Load{
         .val_type = type,
-        .src_addr = newRC<core::Expr>(addr_._load())
+        .src_addr = newNode<core::Expr>(addr_._load())
     };
 }
 
 template<typename T>
 ref<Pointer<T>> ref<Pointer<T>>::_from_ptr(const Pointer<Pointer<T>> &ptr)
 {
-    ref ret;
-    ret.addr_ = ptr;
-    return ret;
+    return ref(ptr);
 }
 
 template<typename U, typename T> requires std::is_integral_v<U>
@@ -52,7 +52,7 @@ void _add_return_statement(const T &val)
                 .return_type = class_type,
                 .val         = core::DerefClassPointer{
                     .class_ptr_type = class_ptr_type,
-                    .class_ptr      = newRC<core::Expr>(val.address()._load())
+                    .class_ptr      = newNode<core::Expr>(val.address()._load())
                 }
             };
             func->append_statement(std::move(ret_stat));
@@ -65,7 +65,7 @@ void _add_return_statement(const T &val)
                 .return_type = arr_type,
                 .val         = core::DerefArrayPointer{
                     .array_ptr_type = arr_ptr_type,
-                    .array_ptr      = newRC<core::Expr>(val.address()._load())
+                    .array_ptr      = newNode<core::Expr>(val.address()._load())
                 }
             };
             func->append_statement(std::move(ret_stat));
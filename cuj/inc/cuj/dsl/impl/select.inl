@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cuj/dsl/function.h>
+#include <cuj/dsl/pointer.h>
+#include <cuj/dsl/select.h>
+
+CUJ_NAMESPACE_BEGIN(cuj::dsl)
+
+template<typename T> requires is_cuj_var_v<T>
+T select(const Arithmetic<bool> &cond, const T &a, const T &b)
+{
+    auto type_ctx = FunctionContext::get_func_context()->get_type_context();
+    auto ptr_type = type_ctx->get_type<Pointer<T>>();
+
+    auto load = [&](const T &val) -> core::Expr
+    {
+        if constexpr(is_cuj_class_v<T>)
+        {
+            return core::DerefClassPointer{
+                .class_ptr_type = ptr_type,
+                .class_ptr      = newNode<core::Expr>(val.address()._load())
+            };
+        }
+        else if constexpr(is_cuj_array_v<T>)
+        {
+            return core::DerefArrayPointer{
+                .array_ptr_type = ptr_type,
+                .array_ptr      = newNode<core::Expr>(val.address()._load())
+            };
+        }
+        else
+            return val._load();
+    };
+
+    core::Select select = {
+        .val_type  = type_ctx->get_type<T>(),
+        .cond_type = type_ctx->get_type<Arithmetic<bool>>(),
+        .cond      = newNode<core::Expr>(cond._load()),
+        .true_val  = newNode<core::Expr>(load(a)),
+        .false_val = newNode<core::Expr>(load(b))
+    };
+
+    if constexpr(is_cuj_class_v<T>)
+    {
+        return *Pointer<T>::_from_expr(core::SaveClassIntoLocalAlloc{
+            .class_ptr_type = ptr_type,
+            .class_val      = newNode<core::Expr>(std::move(select))
+        });
+    }
+    else if constexpr(is_cuj_array_v<T>)
+    {
+        return *Pointer<T>::_from_expr(core::SaveArrayIntoLocalAlloc{
+            .array_ptr_type = ptr_type,
+            .array_val      = newNode<core::Expr>(std::move(select))
+        });
+    }
+    else
+        return T::_from_expr(std::move(select));
+}
+
+CUJ_NAMESPACE_END(cuj::dsl)
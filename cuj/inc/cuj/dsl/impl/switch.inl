@@ -77,7 +77,7 @@ void SwitchBuilder::operator+(F &&case_body_func)
     assert(!switch_s_.branches.empty() && !switch_s_.branches.back().body);
     assert(!switch_s_.default_body);
     auto func = FunctionContext::get_func_context();
-    auto body = newRC<core::Block>();
+    auto body = newNode<core::Block>();
     {
         func->push_block(body);
         CUJ_SCOPE_EXIT{ func->pop_block(); };
@@ -99,7 +99,7 @@ void SwitchBuilder::operator-(F &&default_body_func)
     assert(switch_s_.branches.empty() || switch_s_.branches.back().body);
     assert(!switch_s_.default_body);
     auto func = FunctionContext::get_func_context();
-    auto body = newRC<core::Block>();
+    auto body = newNode<core::Block>();
     {
         func->push_block(body);
         CUJ_SCOPE_EXIT{ func->pop_block(); };
@@ -1,20 +1,48 @@
 #pragma once
 
+#include <atomic>
+
 #include <cuj/dsl/type_context.h>
 #include <cuj/dsl/variable_forward.h>
 
 CUJ_NAMESPACE_BEGIN(cuj::dsl)
 
 inline TypeContext::TypeContext(RC<core::TypeSet> type_set)
-    : type_set_(std::move(type_set))
+    : uid_(generate_uid()), type_set_(std::move(type_set)),
+      mutex_(newRC<std::recursive_mutex>())
 {
 
 }
 
+inline uint64_t TypeContext::generate_uid()
+{
+    static std::atomic<uint64_t> next_uid = 1;
+    return next_uid++;
+}
+
 template<typename T> requires is_cuj_var_v<T>
 const TypeContext::Type *TypeContext::get_type()
 {
-    const auto idx = std::type_index(typeid(T));
+    // types are never removed from a type set, so the last result can be
+    // reused as long as the type context is the same
+    struct Cache
+    {
+        uint64_t    uid  = 0;
+        const Type *type = nullptr;
+    };
+    static thread_local Cache cache;
+    if(cache.uid != uid_)
+        cache = { uid_, create_type<T>() };
+    return cache.type;
+}
+
+template<typename T>
+const TypeContext::Type *TypeContext::create_type()
+{
+    // member and pointed types are created while holding the lock
+    std::lock_guard lock(*mutex_);
+
+    const core::TypeKey idx = std::type_index(typeid(T));
     auto it = type_set_->index_to_type.find(idx);
     if(it != type_set_->index_to_type.end())
         return it->second.get();
@@ -40,6 +68,12 @@ const TypeContext::Type *TypeContext::get_type()
         *it->second = core::Array{ element, T::ElementCount };
     }
 
+    if constexpr(is_cuj_vector_v<T>)
+    {
+        auto element = get_type<typename T::ElementType>();
+        *it->second = core::Vector{ element, T::ElementCount };
+    }
+
     if constexpr(is_cuj_class_v<T>)
     {
         std::vector<const core::Type *> members;
@@ -54,8 +88,9 @@ const TypeContext::Type *TypeContext::get_type()
     return it->second.get();
 }
 
-inline std::type_index TypeContext::get_type_index(const core::Type *type) const
+inline core::TypeKey TypeContext::get_type_index(const core::Type *type) const
 {
+    std::lock_guard lock(*mutex_);
     return type_set_->type_to_index.at(type);
 }
 
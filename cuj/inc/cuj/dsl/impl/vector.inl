@@ -0,0 +1,516 @@
+#pragma once
+
+#include <cuj/dsl/arithmetic.h>
+#include <cuj/dsl/function.h>
+#include <cuj/dsl/pointer.h>
+#include <cuj/dsl/vector.h>
+
+CUJ_NAMESPACE_BEGIN(cuj::dsl)
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+const core::Type *Vector<T, N>::type()
+{
+    return FunctionContext::get_func_context()
+        ->get_type_context()->get_type<Vector>();
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+void Vector<T, N>::init_temp(core::Expr expr)
+{
+    temp_ = FunctionContext::get_func_context()
+        ->create_temp_value(type(), std::move(expr));
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+template<typename R>
+R Vector<T, N>::binary(core::Binary::Op op, const Vector &rhs) const
+{
+    return R::_from_expr(core::Binary{
+        .op       = op,
+        .lhs      = newNode<core::Expr>(_load()),
+        .rhs      = newNode<core::Expr>(rhs._load()),
+        .lhs_type = type(),
+        .rhs_type = type()
+    });
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Arithmetic<T> Vector<T, N>::reduce(core::VectorReduce::Op op) const
+{
+    return Arithmetic<T>::_from_expr(core::VectorReduce{
+        .op          = op,
+        .vector_type = type(),
+        .vector      = newNode<core::Expr>(_load())
+    });
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Vector<T, N> Vector<T, N>::load(const Pointer<Arithmetic<T>> &ptr, bool aligned)
+{
+    auto type_ctx = FunctionContext::get_func_context()->get_type_context();
+    return _from_expr(core::VectorLoad{
+        .vector_type   = type(),
+        .elem_ptr_type = type_ctx->get_type<Pointer<Arithmetic<T>>>(),
+        .elem_ptr      = newNode<core::Expr>(ptr._load()),
+        .aligned       = aligned
+    });
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+void Vector<T, N>::store(const Pointer<Arithmetic<T>> &ptr, bool aligned) const
+{
+    auto func_ctx = FunctionContext::get_func_context();
+    auto type_ctx = func_ctx->get_type_context();
+    auto elem_ptr = ptr._load();
+    auto val = _load();
+    func_ctx->append_statement(core::VectorStore{
+        .vector_type   = type(),
+        .elem_ptr_type = type_ctx->get_type<Pointer<Arithmetic<T>>>(),
+        .elem_ptr      = std::move(elem_ptr),
+        .val           = std::move(val),
+        .aligned       = aligned
+    });
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Vector<T, N>::Vector()
+{
+    alloc_index_ = FunctionContext::get_func_context()->alloc_local_var(type());
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Vector<T, N>::Vector(T value)
+    : Vector(Arithmetic<T>(value))
+{
+
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Vector<T, N>::Vector(const Arithmetic<T> &value)
+{
+    init_temp(core::VectorBroadcast{
+        .vector_type = type(),
+        .scalar      = newNode<core::Expr>(value._load())
+    });
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Vector<T, N>::Vector(const Vector &other)
+{
+    init_temp(other._load());
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Vector<T, N>::Vector(Vector &&other) noexcept
+    : alloc_index_(other.alloc_index_), temp_(other.temp_)
+{
+    other.temp_ = nullptr;
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Vector<T, N>::~Vector()
+{
+    if(temp_)
+        temp_->alive = false;
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Vector<T, N> &Vector<T, N>::operator=(const Vector &other)
+{
+    if(this == &other)
+        return *this;
+    if(!temp_ && !other.temp_ && other.alloc_index_ == alloc_index_)
+        return *this;
+
+    auto func_ctx = FunctionContext::get_func_context();
+    auto val = other._load();
+    if(temp_)
+    {
+        alloc_index_ = func_ctx->overwrite_temp_value(temp_);
+        temp_ = nullptr;
+    }
+
+    func_ctx->append_statement(core::Store{
+        .dst_addr = _addr(),
+        .val      = std::move(val)
+    });
+    return *this;
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+template<typename U> requires std::is_integral_v<U>
+Arithmetic<T> Vector<T, N>::operator[](const Arithmetic<U> &idx) const
+{
+    auto type_ctx = FunctionContext::get_func_context()->get_type_context();
+    auto vector = _load();
+    return Arithmetic<T>::_from_expr(core::VectorExtract{
+        .vector_type = type(),
+        .index_type  = type_ctx->get_type<Arithmetic<U>>(),
+        .vector      = newNode<core::Expr>(std::move(vector)),
+        .index       = newNode<core::Expr>(idx._load())
+    });
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+template<typename U> requires std::is_integral_v<U>
+Arithmetic<T> Vector<T, N>::operator[](U idx) const
+{
+    return this->operator[](Arithmetic<U>(idx));
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+template<typename U> requires std::is_integral_v<U>
+void Vector<T, N>::set(const Arithmetic<U> &idx, const Arithmetic<T> &value)
+{
+    auto type_ctx = FunctionContext::get_func_context()->get_type_context();
+    auto vector = _load();
+    auto index = idx._load();
+    *this = _from_expr(core::VectorInsert{
+        .vector_type = type(),
+        .index_type  = type_ctx->get_type<Arithmetic<U>>(),
+        .vector      = newNode<core::Expr>(std::move(vector)),
+        .index       = newNode<core::Expr>(std::move(index)),
+        .element     = newNode<core::Expr>(value._load())
+    });
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+template<typename U> requires std::is_integral_v<U>
+void Vector<T, N>::set(U idx, const Arithmetic<T> &value)
+{
+    this->set(Arithmetic<U>(idx), value);
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+template<typename U> requires std::is_arithmetic_v<U>
+Vector<U, N> Vector<T, N>::as() const
+{
+    if constexpr(std::is_same_v<T, U>)
+        return *this;
+    else
+    {
+        auto type_ctx = FunctionContext::get_func_context()->get_type_context();
+        return Vector<U, N>::_from_expr(core::ArithmeticCast{
+            .dst_type = type_ctx->get_type<Vector<U, N>>(),
+            .src_type = type(),
+            .src_val  = newNode<core::Expr>(_load())
+        });
+    }
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Vector<T, N> Vector<T, N>::operator-() const
+{
+    static_assert(!std::is_same_v<T, bool>);
+    return _from_expr(core::Unary{
+        .op       = core::Unary::Op::Neg,
+        .val      = newNode<core::Expr>(_load()),
+        .val_type = type()
+    });
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Vector<T, N> Vector<T, N>::operator~() const
+{
+    static_assert(std::is_integral_v<T>);
+    return _from_expr(core::Unary{
+        .op       = core::Unary::Op::BitwiseNot,
+        .val      = newNode<core::Expr>(_load()),
+        .val_type = type()
+    });
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Vector<T, N> Vector<T, N>::operator+(const Vector &rhs) const
+{
+    static_assert(!std::is_same_v<T, bool>);
+    return binary<Vector>(core::Binary::Op::Add, rhs);
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Vector<T, N> Vector<T, N>::operator-(const Vector &rhs) const
+{
+    static_assert(!std::is_same_v<T, bool>);
+    return binary<Vector>(core::Binary::Op::Sub, rhs);
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Vector<T, N> Vector<T, N>::operator*(const Vector &rhs) const
+{
+    static_assert(!std::is_same_v<T, bool>);
+    return binary<Vector>(core::Binary::Op::Mul, rhs);
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Vector<T, N> Vector<T, N>::operator/(const Vector &rhs) const
+{
+    static_assert(!std::is_same_v<T, bool>);
+    return binary<Vector>(core::Binary::Op::Div, rhs);
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Vector<T, N> Vector<T, N>::operator%(const Vector &rhs) const
+{
+    static_assert(std::is_integral_v<T> && !std::is_same_v<T, bool>);
+    return binary<Vector>(core::Binary::Op::Mod, rhs);
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Vector<T, N> Vector<T, N>::operator<<(const Vector &rhs) const
+{
+    static_assert(std::is_integral_v<T>);
+    return binary<Vector>(core::Binary::Op::LeftShift, rhs);
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Vector<T, N> Vector<T, N>::operator>>(const Vector &rhs) const
+{
+    static_assert(std::is_integral_v<T> && !std::is_signed_v<T>);
+    return binary<Vector>(core::Binary::Op::RightShift, rhs);
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Vector<T, N> Vector<T, N>::operator&(const Vector &rhs) const
+{
+    static_assert(std::is_integral_v<T>);
+    return binary<Vector>(core::Binary::Op::BitwiseAnd, rhs);
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Vector<T, N> Vector<T, N>::operator|(const Vector &rhs) const
+{
+    static_assert(std::is_integral_v<T>);
+    return binary<Vector>(core::Binary::Op::BitwiseOr, rhs);
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Vector<T, N> Vector<T, N>::operator^(const Vector &rhs) const
+{
+    static_assert(std::is_integral_v<T>);
+    return binary<Vector>(core::Binary::Op::BitwiseXOr, rhs);
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Vector<bool, N> Vector<T, N>::operator==(const Vector &rhs) const
+{
+    return binary<Vector<bool, N>>(core::Binary::Op::Equal, rhs);
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Vector<bool, N> Vector<T, N>::operator!=(const Vector &rhs) const
+{
+    return binary<Vector<bool, N>>(core::Binary::Op::NotEqual, rhs);
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Vector<bool, N> Vector<T, N>::operator<(const Vector &rhs) const
+{
+    return binary<Vector<bool, N>>(core::Binary::Op::Less, rhs);
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Vector<bool, N> Vector<T, N>::operator<=(const Vector &rhs) const
+{
+    return binary<Vector<bool, N>>(core::Binary::Op::LessEqual, rhs);
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Vector<bool, N> Vector<T, N>::operator>(const Vector &rhs) const
+{
+    return binary<Vector<bool, N>>(core::Binary::Op::Greater, rhs);
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Vector<bool, N> Vector<T, N>::operator>=(const Vector &rhs) const
+{
+    return binary<Vector<bool, N>>(core::Binary::Op::GreaterEqual, rhs);
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+template<int...I>
+Vector<T, sizeof...(I)> Vector<T, N>::shuffle() const
+{
+    static_assert(((I >= 0 && I < static_cast<int>(N)) && ...));
+    // the second operand is never selected
+    return shuffle<I...>(Vector(T(0)));
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+template<int...I>
+Vector<T, sizeof...(I)> Vector<T, N>::shuffle(const Vector &rhs) const
+{
+    static_assert(((I >= 0 && I < static_cast<int>(2 * N)) && ...));
+    auto type_ctx = FunctionContext::get_func_context()->get_type_context();
+    auto lhs = _load();
+    return Vector<T, sizeof...(I)>::_from_expr(core::VectorShuffle{
+        .vector_type = type_ctx->get_type<Vector<T, sizeof...(I)>>(),
+        .src_type    = type(),
+        .lhs         = newNode<core::Expr>(std::move(lhs)),
+        .rhs         = newNode<core::Expr>(rhs._load()),
+        .indices     = { I... }
+    });
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Arithmetic<T> Vector<T, N>::reduce_add() const
+{
+    static_assert(!std::is_same_v<T, bool>);
+    return reduce(core::VectorReduce::Op::Add);
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Arithmetic<T> Vector<T, N>::reduce_mul() const
+{
+    static_assert(!std::is_same_v<T, bool>);
+    return reduce(core::VectorReduce::Op::Mul);
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Arithmetic<T> Vector<T, N>::reduce_min() const
+{
+    static_assert(!std::is_same_v<T, bool>);
+    return reduce(core::VectorReduce::Op::Min);
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Arithmetic<T> Vector<T, N>::reduce_max() const
+{
+    static_assert(!std::is_same_v<T, bool>);
+    return reduce(core::VectorReduce::Op::Max);
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Arithmetic<T> Vector<T, N>::reduce_and() const
+{
+    static_assert(std::is_integral_v<T>);
+    return reduce(core::VectorReduce::Op::BitwiseAnd);
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Arithmetic<T> Vector<T, N>::reduce_or() const
+{
+    static_assert(std::is_integral_v<T>);
+    return reduce(core::VectorReduce::Op::BitwiseOr);
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Arithmetic<T> Vector<T, N>::reduce_xor() const
+{
+    static_assert(std::is_integral_v<T>);
+    return reduce(core::VectorReduce::Op::BitwiseXOr);
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Vector<T, N> Vector<T, N>::load(const Pointer<Arithmetic<T>> &ptr)
+{
+    return load(ptr, false);
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Vector<T, N> Vector<T, N>::load_aligned(const Pointer<Arithmetic<T>> &ptr)
+{
+    return load(ptr, true);
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+void Vector<T, N>::store(const Pointer<Arithmetic<T>> &ptr) const
+{
+    store(ptr, false);
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+void Vector<T, N>::store_aligned(const Pointer<Arithmetic<T>> &ptr) const
+{
+    store(ptr, true);
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+Vector<T, N> Vector<T, N>::_from_expr(core::Expr expr)
+{
+    Vector ret(Uninit{});
+    ret.init_temp(std::move(expr));
+    return ret;
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+core::Expr Vector<T, N>::_load() const
+{
+    if(temp_)
+    {
+        auto func_ctx = FunctionContext::get_func_context();
+        if(auto expr = func_ctx->use_temp_value(temp_))
+            return *expr;
+    }
+    return core::Load{
+        .val_type = type(),
+        .src_addr = newNode<core::Expr>(_addr())
+    };
+}
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+core::LocalAllocAddr Vector<T, N>::_addr() const
+{
+    if(temp_)
+    {
+        alloc_index_ = FunctionContext::get_func_context()
+            ->materialize_temp_value(temp_);
+        temp_ = nullptr;
+    }
+    return core::LocalAllocAddr{
+        .alloc_type  = type(),
+        .alloc_index = alloc_index_
+    };
+}
+
+template<typename T, size_t N>
+Vector<T, N> operator+(T lhs, const Vector<T, N> &rhs)
+{
+    return Vector<T, N>(lhs) + rhs;
+}
+
+template<typename T, size_t N>
+Vector<T, N> operator-(T lhs, const Vector<T, N> &rhs)
+{
+    return Vector<T, N>(lhs) - rhs;
+}
+
+template<typename T, size_t N>
+Vector<T, N> operator*(T lhs, const Vector<T, N> &rhs)
+{
+    return Vector<T, N>(lhs) * rhs;
+}
+
+template<typename T, size_t N>
+Vector<T, N> operator/(T lhs, const Vector<T, N> &rhs)
+{
+    return Vector<T, N>(lhs) / rhs;
+}
+
+template<size_t N>
+Vector<bool, N> operator!(const Vector<bool, N> &mask)
+{
+    auto type_ctx = FunctionContext::get_func_context()->get_type_context();
+    return Vector<bool, N>::_from_expr(core::Unary{
+        .op       = core::Unary::Op::Not,
+        .val      = newNode<core::Expr>(mask._load()),
+        .val_type = type_ctx->get_type<Vector<bool, N>>()
+    });
+}
+
+template<typename T, size_t N>
+Vector<T, N> select(
+    const Vector<bool, N> &mask, const Vector<T, N> &a, const Vector<T, N> &b)
+{
+    auto type_ctx = FunctionContext::get_func_context()->get_type_context();
+    auto cond = mask._load();
+    auto true_val = a._load();
+    return Vector<T, N>::_from_expr(core::Select{
+        .val_type  = type_ctx->get_type<Vector<T, N>>(),
+        .cond_type = type_ctx->get_type<Vector<bool, N>>(),
+        .cond      = newNode<core::Expr>(std::move(cond)),
+        .true_val  = newNode<core::Expr>(std::move(true_val)),
+        .false_val = newNode<core::Expr>(b._load())
+    });
+}
+
+CUJ_NAMESPACE_END(cuj::dsl)
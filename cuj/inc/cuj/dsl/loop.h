@@ -17,8 +17,8 @@ public:
 
 class WhileBuilder : public Uncopyable
 {
-    RC<core::Block> cond_block_;
-    core::Expr      cond_;
+    core::Block *cond_block_ = nullptr;
+    core::Expr   cond_;
 
 public:
 
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <functional>
+#include <mutex>
 #include <set>
 
 #include <cuj/core/prog.h>
@@ -28,8 +30,31 @@ public:
 
     core::Prog _generate_prog() const;
 
+    // calls task(i) for each i in [0, task_count) on thread_count threads
+    // (0 means all hardware threads), with this module being the current
+    // module of each thread. functions added by task i are placed after the
+    // ones added by task i - 1, so the generated prog doesn't depend on
+    // scheduling as long as the tasks give their functions fixed names
+    void record_parallel(
+        size_t                             task_count,
+        const std::function<void(size_t)> &task,
+        int                                thread_count = 0);
+
+    // folds immediate-only arithmetic while recording functions of this module
+    void set_constant_folding(bool enabled);
+
+    bool is_constant_folding_enabled() const;
+
 private:
 
+    bool constant_folding_ = false;
+
+    // guards functions_ and registered_contextless_functions_
+    mutable std::mutex mutex_;
+
+    // task index of each function added in record_parallel
+    std::vector<size_t> parallel_task_indices_;
+
     std::vector<RC<FunctionContext>>    functions_;
     std::set<RC<const FunctionContext>> registered_contextless_functions_;
     RC<TypeContext>                     type_context_;
@@ -50,6 +75,7 @@ void Module::register_function(const Function<F> &func)
     auto func_ctx = func._get_context();
     if(!func_ctx->is_contexted())
     {
+        std::lock_guard lock(mutex_);
         registered_contextless_functions_.insert(func_ctx);
         return;
     }
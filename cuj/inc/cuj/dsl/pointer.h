@@ -10,10 +10,18 @@ CUJ_NAMESPACE_BEGIN(cuj::dsl)
 template<typename T>
 class Pointer
 {
-    size_t alloc_index_;
+    struct Uninit { };
+
+    explicit Pointer(Uninit) { }
+
+    // a temp value is stored into alloc_index_ only when needed
+    mutable size_t     alloc_index_ = 0;
+    mutable TempValue *temp_        = nullptr;
 
     static const core::Type *type();
 
+    void init_temp(core::Expr expr);
+
 public:
 
     using PointedType = T;
@@ -28,6 +36,8 @@ public:
 
     Pointer(Pointer &&other) noexcept;
 
+    ~Pointer();
+
     Pointer &operator=(const Pointer &other);
 
     template<typename U> requires std::is_integral_v<U>
@@ -69,7 +79,7 @@ public:
 
     core::LocalAllocAddr _addr() const;
 
-    core::Load _load() const;
+    core::Expr _load() const;
 };
 
 template<typename T> requires std::is_same_v<T, std::nullptr_t>
@@ -10,7 +10,7 @@ class ref<Pointer<T>>
 {
     Pointer<Pointer<T>> addr_;
 
-    ref() = default;
+    explicit ref(const Pointer<Pointer<T>> &addr) : addr_(addr) { }
 
 public:
 
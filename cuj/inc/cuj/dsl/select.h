@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cuj/dsl/variable_forward.h>
+
+CUJ_NAMESPACE_BEGIN(cuj::dsl)
+
+// cond ? a : b without branching. both a and b are evaluated
+template<typename T> requires is_cuj_var_v<T>
+T select(const Arithmetic<bool> &cond, const T &a, const T &b);
+
+CUJ_NAMESPACE_END(cuj::dsl)
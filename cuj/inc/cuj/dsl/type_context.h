@@ -1,5 +1,6 @@
 #pragma once
 
+#include <mutex>
 #include <typeindex>
 
 #include <cuj/core/type.h>
@@ -23,10 +24,12 @@ public:
 
     TypeContext &operator=(TypeContext &&) noexcept = default;
 
+    // o(1) after the first call with the same T on this thread.
+    // can be called from multiple threads
     template<typename T> requires is_cuj_var_v<T>
     const Type *get_type();
 
-    std::type_index get_type_index(const core::Type *type) const;
+    core::TypeKey get_type_index(const core::Type *type) const;
 
     auto &get_all_types() const { return type_set_->index_to_type; }
 
@@ -34,7 +37,16 @@ public:
 
 private:
 
-    RC<core::TypeSet> type_set_;
+    static uint64_t generate_uid();
+
+    template<typename T>
+    const Type *create_type();
+
+    // unique among all type contexts. copies share the type set, the uid
+    // and the mutex guarding the type set
+    uint64_t                 uid_;
+    RC<core::TypeSet>        type_set_;
+    RC<std::recursive_mutex> mutex_;
 };
 
 CUJ_NAMESPACE_END(cuj::dsl)
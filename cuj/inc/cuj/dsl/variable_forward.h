@@ -6,6 +6,8 @@ CUJ_NAMESPACE_BEGIN(cuj::dsl)
 
 struct CujVoid { };
 
+struct TempValue;
+
 // arithmetic
 
 template<typename T> requires std::is_arithmetic_v<T>
@@ -48,6 +50,20 @@ struct IsCujArray<Array<T, N>> : std::true_type { };
 template<typename T>
 constexpr bool is_cuj_array_v = IsCujArray<T>::value;
 
+// vector
+
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+class Vector;
+
+template<typename T>
+struct IsCujVector : std::false_type { };
+
+template<typename T, size_t N>
+struct IsCujVector<Vector<T, N>> : std::true_type { };
+
+template<typename T>
+constexpr bool is_cuj_vector_v = IsCujVector<T>::value;
+
 // class
 
 template<typename T>
@@ -65,6 +81,7 @@ constexpr bool is_cuj_var_v =
     is_cuj_pointer_v<T>        ||
     std::is_same_v<T, CujVoid> ||
     is_cuj_array_v<T>          ||
+    is_cuj_vector_v<T>         ||
     is_cuj_class_v<T>;
 
 // reference
@@ -231,6 +248,9 @@ using num = Arithmetic<T>;
 template<typename T, size_t N>
 using arr = Array<T, N>;
 
+template<typename T, size_t N>
+using vec = Vector<T, N>;
+
 template<typename T>
 using cxx = cxx_to_cuj_t<T>;
 
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cuj/core/expr.h>
+#include <cuj/dsl/variable_forward.h>
+
+CUJ_NAMESPACE_BEGIN(cuj::dsl)
+
+// fixed-width simd vector. elements are read by value and written with set.
+// vectors can be used as locals, but not as function arguments or results
+template<typename T, size_t N> requires std::is_arithmetic_v<T> && (N > 0)
+class Vector
+{
+    struct Uninit { };
+
+    explicit Vector(Uninit) { }
+
+    // a temp value is stored into alloc_index_ only when needed
+    mutable size_t     alloc_index_ = 0;
+    mutable TempValue *temp_        = nullptr;
+
+    static const core::Type *type();
+
+    void init_temp(core::Expr expr);
+
+    template<typename R>
+    R binary(core::Binary::Op op, const Vector &rhs) const;
+
+    Arithmetic<T> reduce(core::VectorReduce::Op op) const;
+
+    static Vector load(const Pointer<Arithmetic<T>> &ptr, bool aligned);
+
+    void store(const Pointer<Arithmetic<T>> &ptr, bool aligned) const;
+
+public:
+
+    using ElementType = Arithmetic<T>;
+    using RawType     = T;
+
+    static constexpr size_t ElementCount = N;
+
+    Vector();
+
+    Vector(T value);
+
+    Vector(const Arithmetic<T> &value);
+
+    Vector(const Vector &other);
+
+    Vector(Vector &&other) noexcept;
+
+    ~Vector();
+
+    Vector &operator=(const Vector &other);
+
+    constexpr size_t size() const { return N; }
+
+    template<typename U> requires std::is_integral_v<U>
+    Arithmetic<T> operator[](const Arithmetic<U> &idx) const;
+
+    template<typename U> requires std::is_integral_v<U>
+    Arithmetic<T> operator[](U idx) const;
+
+    template<typename U> requires std::is_integral_v<U>
+    void set(const Arithmetic<U> &idx, const Arithmetic<T> &value);
+
+    template<typename U> requires std::is_integral_v<U>
+    void set(U idx, const Arithmetic<T> &value);
+
+    // element-wise conversion
+    template<typename U> requires std::is_arithmetic_v<U>
+    Vector<U, N> as() const;
+
+    Vector operator-() const;
+    Vector operator~() const;
+
+    Vector operator+(const Vector &rhs) const;
+    Vector operator-(const Vector &rhs) const;
+    Vector operator*(const Vector &rhs) const;
+    Vector operator/(const Vector &rhs) const;
+    Vector operator%(const Vector &rhs) const;
+
+    Vector operator<<(const Vector &rhs) const;
+    Vector operator>>(const Vector &rhs) const;
+
+    Vector operator&(const Vector &rhs) const;
+    Vector operator|(const Vector &rhs) const;
+    Vector operator^(const Vector &rhs) const;
+
+    Vector<bool, N> operator==(const Vector &rhs) const;
+    Vector<bool, N> operator!=(const Vector &rhs) const;
+    Vector<bool, N> operator< (const Vector &rhs) const;
+    Vector<bool, N> operator<=(const Vector &rhs) const;
+    Vector<bool, N> operator> (const Vector &rhs) const;
+    Vector<bool, N> operator>=(const Vector &rhs) const;
+
+    // result[i] = (*this)[I[i]]
+    template<int...I>
+    Vector<T, sizeof...(I)> shuffle() const;
+
+    // result[i] = I[i] < N ? (*this)[I[i]] : rhs[I[i] - N]
+    template<int...I>
+    Vector<T, sizeof...(I)> shuffle(const Vector &rhs) const;
+
+    Arithmetic<T> reduce_add() const;
+    Arithmetic<T> reduce_mul() const;
+    Arithmetic<T> reduce_min() const;
+    Arithmetic<T> reduce_max() const;
+    Arithmetic<T> reduce_and() const;
+    Arithmetic<T> reduce_or() const;
+    Arithmetic<T> reduce_xor() const;
+
+    // reads ptr[0], ..., ptr[N - 1]. the aligned versions require ptr to be
+    // aligned to the vector size rounded up to a power of 2
+    static Vector load(const Pointer<Arithmetic<T>> &ptr);
+
+    static Vector load_aligned(const Pointer<Arithmetic<T>> &ptr);
+
+    void store(const Pointer<Arithmetic<T>> &ptr) const;
+
+    void store_aligned(const Pointer<Arithmetic<T>> &ptr) const;
+
+    static Vector _from_expr(core::Expr expr);
+
+    core::Expr _load() const;
+
+    core::LocalAllocAddr _addr() const;
+};
+
+template<typename T, size_t N>
+Vector<T, N> operator+(T lhs, const Vector<T, N> &rhs);
+template<typename T, size_t N>
+Vector<T, N> operator-(T lhs, const Vector<T, N> &rhs);
+template<typename T, size_t N>
+Vector<T, N> operator*(T lhs, const Vector<T, N> &rhs);
+template<typename T, size_t N>
+Vector<T, N> operator/(T lhs, const Vector<T, N> &rhs);
+
+template<size_t N>
+Vector<bool, N> operator!(const Vector<bool, N> &mask);
+
+// element-wise mask ? a : b without branching
+template<typename T, size_t N>
+Vector<T, N> select(
+    const Vector<bool, N> &mask, const Vector<T, N> &a, const Vector<T, N> &b);
+
+CUJ_NAMESPACE_END(cuj::dsl)
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <cuj/gen/interpreter.h>
 #include <cuj/gen/llvm.h>
 #include <cuj/gen/mcjit.h>
+#include <cuj/gen/native_kernel.h>
+#include <cuj/gen/native_launcher.h>
+#include <cuj/gen/orc.h>
 #include <cuj/gen/ptx.h>
 
 CUJ_NAMESPACE_BEGIN(cuj)
@@ -9,8 +13,15 @@ CUJ_NAMESPACE_BEGIN(cuj)
 using gen::Options;
 using gen::OptimizationLevel;
 
+using gen::Dim3;
+using gen::NativeKernelEntry;
+using gen::launch_native_kernel;
+
+using gen::Interpreter;
 using gen::LLVMIRGenerator;
 using gen::MCJIT;
+using gen::NativeLauncher;
+using gen::OrcJIT;
 using gen::PTXGenerator;
 
 CUJ_NAMESPACE_END(cuj)
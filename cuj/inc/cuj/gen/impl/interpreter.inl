@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cassert>
+
+CUJ_NAMESPACE_BEGIN(cuj::gen)
+
+template<typename Ret, typename...Args>
+InterpretedFunction<Ret(Args...)>::InterpretedFunction(
+    const Interpreter *interpreter, size_t func_index)
+    : interpreter_(interpreter), func_index_(func_index)
+{
+
+}
+
+template<typename Ret, typename...Args>
+Ret InterpretedFunction<Ret(Args...)>::operator()(Args...args) const
+{
+    assert(interpreter_);
+    void *arg_ptrs[sizeof...(Args) + 1] = {
+        static_cast<void *>(&args)..., nullptr
+    };
+    if constexpr(std::is_void_v<Ret>)
+        interpreter_->call(func_index_, nullptr, arg_ptrs);
+    else
+    {
+        Ret ret;
+        interpreter_->call(func_index_, &ret, arg_ptrs);
+        return ret;
+    }
+}
+
+template<typename T>
+    requires std::is_function_v<T>
+InterpretedFunction<T> Interpreter::get_function(
+    const std::string &symbol_name) const
+{
+    const size_t index = find_function(symbol_name);
+    if(index == static_cast<size_t>(-1))
+        return {};
+    return InterpretedFunction<T>(this, index);
+}
+
+template<typename T, typename Ret, typename...Args>
+    requires std::is_function_v<T>
+InterpretedFunction<T> Interpreter::get_function(
+    const dsl::Function<Ret(Args...)> &func) const
+{
+    static_assert(
+        mcjit_detail::CFunctionSignatureTrait<T, Ret, Args...>::compatible,
+        "function signature doesn't match");
+    const auto &name = func._get_context()->get_core_func()->name;
+    assert(!name.empty());
+    return this->get_function<T>(name);
+}
+
+template<typename Ret, typename...Args>
+    requires (!std::is_function_v<Ret>)
+auto Interpreter::get_function(const dsl::Function<Ret(Args...)> &func) const
+{
+    using CFunctionType =
+        typename mcjit_detail::FunctionTypeToCFunctionType<Ret(Args...)>::Type;
+    return this->get_function<CFunctionType>(func);
+}
+
+CUJ_NAMESPACE_END(cuj::gen)
@@ -171,4 +171,14 @@ auto MCJIT::get_function(const dsl::Function<Ret(Args...)> &func) const
     return this->get_function<CFunctionType>(func);
 }
 
+template<typename Ret, typename...Args>
+NativeKernelEntry *MCJIT::get_kernel(
+    const dsl::Function<Ret(Args...)> &func) const
+{
+    auto core_func = func._get_context()->get_core_func();
+    assert(core_func->type == core::Func::Kernel);
+    assert(!core_func->name.empty());
+    return this->get_kernel(core_func->name);
+}
+
 CUJ_NAMESPACE_END(cuj::gen)
@@ -0,0 +1,21 @@
+#pragma once
+
+CUJ_NAMESPACE_BEGIN(cuj::gen)
+
+template<typename...Args>
+NativeLauncher::LaunchStatistics NativeLauncher::launch(
+    NativeKernelEntry *entry,
+    const Dim3        &grid_dim,
+    const Dim3        &block_dim,
+    Args            ...kernel_args)
+{
+    if constexpr(sizeof...(kernel_args) > 0)
+    {
+        void *kernel_arg_ptrs[] = { static_cast<void *>(&kernel_args)... };
+        return launch_impl(entry, grid_dim, block_dim, kernel_arg_ptrs);
+    }
+    else
+        return launch_impl(entry, grid_dim, block_dim, nullptr);
+}
+
+CUJ_NAMESPACE_END(cuj::gen)
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cassert>
+
+CUJ_NAMESPACE_BEGIN(cuj::gen)
+
+template<typename T>
+    requires std::is_function_v<T>
+T *OrcJIT::get_function(const std::string &symbol_name) const
+{
+    return reinterpret_cast<T *>(get_function_impl(symbol_name));
+}
+
+template<typename T, typename Ret, typename...Args>
+    requires std::is_function_v<T>
+T *OrcJIT::get_function(const dsl::Function<Ret(Args...)> &func) const
+{
+    static_assert(
+        mcjit_detail::CFunctionSignatureTrait<T, Ret, Args...>::compatible,
+        "function signature doesn't match");
+    const auto &name = func._get_context()->get_core_func()->name;
+    assert(!name.empty());
+    return this->get_function<T>(name);
+}
+
+template<typename Ret, typename ... Args>
+    requires (!std::is_function_v<Ret>)
+auto OrcJIT::get_function(const dsl::Function<Ret(Args...)> &func) const
+{
+    using CFunctionType =
+        typename mcjit_detail::FunctionTypeToCFunctionType<Ret(Args...)>::Type;
+    return this->get_function<CFunctionType>(func);
+}
+
+CUJ_NAMESPACE_END(cuj::gen)
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cuj/gen/mcjit.h>
+
+CUJ_NAMESPACE_BEGIN(cuj::gen)
+
+class Interpreter;
+
+// callable returned by Interpreter::get_function. arguments and return
+// values use the same c types as functions returned by MCJIT
+template<typename T>
+class InterpretedFunction;
+
+template<typename Ret, typename...Args>
+class InterpretedFunction<Ret(Args...)>
+{
+public:
+
+    InterpretedFunction() = default;
+
+    InterpretedFunction(const Interpreter *interpreter, size_t func_index);
+
+    Ret operator()(Args...args) const;
+
+    explicit operator bool() const { return interpreter_ != nullptr; }
+
+private:
+
+    const Interpreter *interpreter_ = nullptr;
+    size_t             func_index_  = 0;
+};
+
+// executes core ir without llvm. functions are lowered into a register-based
+// bytecode, which is much cheaper than compiling them. meant for functions
+// called once or rarely, e.g. before deciding to jit them
+class Interpreter : public Uncopyable
+{
+public:
+
+    Interpreter() = default;
+
+    Interpreter(Interpreter &&other) noexcept;
+
+    Interpreter &operator=(Interpreter &&other) noexcept;
+
+    ~Interpreter();
+
+    void generate(const dsl::Module &mod);
+
+    void generate(const core::Prog &prog);
+
+    template<typename T>
+        requires std::is_function_v<T>
+    InterpretedFunction<T> get_function(const std::string &symbol_name) const;
+
+    template<typename T, typename Ret, typename...Args>
+        requires std::is_function_v<T>
+    InterpretedFunction<T> get_function(
+        const dsl::Function<Ret(Args...)> &func) const;
+
+    template<typename Ret, typename...Args>
+        requires (!std::is_function_v<Ret>)
+    auto get_function(const dsl::Function<Ret(Args...)> &func) const;
+
+    // number of times the function was called, including calls from other
+    // interpreted functions. can be used to decide when to jit it
+    uint64_t get_call_count(const std::string &symbol_name) const;
+
+    // args[i] points to the value of the ith argument. reference arguments
+    // are passed as pointers. ret can be null for void functions
+    void call(size_t func_index, void *ret, void *const *args) const;
+
+private:
+
+    struct InterpreterData;
+
+    // returns -1 when not found
+    size_t find_function(const std::string &symbol_name) const;
+
+    InterpreterData *data_ = nullptr;
+};
+
+CUJ_NAMESPACE_END(cuj::gen)
+
+#include <cuj/gen/impl/interpreter.inl>
@@ -5,11 +5,14 @@
 namespace llvm
 {
 
+    struct Align;
+    class BasicBlock;
     class LLVMContext;
     class DataLayout;
     class Function;
     class FunctionType;
     class Module;
+    class PHINode;
     class Type;
     class Value;
 
@@ -39,10 +42,28 @@ public:
 
     void disable_basic_optimizations();
 
+    // run core::optimize on generated functions before lowering them
+    void enable_core_optimizations();
+
+    // keep scalar locals whose address is never taken in ssa registers
+    // instead of allocas, so that mem2reg is not needed
+    void use_direct_ssa();
+
     void set_data_layout(llvm::DataLayout *data_layout);
 
+    // target triple, 'target-cpu' and 'target-features' of native functions
+    void set_native_target(
+        std::string triple, std::string cpu, std::string features);
+
     void generate(const dsl::Module &mod);
 
+    void generate(const core::Prog &prog);
+
+    // generate only prog.funcs[i] for i in func_indices.
+    // functions outside the subset must not be called from it
+    void generate(
+        const core::Prog &prog, const std::vector<size_t> &func_indices);
+
     llvm::Module *get_llvm_module() const;
 
     std::pair<Box<llvm::LLVMContext>, Box<llvm::Module>> get_data_ownership();
@@ -51,8 +72,9 @@ public:
 
 private:
 
-    std::map<std::type_index, const core::Type *>
-        build_type_to_index(const core::Prog &prog);
+    // returns one type per distinct type key
+    std::vector<const core::Type *>
+        collect_canonical_types(const core::Prog &prog);
 
     llvm::Type *build_llvm_type(const core::Type *type);
 
@@ -64,14 +86,41 @@ private:
 
     void declare_function(const core::Func *func);
 
+    void declare_native_kernel(
+        const core::Func *func, const std::string &symbol_name);
+
     void define_function(const core::Func *func);
 
+    void generate_native_kernel_entry(const core::Func *func);
+
     void clear_temp_function_data();
 
     void generate_local_allocs(const core::Func *func);
 
     void generate_default_ret(const core::Func *func);
 
+    // returns -1 if addr is not the address of an ssa variable
+    int find_ssa_var(const core::Expr &addr) const;
+
+    void write_ssa_var(int var, llvm::BasicBlock *block, llvm::Value *val);
+
+    llvm::Value *read_ssa_var(int var, llvm::BasicBlock *block);
+
+    llvm::Value *read_ssa_var_recursive(int var, llvm::BasicBlock *block);
+
+    llvm::PHINode *create_ssa_phi(int var, llvm::BasicBlock *block);
+
+    llvm::Value *add_ssa_phi_operands(int var, llvm::PHINode *phi);
+
+    llvm::Value *try_remove_trivial_phi(llvm::PHINode *phi);
+
+    llvm::Value *resolve_ssa_value(llvm::Value *val) const;
+
+    // called when all predecessors of block are known
+    void seal_block(llvm::BasicBlock *block);
+
+    void delete_removed_phis();
+
     void generate(const core::Stat &stat);
 
     void generate(const core::Store &store);
@@ -92,6 +141,8 @@ private:
 
     void generate(const core::CallFuncStat &call);
 
+    void generate(const core::VectorStore &store);
+
     llvm::Value *generate(const core::Expr &expr);
 
     llvm::Value *generate(const core::FuncArgAddr &expr);
@@ -126,6 +177,30 @@ private:
 
     llvm::Value *generate(const core::CallFunc &expr);
 
+    llvm::Value *generate(const core::Select &expr);
+
+    llvm::Value *generate(const core::AtomicOperation &expr);
+
+    llvm::Value *generate(const core::VectorBroadcast &expr);
+
+    llvm::Value *generate(const core::VectorExtract &expr);
+
+    llvm::Value *generate(const core::VectorInsert &expr);
+
+    llvm::Value *generate(const core::VectorShuffle &expr);
+
+    llvm::Value *generate(const core::VectorReduce &expr);
+
+    llvm::Value *generate(const core::VectorLoad &expr);
+
+    // bool elements take a byte each like bool scalars, instead of being
+    // packed into bits as <N x i1> in memory
+    llvm::Type *get_vector_memory_type(const core::Type *vector_type) const;
+
+    // element alignment, or the vector size rounded up to a power of 2
+    llvm::Align get_vector_alignment(
+        const core::Type *vector_type, bool aligned) const;
+
     llvm::Value *process_intrinsic_call(
         const core::CallFunc &call, const std::vector<llvm::Value *> &args);
 
@@ -133,8 +208,14 @@ private:
     bool              fast_math_           = false;
     bool              approx_math_func_    = false;
     bool              basic_optimizations_ = true;
+    bool              core_optimizations_  = false;
+    bool              direct_ssa_          = false;
     llvm::DataLayout *data_layout_         = nullptr;
 
+    std::string native_triple_;
+    std::string native_cpu_;
+    std::string native_features_;
+
     LLVMData *llvm_ = nullptr;
 };
 
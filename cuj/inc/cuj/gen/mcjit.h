@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cuj/gen/native_kernel.h>
 #include <cuj/gen/option.h>
 
 CUJ_NAMESPACE_BEGIN(cuj::dsl)
@@ -8,12 +9,28 @@ class Module;
 
 CUJ_NAMESPACE_END(cuj::dsl)
 
+CUJ_NAMESPACE_BEGIN(cuj::core)
+
+struct Prog;
+
+CUJ_NAMESPACE_END(cuj::core)
+
 CUJ_NAMESPACE_BEGIN(cuj::gen)
 
 class MCJIT : public Uncopyable
 {
 public:
 
+    struct CompileCacheStatistics
+    {
+        uint64_t hits   = 0; // number of functions reused from the cache
+        uint64_t misses = 0; // number of functions not found in the cache
+    };
+
+    static CompileCacheStatistics get_compile_cache_statistics();
+
+    static void clear_compile_cache();
+
     MCJIT() = default;
 
     MCJIT(MCJIT &&other) noexcept;
@@ -24,8 +41,22 @@ public:
 
     void set_options(const Options &opts);
 
+    // ir generation and optimization use cached target machines, but each
+    // execution engine owns and destroys its own machine. so every generate
+    // call, tier-up and parallel partition still creates one machine
     void generate(const dsl::Module &mod);
 
+    // e.g. a program read by core::deserialize
+    void generate(const core::Prog &prog);
+
+    // number of functions recompiled by tiered compilation so far
+    size_t get_promoted_function_count() const;
+
+    // empty unless tiered compilation failed to recompile some functions.
+    // their tier-0 code keeps running in that case
+    std::string get_tier_up_error() const;
+
+    // only kept when Options::retain_llvm_ir is set
     const std::string &get_llvm_string() const;
 
     template<typename T>
@@ -40,6 +71,13 @@ public:
         requires (!std::is_function_v<Ret>)
     auto get_function(const dsl::Function<Ret(Args...)> &func) const;
 
+    // entry of a kernel function. see launch_native_kernel
+    NativeKernelEntry *get_kernel(const std::string &symbol_name) const;
+
+    template<typename Ret, typename...Args>
+    NativeKernelEntry *get_kernel(
+        const dsl::Function<Ret(Args...)> &func) const;
+
 private:
 
     struct MCJITData;
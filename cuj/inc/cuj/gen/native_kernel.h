@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+
+#include <cuj/common.h>
+
+CUJ_NAMESPACE_BEGIN(cuj::gen)
+
+struct Dim3
+{
+    int32_t x = 1, y = 1, z = 1;
+};
+
+// a kernel function compiled for the native target runs all threads of one
+// block per call, as a scalar loop over thread indices. simd lanes come only
+// from the llvm loop vectorizer, which handles straight-line kernels and $if
+// branches it can turn into selects. threads of kernels with $while loops run
+// one at a time. kernel_args[i] points to the i-th kernel argument
+using NativeKernelEntry = void(
+    void **kernel_args, const Dim3 *block_idx, const Dim3 *block_dim);
+
+// runs all blocks of the grid on the calling thread
+void launch_native_kernel_impl(
+    NativeKernelEntry *entry,
+    const Dim3        &grid_dim,
+    const Dim3        &block_dim,
+    void             **kernel_args);
+
+template<typename...Args>
+void launch_native_kernel(
+    NativeKernelEntry *entry,
+    const Dim3        &grid_dim,
+    const Dim3        &block_dim,
+    Args            ...kernel_args);
+
+CUJ_NAMESPACE_END(cuj::gen)
+
+#include <cuj/gen/impl/native_kernel.inl>
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cuj/gen/native_kernel.h>
+#include <cuj/utils/uncopyable.h>
+
+CUJ_NAMESPACE_BEGIN(cuj::gen)
+
+// runs the blocks of native kernels on a persistent thread pool.
+// each thread starts with a contiguous range of blocks and steals half of
+// the remaining range of another thread when its own range is used up
+class NativeLauncher : public Uncopyable
+{
+public:
+
+    struct LaunchStatistics
+    {
+        double  seconds     = 0; // wall time of the launch
+        int64_t block_count = 0; // number of executed blocks
+        int64_t steal_count = 0; // number of ranges stolen by idle threads
+    };
+
+    // thread_count <= 0 means std::thread::hardware_concurrency().
+    // the calling thread of launch is one of the threads.
+    // if pin_threads is set, pool thread i is pinned to the i-th cpu usable
+    // by the process, which keeps blocks near the memory they first touched
+    // on numa systems. pinning is only supported on linux
+    explicit NativeLauncher(int thread_count = 0, bool pin_threads = false);
+
+    ~NativeLauncher();
+
+    int get_thread_count() const;
+
+    // number of blocks a thread takes from its range at a time.
+    // 0 gives each thread about 16 chunks per launch
+    void set_chunk_size(int64_t block_count);
+
+    template<typename...Args>
+    LaunchStatistics launch(
+        NativeKernelEntry *entry,
+        const Dim3        &grid_dim,
+        const Dim3        &block_dim,
+        Args            ...kernel_args);
+
+private:
+
+    struct LauncherData;
+
+    LaunchStatistics launch_impl(
+        NativeKernelEntry *entry,
+        const Dim3        &grid_dim,
+        const Dim3        &block_dim,
+        void             **kernel_args);
+
+    void run_thread(int thread_index);
+
+    bool take_chunk(int thread_index, int64_t &begin, int64_t &end);
+
+    bool steal_range(int thread_index);
+
+    int64_t       chunk_size_ = 0;
+    LauncherData *data_       = nullptr;
+};
+
+CUJ_NAMESPACE_END(cuj::gen)
+
+#include <cuj/gen/impl/native_launcher.inl>
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <string>
+
 #include <cuj/common.h>
 
 CUJ_NAMESPACE_BEGIN(cuj::gen)
@@ -9,7 +11,9 @@ enum class OptimizationLevel
     O0,
     O1,
     O2,
-    O3
+    O3,
+    Os,
+    CompileFast, // minimal cleanup, trading code quality for compile latency
 };
 
 struct Options
@@ -17,6 +21,70 @@ struct Options
     OptimizationLevel opt_level        = OptimizationLevel::O3;
     bool              fast_math        = false;
     bool              approx_math_func = false;
+
+    // when not empty, replaces the pipeline selected by opt_level.
+    // uses the textual format of 'opt -passes', e.g. "function(sroa,gvn)"
+    std::string llvm_pipeline;
+
+    // cpu name and feature string (e.g. "+avx2,+fma") of native target.
+    // empty native_cpu means the host cpu, and host features are used
+    // when native_features is also empty
+    std::string native_cpu;
+    std::string native_features;
+
+    // number of threads used by mcjit to optimize and emit code. 0 means
+    // all hardware threads. functions are partitioned by call graph, so a
+    // module forming a single call graph component is compiled on one
+    // thread. ignored when object_cache_directory is set
+    int compile_threads = 1;
+
+    // when true, mcjit compiles the module at O0 and get_function returns
+    // trampolines. a background thread recompiles functions with opt_level
+    // and redirects the trampolines. compile_threads, object cache and
+    // compile cache are not used in this mode
+    bool tiered_compilation = false;
+
+    // when positive, tiered compilation only recompiles functions called
+    // at least this many times
+    uint64_t tier_up_call_threshold = 0;
+
+    // when not empty, mcjit stores compiled object files in this directory
+    // and reuses them for programs with the same structural hash
+    std::string object_cache_directory;
+
+    // when true, mcjit reuses machine code of structurally identical
+    // functions compiled earlier in this process
+    bool enable_compile_cache = false;
+
+    // when true, generators keep the textual llvm ir of the module for
+    // get_llvm_string/get_llvm_ir. printing big modules is expensive, so
+    // by default only a notice is returned
+    bool retain_llvm_ir = false;
+
+    // when true, generators run core::optimize on functions before lowering
+    // them to llvm ir. see get_compile_time_statistics for its effect
+    bool core_optimizations = false;
+
+    // when true, generators keep scalar locals and arguments whose address
+    // is never taken in ssa registers, building phi nodes while lowering
+    // control flow, instead of using allocas and running mem2reg. helps
+    // compile time with O0. tier 0 of tiered compilation always uses it
+    bool direct_ssa = false;
+};
+
+// accumulated over all generators of this process
+struct CompileTimeStatistics
+{
+    double   core_pass_seconds = 0; // spent in core::optimize
+    double   llvm_pass_seconds = 0; // spent in llvm optimization pipelines
+    uint64_t llvm_pass_modules = 0; // modules run through those pipelines
+    uint64_t merged_exprs      = 0;
+    uint64_t removed_stores    = 0;
+    uint64_t removed_stats     = 0;
 };
 
+CompileTimeStatistics get_compile_time_statistics();
+
+void clear_compile_time_statistics();
+
 CUJ_NAMESPACE_END(cuj::gen)
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cuj/gen/mcjit.h>
+
+CUJ_NAMESPACE_BEGIN(cuj::gen)
+
+// native jit built on llvm orc.
+// each function is optimized and compiled on its first call
+class OrcJIT : public Uncopyable
+{
+public:
+
+    OrcJIT() = default;
+
+    OrcJIT(OrcJIT &&other) noexcept;
+
+    OrcJIT &operator=(OrcJIT &&other) noexcept;
+
+    ~OrcJIT();
+
+    void set_options(const Options &opts);
+
+    void generate(const dsl::Module &mod);
+
+    // unoptimized ir. only kept when Options::retain_llvm_ir is set
+    const std::string &get_llvm_string() const;
+
+    template<typename T>
+        requires std::is_function_v<T>
+    T *get_function(const std::string &symbol_name) const;
+
+    template<typename T, typename Ret, typename...Args>
+        requires std::is_function_v<T>
+    T *get_function(const dsl::Function<Ret(Args...)> &func) const;
+
+    template<typename Ret, typename...Args>
+        requires (!std::is_function_v<Ret>)
+    auto get_function(const dsl::Function<Ret(Args...)> &func) const;
+
+private:
+
+    struct OrcJITData;
+
+    void *get_function_impl(const std::string &symbol_name) const;
+
+    Options     opts_;
+    OrcJITData *orc_data_ = nullptr;
+};
+
+CUJ_NAMESPACE_END(cuj::gen)
+
+#include <cuj/gen/impl/orc.inl>
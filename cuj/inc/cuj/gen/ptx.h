@@ -13,6 +13,7 @@ public:
 
     void generate(const dsl::Module &mod);
 
+    // only kept when Options::retain_llvm_ir is set
     const std::string &get_llvm_ir() const;
 
     const std::string &get_ptx() const;
@@ -72,6 +72,8 @@ private:
 
     void print(TextBuilder &b, const core::CallFuncStat &call);
 
+    void print(TextBuilder &b, const core::VectorStore &store);
+
     // expression
 
     void print(TextBuilder &b, const core::Expr &e);
@@ -108,6 +110,21 @@ private:
 
     void print(TextBuilder &b, const core::CallFunc &call);
 
+    void print(TextBuilder &b, const core::Select &select);
+
+    void print(TextBuilder &b, const core::VectorBroadcast &broadcast);
+
+    void print(TextBuilder &b, const core::VectorExtract &extract);
+
+    void print(TextBuilder &b, const core::VectorInsert &insert);
+
+    void print(TextBuilder &b, const core::VectorShuffle &shuffle);
+
+    void print(TextBuilder &b, const core::VectorReduce &reduce);
+
+    void print(TextBuilder &b, const core::VectorLoad &load);
+    void print(TextBuilder &b, const core::AtomicOperation &atomic);
+
     // type
 
     void print(TextBuilder &b, const core::Type &type);
@@ -119,6 +136,8 @@ private:
     void print(TextBuilder &b, const core::Array &a);
 
     void print(TextBuilder &b, const core::Pointer &p);
+
+    void print(TextBuilder &b, const core::Vector &v);
 };
 
 template<typename...Args>
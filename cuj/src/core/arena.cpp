@@ -0,0 +1,57 @@
+#include <algorithm>
+#include <cstdint>
+
+#include <cuj/core/arena.h>
+
+CUJ_NAMESPACE_BEGIN(cuj::core)
+
+Arena::~Arena()
+{
+    for(auto d = destructors_; d; d = d->next)
+        d->destroy(d->object);
+}
+
+size_t Arena::get_node_count() const
+{
+    return node_count_;
+}
+
+size_t Arena::get_reserved_bytes() const
+{
+    return reserved_bytes_;
+}
+
+void *Arena::allocate(size_t bytes, size_t alignment)
+{
+    auto align_up = [alignment](std::byte *p)
+    {
+        const auto addr = reinterpret_cast<uintptr_t>(p);
+        return p + ((alignment - addr % alignment) % alignment);
+    };
+
+    if(chunk_cur_)
+    {
+        auto ret = align_up(chunk_cur_);
+        if(ret + bytes <= chunk_end_)
+        {
+            chunk_cur_ = ret + bytes;
+            return ret;
+        }
+    }
+
+    // big nodes get a chunk of their own, so the current chunk is kept
+    const size_t chunk_size = (std::max)(CHUNK_SIZE, bytes + alignment);
+    chunks_.push_back(Box<std::byte[]>(new std::byte[chunk_size]));
+    reserved_bytes_ += chunk_size;
+
+    auto chunk = chunks_.back().get();
+    auto ret = align_up(chunk);
+    if(chunk_size > CHUNK_SIZE && chunk_cur_)
+        return ret;
+
+    chunk_cur_ = ret + bytes;
+    chunk_end_ = chunk + chunk_size;
+    return ret;
+}
+
+CUJ_NAMESPACE_END(cuj::core)
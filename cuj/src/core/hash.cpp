@@ -0,0 +1,455 @@
+#include <cuj/core/hash.h>
+#include <cuj/core/visit.h>
+
+CUJ_NAMESPACE_BEGIN(cuj::core)
+
+namespace
+{
+
+    // see dsl::FunctionContext
+    constexpr std::string_view AUTO_FUNC_NAME_PREFIX = "__cuj_auto_function_name_";
+
+} // namespace anonymous
+
+void Hasher::hash(const Prog &prog)
+{
+    func_ids_.clear();
+    for(size_t i = 0; i < prog.funcs.size(); ++i)
+        func_ids_.insert({ prog.funcs[i].get(), i });
+
+    hash_value(prog.funcs.size());
+    for(auto &f : prog.funcs)
+        hash(*f);
+}
+
+void Hasher::hash_canonical(const Prog &prog, size_t func_index)
+{
+    func_ids_.clear();
+    for(size_t i = 0; i < prog.funcs.size(); ++i)
+        func_ids_.insert({ prog.funcs[i].get(), i });
+
+    canonical_func_ids_.clear();
+    std::vector<size_t> funcs = { func_index };
+    canonical_func_ids_.insert({ func_index, 0 });
+
+    auto add_callee = [&](size_t index)
+    {
+        if(canonical_func_ids_.insert({ index, funcs.size() }).second)
+            funcs.push_back(index);
+    };
+
+    auto on_call_func = [&](const CallFunc &call)
+    {
+        if(call.contextless_func)
+        {
+            if(auto it = func_ids_.find(call.contextless_func.get());
+               it != func_ids_.end())
+                add_callee(it->second);
+        }
+        else if(call.intrinsic == Intrinsic::None)
+            add_callee(call.contexted_func_index);
+    };
+    for(size_t i = 0; i < funcs.size(); ++i)
+        visit_call_funcs(*prog.funcs[funcs[i]]->root_block, on_call_func);
+
+    canonical_ = true;
+    hash_value(funcs.size());
+    for(auto i : funcs)
+        hash(*prog.funcs[i]);
+    canonical_ = false;
+}
+
+void Hasher::hash(const Func &func)
+{
+    if(canonical_ && func.name.starts_with(AUTO_FUNC_NAME_PREFIX))
+        hash_value(uint8_t(0));
+    else
+    {
+        hash_value(uint8_t(1));
+        hash_string(func.name);
+    }
+    hash_value(func.type);
+
+    hash_value(func.argument_types.size());
+    for(auto &arg : func.argument_types)
+    {
+        hash(arg.type);
+        hash_value(arg.is_reference);
+    }
+    hash(func.return_type.type);
+    hash_value(func.return_type.is_reference);
+
+    hash_value(func.local_alloc_types.size());
+    for(auto type : func.local_alloc_types)
+        hash(type);
+
+    hash(*func.root_block);
+}
+
+void Hasher::hash(const Type *type)
+{
+    if(auto it = type_ids_.find(type); it != type_ids_.end())
+    {
+        hash_value(uint8_t(0xff));
+        hash_value(it->second);
+        return;
+    }
+    type_ids_.insert({ type, type_ids_.size() });
+
+    hash_value(type->index());
+    type->match(
+        [&](Builtin t)
+    {
+        hash_value(t);
+    },
+        [&](const Struct &t)
+    {
+        hash_value(t.members.size());
+        for(auto m : t.members)
+            hash(m);
+    },
+        [&](const Array &t)
+    {
+        hash(t.element);
+        hash_value(t.size);
+    },
+        [&](const Pointer &t)
+    {
+        hash(t.pointed);
+    },
+        [&](const Vector &t)
+    {
+        hash(t.element);
+        hash_value(t.size);
+    });
+}
+
+void Hasher::hash(const Stat &stat)
+{
+    hash_value(stat.index());
+    stat.match([&](auto &_s) { hash(_s); });
+}
+
+void Hasher::hash(const Expr &expr)
+{
+    hash_value(expr.index());
+    expr.match([&](auto &_e) { hash(_e); });
+}
+
+void Hasher::hash_bytes(const void *data, size_t bytes)
+{
+    // fnv-1a
+    auto p = static_cast<const uint8_t *>(data);
+    for(size_t i = 0; i < bytes; ++i)
+    {
+        state_ ^= p[i];
+        state_ *= 0x100000001b3ull;
+    }
+    if(recorder_)
+        recorder_->append(static_cast<const char *>(data), bytes);
+}
+
+void Hasher::set_recorder(std::string *recorder)
+{
+    recorder_ = recorder;
+}
+
+void Hasher::hash_string(std::string_view str)
+{
+    hash_value(str.size());
+    hash_bytes(str.data(), str.size());
+}
+
+uint64_t Hasher::get_hash() const
+{
+    return state_;
+}
+
+std::string Hasher::get_hash_str() const
+{
+    constexpr char DIGITS[] = "0123456789abcdef";
+    std::string ret(16, '0');
+    for(int i = 0; i < 16; ++i)
+        ret[15 - i] = DIGITS[(state_ >> (4 * i)) & 0xf];
+    return ret;
+}
+
+void Hasher::hash(const Store &store)
+{
+    hash(store.dst_addr);
+    hash(store.val);
+}
+
+void Hasher::hash(const Block &block)
+{
+    hash_value(block.stats.size());
+    for(auto &s : block.stats)
+        hash(*s);
+}
+
+void Hasher::hash(const Return &ret)
+{
+    hash(ret.return_type);
+    if(auto builtin = ret.return_type->as_if<Builtin>();
+       !builtin || *builtin != Builtin::Void)
+        hash(ret.val);
+}
+
+void Hasher::hash(const If &if_s)
+{
+    hash(*if_s.calc_cond);
+    hash(if_s.cond);
+    hash(*if_s.then_body);
+    hash_value(if_s.else_body != nullptr);
+    if(if_s.else_body)
+        hash(*if_s.else_body);
+}
+
+void Hasher::hash(const Loop &loop)
+{
+    hash(*loop.body);
+}
+
+void Hasher::hash(const Break &break_s)
+{
+
+}
+
+void Hasher::hash(const Continue &continue_s)
+{
+
+}
+
+void Hasher::hash(const Switch &switch_s)
+{
+    hash(switch_s.value);
+    hash_value(switch_s.branches.size());
+    for(auto &b : switch_s.branches)
+    {
+        hash(b.cond);
+        hash(*b.body);
+        hash_value(b.fallthrough);
+    }
+    hash_value(switch_s.default_body != nullptr);
+    if(switch_s.default_body)
+        hash(*switch_s.default_body);
+}
+
+void Hasher::hash(const CallFuncStat &call)
+{
+    hash(call.call_expr);
+}
+
+void Hasher::hash(const VectorStore &store)
+{
+    hash(store.vector_type);
+    hash(store.elem_ptr_type);
+    hash(store.elem_ptr);
+    hash(store.val);
+    hash_value(store.aligned);
+}
+
+void Hasher::hash(const FuncArgAddr &expr)
+{
+    hash(expr.addr_type);
+    hash_value(expr.arg_index);
+}
+
+void Hasher::hash(const LocalAllocAddr &expr)
+{
+    hash(expr.alloc_type);
+    hash_value(expr.alloc_index);
+}
+
+void Hasher::hash(const Load &expr)
+{
+    hash(expr.val_type);
+    hash(*expr.src_addr);
+}
+
+void Hasher::hash(const Immediate &expr)
+{
+    hash_value(expr.value.index());
+    expr.value.match([&](auto v) { hash_value(v); });
+}
+
+void Hasher::hash(const NullPtr &expr)
+{
+    hash(expr.ptr_type);
+}
+
+void Hasher::hash(const ArithmeticCast &expr)
+{
+    hash(expr.dst_type);
+    hash(expr.src_type);
+    hash(*expr.src_val);
+}
+
+void Hasher::hash(const PointerOffset &expr)
+{
+    hash(expr.ptr_type);
+    hash(expr.offset_type);
+    hash(*expr.ptr_val);
+    hash(*expr.offset_val);
+    hash_value(expr.negative);
+}
+
+void Hasher::hash(const ClassPointerToMemberPointer &expr)
+{
+    hash(expr.class_ptr_type);
+    hash(expr.member_ptr_type);
+    hash(*expr.class_ptr);
+    hash_value(expr.member_index);
+}
+
+void Hasher::hash(const DerefClassPointer &expr)
+{
+    hash(expr.class_ptr_type);
+    hash(*expr.class_ptr);
+}
+
+void Hasher::hash(const DerefArrayPointer &expr)
+{
+    hash(expr.array_ptr_type);
+    hash(*expr.array_ptr);
+}
+
+void Hasher::hash(const SaveClassIntoLocalAlloc &expr)
+{
+    hash(expr.class_ptr_type);
+    hash(*expr.class_val);
+}
+
+void Hasher::hash(const SaveArrayIntoLocalAlloc &expr)
+{
+    hash(expr.array_ptr_type);
+    hash(*expr.array_val);
+}
+
+void Hasher::hash(const ArrayAddrToFirstElemAddr &expr)
+{
+    hash(expr.array_ptr_type);
+    hash(*expr.array_ptr);
+}
+
+void Hasher::hash(const Binary &expr)
+{
+    hash_value(expr.op);
+    hash(*expr.lhs);
+    hash(*expr.rhs);
+    hash(expr.lhs_type);
+    hash(expr.rhs_type);
+}
+
+void Hasher::hash(const Unary &expr)
+{
+    hash_value(expr.op);
+    hash(*expr.val);
+    hash(expr.val_type);
+}
+
+void Hasher::hash(const CallFunc &expr)
+{
+    if(expr.contextless_func)
+    {
+        hash_value(uint8_t(0));
+        if(auto it = func_ids_.find(expr.contextless_func.get());
+           it != func_ids_.end())
+            hash_func_index(it->second);
+        else
+            hash_string(expr.contextless_func->name);
+    }
+    else if(expr.intrinsic != Intrinsic::None)
+    {
+        hash_value(uint8_t(1));
+        hash_value(expr.intrinsic);
+    }
+    else
+    {
+        hash_value(uint8_t(2));
+        hash_func_index(expr.contexted_func_index);
+    }
+
+    hash_value(expr.args.size());
+    for(auto &a : expr.args)
+        hash(*a);
+}
+
+void Hasher::hash(const Select &expr)
+{
+    hash(expr.val_type);
+    hash(expr.cond_type);
+    hash(*expr.cond);
+    hash(*expr.true_val);
+    hash(*expr.false_val);
+}
+
+void Hasher::hash(const VectorBroadcast &expr)
+{
+    hash(expr.vector_type);
+    hash(*expr.scalar);
+}
+
+void Hasher::hash(const VectorExtract &expr)
+{
+    hash(expr.vector_type);
+    hash(expr.index_type);
+    hash(*expr.vector);
+    hash(*expr.index);
+}
+
+void Hasher::hash(const VectorInsert &expr)
+{
+    hash(expr.vector_type);
+    hash(expr.index_type);
+    hash(*expr.vector);
+    hash(*expr.index);
+    hash(*expr.element);
+}
+
+void Hasher::hash(const VectorShuffle &expr)
+{
+    hash(expr.vector_type);
+    hash(expr.src_type);
+    hash(*expr.lhs);
+    hash(*expr.rhs);
+    hash_value(expr.indices.size());
+    hash_bytes(expr.indices.data(), expr.indices.size() * sizeof(int32_t));
+}
+
+void Hasher::hash(const VectorReduce &expr)
+{
+    hash_value(expr.op);
+    hash(expr.vector_type);
+    hash(*expr.vector);
+}
+
+void Hasher::hash(const VectorLoad &expr)
+{
+    hash(expr.vector_type);
+    hash(expr.elem_ptr_type);
+    hash(*expr.elem_ptr);
+    hash_value(expr.aligned);
+}
+
+void Hasher::hash(const AtomicOperation &expr)
+{
+    hash_value(expr.op);
+    hash_value(expr.order);
+    hash_value(expr.scope);
+    hash(expr.val_type);
+    hash(*expr.ptr);
+    hash(*expr.val);
+    if(expr.cmp)
+        hash(*expr.cmp);
+}
+
+void Hasher::hash_func_index(size_t index)
+{
+    if(canonical_)
+        hash_value(canonical_func_ids_.at(index));
+    else
+        hash_value(index);
+}
+
+CUJ_NAMESPACE_END(cuj::core)
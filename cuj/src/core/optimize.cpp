@@ -0,0 +1,829 @@
+#include <cstring>
+#include <map>
+#include <optional>
+#include <set>
+
+#include <cuj/core/optimize.h>
+#include <cuj/core/visit.h>
+
+CUJ_NAMESPACE_BEGIN(cuj::core)
+
+namespace
+{
+
+    template<typename F>
+    void for_each_child(Expr &expr, F &&f)
+    {
+        expr.match(
+            [&](Load                        &e) { f(e.src_addr); },
+            [&](ArithmeticCast              &e) { f(e.src_val); },
+            [&](PointerOffset               &e) { f(e.ptr_val); f(e.offset_val); },
+            [&](ClassPointerToMemberPointer &e) { f(e.class_ptr); },
+            [&](DerefClassPointer           &e) { f(e.class_ptr); },
+            [&](DerefArrayPointer           &e) { f(e.array_ptr); },
+            [&](SaveClassIntoLocalAlloc     &e) { f(e.class_val); },
+            [&](SaveArrayIntoLocalAlloc     &e) { f(e.array_val); },
+            [&](ArrayAddrToFirstElemAddr    &e) { f(e.array_ptr); },
+            [&](Binary                      &e) { f(e.lhs); f(e.rhs); },
+            [&](Unary                       &e) { f(e.val); },
+            [&](Select                      &e)
+        {
+            f(e.cond);
+            f(e.true_val);
+            f(e.false_val);
+        },
+            [&](VectorBroadcast             &e) { f(e.scalar); },
+            [&](VectorExtract               &e) { f(e.vector); f(e.index); },
+            [&](VectorInsert                &e)
+        {
+            f(e.vector);
+            f(e.index);
+            f(e.element);
+        },
+            [&](VectorShuffle               &e) { f(e.lhs); f(e.rhs); },
+            [&](VectorReduce                &e) { f(e.vector); },
+            [&](VectorLoad                  &e) { f(e.elem_ptr); },
+            [&](AtomicOperation             &e)
+        {
+            f(e.ptr);
+            f(e.val);
+            if(e.cmp)
+                f(e.cmp);
+        },
+            [&](CallFunc &e)
+        {
+            for(auto &arg : e.args)
+                f(arg);
+        },
+            [](auto &) { });
+    }
+
+    // deep copy of a function body into another arena. expression nodes
+    // shared by multiple parents are duplicated, so passes can replace any
+    // node in place
+    class FuncCloner
+    {
+    public:
+
+        using FuncMap = std::map<const Func *, RC<const Func>>;
+
+        FuncCloner(Arena &arena, const FuncMap &func_map)
+            : arena_(arena), func_map_(func_map)
+        {
+
+        }
+
+        Block *clone(const Block &block)
+        {
+            return arena_.create<Block>(clone_block(block));
+        }
+
+    private:
+
+        Block clone_block(const Block &block)
+        {
+            Block ret;
+            ret.stats.reserve(block.stats.size());
+            for(auto s : block.stats)
+                ret.stats.push_back(clone(s));
+            return ret;
+        }
+
+        Stat *clone(const Stat *stat)
+        {
+            if(!stat)
+                return nullptr;
+            return arena_.create<Stat>(clone_stat(*stat));
+        }
+
+        Stat clone_stat(const Stat &stat)
+        {
+            return stat.match(
+                [&](const Store &s) -> Stat
+            {
+                return Store{ clone_expr(s.dst_addr), clone_expr(s.val) };
+            },
+                [&](const Block &s) -> Stat
+            {
+                return clone_block(s);
+            },
+                [&](const Return &s) -> Stat
+            {
+                return Return{ s.return_type, clone_expr(s.val) };
+            },
+                [&](const If &s) -> Stat
+            {
+                return If{
+                    .calc_cond = clone(*s.calc_cond),
+                    .cond      = clone_expr(s.cond),
+                    .then_body = clone(s.then_body),
+                    .else_body = clone(s.else_body)
+                };
+            },
+                [&](const Loop &s) -> Stat
+            {
+                return Loop{ clone(*s.body) };
+            },
+                [&](const Switch &s) -> Stat
+            {
+                Switch ret = s;
+                ret.value = clone_expr(s.value);
+                for(auto &b : ret.branches)
+                    b.body = clone(*b.body);
+                if(s.default_body)
+                    ret.default_body = clone(*s.default_body);
+                return ret;
+            },
+                [&](const CallFuncStat &s) -> Stat
+            {
+                Expr call = clone_expr(s.call_expr);
+                return CallFuncStat{ call.as<CallFunc>() };
+            },
+                [&](const VectorStore &s) -> Stat
+            {
+                VectorStore ret = s;
+                ret.elem_ptr = clone_expr(s.elem_ptr);
+                ret.val = clone_expr(s.val);
+                return ret;
+            },
+                [&](const auto &s) -> Stat
+            {
+                return s;
+            });
+        }
+
+        Expr clone_expr(const Expr &expr)
+        {
+            Expr ret = expr;
+            for_each_child(ret, [&](Expr *&child)
+            {
+                child = arena_.create<Expr>(clone_expr(*child));
+            });
+            if(auto call = ret.as_if<CallFunc>(); call && call->contextless_func)
+            {
+                if(auto it = func_map_.find(call->contextless_func.get());
+                   it != func_map_.end())
+                    call->contextless_func = it->second;
+            }
+            return ret;
+        }
+
+        Arena         &arena_;
+        const FuncMap &func_map_;
+    };
+
+    // unreachable statements
+
+    bool is_terminator(const Stat &stat)
+    {
+        if(stat.is<Return>() || stat.is<Break>() || stat.is<Continue>())
+            return true;
+        auto block = stat.as_if<Block>();
+        return block && !block->stats.empty() &&
+               is_terminator(*block->stats.back());
+    }
+
+    uint64_t remove_unreachable_stats(Block &block);
+
+    uint64_t remove_unreachable_stats(Stat &stat)
+    {
+        return stat.match(
+            [](Block &s)
+        {
+            return remove_unreachable_stats(s);
+        },
+            [](If &s)
+        {
+            uint64_t ret = remove_unreachable_stats(*s.calc_cond);
+            ret += remove_unreachable_stats(*s.then_body);
+            if(s.else_body)
+                ret += remove_unreachable_stats(*s.else_body);
+            return ret;
+        },
+            [](Loop &s)
+        {
+            return remove_unreachable_stats(*s.body);
+        },
+            [](Switch &s)
+        {
+            uint64_t ret = 0;
+            for(auto &b : s.branches)
+                ret += remove_unreachable_stats(*b.body);
+            if(s.default_body)
+                ret += remove_unreachable_stats(*s.default_body);
+            return ret;
+        },
+            [](auto &)
+        {
+            return uint64_t(0);
+        });
+    }
+
+    uint64_t remove_unreachable_stats(Block &block)
+    {
+        uint64_t ret = 0;
+        for(size_t i = 0; i < block.stats.size(); ++i)
+        {
+            ret += remove_unreachable_stats(*block.stats[i]);
+            if(is_terminator(*block.stats[i]))
+            {
+                ret += block.stats.size() - i - 1;
+                block.stats.resize(i + 1);
+                break;
+            }
+        }
+        return ret;
+    }
+
+    // dead stores
+
+    // atomic operations are treated as calls since they write memory
+    bool has_call(const Expr &expr)
+    {
+        class CallFinder : public Visitor<CallFinder>
+        {
+        public:
+
+            bool found = false;
+
+            void on_call_func(const CallFunc &) { found = true; }
+
+            void on_atomic_operation(const AtomicOperation &) { found = true; }
+        };
+        CallFinder finder;
+        finder.visit(expr);
+        return finder.found;
+    }
+
+    class LocalReadCounter : public Visitor<LocalReadCounter>
+    {
+    public:
+
+        explicit LocalReadCounter(size_t local_count)
+            : reads(local_count, 0)
+        {
+
+        }
+
+        std::vector<int64_t> reads;
+
+        void on_local_alloc_addr(const LocalAllocAddr &e)
+        {
+            ++reads[e.alloc_index];
+        }
+
+        void on_store(const Store &s)
+        {
+            // the address is visited later as a child
+            if(auto addr = s.dst_addr.as_if<LocalAllocAddr>())
+                --reads[addr->alloc_index];
+        }
+    };
+
+    class DeadStoreRemover : public Rewriter<DeadStoreRemover>
+    {
+    public:
+
+        explicit DeadStoreRemover(const std::vector<int64_t> &reads)
+            : reads_(reads)
+        {
+
+        }
+
+        uint64_t removed = 0;
+
+        void rewrite_stat(Stat &stat)
+        {
+            auto store = stat.as_if<Store>();
+            if(!store)
+                return;
+            auto addr = store->dst_addr.as_if<LocalAllocAddr>();
+            if(!addr || reads_[addr->alloc_index] > 0 || has_call(store->val))
+                return;
+            stat = Block{};
+            ++removed;
+        }
+
+    private:
+
+        const std::vector<int64_t> &reads_;
+    };
+
+    uint64_t remove_dead_stores(Func &func)
+    {
+        uint64_t ret = 0;
+        while(true)
+        {
+            LocalReadCounter counter(func.local_alloc_types.size());
+            counter.visit(*func.root_block);
+            DeadStoreRemover remover(counter.reads);
+            remover.rewrite(func);
+            if(!remover.removed)
+                return ret;
+            ret += remover.removed;
+        }
+    }
+
+    // value numbering
+
+    // locals are mapped to i and arguments to -1-i
+    using SlotID = int64_t;
+
+    std::optional<SlotID> get_slot(const Expr &addr)
+    {
+        if(auto local = addr.as_if<LocalAllocAddr>())
+            return static_cast<SlotID>(local->alloc_index);
+        if(auto arg = addr.as_if<FuncArgAddr>())
+            return -1 - static_cast<SlotID>(arg->arg_index);
+        return std::nullopt;
+    }
+
+    class AddressTakenSlotCollector :
+        public Visitor<AddressTakenSlotCollector>
+    {
+    public:
+
+        using Visitor::visit;
+
+        explicit AddressTakenSlotCollector(const Func &func)
+        {
+            slots.locals.resize(func.local_alloc_types.size(), false);
+            slots.args.resize(func.argument_types.size(), false);
+        }
+
+        AddressTakenSlots slots;
+
+        void visit(const Store &s)
+        {
+            if(!get_slot(s.dst_addr))
+                visit(s.dst_addr);
+            visit(s.val);
+        }
+
+        void visit(const Load &e)
+        {
+            if(!get_slot(*e.src_addr))
+                visit(*e.src_addr);
+        }
+
+        void on_local_alloc_addr(const LocalAllocAddr &e)
+        {
+            slots.locals[e.alloc_index] = true;
+        }
+
+        void on_func_arg_addr(const FuncArgAddr &e)
+        {
+            slots.args[e.arg_index] = true;
+        }
+    };
+
+    class SlotWriteCollector : public Visitor<SlotWriteCollector>
+    {
+    public:
+
+        std::set<SlotID> writes;
+
+        void on_store(const Store &s)
+        {
+            if(auto slot = get_slot(s.dst_addr))
+                writes.insert(*slot);
+        }
+    };
+
+    template<typename Node>
+    std::set<SlotID> get_slot_writes(const Node &node)
+    {
+        SlotWriteCollector collector;
+        collector.visit(node);
+        return std::move(collector.writes);
+    }
+
+    template<typename T>
+    void append_key(std::string &key, const T &value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        key.append(bytes, sizeof(T));
+    }
+
+    const Type *get_result_type(const Expr &expr)
+    {
+        return expr.match(
+            [](const ArithmeticCast &e) -> const Type *
+        {
+            return e.dst_type;
+        },
+            [](const PointerOffset &e) -> const Type *
+        {
+            return e.ptr_type;
+        },
+            [](const ClassPointerToMemberPointer &e) -> const Type *
+        {
+            return e.member_ptr_type;
+        },
+            [](const Binary &e) -> const Type *
+        {
+            switch(e.op)
+            {
+            case Binary::Op::Equal:
+            case Binary::Op::NotEqual:
+            case Binary::Op::Less:
+            case Binary::Op::LessEqual:
+            case Binary::Op::Greater:
+            case Binary::Op::GreaterEqual:
+                return nullptr;
+            default:
+                return e.lhs_type;
+            }
+        },
+            [](const Unary &e) -> const Type *
+        {
+            return e.val_type;
+        },
+            [](const auto &) -> const Type *
+        {
+            return nullptr;
+        });
+    }
+
+    class ValueNumbering
+    {
+    public:
+
+        explicit ValueNumbering(Func &func)
+            : func_(func), address_taken_(find_address_taken_slots(func))
+        {
+
+        }
+
+        uint64_t run()
+        {
+            process(*func_.root_block, {});
+            for(auto &[block, inserts] : inserts_)
+            {
+                std::vector<Stat *> stats;
+                for(auto s : block->stats)
+                {
+                    if(auto it = inserts.find(s); it != inserts.end())
+                    {
+                        stats.insert(
+                            stats.end(), it->second.begin(), it->second.end());
+                    }
+                    stats.push_back(s);
+                }
+                block->stats = std::move(stats);
+            }
+            return merged_;
+        }
+
+    private:
+
+        static constexpr size_t NO_TEMP = static_cast<size_t>(-1);
+
+        struct Candidate
+        {
+            Expr                *expr;
+            const Type          *type;
+            Block               *block;
+            Stat                *stat;
+            std::vector<SlotID>  slots;
+            Candidate           *parent;
+            size_t               temp = NO_TEMP;
+
+            // the expression was moved into the computation of an ancestor
+            bool is_inside_temp() const
+            {
+                for(auto p = parent; p; p = p->parent)
+                {
+                    if(p->temp != NO_TEMP)
+                        return true;
+                }
+                return false;
+            }
+        };
+
+        using Table = std::map<std::string, Candidate *>;
+
+        // returns false when the value may change without a visible store
+        bool describe(
+            const Expr &expr, std::string &key, std::vector<SlotID> &slots) const
+        {
+            key.push_back(static_cast<char>(expr.index()));
+            return expr.match(
+                [&](const FuncArgAddr &e)
+            {
+                append_key(key, e.arg_index);
+                return true;
+            },
+                [&](const LocalAllocAddr &e)
+            {
+                append_key(key, e.alloc_index);
+                return true;
+            },
+                [&](const Load &e)
+            {
+                const auto slot = get_slot(*e.src_addr);
+                if(!slot || is_address_taken(*slot))
+                    return false;
+                slots.push_back(*slot);
+                append_key(key, e.val_type);
+                return describe(*e.src_addr, key, slots);
+            },
+                [&](const Immediate &e)
+            {
+                key.push_back(static_cast<char>(e.value.index()));
+                e.value.match([&](auto v) { append_key(key, v); });
+                return true;
+            },
+                [&](const NullPtr &e)
+            {
+                append_key(key, e.ptr_type);
+                return true;
+            },
+                [&](const ArithmeticCast &e)
+            {
+                append_key(key, e.dst_type);
+                append_key(key, e.src_type);
+                return describe(*e.src_val, key, slots);
+            },
+                [&](const PointerOffset &e)
+            {
+                append_key(key, e.ptr_type);
+                append_key(key, e.offset_type);
+                append_key(key, e.negative);
+                return describe(*e.ptr_val, key, slots) &&
+                       describe(*e.offset_val, key, slots);
+            },
+                [&](const ClassPointerToMemberPointer &e)
+            {
+                append_key(key, e.member_ptr_type);
+                append_key(key, e.member_index);
+                return describe(*e.class_ptr, key, slots);
+            },
+                [&](const Binary &e)
+            {
+                append_key(key, e.op);
+                append_key(key, e.lhs_type);
+                append_key(key, e.rhs_type);
+                return describe(*e.lhs, key, slots) &&
+                       describe(*e.rhs, key, slots);
+            },
+                [&](const Unary &e)
+            {
+                append_key(key, e.op);
+                append_key(key, e.val_type);
+                return describe(*e.val, key, slots);
+            },
+                [](const auto &)
+            {
+                return false;
+            });
+        }
+
+        bool is_address_taken(SlotID slot) const
+        {
+            // locals created by this pass are not in address_taken_
+            if(slot >= 0)
+            {
+                return static_cast<size_t>(slot) < address_taken_.locals.size()
+                    && address_taken_.locals[slot];
+            }
+            return address_taken_.args[-1 - slot];
+        }
+
+        static void kill(Table &table, const std::set<SlotID> &writes)
+        {
+            if(writes.empty())
+                return;
+            std::erase_if(table, [&](const auto &item)
+            {
+                for(auto slot : item.second->slots)
+                {
+                    if(writes.contains(slot))
+                        return true;
+                }
+                return false;
+            });
+        }
+
+        void merge(Candidate &candidate, Expr &expr)
+        {
+            if(candidate.temp == NO_TEMP)
+            {
+                candidate.temp = func_.local_alloc_types.size();
+                func_.local_alloc_types.push_back(candidate.type);
+
+                auto store = func_.arena->create<Stat>(Store{
+                    .dst_addr = LocalAllocAddr{ candidate.type, candidate.temp },
+                    .val      = *candidate.expr
+                });
+                inserts_[candidate.block][candidate.stat].push_back(store);
+                *candidate.expr = load_temp(candidate);
+            }
+            expr = load_temp(candidate);
+            ++merged_;
+        }
+
+        Expr load_temp(const Candidate &candidate)
+        {
+            return Load{
+                .val_type = candidate.type,
+                .src_addr = func_.arena->create<Expr>(
+                    LocalAllocAddr{ candidate.type, candidate.temp })
+            };
+        }
+
+        // new values are only recorded when they can be computed right
+        // before stat in block
+        void process(
+            Expr      &expr,
+            Block     *block,
+            Stat      *stat,
+            Table     &table,
+            Candidate *parent)
+        {
+            if(auto type = get_result_type(expr))
+            {
+                std::string key;
+                std::vector<SlotID> slots;
+                if(describe(expr, key, slots))
+                {
+                    if(auto it = table.find(key);
+                       it != table.end() && !it->second->is_inside_temp())
+                    {
+                        merge(*it->second, expr);
+                        return;
+                    }
+                    if(block)
+                    {
+                        candidates_.push_back(newBox<Candidate>(Candidate{
+                            .expr   = &expr,
+                            .type   = type,
+                            .block  = block,
+                            .stat   = stat,
+                            .slots  = std::move(slots),
+                            .parent = parent
+                        }));
+                        parent = candidates_.back().get();
+                        table[std::move(key)] = parent;
+                    }
+                }
+            }
+            for_each_child(expr, [&](Expr *child)
+            {
+                process(*child, block, stat, table, parent);
+            });
+        }
+
+        void process(Block &block, Table table)
+        {
+            for(auto s : block.stats)
+                process(*s, &block, table);
+        }
+
+        void process(Stat &stat, Block *block, Table &table)
+        {
+            stat.match(
+                [&](Store &s)
+            {
+                process(s.dst_addr, block, &stat, table, nullptr);
+                process(s.val, block, &stat, table, nullptr);
+                if(auto slot = get_slot(s.dst_addr))
+                    kill(table, { *slot });
+            },
+                [&](Block &s)
+            {
+                process(s, table);
+                kill(table, get_slot_writes(s));
+            },
+                [&](Return &s)
+            {
+                process(s.val, block, &stat, table, nullptr);
+            },
+                [&](If &s)
+            {
+                process(*s.calc_cond, table);
+                kill(table, get_slot_writes(*s.calc_cond));
+                const bool record = s.calc_cond->stats.empty();
+                process(s.cond, record ? block : nullptr, &stat, table, nullptr);
+                process_body(*s.then_body, table);
+                if(s.else_body)
+                    process_body(*s.else_body, table);
+                kill(table, get_slot_writes(stat));
+            },
+                [&](Loop &s)
+            {
+                kill(table, get_slot_writes(*s.body));
+                process(*s.body, table);
+            },
+                [&](Switch &s)
+            {
+                process(s.value, block, &stat, table, nullptr);
+                for(auto &b : s.branches)
+                    process(*b.body, table);
+                if(s.default_body)
+                    process(*s.default_body, table);
+                kill(table, get_slot_writes(stat));
+            },
+                [&](CallFuncStat &s)
+            {
+                for(auto arg : s.call_expr.args)
+                    process(*arg, block, &stat, table, nullptr);
+            },
+                [&](VectorStore &s)
+            {
+                process(s.elem_ptr, block, &stat, table, nullptr);
+                process(s.val, block, &stat, table, nullptr);
+            },
+                [](auto &) { });
+        }
+
+        void process_body(Stat &body, const Table &table)
+        {
+            if(auto block = body.as_if<Block>())
+                process(*block, table);
+            else
+            {
+                Table body_table = table;
+                process(body, nullptr, body_table);
+            }
+        }
+
+        Func             &func_;
+        AddressTakenSlots address_taken_;
+        uint64_t          merged_ = 0;
+
+        std::vector<Box<Candidate>> candidates_;
+
+        // block -> statement -> new statements to be inserted before it
+        std::map<Block *, std::map<Stat *, std::vector<Stat *>>> inserts_;
+    };
+
+    void optimize(Func &func, OptimizationStatistics &statistics)
+    {
+        statistics.removed_stats += remove_unreachable_stats(*func.root_block);
+        statistics.merged_exprs += ValueNumbering(func).run();
+        statistics.removed_stores += remove_dead_stores(func);
+    }
+
+} // namespace anonymous
+
+AddressTakenSlots find_address_taken_slots(const Func &func)
+{
+    AddressTakenSlotCollector collector(func);
+    collector.visit(*func.root_block);
+    return std::move(collector.slots);
+}
+
+Prog optimize(
+    const Prog                &prog,
+    const std::vector<size_t> &func_indices,
+    OptimizationStatistics    *statistics)
+{
+    Prog ret = prog;
+
+    FuncCloner::FuncMap func_map;
+    std::vector<std::pair<const Func *, RC<Func>>> funcs;
+    for(auto i : func_indices)
+    {
+        auto &src = *prog.funcs[i];
+        auto dst = newRC<Func>();
+        dst->name              = src.name;
+        dst->type              = src.type;
+        dst->type_set          = src.type_set;
+        dst->argument_types    = src.argument_types;
+        dst->return_type       = src.return_type;
+        dst->local_alloc_types = src.local_alloc_types;
+
+        func_map.insert({ &src, dst });
+        funcs.push_back({ &src, dst });
+        ret.funcs[i] = dst;
+    }
+
+    OptimizationStatistics local_statistics;
+    for(auto &[src, dst] : funcs)
+    {
+        FuncCloner cloner(*dst->arena, func_map);
+        dst->root_block = cloner.clone(*src->root_block);
+        optimize(*dst, local_statistics);
+    }
+
+    if(statistics)
+    {
+        statistics->merged_exprs   += local_statistics.merged_exprs;
+        statistics->removed_stores += local_statistics.removed_stores;
+        statistics->removed_stats  += local_statistics.removed_stats;
+    }
+    return ret;
+}
+
+Prog optimize(const Prog &prog, OptimizationStatistics *statistics)
+{
+    std::vector<size_t> func_indices(prog.funcs.size());
+    for(size_t i = 0; i < func_indices.size(); ++i)
+        func_indices[i] = i;
+    return optimize(prog, func_indices, statistics);
+}
+
+CUJ_NAMESPACE_END(cuj::core)
@@ -0,0 +1,1299 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+
+#include <cuj/core/serialize.h>
+
+CUJ_NAMESPACE_BEGIN(cuj::core)
+
+namespace
+{
+
+    // layout:
+    //   magic, version (u32)
+    //   type count, type records
+    //   func count, func records
+    //
+    // integers are written as leb128 varints. immediate values are written
+    // as little-endian fixed-size bytes.
+    //
+    // a func record ends with a stream of expr/stat/block records in post
+    // order. each record refers to earlier ones by their index in its own
+    // kind, so reading them never needs to look ahead
+
+    constexpr std::array<uint8_t, 4> MAGIC = { 'C', 'U', 'J', 'P' };
+
+    enum class TypeTag : uint8_t
+    {
+        Builtin,
+        Struct,
+        Array,
+        Pointer,
+        Vector,
+    };
+
+    // expr records are tagged by their variant index
+    constexpr uint8_t STAT_TAG_BASE = 0x40;
+    constexpr uint8_t BLOCK_TAG     = 0x80;
+    constexpr uint8_t END_TAG       = 0xff;
+
+    constexpr uint64_t INTRINSIC_COUNT = 0
+#define CUJ_INTRINSIC_TYPE(TYPE) + 1
+#include <cuj/core/intrinsic_types.txt>
+#undef CUJ_INTRINSIC_TYPE
+        ;
+
+    static_assert(std::variant_size_v<Expr::std_variant_t> < STAT_TAG_BASE);
+    static_assert(
+        STAT_TAG_BASE + std::variant_size_v<Stat::std_variant_t> < BLOCK_TAG);
+
+    template<typename V, typename T, size_t I = 0>
+    constexpr uint8_t tag_of()
+    {
+        using Alternative =
+            std::variant_alternative_t<I, typename V::std_variant_t>;
+        if constexpr(std::is_same_v<Alternative, T>)
+            return static_cast<uint8_t>(I);
+        else
+            return tag_of<V, T, I + 1>();
+    }
+
+    [[noreturn]] void throw_invalid(const char *reason)
+    {
+        throw CujException(
+            std::string("invalid serialized program: ") + reason);
+    }
+
+    class ProgWriter
+    {
+    public:
+
+        explicit ProgWriter(const Prog &prog);
+
+        std::vector<uint8_t> write();
+
+    private:
+
+        void write_u8(uint8_t value);
+
+        void write_uint(uint64_t value);
+
+        void write_string(const std::string &str);
+
+        template<typename T>
+        void write_fixed(T value);
+
+        void add_types(const TypeSet &set);
+
+        void write_type_id(const Type *type);
+
+        void write_type(const Type &type);
+
+        void write_func(const Func &func);
+
+        size_t write_expr(const Expr &expr);
+
+        size_t write_stat(const Stat &stat);
+
+        size_t write_block(const Block &block);
+
+        void write_immediate(const Immediate &imm);
+
+        // call payload shared by CallFunc and CallFuncStat
+        void write_call_args(const CallFunc &call);
+
+        const Prog &prog_;
+
+        std::vector<uint8_t> data_;
+
+        std::vector<const Type *>      types_;
+        std::map<TypeKey, size_t>      type_keys_;
+        std::map<const Type *, size_t> type_ids_;
+        std::map<const Func *, size_t> func_ids_;
+
+        // per function
+        std::map<const Expr *, size_t> expr_ids_;
+        size_t                         stat_count_  = 0;
+        size_t                         block_count_ = 0;
+    };
+
+    class ProgReader
+    {
+    public:
+
+        ProgReader(const void *data, size_t bytes);
+
+        Prog read();
+
+    private:
+
+        uint8_t read_u8();
+
+        uint64_t read_uint();
+
+        size_t read_index(size_t count);
+
+        std::string read_string();
+
+        template<typename T>
+        T read_fixed();
+
+        const Type *read_type_id();
+
+        void read_type(Type &type);
+
+        void check_type_cycles() const;
+
+        void read_func(Func &func);
+
+        void read_expr(Func &func, uint8_t tag);
+
+        void read_stat(Func &func, uint8_t tag);
+
+        Immediate read_immediate();
+
+        CallFunc read_call();
+
+        Expr *read_expr_ref();
+
+        Stat *read_stat_ref();
+
+        Block *read_block_ref();
+
+        const uint8_t *cur_;
+        const uint8_t *end_;
+
+        std::vector<const Type *>    types_;
+        std::vector<RC<const Func>> funcs_;
+
+        // per function
+        std::vector<Expr *>  exprs_;
+        std::vector<Stat *>  stats_;
+        std::vector<Block *> blocks_;
+    };
+
+    ProgWriter::ProgWriter(const Prog &prog)
+        : prog_(prog)
+    {
+
+    }
+
+    std::vector<uint8_t> ProgWriter::write()
+    {
+        data_.insert(data_.end(), MAGIC.begin(), MAGIC.end());
+        write_fixed(SERIALIZED_PROG_VERSION);
+
+        if(prog_.global_type_set)
+            add_types(*prog_.global_type_set);
+        for(auto &f : prog_.funcs)
+        {
+            if(f->type_set)
+                add_types(*f->type_set);
+        }
+
+        write_uint(types_.size());
+        for(auto type : types_)
+            write_type(*type);
+
+        for(size_t i = 0; i < prog_.funcs.size(); ++i)
+            func_ids_.insert({ prog_.funcs[i].get(), i });
+
+        write_uint(prog_.funcs.size());
+        for(auto &f : prog_.funcs)
+            write_func(*f);
+
+        return std::move(data_);
+    }
+
+    void ProgWriter::write_u8(uint8_t value)
+    {
+        data_.push_back(value);
+    }
+
+    void ProgWriter::write_uint(uint64_t value)
+    {
+        while(value >= 0x80)
+        {
+            data_.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        data_.push_back(static_cast<uint8_t>(value));
+    }
+
+    void ProgWriter::write_string(const std::string &str)
+    {
+        write_uint(str.size());
+        data_.insert(data_.end(), str.begin(), str.end());
+    }
+
+    template<typename T>
+    void ProgWriter::write_fixed(T value)
+    {
+        std::array<uint8_t, sizeof(T)> bytes;
+        std::memcpy(bytes.data(), &value, sizeof(T));
+        if constexpr(std::endian::native == std::endian::big)
+            std::reverse(bytes.begin(), bytes.end());
+        data_.insert(data_.end(), bytes.begin(), bytes.end());
+    }
+
+    void ProgWriter::add_types(const TypeSet &set)
+    {
+        // type sets of different functions contain distinct copies of the
+        // same dsl types. they share one table entry
+        for(auto &[key, type] : set.index_to_type)
+        {
+            auto it = type_keys_.try_emplace(key, types_.size()).first;
+            if(it->second == types_.size())
+                types_.push_back(type.get());
+            type_ids_.insert({ type.get(), it->second });
+        }
+    }
+
+    void ProgWriter::write_type_id(const Type *type)
+    {
+        auto it = type_ids_.find(type);
+        if(it == type_ids_.end())
+            throw CujException("serialize: type is not in any type set");
+        write_uint(it->second);
+    }
+
+    void ProgWriter::write_type(const Type &type)
+    {
+        type.match(
+            [&](Builtin t)
+        {
+            write_u8(static_cast<uint8_t>(TypeTag::Builtin));
+            write_u8(static_cast<uint8_t>(t));
+        },
+            [&](const Struct &t)
+        {
+            write_u8(static_cast<uint8_t>(TypeTag::Struct));
+            write_uint(t.members.size());
+            for(auto m : t.members)
+                write_type_id(m);
+        },
+            [&](const Array &t)
+        {
+            write_u8(static_cast<uint8_t>(TypeTag::Array));
+            write_type_id(t.element);
+            write_uint(t.size);
+        },
+            [&](const Pointer &t)
+        {
+            write_u8(static_cast<uint8_t>(TypeTag::Pointer));
+            write_type_id(t.pointed);
+        },
+            [&](const Vector &t)
+        {
+            write_u8(static_cast<uint8_t>(TypeTag::Vector));
+            write_type_id(t.element);
+            write_uint(t.size);
+        });
+    }
+
+    void ProgWriter::write_func(const Func &func)
+    {
+        write_string(func.name);
+        write_u8(static_cast<uint8_t>(func.type));
+
+        write_uint(func.argument_types.size());
+        for(auto &arg : func.argument_types)
+        {
+            write_type_id(arg.type);
+            write_u8(arg.is_reference);
+        }
+        write_type_id(func.return_type.type);
+        write_u8(func.return_type.is_reference);
+
+        write_uint(func.local_alloc_types.size());
+        for(auto type : func.local_alloc_types)
+            write_type_id(type);
+
+        expr_ids_.clear();
+        stat_count_ = 0;
+        block_count_ = 0;
+
+        const size_t root = write_block(*func.root_block);
+        write_u8(END_TAG);
+        write_uint(root);
+    }
+
+    size_t ProgWriter::write_expr(const Expr &expr)
+    {
+        if(auto it = expr_ids_.find(&expr); it != expr_ids_.end())
+            return it->second;
+
+        // children first, so that the record below only refers backwards
+        std::vector<size_t> children;
+        auto child = [&](const Expr *e) { children.push_back(write_expr(*e)); };
+        expr.match(
+            [&](const Load &e) { child(e.src_addr); },
+            [&](const ArithmeticCast &e) { child(e.src_val); },
+            [&](const PointerOffset &e)
+        {
+            child(e.ptr_val);
+            child(e.offset_val);
+        },
+            [&](const ClassPointerToMemberPointer &e) { child(e.class_ptr); },
+            [&](const DerefClassPointer &e) { child(e.class_ptr); },
+            [&](const DerefArrayPointer &e) { child(e.array_ptr); },
+            [&](const SaveClassIntoLocalAlloc &e) { child(e.class_val); },
+            [&](const SaveArrayIntoLocalAlloc &e) { child(e.array_val); },
+            [&](const ArrayAddrToFirstElemAddr &e) { child(e.array_ptr); },
+            [&](const Binary &e)
+        {
+            child(e.lhs);
+            child(e.rhs);
+        },
+            [&](const Unary &e) { child(e.val); },
+            [&](const CallFunc &e)
+        {
+            for(auto a : e.args)
+                child(a);
+        },
+            [&](const Select &e)
+        {
+            child(e.cond);
+            child(e.true_val);
+            child(e.false_val);
+        },
+            [&](const VectorBroadcast &e) { child(e.scalar); },
+            [&](const VectorExtract &e)
+        {
+            child(e.vector);
+            child(e.index);
+        },
+            [&](const VectorInsert &e)
+        {
+            child(e.vector);
+            child(e.index);
+            child(e.element);
+        },
+            [&](const VectorShuffle &e)
+        {
+            child(e.lhs);
+            child(e.rhs);
+        },
+            [&](const VectorReduce &e) { child(e.vector); },
+            [&](const VectorLoad &e) { child(e.elem_ptr); },
+            [&](const AtomicOperation &e)
+        {
+            child(e.ptr);
+            child(e.val);
+            if(e.cmp)
+                child(e.cmp);
+        },
+            [&](const auto &) { });
+
+        write_u8(static_cast<uint8_t>(expr.index()));
+        expr.match(
+            [&](const FuncArgAddr &e)
+        {
+            write_type_id(e.addr_type);
+            write_uint(e.arg_index);
+        },
+            [&](const LocalAllocAddr &e)
+        {
+            write_type_id(e.alloc_type);
+            write_uint(e.alloc_index);
+        },
+            [&](const Load &e)
+        {
+            write_type_id(e.val_type);
+            write_uint(children[0]);
+        },
+            [&](const Immediate &e)
+        {
+            write_immediate(e);
+        },
+            [&](const NullPtr &e)
+        {
+            write_type_id(e.ptr_type);
+        },
+            [&](const ArithmeticCast &e)
+        {
+            write_type_id(e.dst_type);
+            write_type_id(e.src_type);
+            write_uint(children[0]);
+        },
+            [&](const PointerOffset &e)
+        {
+            write_type_id(e.ptr_type);
+            write_type_id(e.offset_type);
+            write_uint(children[0]);
+            write_uint(children[1]);
+            write_u8(e.negative);
+        },
+            [&](const ClassPointerToMemberPointer &e)
+        {
+            write_type_id(e.class_ptr_type);
+            write_type_id(e.member_ptr_type);
+            write_uint(children[0]);
+            write_uint(e.member_index);
+        },
+            [&](const DerefClassPointer &e)
+        {
+            write_type_id(e.class_ptr_type);
+            write_uint(children[0]);
+        },
+            [&](const DerefArrayPointer &e)
+        {
+            write_type_id(e.array_ptr_type);
+            write_uint(children[0]);
+        },
+            [&](const SaveClassIntoLocalAlloc &e)
+        {
+            write_type_id(e.class_ptr_type);
+            write_uint(children[0]);
+        },
+            [&](const SaveArrayIntoLocalAlloc &e)
+        {
+            write_type_id(e.array_ptr_type);
+            write_uint(children[0]);
+        },
+            [&](const ArrayAddrToFirstElemAddr &e)
+        {
+            write_type_id(e.array_ptr_type);
+            write_uint(children[0]);
+        },
+            [&](const Binary &e)
+        {
+            write_u8(static_cast<uint8_t>(e.op));
+            write_uint(children[0]);
+            write_uint(children[1]);
+            write_type_id(e.lhs_type);
+            write_type_id(e.rhs_type);
+        },
+            [&](const Unary &e)
+        {
+            write_u8(static_cast<uint8_t>(e.op));
+            write_uint(children[0]);
+            write_type_id(e.val_type);
+        },
+            [&](const CallFunc &e)
+        {
+            write_call_args(e);
+            for(auto c : children)
+                write_uint(c);
+        },
+            [&](const Select &e)
+        {
+            write_type_id(e.val_type);
+            write_type_id(e.cond_type);
+            write_uint(children[0]);
+            write_uint(children[1]);
+            write_uint(children[2]);
+        },
+            [&](const VectorBroadcast &e)
+        {
+            write_type_id(e.vector_type);
+            write_uint(children[0]);
+        },
+            [&](const VectorExtract &e)
+        {
+            write_type_id(e.vector_type);
+            write_type_id(e.index_type);
+            write_uint(children[0]);
+            write_uint(children[1]);
+        },
+            [&](const VectorInsert &e)
+        {
+            write_type_id(e.vector_type);
+            write_type_id(e.index_type);
+            write_uint(children[0]);
+            write_uint(children[1]);
+            write_uint(children[2]);
+        },
+            [&](const VectorShuffle &e)
+        {
+            write_type_id(e.vector_type);
+            write_type_id(e.src_type);
+            write_uint(children[0]);
+            write_uint(children[1]);
+            write_uint(e.indices.size());
+            for(auto i : e.indices)
+                write_fixed(i);
+        },
+            [&](const VectorReduce &e)
+        {
+            write_u8(static_cast<uint8_t>(e.op));
+            write_type_id(e.vector_type);
+            write_uint(children[0]);
+        },
+            [&](const VectorLoad &e)
+        {
+            write_type_id(e.vector_type);
+            write_type_id(e.elem_ptr_type);
+            write_uint(children[0]);
+            write_u8(e.aligned);
+        },
+            [&](const AtomicOperation &e)
+        {
+            write_u8(static_cast<uint8_t>(e.op));
+            write_u8(static_cast<uint8_t>(e.order));
+            write_u8(static_cast<uint8_t>(e.scope));
+            write_type_id(e.val_type);
+            for(auto c : children)
+                write_uint(c);
+        });
+
+        const size_t id = expr_ids_.size();
+        expr_ids_.insert({ &expr, id });
+        return id;
+    }
+
+    size_t ProgWriter::write_stat(const Stat &stat)
+    {
+        stat.match(
+            [&](const Store &s)
+        {
+            const size_t dst = write_expr(s.dst_addr);
+            const size_t val = write_expr(s.val);
+            write_u8(STAT_TAG_BASE + static_cast<uint8_t>(stat.index()));
+            write_uint(dst);
+            write_uint(val);
+        },
+            [&](const Block &s)
+        {
+            const size_t block = write_block(s);
+            write_u8(STAT_TAG_BASE + static_cast<uint8_t>(stat.index()));
+            write_uint(block);
+        },
+            [&](const Return &s)
+        {
+            auto builtin = s.return_type->as_if<Builtin>();
+            const bool has_val = !builtin || *builtin != Builtin::Void;
+            const size_t val = has_val ? write_expr(s.val) : 0;
+            write_u8(STAT_TAG_BASE + static_cast<uint8_t>(stat.index()));
+            write_type_id(s.return_type);
+            write_u8(has_val);
+            if(has_val)
+                write_uint(val);
+        },
+            [&](const If &s)
+        {
+            const size_t calc_cond = write_block(*s.calc_cond);
+            const size_t cond = write_expr(s.cond);
+            const size_t then_body = write_stat(*s.then_body);
+            const size_t else_body = s.else_body ? write_stat(*s.else_body) + 1 : 0;
+            write_u8(STAT_TAG_BASE + static_cast<uint8_t>(stat.index()));
+            write_uint(calc_cond);
+            write_uint(cond);
+            write_uint(then_body);
+            write_uint(else_body);
+        },
+            [&](const Loop &s)
+        {
+            const size_t body = write_block(*s.body);
+            write_u8(STAT_TAG_BASE + static_cast<uint8_t>(stat.index()));
+            write_uint(body);
+        },
+            [&](const Switch &s)
+        {
+            const size_t value = write_expr(s.value);
+            std::vector<size_t> bodies;
+            for(auto &b : s.branches)
+                bodies.push_back(write_block(*b.body));
+            const size_t default_body =
+                s.default_body ? write_block(*s.default_body) + 1 : 0;
+            write_u8(STAT_TAG_BASE + static_cast<uint8_t>(stat.index()));
+            write_uint(value);
+            write_uint(s.branches.size());
+            for(size_t i = 0; i < s.branches.size(); ++i)
+            {
+                write_immediate(s.branches[i].cond);
+                write_uint(bodies[i]);
+                write_u8(s.branches[i].fallthrough);
+            }
+            write_uint(default_body);
+        },
+            [&](const CallFuncStat &s)
+        {
+            std::vector<size_t> args;
+            for(auto a : s.call_expr.args)
+                args.push_back(write_expr(*a));
+            write_u8(STAT_TAG_BASE + static_cast<uint8_t>(stat.index()));
+            write_call_args(s.call_expr);
+            for(auto a : args)
+                write_uint(a);
+        },
+            [&](const VectorStore &s)
+        {
+            const size_t elem_ptr = write_expr(s.elem_ptr);
+            const size_t val = write_expr(s.val);
+            write_u8(STAT_TAG_BASE + static_cast<uint8_t>(stat.index()));
+            write_type_id(s.vector_type);
+            write_type_id(s.elem_ptr_type);
+            write_uint(elem_ptr);
+            write_uint(val);
+            write_u8(s.aligned);
+        },
+            [&](const auto &)
+        {
+            // break & continue
+            write_u8(STAT_TAG_BASE + static_cast<uint8_t>(stat.index()));
+        });
+        return stat_count_++;
+    }
+
+    size_t ProgWriter::write_block(const Block &block)
+    {
+        std::vector<size_t> stats;
+        stats.reserve(block.stats.size());
+        for(auto s : block.stats)
+            stats.push_back(write_stat(*s));
+        write_u8(BLOCK_TAG);
+        write_uint(stats.size());
+        for(auto s : stats)
+            write_uint(s);
+        return block_count_++;
+    }
+
+    void ProgWriter::write_immediate(const Immediate &imm)
+    {
+        write_u8(static_cast<uint8_t>(imm.value.index()));
+        imm.value.match([&](auto v) { write_fixed(v); });
+    }
+
+    void ProgWriter::write_call_args(const CallFunc &call)
+    {
+        if(call.contextless_func)
+        {
+            auto it = func_ids_.find(call.contextless_func.get());
+            if(it == func_ids_.end())
+            {
+                throw CujException(
+                    "serialize: callee " + call.contextless_func->name +
+                    " is not in the program");
+            }
+            write_uint(it->second + 1);
+        }
+        else
+            write_uint(0);
+        write_uint(call.contexted_func_index);
+        write_uint(static_cast<uint32_t>(call.intrinsic));
+        write_uint(call.args.size());
+    }
+
+    ProgReader::ProgReader(const void *data, size_t bytes)
+        : cur_(static_cast<const uint8_t *>(data)),
+          end_(static_cast<const uint8_t *>(data) + bytes)
+    {
+
+    }
+
+    Prog ProgReader::read()
+    {
+        if(end_ - cur_ < static_cast<ptrdiff_t>(MAGIC.size()) ||
+           !std::equal(MAGIC.begin(), MAGIC.end(), cur_))
+            throw_invalid("bad magic number");
+        cur_ += MAGIC.size();
+
+        if(const auto version = read_fixed<uint32_t>();
+           version != SERIALIZED_PROG_VERSION)
+        {
+            throw CujException(
+                "unsupported serialized program version: " +
+                std::to_string(version));
+        }
+
+        auto type_set = newRC<TypeSet>();
+        const size_t type_count = read_index(
+            static_cast<size_t>(end_ - cur_) + 1);
+        types_.reserve(type_count);
+        for(size_t i = 0; i < type_count; ++i)
+        {
+            auto type = newRC<Type>();
+            type_set->index_to_type.insert({ TypeKey(i), type });
+            type_set->type_to_index.insert({ type.get(), TypeKey(i) });
+            types_.push_back(type.get());
+        }
+        for(size_t i = 0; i < type_count; ++i)
+        {
+            read_type(*type_set->index_to_type.at(TypeKey(i)));
+        }
+        check_type_cycles();
+
+        const size_t func_count = read_index(
+            static_cast<size_t>(end_ - cur_) + 1);
+        std::vector<RC<Func>> funcs;
+        funcs.reserve(func_count);
+        for(size_t i = 0; i < func_count; ++i)
+            funcs.push_back(newRC<Func>());
+        funcs_.assign(funcs.begin(), funcs.end());
+        for(auto &f : funcs)
+            read_func(*f);
+
+        if(cur_ != end_)
+            throw_invalid("trailing bytes");
+
+        Prog prog;
+        prog.global_type_set = std::move(type_set);
+        prog.funcs = std::move(funcs_);
+        return prog;
+    }
+
+    uint8_t ProgReader::read_u8()
+    {
+        if(cur_ == end_)
+            throw_invalid("unexpected end of data");
+        return *cur_++;
+    }
+
+    uint64_t ProgReader::read_uint()
+    {
+        uint64_t ret = 0;
+        for(int shift = 0; shift < 64; shift += 7)
+        {
+            const uint8_t byte = read_u8();
+            ret |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if(!(byte & 0x80))
+                return ret;
+        }
+        throw_invalid("varint is too long");
+    }
+
+    size_t ProgReader::read_index(size_t count)
+    {
+        const uint64_t ret = read_uint();
+        if(ret >= count)
+            throw_invalid("index out of range");
+        return static_cast<size_t>(ret);
+    }
+
+    std::string ProgReader::read_string()
+    {
+        const size_t size = read_index(static_cast<size_t>(end_ - cur_) + 1);
+        std::string ret(reinterpret_cast<const char *>(cur_), size);
+        cur_ += size;
+        return ret;
+    }
+
+    template<typename T>
+    T ProgReader::read_fixed()
+    {
+        if(end_ - cur_ < static_cast<ptrdiff_t>(sizeof(T)))
+            throw_invalid("unexpected end of data");
+        std::array<uint8_t, sizeof(T)> bytes;
+        std::memcpy(bytes.data(), cur_, sizeof(T));
+        cur_ += sizeof(T);
+        if constexpr(std::endian::native == std::endian::big)
+            std::reverse(bytes.begin(), bytes.end());
+        T ret;
+        std::memcpy(&ret, bytes.data(), sizeof(T));
+        return ret;
+    }
+
+    const Type *ProgReader::read_type_id()
+    {
+        return types_[read_index(types_.size())];
+    }
+
+    void ProgReader::read_type(Type &type)
+    {
+        switch(static_cast<TypeTag>(read_u8()))
+        {
+        case TypeTag::Builtin:
+        {
+            const uint8_t builtin = read_u8();
+            if(builtin > static_cast<uint8_t>(Builtin::Void))
+                throw_invalid("unknown builtin type");
+            type = static_cast<Builtin>(builtin);
+            break;
+        }
+        case TypeTag::Struct:
+        {
+            Struct s;
+            s.members.resize(read_index(types_.size() + 1));
+            for(auto &m : s.members)
+                m = read_type_id();
+            type = std::move(s);
+            break;
+        }
+        case TypeTag::Array:
+        {
+            auto element = read_type_id();
+            type = Array{ element, static_cast<size_t>(read_uint()) };
+            break;
+        }
+        case TypeTag::Pointer:
+            type = Pointer{ read_type_id() };
+            break;
+        case TypeTag::Vector:
+        {
+            auto element = read_type_id();
+            type = Vector{ element, static_cast<size_t>(read_uint()) };
+            break;
+        }
+        default:
+            throw_invalid("unknown type tag");
+        }
+    }
+
+    // a type containing itself by value has no size. types are sorted so that
+    // members come first, and types left out of the order are on a cycle
+    void ProgReader::check_type_cycles() const
+    {
+        std::map<const Type *, size_t> indices;
+        for(size_t i = 0; i < types_.size(); ++i)
+            indices.insert({ types_[i], i });
+
+        std::vector<std::vector<size_t>> containers(types_.size());
+        std::vector<size_t> unsorted_members(types_.size(), 0);
+        for(size_t i = 0; i < types_.size(); ++i)
+        {
+            auto add_member = [&](const Type *member)
+            {
+                containers[indices.at(member)].push_back(i);
+                ++unsorted_members[i];
+            };
+            types_[i]->match(
+                [&](const Struct &t)
+            {
+                for(auto m : t.members)
+                    add_member(m);
+            },
+                [&](const Array &t) { add_member(t.element); },
+                [&](const Vector &t) { add_member(t.element); },
+                [](const auto &) { });
+        }
+
+        std::vector<size_t> sorted;
+        sorted.reserve(types_.size());
+        for(size_t i = 0; i < types_.size(); ++i)
+        {
+            if(!unsorted_members[i])
+                sorted.push_back(i);
+        }
+        for(size_t i = 0; i < sorted.size(); ++i)
+        {
+            for(size_t c : containers[sorted[i]])
+            {
+                if(!--unsorted_members[c])
+                    sorted.push_back(c);
+            }
+        }
+        if(sorted.size() != types_.size())
+            throw_invalid("type contains itself by value");
+    }
+
+    void ProgReader::read_func(Func &func)
+    {
+        func.name = read_string();
+        func.type = read_u8() ? Func::Kernel : Func::Regular;
+
+        func.argument_types.resize(read_index(
+            static_cast<size_t>(end_ - cur_) + 1));
+        for(auto &arg : func.argument_types)
+        {
+            arg.type = read_type_id();
+            arg.is_reference = read_u8() != 0;
+        }
+        func.return_type.type = read_type_id();
+        func.return_type.is_reference = read_u8() != 0;
+
+        func.local_alloc_types.resize(read_index(
+            static_cast<size_t>(end_ - cur_) + 1));
+        for(auto &type : func.local_alloc_types)
+            type = read_type_id();
+
+        exprs_.clear();
+        stats_.clear();
+        blocks_.clear();
+
+        for(;;)
+        {
+            const uint8_t tag = read_u8();
+            if(tag == END_TAG)
+                break;
+            if(tag == BLOCK_TAG)
+            {
+                auto block = func.arena->create<Block>();
+                block->stats.resize(read_index(stats_.size() + 1));
+                for(auto &s : block->stats)
+                    s = read_stat_ref();
+                blocks_.push_back(block);
+            }
+            else if(tag >= STAT_TAG_BASE)
+                read_stat(func, tag - STAT_TAG_BASE);
+            else
+                read_expr(func, tag);
+        }
+
+        func.root_block = read_block_ref();
+    }
+
+    void ProgReader::read_expr(Func &func, uint8_t tag)
+    {
+        Expr expr;
+        switch(tag)
+        {
+        case tag_of<Expr, FuncArgAddr>():
+        {
+            auto type = read_type_id();
+            expr = FuncArgAddr{
+                type, read_index(func.argument_types.size()) };
+            break;
+        }
+        case tag_of<Expr, LocalAllocAddr>():
+        {
+            auto type = read_type_id();
+            expr = LocalAllocAddr{
+                type, read_index(func.local_alloc_types.size()) };
+            break;
+        }
+        case tag_of<Expr, Load>():
+        {
+            auto type = read_type_id();
+            expr = Load{ type, read_expr_ref() };
+            break;
+        }
+        case tag_of<Expr, Immediate>():
+            expr = read_immediate();
+            break;
+        case tag_of<Expr, NullPtr>():
+            expr = NullPtr{ read_type_id() };
+            break;
+        case tag_of<Expr, ArithmeticCast>():
+        {
+            ArithmeticCast e;
+            e.dst_type = read_type_id();
+            e.src_type = read_type_id();
+            e.src_val = read_expr_ref();
+            expr = e;
+            break;
+        }
+        case tag_of<Expr, PointerOffset>():
+        {
+            PointerOffset e;
+            e.ptr_type = read_type_id();
+            e.offset_type = read_type_id();
+            e.ptr_val = read_expr_ref();
+            e.offset_val = read_expr_ref();
+            e.negative = read_u8() != 0;
+            expr = e;
+            break;
+        }
+        case tag_of<Expr, ClassPointerToMemberPointer>():
+        {
+            ClassPointerToMemberPointer e;
+            e.class_ptr_type = read_type_id();
+            e.member_ptr_type = read_type_id();
+            e.class_ptr = read_expr_ref();
+            auto class_ptr = e.class_ptr_type->as_if<Pointer>();
+            auto class_type =
+                class_ptr ? class_ptr->pointed->as_if<Struct>() : nullptr;
+            if(!class_type)
+                throw_invalid("member of a non-class pointer");
+            e.member_index = read_index(class_type->members.size());
+            expr = e;
+            break;
+        }
+        case tag_of<Expr, DerefClassPointer>():
+        {
+            auto type = read_type_id();
+            expr = DerefClassPointer{ type, read_expr_ref() };
+            break;
+        }
+        case tag_of<Expr, DerefArrayPointer>():
+        {
+            auto type = read_type_id();
+            expr = DerefArrayPointer{ type, read_expr_ref() };
+            break;
+        }
+        case tag_of<Expr, SaveClassIntoLocalAlloc>():
+        {
+            auto type = read_type_id();
+            expr = SaveClassIntoLocalAlloc{ type, read_expr_ref() };
+            break;
+        }
+        case tag_of<Expr, SaveArrayIntoLocalAlloc>():
+        {
+            auto type = read_type_id();
+            expr = SaveArrayIntoLocalAlloc{ type, read_expr_ref() };
+            break;
+        }
+        case tag_of<Expr, ArrayAddrToFirstElemAddr>():
+        {
+            auto type = read_type_id();
+            expr = ArrayAddrToFirstElemAddr{ type, read_expr_ref() };
+            break;
+        }
+        case tag_of<Expr, Binary>():
+        {
+            Binary e;
+            const uint8_t op = read_u8();
+            if(op > static_cast<uint8_t>(Binary::Op::BitwiseXOr))
+                throw_invalid("unknown binary operator");
+            e.op = static_cast<Binary::Op>(op);
+            e.lhs = read_expr_ref();
+            e.rhs = read_expr_ref();
+            e.lhs_type = read_type_id();
+            e.rhs_type = read_type_id();
+            expr = e;
+            break;
+        }
+        case tag_of<Expr, Unary>():
+        {
+            Unary e;
+            const uint8_t op = read_u8();
+            if(op > static_cast<uint8_t>(Unary::Op::BitwiseNot))
+                throw_invalid("unknown unary operator");
+            e.op = static_cast<Unary::Op>(op);
+            e.val = read_expr_ref();
+            e.val_type = read_type_id();
+            expr = e;
+            break;
+        }
+        case tag_of<Expr, CallFunc>():
+            expr = read_call();
+            break;
+        case tag_of<Expr, Select>():
+        {
+            Select e;
+            e.val_type = read_type_id();
+            e.cond_type = read_type_id();
+            e.cond = read_expr_ref();
+            e.true_val = read_expr_ref();
+            e.false_val = read_expr_ref();
+            expr = e;
+            break;
+        }
+        case tag_of<Expr, VectorBroadcast>():
+        {
+            auto type = read_type_id();
+            expr = VectorBroadcast{ type, read_expr_ref() };
+            break;
+        }
+        case tag_of<Expr, VectorExtract>():
+        {
+            VectorExtract e;
+            e.vector_type = read_type_id();
+            e.index_type = read_type_id();
+            e.vector = read_expr_ref();
+            e.index = read_expr_ref();
+            expr = e;
+            break;
+        }
+        case tag_of<Expr, VectorInsert>():
+        {
+            VectorInsert e;
+            e.vector_type = read_type_id();
+            e.index_type = read_type_id();
+            e.vector = read_expr_ref();
+            e.index = read_expr_ref();
+            e.element = read_expr_ref();
+            expr = e;
+            break;
+        }
+        case tag_of<Expr, VectorShuffle>():
+        {
+            VectorShuffle e;
+            e.vector_type = read_type_id();
+            e.src_type = read_type_id();
+            e.lhs = read_expr_ref();
+            e.rhs = read_expr_ref();
+            e.indices.resize(read_index(
+                static_cast<size_t>(end_ - cur_) / sizeof(int32_t) + 1));
+            for(auto &i : e.indices)
+                i = read_fixed<int32_t>();
+            expr = std::move(e);
+            break;
+        }
+        case tag_of<Expr, VectorReduce>():
+        {
+            VectorReduce e;
+            const uint8_t op = read_u8();
+            if(op > static_cast<uint8_t>(VectorReduce::Op::BitwiseXOr))
+                throw_invalid("unknown vector reduction");
+            e.op = static_cast<VectorReduce::Op>(op);
+            e.vector_type = read_type_id();
+            e.vector = read_expr_ref();
+            expr = e;
+            break;
+        }
+        case tag_of<Expr, VectorLoad>():
+        {
+            VectorLoad e;
+            e.vector_type = read_type_id();
+            e.elem_ptr_type = read_type_id();
+            e.elem_ptr = read_expr_ref();
+            e.aligned = read_u8() != 0;
+            expr = e;
+            break;
+        }
+        case tag_of<Expr, AtomicOperation>():
+        {
+            AtomicOperation e;
+            const uint8_t op = read_u8();
+            if(op > static_cast<uint8_t>(AtomicOperation::Op::CompareExchange))
+                throw_invalid("unknown atomic operation");
+            e.op = static_cast<AtomicOperation::Op>(op);
+            const uint8_t order = read_u8();
+            if(order > static_cast<uint8_t>(MemoryOrder::SeqCst))
+                throw_invalid("unknown memory order");
+            e.order = static_cast<MemoryOrder>(order);
+            const uint8_t scope = read_u8();
+            if(scope > static_cast<uint8_t>(MemoryScope::System))
+                throw_invalid("unknown memory scope");
+            e.scope = static_cast<MemoryScope>(scope);
+            e.val_type = read_type_id();
+            e.ptr = read_expr_ref();
+            e.val = read_expr_ref();
+            if(e.op == AtomicOperation::Op::CompareExchange)
+                e.cmp = read_expr_ref();
+            expr = e;
+            break;
+        }
+        default:
+            throw_invalid("unknown expression tag");
+        }
+        exprs_.push_back(func.arena->create<Expr>(std::move(expr)));
+    }
+
+    void ProgReader::read_stat(Func &func, uint8_t tag)
+    {
+        Stat stat;
+        switch(tag)
+        {
+        case tag_of<Stat, Store>():
+        {
+            Store s;
+            s.dst_addr = *read_expr_ref();
+            s.val = *read_expr_ref();
+            stat = std::move(s);
+            break;
+        }
+        case tag_of<Stat, Block>():
+            stat = *read_block_ref();
+            break;
+        case tag_of<Stat, Return>():
+        {
+            Return s;
+            s.return_type = read_type_id();
+            if(read_u8())
+                s.val = *read_expr_ref();
+            stat = std::move(s);
+            break;
+        }
+        case tag_of<Stat, If>():
+        {
+            If s;
+            s.calc_cond = read_block_ref();
+            s.cond = *read_expr_ref();
+            s.then_body = read_stat_ref();
+            if(const size_t else_body = read_index(stats_.size() + 1))
+                s.else_body = stats_[else_body - 1];
+            stat = std::move(s);
+            break;
+        }
+        case tag_of<Stat, Loop>():
+            stat = Loop{ read_block_ref() };
+            break;
+        case tag_of<Stat, Break>():
+            stat = Break{};
+            break;
+        case tag_of<Stat, Continue>():
+            stat = Continue{};
+            break;
+        case tag_of<Stat, Switch>():
+        {
+            Switch s;
+            s.value = *read_expr_ref();
+            s.branches.resize(read_index(blocks_.size() + 1));
+            for(auto &b : s.branches)
+            {
+                b.cond = read_immediate();
+                b.body = read_block_ref();
+                b.fallthrough = read_u8() != 0;
+            }
+            if(const size_t default_body = read_index(blocks_.size() + 1))
+                s.default_body = blocks_[default_body - 1];
+            stat = std::move(s);
+            break;
+        }
+        case tag_of<Stat, CallFuncStat>():
+            stat = CallFuncStat{ read_call() };
+            break;
+        case tag_of<Stat, VectorStore>():
+        {
+            VectorStore s;
+            s.vector_type = read_type_id();
+            s.elem_ptr_type = read_type_id();
+            s.elem_ptr = *read_expr_ref();
+            s.val = *read_expr_ref();
+            s.aligned = read_u8() != 0;
+            stat = std::move(s);
+            break;
+        }
+        default:
+            throw_invalid("unknown statement tag");
+        }
+        stats_.push_back(func.arena->create<Stat>(std::move(stat)));
+    }
+
+    Immediate ProgReader::read_immediate()
+    {
+        Immediate ret;
+        switch(read_u8())
+        {
+        case 0:  ret.value = read_fixed<uint8_t>();  break;
+        case 1:  ret.value = read_fixed<uint16_t>(); break;
+        case 2:  ret.value = read_fixed<uint32_t>(); break;
+        case 3:  ret.value = read_fixed<uint64_t>(); break;
+        case 4:  ret.value = read_fixed<int8_t>();   break;
+        case 5:  ret.value = read_fixed<int16_t>();  break;
+        case 6:  ret.value = read_fixed<int32_t>();  break;
+        case 7:  ret.value = read_fixed<int64_t>();  break;
+        case 8:  ret.value = read_fixed<float>();    break;
+        case 9:  ret.value = read_fixed<double>();   break;
+        case 10: ret.value = read_fixed<char>();     break;
+        case 11: ret.value = read_fixed<bool>();     break;
+        default:
+            throw_invalid("unknown immediate type");
+        }
+        return ret;
+    }
+
+    CallFunc ProgReader::read_call()
+    {
+        CallFunc ret;
+        if(const size_t callee = read_index(funcs_.size() + 1))
+            ret.contextless_func = funcs_[callee - 1];
+        ret.contexted_func_index = read_index(funcs_.size());
+        ret.intrinsic = static_cast<Intrinsic>(read_index(INTRINSIC_COUNT));
+        ret.args.resize(read_index(exprs_.size() + 1));
+        for(auto &a : ret.args)
+            a = read_expr_ref();
+        return ret;
+    }
+
+    Expr *ProgReader::read_expr_ref()
+    {
+        return exprs_[read_index(exprs_.size())];
+    }
+
+    Stat *ProgReader::read_stat_ref()
+    {
+        return stats_[read_index(stats_.size())];
+    }
+
+    Block *ProgReader::read_block_ref()
+    {
+        return blocks_[read_index(blocks_.size())];
+    }
+
+} // namespace anonymous
+
+std::vector<uint8_t> serialize(const Prog &prog)
+{
+    return ProgWriter(prog).write();
+}
+
+Prog deserialize(const void *data, size_t bytes)
+{
+    return ProgReader(data, bytes).read();
+}
+
+CUJ_NAMESPACE_END(cuj::core)
@@ -6,7 +6,7 @@ f32 abs(f32 x)
 {
     return f32::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f32_abs,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -14,7 +14,7 @@ f32 mod(f32 x, f32 y)
 {
     return f32::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f32_mod,
-        .args      = { newRC<core::Expr>(x._load()), newRC<core::Expr>(y._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()), dsl::newNode<core::Expr>(y._load()) }
     });
 }
 
@@ -22,7 +22,7 @@ f32 rem(f32 x, f32 y)
 {
     return f32::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f32_rem,
-        .args      = { newRC<core::Expr>(x._load()), newRC<core::Expr>(y._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()), dsl::newNode<core::Expr>(y._load()) }
     });
 }
 
@@ -30,7 +30,7 @@ f32 exp(f32 x)
 {
     return f32::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f32_exp,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -38,7 +38,7 @@ f32 exp2(f32 x)
 {
     return f32::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f32_exp2,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -46,7 +46,7 @@ f32 exp10(f32 x)
 {
     return f32::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f32_exp10,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -54,7 +54,7 @@ f32 log(f32 x)
 {
     return f32::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f32_log,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -62,7 +62,7 @@ f32 log2(f32 x)
 {
     return f32::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f32_log2,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -70,7 +70,7 @@ f32 log10(f32 x)
 {
     return f32::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f32_log10,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -78,7 +78,7 @@ f32 pow(f32 x, f32 y)
 {
     return f32::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f32_pow,
-        .args      = { newRC<core::Expr>(x._load()), newRC<core::Expr>(y._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()), dsl::newNode<core::Expr>(y._load()) }
     });
 }
 
@@ -86,7 +86,7 @@ f32 sqrt(f32 x)
 {
     return f32::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f32_sqrt,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -94,7 +94,7 @@ f32 rsqrt(f32 x)
 {
     return f32::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f32_rsqrt,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -102,7 +102,7 @@ f32 sin(f32 x)
 {
     return f32::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f32_sin,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -110,7 +110,7 @@ f32 cos(f32 x)
 {
     return f32::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f32_cos,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -118,7 +118,7 @@ f32 tan(f32 x)
 {
     return f32::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f32_tan,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -126,7 +126,7 @@ f32 asin(f32 x)
 {
     return f32::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f32_asin,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -134,7 +134,7 @@ f32 acos(f32 x)
 {
     return f32::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f32_acos,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -142,7 +142,7 @@ f32 atan(f32 x)
 {
     return f32::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f32_atan,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -150,7 +150,7 @@ f32 atan2(f32 y, f32 x)
 {
     return f32::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f32_atan2,
-        .args      = { newRC<core::Expr>(y._load()), newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(y._load()), dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -158,7 +158,7 @@ f32 ceil(f32 x)
 {
     return f32::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f32_ceil,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -166,7 +166,7 @@ f32 floor(f32 x)
 {
     return f32::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f32_floor,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -174,7 +174,7 @@ f32 trunc(f32 x)
 {
     return f32::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f32_trunc,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -182,7 +182,7 @@ f32 round(f32 x)
 {
     return f32::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f32_round,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -190,7 +190,7 @@ boolean isfinite(f32 x)
 {
     return i32::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f32_isfinite,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     }) != i32(0);
 }
 
@@ -198,7 +198,7 @@ boolean isinf(f32 x)
 {
     return i32::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f32_isinf,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     }) != i32(0);
 }
 
@@ -206,7 +206,7 @@ boolean isnan(f32 x)
 {
     return i32::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f32_isnan,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     }) != i32(0);
 }
 
@@ -214,7 +214,7 @@ f64 abs(f64 x)
 {
     return f64::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f64_abs,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -222,7 +222,7 @@ f64 mod(f64 x, f64 y)
 {
     return f64::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f64_mod,
-        .args      = { newRC<core::Expr>(x._load()), newRC<core::Expr>(y._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()), dsl::newNode<core::Expr>(y._load()) }
     });
 }
 
@@ -230,7 +230,7 @@ f64 rem(f64 x, f64 y)
 {
     return f64::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f64_rem,
-        .args      = { newRC<core::Expr>(x._load()), newRC<core::Expr>(y._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()), dsl::newNode<core::Expr>(y._load()) }
     });
 }
 
@@ -238,7 +238,7 @@ f64 exp(f64 x)
 {
     return f64::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f64_exp,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -246,7 +246,7 @@ f64 exp2(f64 x)
 {
     return f64::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f64_exp2,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -254,7 +254,7 @@ f64 exp10(f64 x)
 {
     return f64::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f64_exp10,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -262,7 +262,7 @@ f64 log(f64 x)
 {
     return f64::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f64_log,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -270,7 +270,7 @@ f64 log2(f64 x)
 {
     return f64::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f64_log2,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -278,7 +278,7 @@ f64 log10(f64 x)
 {
     return f64::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f64_log10,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -286,7 +286,7 @@ f64 pow(f64 x, f64 y)
 {
     return f64::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f64_pow,
-        .args      = { newRC<core::Expr>(x._load()), newRC<core::Expr>(y._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()), dsl::newNode<core::Expr>(y._load()) }
     });
 }
 
@@ -294,7 +294,7 @@ f64 sqrt(f64 x)
 {
     return f64::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f64_sqrt,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -302,7 +302,7 @@ f64 rsqrt(f64 x)
 {
     return f64::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f64_rsqrt,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -310,7 +310,7 @@ f64 sin(f64 x)
 {
     return f64::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f64_sin,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -318,7 +318,7 @@ f64 cos(f64 x)
 {
     return f64::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f64_cos,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -326,7 +326,7 @@ f64 tan(f64 x)
 {
     return f64::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f64_tan,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -334,7 +334,7 @@ f64 asin(f64 x)
 {
     return f64::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f64_asin,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -342,7 +342,7 @@ f64 acos(f64 x)
 {
     return f64::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f64_acos,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -350,7 +350,7 @@ f64 atan(f64 x)
 {
     return f64::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f64_atan,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -358,7 +358,7 @@ f64 atan2(f64 y, f64 x)
 {
     return f64::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f64_atan2,
-        .args      = { newRC<core::Expr>(y._load()), newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(y._load()), dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -366,7 +366,7 @@ f64 ceil(f64 x)
 {
     return f64::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f64_ceil,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -374,7 +374,7 @@ f64 floor(f64 x)
 {
     return f64::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f64_floor,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -382,7 +382,7 @@ f64 trunc(f64 x)
 {
     return f64::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f64_trunc,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -390,7 +390,7 @@ f64 round(f64 x)
 {
     return f64::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f64_round,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     });
 }
 
@@ -398,7 +398,7 @@ boolean isfinite(f64 x)
 {
     return i32::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f64_isfinite,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     }) != i32(0);
 }
 
@@ -406,7 +406,7 @@ boolean isinf(f64 x)
 {
     return i32::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f64_isinf,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     }) != i32(0);
 }
 
@@ -414,7 +414,7 @@ boolean isnan(f64 x)
 {
     return i32::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f64_isnan,
-        .args      = { newRC<core::Expr>(x._load()) }
+        .args      = { dsl::newNode<core::Expr>(x._load()) }
     }) != i32(0);
 }
 
@@ -422,7 +422,7 @@ f32 min(f32 a, f32 b)
 {
     return f32::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f32_min,
-        .args      = { newRC<core::Expr>(a._load()), newRC<core::Expr>(b._load()) }
+        .args      = { dsl::newNode<core::Expr>(a._load()), dsl::newNode<core::Expr>(b._load()) }
     });
 }
 
@@ -430,7 +430,7 @@ f32 max(f32 a, f32 b)
 {
     return f32::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f32_max,
-        .args      = { newRC<core::Expr>(a._load()), newRC<core::Expr>(b._load()) }
+        .args      = { dsl::newNode<core::Expr>(a._load()), dsl::newNode<core::Expr>(b._load()) }
     });
 }
 
@@ -438,7 +438,7 @@ f64 min(f64 a, f64 b)
 {
     return f64::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f64_min,
-        .args      = { newRC<core::Expr>(a._load()), newRC<core::Expr>(b._load()) }
+        .args      = { dsl::newNode<core::Expr>(a._load()), dsl::newNode<core::Expr>(b._load()) }
     });
 }
 
@@ -446,7 +446,7 @@ f64 max(f64 a, f64 b)
 {
     return f64::_from_expr(core::CallFunc{
         .intrinsic = core::Intrinsic::f64_max,
-        .args      = { newRC<core::Expr>(a._load()), newRC<core::Expr>(b._load()) }
+        .args      = { dsl::newNode<core::Expr>(a._load()), dsl::newNode<core::Expr>(b._load()) }
     });
 }
 
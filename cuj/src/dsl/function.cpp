@@ -1,6 +1,8 @@
+#include <algorithm>
 #include <cassert>
 #include <string>
 
+#include <cuj/core/visit.h>
 #include <cuj/dsl/dsl.h>
 
 CUJ_NAMESPACE_BEGIN(cuj::dsl)
@@ -43,7 +45,7 @@ FunctionContext::FunctionContext(bool self_contained_typeset)
     func_ = newRC<core::Func>();
     func_->name =
         "__cuj_auto_function_name_" + std::to_string(auto_func_name_index++);
-    func_->root_block = newRC<core::Block>();
+    func_->root_block = func_->arena->create<core::Block>();
 
     if(self_contained_typeset)
     {
@@ -52,6 +54,7 @@ FunctionContext::FunctionContext(bool self_contained_typeset)
     }
 
     blocks_.push(func_->root_block);
+    block_temp_values_.emplace();
 }
 
 void FunctionContext::set_module(Module *mod)
@@ -70,10 +73,11 @@ void FunctionContext::set_type(core::Func::FuncType type)
     func_->type = type;
 }
 
-void FunctionContext::append_statement(RC<core::Stat> stat)
+void FunctionContext::append_statement(core::Stat *stat)
 {
     assert(!blocks_.empty());
-    blocks_.top()->stats.push_back(std::move(stat));
+    blocks_.top()->stats.push_back(stat);
+    ++epoch_;
 }
 
 void FunctionContext::add_argument(const core::Type *type, bool is_reference)
@@ -93,18 +97,50 @@ const core::Func::Argument &FunctionContext::get_return() const
 
 void FunctionContext::append_statement(core::Stat stat)
 {
-    append_statement(newRC<core::Stat>(std::move(stat)));
+    append_statement(create_node<core::Stat>(std::move(stat)));
 }
 
-void FunctionContext::push_block(RC<core::Block> block)
+void FunctionContext::push_block(core::Block *block)
 {
-    blocks_.push(std::move(block));
+    blocks_.push(block);
+    block_temp_values_.emplace();
+    ++epoch_;
 }
 
 void FunctionContext::pop_block()
 {
     assert(blocks_.size() >= 2);
+
+    // the block may be moved into its parent statement after being popped,
+    // so temp values which may still be used are stored now
+    for(auto value : block_temp_values_.top())
+    {
+        if(value->alive && !value->materialized)
+            materialize_temp_value(value);
+    }
+    insert_pending_stores(blocks_.top(), block_temp_values_.top());
+
+    block_temp_values_.pop();
     blocks_.pop();
+    ++epoch_;
+}
+
+void FunctionContext::finish_recording()
+{
+    // nested blocks are left open when recording throws
+    if(blocks_.size() == 1)
+        insert_pending_stores(blocks_.top(), block_temp_values_.top());
+}
+
+const core::Block *FunctionContext::get_current_block() const
+{
+    assert(!blocks_.empty());
+    return blocks_.top();
+}
+
+bool FunctionContext::is_constant_folding_enabled() const
+{
+    return module_ && module_->is_constant_folding_enabled();
 }
 
 TypeContext *FunctionContext::get_type_context()
@@ -127,6 +163,21 @@ size_t FunctionContext::get_index_in_module() const
     return index_in_module_;
 }
 
+void FunctionContext::remap_function_indices(
+    const std::vector<size_t> &old_to_new)
+{
+    index_in_module_ = old_to_new[index_in_module_];
+
+    // calls are owned by func_, so they can be modified here
+    core::visit_call_funcs(*func_->root_block, [&](const core::CallFunc &call)
+    {
+        if(call.contextless_func)
+            return;
+        auto &index = const_cast<core::CallFunc &>(call).contexted_func_index;
+        index = old_to_new[index];
+    });
+}
+
 size_t FunctionContext::alloc_local_var(const core::Type *type)
 {
     const size_t index = func_->local_alloc_types.size();
@@ -134,15 +185,147 @@ size_t FunctionContext::alloc_local_var(const core::Type *type)
     return index;
 }
 
+TempValue *FunctionContext::create_temp_value(
+    const core::Type *type, core::Expr expr)
+{
+    assert(!blocks_.empty());
+    auto block = blocks_.top();
+    auto value = create_node<TempValue>(TempValue{
+        .type       = type,
+        .expr       = std::move(expr),
+        .block      = block,
+        .stat_index = block->stats.size(),
+        .epoch      = epoch_
+    });
+
+    // expressions with side effects are evaluated right away
+    const bool has_side_effect =
+        value->expr.is<core::CallFunc>() ||
+        value->expr.is<core::AtomicOperation>() ||
+        value->expr.is<core::SaveClassIntoLocalAlloc>() ||
+        value->expr.is<core::SaveArrayIntoLocalAlloc>();
+    if(has_side_effect)
+    {
+        value->alloc_index = alloc_local_var(type);
+        value->materialized = true;
+        append_statement(core::Store{
+            .dst_addr = core::LocalAllocAddr{
+                .alloc_type  = type,
+                .alloc_index = value->alloc_index
+            },
+            .val = value->expr
+        });
+        return value;
+    }
+
+    block_temp_values_.top().push_back(value);
+    return value;
+}
+
+const core::Expr *FunctionContext::use_temp_value(TempValue *value)
+{
+    if(value->materialized || value->epoch != epoch_)
+        return nullptr;
+
+    // leaves are cheap to repeat. other expressions are used in place only
+    // once, so that repeated uses don't evaluate them again and again
+    const bool is_leaf =
+        value->expr.is<core::Immediate>() ||
+        value->expr.is<core::NullPtr>() ||
+        value->expr.is<core::LocalAllocAddr>() ||
+        value->expr.is<core::FuncArgAddr>();
+    if(!is_leaf)
+    {
+        if(value->used)
+            return nullptr;
+        value->used = true;
+    }
+    return &value->expr;
+}
+
+size_t FunctionContext::materialize_temp_value(TempValue *value)
+{
+    if(value->materialized)
+        return value->alloc_index;
+    value->alloc_index = alloc_local_var(value->type);
+    value->materialized = true;
+
+    // the store is inserted when the block of the value is finished. see
+    // insert_pending_stores
+    value->store_pending = true;
+    value->store_order = store_count_++;
+    return value->alloc_index;
+}
+
+size_t FunctionContext::overwrite_temp_value(TempValue *value)
+{
+    // nothing can have loaded the old value from its local yet
+    if(!value->materialized && value->epoch == epoch_)
+    {
+        value->alloc_index = alloc_local_var(value->type);
+        value->materialized = true;
+        return value->alloc_index;
+    }
+    return materialize_temp_value(value);
+}
+
+void FunctionContext::insert_pending_stores(
+    core::Block *block, const std::vector<TempValue *> &values)
+{
+    std::vector<TempValue *> pending;
+    for(auto value : values)
+    {
+        if(value->store_pending)
+            pending.push_back(value);
+    }
+    if(pending.empty())
+        return;
+
+    // a store placed after the first stat_index statements gives the value of
+    // the expression at the time the temp value was created. stores at the
+    // same place keep their order, as later ones may load earlier ones
+    std::sort(pending.begin(), pending.end(), [](TempValue *a, TempValue *b)
+    {
+        if(a->stat_index != b->stat_index)
+            return a->stat_index < b->stat_index;
+        return a->store_order < b->store_order;
+    });
+
+    std::vector<core::Stat *> stats;
+    stats.reserve(block->stats.size() + pending.size());
+    auto next = pending.begin();
+    for(size_t i = 0; i <= block->stats.size(); ++i)
+    {
+        for(; next != pending.end() && (*next)->stat_index == i; ++next)
+        {
+            auto value = *next;
+            stats.push_back(create_node<core::Stat>(core::Store{
+                .dst_addr = core::LocalAllocAddr{
+                    .alloc_type  = value->type,
+                    .alloc_index = value->alloc_index
+                },
+                .val = value->expr
+            }));
+            value->store_pending = false;
+        }
+        if(i < block->stats.size())
+            stats.push_back(block->stats[i]);
+    }
+    assert(next == pending.end());
+    block->stats = std::move(stats);
+}
+
 RC<FunctionContext> FunctionContext::clone_with_module(Module *mod)
 {
     assert(!module_);
     auto ret = RC<FunctionContext>(new FunctionContext(Uninit{}));
-    ret->func_            = func_;
-    ret->type_context_    = type_context_;
-    ret->index_in_module_ = index_in_module_;
-    ret->module_          = mod;
-    ret->blocks_          = blocks_;
+    ret->func_              = func_;
+    ret->type_context_      = type_context_;
+    ret->index_in_module_   = index_in_module_;
+    ret->module_            = mod;
+    ret->blocks_            = blocks_;
+    ret->store_count_       = store_count_;
+    ret->block_temp_values_ = block_temp_values_;
     return ret;
 }
 
@@ -1,7 +1,14 @@
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <numeric>
 #include <stack>
+#include <thread>
 
 #include <cuj/core/visit.h>
 #include <cuj/dsl/dsl.h>
+#include <cuj/utils/scope_guard.h>
 
 CUJ_NAMESPACE_BEGIN(cuj::dsl)
 
@@ -14,6 +21,14 @@ namespace
         return current_module;
     }
 
+    constexpr size_t NO_PARALLEL_TASK = std::numeric_limits<size_t>::max();
+
+    size_t &current_parallel_task()
+    {
+        static thread_local size_t task = NO_PARALLEL_TASK;
+        return task;
+    }
+
 } // namespace anonymous
 
 void Module::set_current_module(Module *mod)
@@ -33,6 +48,7 @@ Module::Module()
 
 RC<FunctionContext> Module::_get_function(size_t index)
 {
+    std::lock_guard lock(mutex_);
     return functions_[index];
 }
 
@@ -43,13 +59,117 @@ TypeContext *Module::_get_type_context()
 
 size_t Module::_add_function(RC<FunctionContext> context)
 {
+    std::lock_guard lock(mutex_);
     const size_t ret = functions_.size();
     functions_.push_back(std::move(context));
+    if(const size_t task = current_parallel_task(); task != NO_PARALLEL_TASK)
+        parallel_task_indices_.push_back(task);
     return ret;
 }
 
+void Module::record_parallel(
+    size_t                             task_count,
+    const std::function<void(size_t)> &task,
+    int                                thread_count)
+{
+    if(thread_count <= 0)
+        thread_count = static_cast<int>(std::thread::hardware_concurrency());
+    thread_count = static_cast<int>(
+        std::clamp<size_t>(thread_count, 1, std::max<size_t>(task_count, 1)));
+
+    size_t first_function;
+    {
+        std::lock_guard lock(mutex_);
+        if(!parallel_task_indices_.empty())
+            throw CujException("nested Module::record_parallel");
+        first_function = functions_.size();
+    }
+
+    std::atomic<size_t> next_task = 0;
+    std::exception_ptr  exception;
+    std::mutex          exception_mutex;
+
+    auto worker = [&]
+    {
+        auto old_module = get_current_module();
+        set_current_module(this);
+        CUJ_SCOPE_EXIT
+        {
+            set_current_module(old_module);
+            current_parallel_task() = NO_PARALLEL_TASK;
+        };
+
+        for(size_t i = next_task++; i < task_count; i = next_task++)
+        {
+            current_parallel_task() = i;
+            try
+            {
+                task(i);
+            }
+            catch(...)
+            {
+                std::lock_guard lock(exception_mutex);
+                if(!exception)
+                    exception = std::current_exception();
+                next_task = task_count;
+            }
+        }
+    };
+
+    // the calling thread works as well
+    std::vector<std::thread> threads;
+    for(int i = 1; i < thread_count; ++i)
+        threads.emplace_back(worker);
+    worker();
+    for(auto &t : threads)
+        t.join();
+
+    // stable sorting keeps the recording order of functions in one task
+    std::lock_guard lock(mutex_);
+    CUJ_SCOPE_EXIT{ parallel_task_indices_.clear(); };
+
+    const size_t new_count = functions_.size() - first_function;
+    assert(parallel_task_indices_.size() == new_count);
+
+    std::vector<size_t> new_to_old(new_count);
+    std::iota(new_to_old.begin(), new_to_old.end(), size_t(0));
+    std::ranges::stable_sort(new_to_old, [&](size_t a, size_t b)
+    {
+        return parallel_task_indices_[a] < parallel_task_indices_[b];
+    });
+
+    std::vector<size_t> old_to_new(functions_.size());
+    std::iota(old_to_new.begin(), old_to_new.end(), size_t(0));
+    for(size_t i = 0; i < new_count; ++i)
+        old_to_new[first_function + new_to_old[i]] = first_function + i;
+
+    std::vector<RC<FunctionContext>> new_functions(new_count);
+    for(size_t i = 0; i < new_count; ++i)
+    {
+        auto &func = functions_[first_function + new_to_old[i]];
+        func->remap_function_indices(old_to_new);
+        new_functions[i] = std::move(func);
+    }
+    std::ranges::move(new_functions, functions_.begin() + first_function);
+
+    if(exception)
+        std::rethrow_exception(exception);
+}
+
+void Module::set_constant_folding(bool enabled)
+{
+    constant_folding_ = enabled;
+}
+
+bool Module::is_constant_folding_enabled() const
+{
+    return constant_folding_;
+}
+
 core::Prog Module::_generate_prog() const
 {
+    std::lock_guard lock(mutex_);
+
     core::Prog ret;
     ret.global_type_set = type_context_->get_type_set();
 
@@ -59,15 +179,14 @@ core::Prog Module::_generate_prog() const
     for(auto &f : registered_contextless_functions_)
         unprocessed_funcs.push(f->get_core_func());
 
-    core::Visitor visitor;
-    visitor.on_call_func = [&](const core::CallFunc &call_func)
+    auto on_call_func = [&](const core::CallFunc &call_func)
     {
         if(call_func.contextless_func)
             unprocessed_funcs.push(call_func.contextless_func);
     };
 
     for(auto &f : functions_)
-        visitor.visit(*f->get_core_func()->root_block);
+        core::visit_call_funcs(*f->get_core_func()->root_block, on_call_func);
 
     while(!unprocessed_funcs.empty())
     {
@@ -77,7 +196,7 @@ core::Prog Module::_generate_prog() const
         auto it = all_contextless_functions.find(func);
         if(it == all_contextless_functions.end())
         {
-            visitor.visit(*func->root_block);
+            core::visit_call_funcs(*func->root_block, on_call_func);
             all_contextless_functions.insert(func);
         }
     }
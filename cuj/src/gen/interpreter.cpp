@@ -0,0 +1,1645 @@
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <unordered_map>
+
+#include <cuj/dsl/module.h>
+#include <cuj/gen/interpreter.h>
+#include <cuj/utils/scope_guard.h>
+#include <cuj/utils/unreachable.h>
+
+CUJ_NAMESPACE_BEGIN(cuj::gen)
+
+namespace
+{
+
+    // each call owns a frame holding arguments, local allocs, constants and
+    // temporary values. registers are byte offsets into the frame
+
+    struct Instruction;
+
+    using Handler = void(*)(const Instruction &, std::byte *);
+
+    enum class OpCode : uint32_t
+    {
+        Compute,     // handler(inst, frame)
+        Jump,        // pc = aux
+        JumpIfFalse, // if !a then pc = aux
+        Switch,      // jump by switch_tables[aux]
+        Call,        // dst = call_sites[aux]
+        Return,      // return a
+        Trap,        // throw trap_messages[aux]
+    };
+
+    struct Instruction
+    {
+        OpCode   op;
+        uint32_t dst = 0;
+        uint32_t a   = 0;
+        uint32_t b   = 0;
+        uint32_t aux = 0; // not a register
+        Handler  handler = nullptr;
+    };
+
+    // values are compared by their bits
+    struct SwitchTable
+    {
+        uint32_t                                   value_size = 0;
+        std::vector<std::pair<uint64_t, uint32_t>> cases;
+        uint32_t                                   default_pc = 0;
+    };
+
+    struct CallSite
+    {
+        size_t                callee;
+        std::vector<uint32_t> args;
+    };
+
+    struct FunctionCode
+    {
+        std::string name;
+
+        std::vector<Instruction> insts;
+        std::vector<SwitchTable> switch_tables;
+        std::vector<CallSite>    call_sites;
+        std::vector<std::string> trap_messages;
+
+        // constants are stored in the frame prefix
+        std::vector<std::byte> frame_init;
+        size_t                 frame_size = 0;
+
+        std::vector<uint32_t> arg_offsets;
+        std::vector<uint32_t> arg_sizes;
+        size_t                ret_size = 0;
+
+        mutable std::atomic<uint64_t> call_count = 0;
+    };
+
+    constexpr uint32_t TEMP_REGISTER_BIT = 1u << 31;
+
+    template<typename T>
+    T read(const std::byte *frame, uint32_t reg)
+    {
+        T ret;
+        std::memcpy(&ret, frame + reg, sizeof(T));
+        return ret;
+    }
+
+    template<typename T>
+    void write(std::byte *frame, uint32_t reg, const T &value)
+    {
+        std::memcpy(frame + reg, &value, sizeof(T));
+    }
+
+    template<typename F>
+    auto match_builtin(core::Builtin type, F &&f)
+    {
+        switch(type)
+        {
+        case core::Builtin::S8:   return f.template operator()<int8_t>();
+        case core::Builtin::S16:  return f.template operator()<int16_t>();
+        case core::Builtin::S32:  return f.template operator()<int32_t>();
+        case core::Builtin::S64:  return f.template operator()<int64_t>();
+        case core::Builtin::U8:   return f.template operator()<uint8_t>();
+        case core::Builtin::U16:  return f.template operator()<uint16_t>();
+        case core::Builtin::U32:  return f.template operator()<uint32_t>();
+        case core::Builtin::U64:  return f.template operator()<uint64_t>();
+        case core::Builtin::F32:  return f.template operator()<float>();
+        case core::Builtin::F64:  return f.template operator()<double>();
+        case core::Builtin::Char: return f.template operator()<char>();
+        case core::Builtin::Bool: return f.template operator()<bool>();
+        default:
+            break;
+        }
+        throw CujException("interpreter: invalid arithmetic type");
+    }
+
+    template<typename T>
+    constexpr bool is_int_v = std::is_integral_v<T> && !std::is_same_v<T, bool>;
+
+    // integer arithmetic wraps around like llvm
+    template<typename T>
+    struct WrapType { using Type = T; };
+
+    template<typename T> requires is_int_v<T>
+    struct WrapType<T>
+    {
+        using Type = std::common_type_t<unsigned, std::make_unsigned_t<T>>;
+    };
+
+    template<typename T>
+    using wrap_t = typename WrapType<T>::Type;
+
+    // ======================= computation handlers =======================
+
+    void copy_handler(const Instruction &inst, std::byte *frame)
+    {
+        std::memmove(frame + inst.dst, frame + inst.a, inst.aux);
+    }
+
+    void frame_addr_handler(const Instruction &inst, std::byte *frame)
+    {
+        write(frame, inst.dst, frame + inst.a);
+    }
+
+    void load_handler(const Instruction &inst, std::byte *frame)
+    {
+        std::memmove(frame + inst.dst, read<std::byte *>(frame, inst.a), inst.aux);
+    }
+
+    void store_handler(const Instruction &inst, std::byte *frame)
+    {
+        std::memmove(read<std::byte *>(frame, inst.a), frame + inst.b, inst.aux);
+    }
+
+    void member_addr_handler(const Instruction &inst, std::byte *frame)
+    {
+        write(frame, inst.dst, read<std::byte *>(frame, inst.a) + inst.aux);
+    }
+
+    template<typename Offset, bool Negative>
+    void pointer_offset_handler(const Instruction &inst, std::byte *frame)
+    {
+        // gep indices are signed
+        int64_t offset;
+        if constexpr(std::is_same_v<Offset, bool>)
+            offset = read<bool>(frame, inst.b) ? 1 : 0;
+        else
+        {
+            offset = static_cast<int64_t>(static_cast<std::make_signed_t<Offset>>(
+                read<Offset>(frame, inst.b)));
+        }
+        if constexpr(Negative)
+            offset = -offset;
+        auto ptr = read<std::byte *>(frame, inst.a);
+        write(frame, inst.dst, ptr + offset * static_cast<int64_t>(inst.aux));
+    }
+
+    template<typename Dst, typename Src>
+    Dst cast_value(Src src)
+    {
+        if constexpr(std::is_same_v<Src, bool>)
+            return src ? Dst(1) : Dst(0);
+        else if constexpr(std::is_same_v<Dst, bool>)
+        {
+            if constexpr(std::is_floating_point_v<Src>)
+                return src != 0;
+            else
+                return (src & 1) != 0;
+        }
+        else if constexpr(is_int_v<Src> && is_int_v<Dst>)
+        {
+            // extension depends on the destination signedness, like llvm
+            if constexpr(std::is_signed_v<Dst>)
+                return static_cast<Dst>(static_cast<std::make_signed_t<Src>>(src));
+            else
+                return static_cast<Dst>(static_cast<std::make_unsigned_t<Src>>(src));
+        }
+        else
+            return static_cast<Dst>(src);
+    }
+
+    template<typename Dst, typename Src>
+    void cast_handler(const Instruction &inst, std::byte *frame)
+    {
+        write(frame, inst.dst, cast_value<Dst>(read<Src>(frame, inst.a)));
+    }
+
+    template<typename T, core::Binary::Op Op>
+    auto apply_binary(T lhs, T rhs)
+    {
+        using Op_ = core::Binary::Op;
+        using W = wrap_t<T>;
+
+        if constexpr(Op == Op_::Add)
+            return static_cast<T>(static_cast<W>(lhs) + static_cast<W>(rhs));
+        else if constexpr(Op == Op_::Sub)
+            return static_cast<T>(static_cast<W>(lhs) - static_cast<W>(rhs));
+        else if constexpr(Op == Op_::Mul)
+            return static_cast<T>(static_cast<W>(lhs) * static_cast<W>(rhs));
+        else if constexpr(Op == Op_::Div || Op == Op_::Mod)
+        {
+            if constexpr(std::is_floating_point_v<T>)
+            {
+                if constexpr(Op == Op_::Div)
+                    return lhs / rhs;
+                else
+                    return static_cast<T>(std::fmod(lhs, rhs));
+            }
+            else
+            {
+                if(!rhs)
+                    throw CujException("interpreter: integer division by zero");
+                if constexpr(std::is_signed_v<T>)
+                {
+                    if(lhs == std::numeric_limits<T>::min() && rhs == T(-1))
+                        return Op == Op_::Div ? lhs : T(0);
+                }
+                if constexpr(Op == Op_::Div)
+                    return static_cast<T>(lhs / rhs);
+                else
+                    return static_cast<T>(lhs % rhs);
+            }
+        }
+        else if constexpr(Op == Op_::Equal)
+            return lhs == rhs;
+        else if constexpr(Op == Op_::NotEqual)
+        {
+            // ordered comparison, like llvm's fcmp one
+            if constexpr(std::is_floating_point_v<T>)
+                return lhs < rhs || lhs > rhs;
+            else
+                return lhs != rhs;
+        }
+        else if constexpr(Op == Op_::Less)
+            return lhs < rhs;
+        else if constexpr(Op == Op_::LessEqual)
+            return lhs <= rhs;
+        else if constexpr(Op == Op_::Greater)
+            return lhs > rhs;
+        else if constexpr(Op == Op_::GreaterEqual)
+            return lhs >= rhs;
+        else if constexpr(!is_int_v<T>)
+        {
+            throw CujException("interpreter: invalid operand type");
+            return lhs;
+        }
+        else if constexpr(Op == Op_::LeftShift || Op == Op_::RightShift)
+        {
+            using U = std::make_unsigned_t<T>;
+            const auto amount = static_cast<uint64_t>(static_cast<U>(rhs));
+            if(amount >= sizeof(T) * 8)
+                return T(0);
+            if constexpr(Op == Op_::LeftShift)
+                return static_cast<T>(static_cast<W>(lhs) << amount);
+            else
+                return static_cast<T>(static_cast<U>(lhs) >> amount);
+        }
+        else if constexpr(Op == Op_::BitwiseAnd)
+            return static_cast<T>(lhs & rhs);
+        else if constexpr(Op == Op_::BitwiseOr)
+            return static_cast<T>(lhs | rhs);
+        else
+            return static_cast<T>(lhs ^ rhs);
+    }
+
+    template<typename T, core::Binary::Op Op>
+    void binary_handler(const Instruction &inst, std::byte *frame)
+    {
+        const T lhs = read<T>(frame, inst.a);
+        const T rhs = read<T>(frame, inst.b);
+        write(frame, inst.dst, apply_binary<T, Op>(lhs, rhs));
+    }
+
+    template<typename T, core::Unary::Op Op>
+    void unary_handler(const Instruction &inst, std::byte *frame)
+    {
+        const T val = read<T>(frame, inst.a);
+        if constexpr(Op == core::Unary::Op::Not)
+            write(frame, inst.dst, !val);
+        else if constexpr(std::is_same_v<T, bool>)
+            throw CujException("interpreter: invalid operand type");
+        else if constexpr(Op == core::Unary::Op::Neg)
+            write(frame, inst.dst, static_cast<T>(-static_cast<wrap_t<T>>(val)));
+        else if constexpr(is_int_v<T>)
+            write(frame, inst.dst, static_cast<T>(~val));
+        else
+            throw CujException("interpreter: invalid operand type");
+    }
+
+    // all memory orders are executed as sequentially consistent.
+    // for CompareExchange, b holds cmp followed by val
+    template<typename T, core::AtomicOperation::Op Op>
+    void atomic_handler(const Instruction &inst, std::byte *frame)
+    {
+        using Op_ = core::AtomicOperation::Op;
+
+        std::atomic_ref<T> dst(*read<T *>(frame, inst.a));
+        T old;
+        if constexpr(Op == Op_::CompareExchange)
+        {
+            old = read<T>(frame, inst.b);
+            dst.compare_exchange_strong(
+                old, read<T>(frame, inst.b + static_cast<uint32_t>(sizeof(T))));
+        }
+        else if constexpr(Op == Op_::Exchange)
+            old = dst.exchange(read<T>(frame, inst.b));
+        else
+        {
+            const T val = read<T>(frame, inst.b);
+            auto apply = [&](T x) -> T
+            {
+                using BOp = core::Binary::Op;
+                if constexpr(Op == Op_::Add)
+                    return apply_binary<T, BOp::Add>(x, val);
+                else if constexpr(Op == Op_::Sub)
+                    return apply_binary<T, BOp::Sub>(x, val);
+                else if constexpr(Op == Op_::Min)
+                    return val < x ? val : x;
+                else if constexpr(Op == Op_::Max)
+                    return val > x ? val : x;
+                else if constexpr(Op == Op_::BitwiseAnd)
+                    return apply_binary<T, BOp::BitwiseAnd>(x, val);
+                else if constexpr(Op == Op_::BitwiseOr)
+                    return apply_binary<T, BOp::BitwiseOr>(x, val);
+                else
+                    return apply_binary<T, BOp::BitwiseXOr>(x, val);
+            };
+            old = dst.load();
+            while(!dst.compare_exchange_weak(old, apply(old)))
+                ;
+        }
+        write(frame, inst.dst, old);
+    }
+
+    template<typename T, T(*F)(T)>
+    void math1_handler(const Instruction &inst, std::byte *frame)
+    {
+        write(frame, inst.dst, F(read<T>(frame, inst.a)));
+    }
+
+    template<typename T, T(*F)(T, T)>
+    void math2_handler(const Instruction &inst, std::byte *frame)
+    {
+        write(frame, inst.dst, F(read<T>(frame, inst.a), read<T>(frame, inst.b)));
+    }
+
+    template<typename T, int32_t(*F)(T)>
+    void classify_handler(const Instruction &inst, std::byte *frame)
+    {
+        write(frame, inst.dst, F(read<T>(frame, inst.a)));
+    }
+
+    template<typename T> T math_abs(T x)       { return std::abs(x); }
+    template<typename T> T math_mod(T x, T y)  { return std::fmod(x, y); }
+    template<typename T> T math_rem(T x, T y)  { return std::remainder(x, y); }
+    template<typename T> T math_exp(T x)       { return std::exp(x); }
+    template<typename T> T math_exp2(T x)      { return std::exp2(x); }
+    template<typename T> T math_exp10(T x)     { return std::pow(T(10), x); }
+    template<typename T> T math_log(T x)       { return std::log(x); }
+    template<typename T> T math_log2(T x)      { return std::log2(x); }
+    template<typename T> T math_log10(T x)     { return std::log10(x); }
+    template<typename T> T math_pow(T x, T y)  { return std::pow(x, y); }
+    template<typename T> T math_sqrt(T x)      { return std::sqrt(x); }
+    template<typename T> T math_rsqrt(T x)     { return 1 / std::sqrt(x); }
+    template<typename T> T math_sin(T x)       { return std::sin(x); }
+    template<typename T> T math_cos(T x)       { return std::cos(x); }
+    template<typename T> T math_tan(T x)       { return std::tan(x); }
+    template<typename T> T math_asin(T x)      { return std::asin(x); }
+    template<typename T> T math_acos(T x)      { return std::acos(x); }
+    template<typename T> T math_atan(T x)      { return std::atan(x); }
+    template<typename T> T math_atan2(T y, T x){ return std::atan2(y, x); }
+    template<typename T> T math_ceil(T x)      { return std::ceil(x); }
+    template<typename T> T math_floor(T x)     { return std::floor(x); }
+    template<typename T> T math_trunc(T x)     { return std::trunc(x); }
+    template<typename T> T math_round(T x)     { return std::round(x); }
+
+    // llvm.minimum/maximum propagate nan
+    template<typename T> T math_min(T x, T y)
+    {
+        if(std::isnan(x) || std::isnan(y))
+            return std::numeric_limits<T>::quiet_NaN();
+        return std::fmin(x, y);
+    }
+
+    template<typename T> T math_max(T x, T y)
+    {
+        if(std::isnan(x) || std::isnan(y))
+            return std::numeric_limits<T>::quiet_NaN();
+        return std::fmax(x, y);
+    }
+
+    template<typename T> int32_t math_isfinite(T x) { return std::isfinite(x); }
+    template<typename T> int32_t math_isinf(T x)    { return std::isinf(x); }
+    template<typename T> int32_t math_isnan(T x)    { return std::isnan(x); }
+
+    // ============================ lowering ============================
+
+    struct TypeLayout
+    {
+        size_t size  = 0;
+        size_t align = 1;
+
+        std::vector<size_t> member_offsets;
+    };
+
+    size_t align_up(size_t x, size_t align)
+    {
+        return (x + align - 1) / align * align;
+    }
+
+    class TypeLayouts
+    {
+    public:
+
+        const TypeLayout &get(const core::Type *type)
+        {
+            if(auto it = layouts_.find(type); it != layouts_.end())
+                return it->second;
+
+            TypeLayout layout = type->match(
+                [&](core::Builtin t)
+            {
+                switch(t)
+                {
+                case core::Builtin::S8:
+                case core::Builtin::U8:
+                case core::Builtin::Char:
+                case core::Builtin::Bool:
+                    return TypeLayout{ 1, 1, {} };
+                case core::Builtin::S16:
+                case core::Builtin::U16:
+                    return TypeLayout{ 2, 2, {} };
+                case core::Builtin::S32:
+                case core::Builtin::U32:
+                case core::Builtin::F32:
+                    return TypeLayout{ 4, 4, {} };
+                case core::Builtin::S64:
+                case core::Builtin::U64:
+                case core::Builtin::F64:
+                    return TypeLayout{ 8, 8, {} };
+                case core::Builtin::Void:
+                    break;
+                }
+                return TypeLayout{ 0, 1, {} };
+            },
+                [&](const core::Struct &t)
+            {
+                TypeLayout ret;
+                for(auto m : t.members)
+                {
+                    auto &member = get(m);
+                    ret.size = align_up(ret.size, member.align);
+                    ret.member_offsets.push_back(ret.size);
+                    ret.size += member.size;
+                    ret.align = (std::max)(ret.align, member.align);
+                }
+                ret.size = align_up(ret.size, ret.align);
+                return ret;
+            },
+                [&](const core::Array &t)
+            {
+                auto &element = get(t.element);
+                return TypeLayout{ element.size * t.size, element.align, {} };
+            },
+                [&](const core::Pointer &)
+            {
+                return TypeLayout{ sizeof(void *), alignof(void *), {} };
+            },
+                [&](const core::Vector &t)
+            {
+                auto &element = get(t.element);
+                return TypeLayout{ element.size * t.size, element.align, {} };
+            });
+
+            return layouts_.insert({ type, std::move(layout) }).first->second;
+        }
+
+        // void pointers are byte pointers
+        size_t get_pointed_size(const core::Type *ptr_type)
+        {
+            auto pointed = ptr_type->as<core::Pointer>().pointed;
+            if(auto b = pointed->as_if<core::Builtin>();
+               b && *b == core::Builtin::Void)
+                return 1;
+            return get(pointed).size;
+        }
+
+    private:
+
+        std::map<const core::Type *, TypeLayout> layouts_;
+    };
+
+    class FunctionLowering
+    {
+    public:
+
+        FunctionLowering(
+            const core::Prog                           &prog,
+            const std::map<const core::Func *, size_t> &func_indices,
+            TypeLayouts                                &layouts);
+
+        void lower(const core::Func &func, FunctionCode &code);
+
+    private:
+
+        uint32_t alloc_frame(size_t size, size_t align);
+
+        uint32_t alloc_temp(size_t size, size_t align);
+
+        uint32_t alloc_temp(const core::Type *type);
+
+        uint32_t pc() const;
+
+        void emit(
+            OpCode op, uint32_t dst = 0, uint32_t a = 0, uint32_t b = 0,
+            uint32_t aux = 0, Handler handler = nullptr);
+
+        void emit_compute(
+            Handler handler, uint32_t dst,
+            uint32_t a = 0, uint32_t b = 0, uint32_t aux = 0);
+
+        void emit_trap(std::string message);
+
+        // true when evaluating expr may write memory observed by other
+        // expressions, i.e. it calls a function
+        bool has_call(const core::Expr &expr);
+
+        void lower(const core::Stat &stat);
+        void lower(const core::Store &store);
+        void lower(const core::Block &block);
+        void lower(const core::Return &ret);
+        void lower(const core::If &if_s);
+        void lower(const core::Loop &loop);
+        void lower(const core::Break &break_s);
+        void lower(const core::Continue &continue_s);
+        void lower(const core::Switch &switch_s);
+        void lower(const core::CallFuncStat &call);
+        void lower(const core::VectorStore &store);
+
+        // returns the register holding the value. when dst is given, the
+        // value ends up in dst. when may_alias is true, the returned register
+        // may be a local alloc instead of a copy of it
+        uint32_t lower(
+            const core::Expr &expr, bool may_alias,
+            std::optional<uint32_t> dst = std::nullopt);
+
+        uint32_t lower_call(
+            const core::CallFunc &call, std::optional<uint32_t> dst);
+
+        uint32_t lower_intrinsic(
+            const core::CallFunc &call, std::optional<uint32_t> dst);
+
+        // lower operands left to right. an operand aliasing a local is copied
+        // when a later operand calls a function
+        std::vector<uint32_t> lower_operands(
+            const std::vector<const core::Expr *> &operands);
+
+        uint32_t move_to(
+            uint32_t src, std::optional<uint32_t> dst, size_t size);
+
+        size_t get_value_size(const core::Expr &expr);
+
+        size_t get_call_result_size(const core::CallFunc &call);
+
+        // register of a local alloc or argument addressed by expr
+        std::optional<uint32_t> get_frame_slot(const core::Expr &expr) const;
+
+        const core::Prog                           &prog_;
+        const std::map<const core::Func *, size_t> &func_indices_;
+        TypeLayouts                                &layouts_;
+
+        FunctionCode *code_ = nullptr;
+
+        std::vector<uint32_t> local_offsets_;
+        std::vector<uint32_t> arg_offsets_;
+
+        size_t temp_top_  = 0;
+        size_t temp_size_ = 0;
+
+        std::unordered_map<const core::Expr *, bool> has_call_;
+
+        std::vector<std::vector<uint32_t>> break_jumps_;
+        std::vector<uint32_t>              continue_dsts_;
+    };
+
+    FunctionLowering::FunctionLowering(
+        const core::Prog                           &prog,
+        const std::map<const core::Func *, size_t> &func_indices,
+        TypeLayouts                                &layouts)
+        : prog_(prog), func_indices_(func_indices), layouts_(layouts)
+    {
+
+    }
+
+    void FunctionLowering::lower(const core::Func &func, FunctionCode &code)
+    {
+        code_ = &code;
+
+        for(auto &arg : func.argument_types)
+        {
+            auto &layout = layouts_.get(arg.type);
+            const size_t size = arg.is_reference ? sizeof(void *) : layout.size;
+            const size_t align = arg.is_reference ? alignof(void *) : layout.align;
+            arg_offsets_.push_back(alloc_frame(size, align));
+            code.arg_offsets.push_back(arg_offsets_.back());
+            code.arg_sizes.push_back(static_cast<uint32_t>(size));
+        }
+
+        code.ret_size = func.return_type.is_reference ?
+            sizeof(void *) : layouts_.get(func.return_type.type).size;
+
+        for(auto type : func.local_alloc_types)
+        {
+            auto &layout = layouts_.get(type);
+            local_offsets_.push_back(alloc_frame(layout.size, layout.align));
+        }
+
+        lower(*func.root_block);
+
+        // falling off the end returns zero, like the llvm backend
+        const uint32_t zero = alloc_frame((std::max)(code.ret_size, size_t(1)), 8);
+        emit(OpCode::Return, 0, zero);
+
+        // temporaries are placed after all other frame slots
+        const size_t temp_base = align_up(code.frame_init.size(), 8);
+        auto relocate = [&](uint32_t &reg)
+        {
+            if(reg & TEMP_REGISTER_BIT)
+                reg = static_cast<uint32_t>(temp_base + (reg & ~TEMP_REGISTER_BIT));
+        };
+        for(auto &inst : code.insts)
+        {
+            relocate(inst.dst);
+            relocate(inst.a);
+            relocate(inst.b);
+        }
+        for(auto &site : code.call_sites)
+        {
+            for(auto &a : site.args)
+                relocate(a);
+        }
+        code.frame_size = (std::max<size_t>)(temp_base + temp_size_, 8);
+    }
+
+    uint32_t FunctionLowering::alloc_frame(size_t size, size_t align)
+    {
+        const size_t offset = align_up(code_->frame_init.size(), align);
+        code_->frame_init.resize(offset + size);
+        return static_cast<uint32_t>(offset);
+    }
+
+    uint32_t FunctionLowering::alloc_temp(size_t size, size_t align)
+    {
+        const size_t offset = align_up(temp_top_, align);
+        temp_top_ = offset + size;
+        temp_size_ = (std::max)(temp_size_, temp_top_);
+        return static_cast<uint32_t>(offset) | TEMP_REGISTER_BIT;
+    }
+
+    uint32_t FunctionLowering::alloc_temp(const core::Type *type)
+    {
+        auto &layout = layouts_.get(type);
+        return alloc_temp(layout.size, layout.align);
+    }
+
+    uint32_t FunctionLowering::pc() const
+    {
+        return static_cast<uint32_t>(code_->insts.size());
+    }
+
+    void FunctionLowering::emit(
+        OpCode op, uint32_t dst, uint32_t a, uint32_t b,
+        uint32_t aux, Handler handler)
+    {
+        code_->insts.push_back({ op, dst, a, b, aux, handler });
+    }
+
+    void FunctionLowering::emit_compute(
+        Handler handler, uint32_t dst, uint32_t a, uint32_t b, uint32_t aux)
+    {
+        emit(OpCode::Compute, dst, a, b, aux, handler);
+    }
+
+    void FunctionLowering::emit_trap(std::string message)
+    {
+        emit(OpCode::Trap, 0, 0, 0,
+             static_cast<uint32_t>(code_->trap_messages.size()));
+        code_->trap_messages.push_back(std::move(message));
+    }
+
+    bool FunctionLowering::has_call(const core::Expr &expr)
+    {
+        if(auto it = has_call_.find(&expr); it != has_call_.end())
+            return it->second;
+
+        auto any = [&](std::initializer_list<const core::Expr *> exprs)
+        {
+            for(auto e : exprs)
+            {
+                if(has_call(*e))
+                    return true;
+            }
+            return false;
+        };
+
+        const bool ret = expr.match(
+            [&](const core::Load &e) { return any({ e.src_addr }); },
+            [&](const core::ArithmeticCast &e) { return any({ e.src_val }); },
+            [&](const core::PointerOffset &e)
+        {
+            return any({ e.ptr_val, e.offset_val });
+        },
+            [&](const core::ClassPointerToMemberPointer &e)
+        {
+            return any({ e.class_ptr });
+        },
+            [&](const core::DerefClassPointer &e) { return any({ e.class_ptr }); },
+            [&](const core::DerefArrayPointer &e) { return any({ e.array_ptr }); },
+            [&](const core::SaveClassIntoLocalAlloc &e)
+        {
+            return any({ e.class_val });
+        },
+            [&](const core::SaveArrayIntoLocalAlloc &e)
+        {
+            return any({ e.array_val });
+        },
+            [&](const core::ArrayAddrToFirstElemAddr &e)
+        {
+            return any({ e.array_ptr });
+        },
+            [&](const core::Binary &e) { return any({ e.lhs, e.rhs }); },
+            [&](const core::Unary &e) { return any({ e.val }); },
+            [&](const core::CallFunc &) { return true; },
+            [&](const core::Select &e)
+        {
+            return any({ e.cond, e.true_val, e.false_val });
+        },
+            [&](const core::AtomicOperation &) { return true; },
+            [&](const auto &) { return false; });
+
+        has_call_.insert({ &expr, ret });
+        return ret;
+    }
+
+    void FunctionLowering::lower(const core::Stat &stat)
+    {
+        // temporaries don't live across statements
+        const size_t temp_top = temp_top_;
+        stat.match([&](auto &_s) { lower(_s); });
+        temp_top_ = temp_top;
+    }
+
+    void FunctionLowering::lower(const core::Store &store)
+    {
+        if(auto slot = get_frame_slot(store.dst_addr))
+        {
+            lower(store.val, true, *slot);
+            return;
+        }
+
+        auto operands = lower_operands({ &store.dst_addr, &store.val });
+
+        emit_compute(
+            &store_handler, 0, operands[0], operands[1],
+            static_cast<uint32_t>(get_value_size(store.val)));
+    }
+
+    void FunctionLowering::lower(const core::Block &block)
+    {
+        for(auto s : block.stats)
+            lower(*s);
+    }
+
+    void FunctionLowering::lower(const core::Return &ret)
+    {
+        if(auto builtin = ret.return_type->as_if<core::Builtin>();
+           builtin && *builtin == core::Builtin::Void)
+        {
+            emit(OpCode::Return);
+            return;
+        }
+        emit(OpCode::Return, 0, lower(ret.val, true));
+    }
+
+    void FunctionLowering::lower(const core::If &if_s)
+    {
+        lower(*if_s.calc_cond);
+        const uint32_t cond = lower(if_s.cond, true);
+
+        const uint32_t jump_to_else = pc();
+        emit(OpCode::JumpIfFalse, 0, cond);
+
+        lower(*if_s.then_body);
+
+        if(if_s.else_body)
+        {
+            const uint32_t jump_to_exit = pc();
+            emit(OpCode::Jump);
+            code_->insts[jump_to_else].aux = pc();
+            lower(*if_s.else_body);
+            code_->insts[jump_to_exit].aux = pc();
+        }
+        else
+            code_->insts[jump_to_else].aux = pc();
+    }
+
+    void FunctionLowering::lower(const core::Loop &loop)
+    {
+        const uint32_t start = pc();
+        break_jumps_.emplace_back();
+        continue_dsts_.push_back(start);
+
+        lower(*loop.body);
+        emit(OpCode::Jump, 0, 0, 0, start);
+
+        for(auto j : break_jumps_.back())
+            code_->insts[j].aux = pc();
+        break_jumps_.pop_back();
+        continue_dsts_.pop_back();
+    }
+
+    void FunctionLowering::lower(const core::Break &)
+    {
+        assert(!break_jumps_.empty());
+        break_jumps_.back().push_back(pc());
+        emit(OpCode::Jump);
+    }
+
+    void FunctionLowering::lower(const core::Continue &)
+    {
+        assert(!continue_dsts_.empty());
+        emit(OpCode::Jump, 0, 0, 0, continue_dsts_.back());
+    }
+
+    void FunctionLowering::lower(const core::Switch &switch_s)
+    {
+        const uint32_t value = lower(switch_s.value, true);
+
+        SwitchTable table;
+        table.value_size = static_cast<uint32_t>(get_value_size(switch_s.value));
+
+        const uint32_t table_index =
+            static_cast<uint32_t>(code_->switch_tables.size());
+        emit(OpCode::Switch, 0, value, 0, table_index);
+
+        std::vector<uint32_t> fallthrough_jumps, exit_jumps;
+        for(auto &b : switch_s.branches)
+        {
+            for(auto j : fallthrough_jumps)
+                code_->insts[j].aux = pc();
+            fallthrough_jumps.clear();
+
+            const uint64_t cond = b.cond.value.match(
+                [&]<typename T>(T v)
+            {
+                if constexpr(std::is_floating_point_v<T>)
+                {
+                    throw CujException(
+                        "switch statement requires an integer cond");
+                }
+                uint64_t bits = 0;
+                std::memcpy(&bits, &v, sizeof(T));
+                return bits;
+            });
+            table.cases.push_back({ cond, pc() });
+
+            lower(*b.body);
+            (b.fallthrough ? fallthrough_jumps : exit_jumps).push_back(pc());
+            emit(OpCode::Jump);
+        }
+
+        for(auto j : fallthrough_jumps)
+            code_->insts[j].aux = pc();
+        table.default_pc = pc();
+        if(switch_s.default_body)
+            lower(*switch_s.default_body);
+
+        for(auto j : exit_jumps)
+            code_->insts[j].aux = pc();
+        if(!switch_s.default_body)
+            table.default_pc = pc();
+
+        code_->switch_tables.push_back(std::move(table));
+    }
+
+    void FunctionLowering::lower(const core::CallFuncStat &call)
+    {
+        lower_call(call.call_expr, std::nullopt);
+    }
+
+    void FunctionLowering::lower(const core::VectorStore &)
+    {
+        throw CujException("interpreter: vector types are not supported");
+    }
+
+    uint32_t FunctionLowering::lower(
+        const core::Expr &expr, bool may_alias, std::optional<uint32_t> dst)
+    {
+        auto result = [&](const core::Type *type)
+        {
+            return dst ? *dst : alloc_temp(type);
+        };
+
+        auto result_of_size = [&](size_t size, size_t align)
+        {
+            return dst ? *dst : alloc_temp(size, align);
+        };
+
+        auto pointer_result = [&]
+        {
+            return result_of_size(sizeof(void *), alignof(void *));
+        };
+
+        return expr.match(
+            [&](const core::FuncArgAddr &e)
+        {
+            const uint32_t ret = pointer_result();
+            emit_compute(&frame_addr_handler, ret, arg_offsets_[e.arg_index]);
+            return ret;
+        },
+            [&](const core::LocalAllocAddr &e)
+        {
+            const uint32_t ret = pointer_result();
+            emit_compute(&frame_addr_handler, ret, local_offsets_[e.alloc_index]);
+            return ret;
+        },
+            [&](const core::Load &e)
+        {
+            const size_t size = layouts_.get(e.val_type).size;
+            if(auto slot = get_frame_slot(*e.src_addr))
+            {
+                if(may_alias && !dst)
+                    return *slot;
+                return move_to(*slot, result(e.val_type), size);
+            }
+            const uint32_t ptr = lower(*e.src_addr, true);
+            const uint32_t ret = result(e.val_type);
+            emit_compute(&load_handler, ret, ptr, 0, static_cast<uint32_t>(size));
+            return ret;
+        },
+            [&](const core::Immediate &e)
+        {
+            return e.value.match([&]<typename T>(T v)
+            {
+                const uint32_t slot = alloc_frame(sizeof(T), alignof(T));
+                std::memcpy(code_->frame_init.data() + slot, &v, sizeof(T));
+                if(dst)
+                    return move_to(slot, dst, sizeof(T));
+                return slot;
+            });
+        },
+            [&](const core::NullPtr &)
+        {
+            // frame_init is zero-filled
+            const uint32_t slot = alloc_frame(sizeof(void *), alignof(void *));
+            if(dst)
+                return move_to(slot, dst, sizeof(void *));
+            return slot;
+        },
+            [&](const core::ArithmeticCast &e)
+        {
+            const auto src_type = e.src_type->as<core::Builtin>();
+            const auto dst_type = e.dst_type->as<core::Builtin>();
+            const uint32_t src = lower(*e.src_val, true);
+            if(src_type == dst_type)
+                return move_to(src, dst, layouts_.get(e.src_type).size);
+            const uint32_t ret = result(e.dst_type);
+            auto handler = match_builtin(dst_type, [&]<typename Dst>()
+            {
+                return match_builtin(src_type, [&]<typename Src>()
+                {
+                    return &cast_handler<Dst, Src>;
+                });
+            });
+            emit_compute(handler, ret, src);
+            return ret;
+        },
+            [&](const core::PointerOffset &e)
+        {
+            auto operands = lower_operands({ e.ptr_val, e.offset_val });
+            const uint32_t ret = pointer_result();
+            auto handler = match_builtin(
+                e.offset_type->as<core::Builtin>(), [&]<typename T>() -> Handler
+            {
+                if constexpr(std::is_floating_point_v<T>)
+                    throw CujException("pointer offset must be an integer");
+                else if(e.negative)
+                    return &pointer_offset_handler<T, true>;
+                else
+                    return &pointer_offset_handler<T, false>;
+            });
+            emit_compute(
+                handler, ret, operands[0], operands[1],
+                static_cast<uint32_t>(layouts_.get_pointed_size(e.ptr_type)));
+            return ret;
+        },
+            [&](const core::ClassPointerToMemberPointer &e)
+        {
+            const uint32_t ptr = lower(*e.class_ptr, true);
+            auto class_type = e.class_ptr_type->as<core::Pointer>().pointed;
+            const size_t offset =
+                layouts_.get(class_type).member_offsets[e.member_index];
+            const uint32_t ret = pointer_result();
+            emit_compute(
+                &member_addr_handler, ret, ptr, 0,
+                static_cast<uint32_t>(offset));
+            return ret;
+        },
+            [&](const core::DerefClassPointer &e)
+        {
+            auto type = e.class_ptr_type->as<core::Pointer>().pointed;
+            const uint32_t ptr = lower(*e.class_ptr, true);
+            const uint32_t ret = result(type);
+            emit_compute(
+                &load_handler, ret, ptr, 0,
+                static_cast<uint32_t>(layouts_.get(type).size));
+            return ret;
+        },
+            [&](const core::DerefArrayPointer &e)
+        {
+            auto type = e.array_ptr_type->as<core::Pointer>().pointed;
+            const uint32_t ptr = lower(*e.array_ptr, true);
+            const uint32_t ret = result(type);
+            emit_compute(
+                &load_handler, ret, ptr, 0,
+                static_cast<uint32_t>(layouts_.get(type).size));
+            return ret;
+        },
+            [&](const core::SaveClassIntoLocalAlloc &e)
+        {
+            auto &layout = layouts_.get(
+                e.class_ptr_type->as<core::Pointer>().pointed);
+            const uint32_t slot = alloc_frame(layout.size, layout.align);
+            lower(*e.class_val, true, slot);
+            const uint32_t ret = pointer_result();
+            emit_compute(&frame_addr_handler, ret, slot);
+            return ret;
+        },
+            [&](const core::SaveArrayIntoLocalAlloc &e)
+        {
+            auto &layout = layouts_.get(
+                e.array_ptr_type->as<core::Pointer>().pointed);
+            const uint32_t slot = alloc_frame(layout.size, layout.align);
+            lower(*e.array_val, true, slot);
+            const uint32_t ret = pointer_result();
+            emit_compute(&frame_addr_handler, ret, slot);
+            return ret;
+        },
+            [&](const core::ArrayAddrToFirstElemAddr &e)
+        {
+            const uint32_t ptr = lower(*e.array_ptr, may_alias);
+            return move_to(ptr, dst, sizeof(void *));
+        },
+            [&](const core::Binary &e)
+        {
+            using Op = core::Binary::Op;
+
+            auto operands = lower_operands({ e.lhs, e.rhs });
+            const auto type = e.lhs_type->as<core::Builtin>();
+            const bool is_compare =
+                e.op == Op::Equal || e.op == Op::NotEqual ||
+                e.op == Op::Less || e.op == Op::LessEqual ||
+                e.op == Op::Greater || e.op == Op::GreaterEqual;
+            const uint32_t ret = is_compare ?
+                result_of_size(1, 1) : result(e.lhs_type);
+
+            auto handler = match_builtin(type, [&]<typename T>() -> Handler
+            {
+                switch(e.op)
+                {
+#define CUJ_BINARY_HANDLER(OP) case Op::OP: return &binary_handler<T, Op::OP>
+                CUJ_BINARY_HANDLER(Add);
+                CUJ_BINARY_HANDLER(Sub);
+                CUJ_BINARY_HANDLER(Mul);
+                CUJ_BINARY_HANDLER(Div);
+                CUJ_BINARY_HANDLER(Mod);
+                CUJ_BINARY_HANDLER(Equal);
+                CUJ_BINARY_HANDLER(NotEqual);
+                CUJ_BINARY_HANDLER(Less);
+                CUJ_BINARY_HANDLER(LessEqual);
+                CUJ_BINARY_HANDLER(Greater);
+                CUJ_BINARY_HANDLER(GreaterEqual);
+                CUJ_BINARY_HANDLER(LeftShift);
+                CUJ_BINARY_HANDLER(RightShift);
+                CUJ_BINARY_HANDLER(BitwiseAnd);
+                CUJ_BINARY_HANDLER(BitwiseOr);
+                CUJ_BINARY_HANDLER(BitwiseXOr);
+#undef CUJ_BINARY_HANDLER
+                }
+                unreachable();
+            });
+            emit_compute(handler, ret, operands[0], operands[1]);
+            return ret;
+        },
+            [&](const core::Unary &e)
+        {
+            using Op = core::Unary::Op;
+
+            const uint32_t val = lower(*e.val, true);
+            const uint32_t ret = result(e.val_type);
+            auto handler = match_builtin(
+                e.val_type->as<core::Builtin>(), [&]<typename T>() -> Handler
+            {
+                switch(e.op)
+                {
+                case Op::Neg:        return &unary_handler<T, Op::Neg>;
+                case Op::Not:        return &unary_handler<T, Op::Not>;
+                case Op::BitwiseNot: return &unary_handler<T, Op::BitwiseNot>;
+                }
+                unreachable();
+            });
+            emit_compute(handler, ret, val);
+            return ret;
+        },
+            [&](const core::CallFunc &e)
+        {
+            return lower_call(e, dst);
+        },
+            [&](const core::Select &e)
+        {
+            if(e.cond_type->is<core::Vector>())
+            {
+                throw CujException(
+                    "interpreter: vector types are not supported");
+            }
+
+            // both values are evaluated before choosing one of them
+            auto operands = lower_operands({ e.cond, e.true_val, e.false_val });
+            const uint32_t ret = result(e.val_type);
+            const size_t size = layouts_.get(e.val_type).size;
+
+            const uint32_t jump_to_false = pc();
+            emit(OpCode::JumpIfFalse, 0, operands[0]);
+            emit_compute(
+                &copy_handler, ret, operands[1], 0, static_cast<uint32_t>(size));
+            const uint32_t jump_to_exit = pc();
+            emit(OpCode::Jump);
+            code_->insts[jump_to_false].aux = pc();
+            emit_compute(
+                &copy_handler, ret, operands[2], 0, static_cast<uint32_t>(size));
+            code_->insts[jump_to_exit].aux = pc();
+            return ret;
+        },
+            [&](const core::AtomicOperation &e)
+        {
+            using Op = core::AtomicOperation::Op;
+
+            std::vector<const core::Expr *> args = { e.ptr, e.val };
+            if(e.cmp)
+                args.push_back(e.cmp);
+            auto operands = lower_operands(args);
+
+            const size_t size = layouts_.get(e.val_type).size;
+            uint32_t val = operands[1];
+            if(e.cmp)
+            {
+                val = alloc_temp(2 * size, size);
+                move_to(operands[2], val, size);
+                move_to(operands[1], val + static_cast<uint32_t>(size), size);
+            }
+
+            const uint32_t ret = result(e.val_type);
+            auto handler = match_builtin(
+                e.val_type->as<core::Builtin>(), [&]<typename T>() -> Handler
+            {
+                switch(e.op)
+                {
+#define CUJ_ATOMIC_HANDLER(OP) case Op::OP: return &atomic_handler<T, Op::OP>
+                CUJ_ATOMIC_HANDLER(Add);
+                CUJ_ATOMIC_HANDLER(Sub);
+                CUJ_ATOMIC_HANDLER(Min);
+                CUJ_ATOMIC_HANDLER(Max);
+                CUJ_ATOMIC_HANDLER(BitwiseAnd);
+                CUJ_ATOMIC_HANDLER(BitwiseOr);
+                CUJ_ATOMIC_HANDLER(BitwiseXOr);
+                CUJ_ATOMIC_HANDLER(Exchange);
+                CUJ_ATOMIC_HANDLER(CompareExchange);
+#undef CUJ_ATOMIC_HANDLER
+                }
+                unreachable();
+            });
+            emit_compute(handler, ret, operands[0], val);
+            return ret;
+        },
+            [&](const auto &) -> uint32_t
+        {
+            throw CujException("interpreter: vector types are not supported");
+        });
+    }
+
+    uint32_t FunctionLowering::lower_call(
+        const core::CallFunc &call, std::optional<uint32_t> dst)
+    {
+        if(!call.contextless_func && call.intrinsic != core::Intrinsic::None)
+            return lower_intrinsic(call, dst);
+
+        CallSite site;
+        if(call.contextless_func)
+        {
+            auto it = func_indices_.find(call.contextless_func.get());
+            if(it == func_indices_.end())
+            {
+                throw CujException(
+                    "interpreter: callee " + call.contextless_func->name +
+                    " is not in the program");
+            }
+            site.callee = it->second;
+        }
+        else
+            site.callee = call.contexted_func_index;
+
+        std::vector<const core::Expr *> args(call.args.begin(), call.args.end());
+        site.args = lower_operands(args);
+
+        const uint32_t ret = dst ? *dst : alloc_temp(get_call_result_size(call), 8);
+
+        emit(OpCode::Call, ret, 0, 0,
+             static_cast<uint32_t>(code_->call_sites.size()));
+        code_->call_sites.push_back(std::move(site));
+        return ret;
+    }
+
+    uint32_t FunctionLowering::lower_intrinsic(
+        const core::CallFunc &call, std::optional<uint32_t> dst)
+    {
+        std::vector<const core::Expr *> args(call.args.begin(), call.args.end());
+        auto operands = lower_operands(args);
+        operands.resize(2, 0);
+
+        auto emit_math = [&](Handler handler)
+        {
+            const uint32_t ret = dst ? *dst : alloc_temp(8, 8);
+            emit_compute(handler, ret, operands[0], operands[1]);
+            return ret;
+        };
+
+        switch(call.intrinsic)
+        {
+#define CUJ_MATH1(NAME)                                                         \
+        case core::Intrinsic::f32_##NAME:                                       \
+            return emit_math(&math1_handler<float, &math_##NAME<float>>);       \
+        case core::Intrinsic::f64_##NAME:                                       \
+            return emit_math(&math1_handler<double, &math_##NAME<double>>)
+#define CUJ_MATH2(NAME)                                                         \
+        case core::Intrinsic::f32_##NAME:                                       \
+            return emit_math(&math2_handler<float, &math_##NAME<float>>);       \
+        case core::Intrinsic::f64_##NAME:                                       \
+            return emit_math(&math2_handler<double, &math_##NAME<double>>)
+#define CUJ_CLASSIFY(NAME)                                                      \
+        case core::Intrinsic::f32_##NAME:                                       \
+            return emit_math(&classify_handler<float, &math_##NAME<float>>);    \
+        case core::Intrinsic::f64_##NAME:                                       \
+            return emit_math(&classify_handler<double, &math_##NAME<double>>)
+
+        CUJ_MATH1(abs);
+        CUJ_MATH2(mod);
+        CUJ_MATH2(rem);
+        CUJ_MATH1(exp);
+        CUJ_MATH1(exp2);
+        CUJ_MATH1(exp10);
+        CUJ_MATH1(log);
+        CUJ_MATH1(log2);
+        CUJ_MATH1(log10);
+        CUJ_MATH2(pow);
+        CUJ_MATH1(sqrt);
+        CUJ_MATH1(rsqrt);
+        CUJ_MATH1(sin);
+        CUJ_MATH1(cos);
+        CUJ_MATH1(tan);
+        CUJ_MATH1(asin);
+        CUJ_MATH1(acos);
+        CUJ_MATH1(atan);
+        CUJ_MATH2(atan2);
+        CUJ_MATH1(ceil);
+        CUJ_MATH1(floor);
+        CUJ_MATH1(trunc);
+        CUJ_MATH1(round);
+        CUJ_CLASSIFY(isfinite);
+        CUJ_CLASSIFY(isinf);
+        CUJ_CLASSIFY(isnan);
+        CUJ_MATH2(min);
+        CUJ_MATH2(max);
+
+#undef CUJ_MATH1
+#undef CUJ_MATH2
+#undef CUJ_CLASSIFY
+
+        default:
+            break;
+        }
+
+        // e.g. thread index of ptx. fails only when actually executed
+        emit_trap(
+            std::string("interpreter: unsupported intrinsic ") +
+            core::intrinsic_name(call.intrinsic));
+        return dst ? *dst : alloc_temp(8, 8);
+    }
+
+    std::vector<uint32_t> FunctionLowering::lower_operands(
+        const std::vector<const core::Expr *> &operands)
+    {
+        std::vector<bool> later_call(operands.size(), false);
+        for(size_t i = operands.size(); i > 1; --i)
+            later_call[i - 2] = later_call[i - 1] || has_call(*operands[i - 1]);
+
+        std::vector<uint32_t> ret;
+        ret.reserve(operands.size());
+        for(size_t i = 0; i < operands.size(); ++i)
+            ret.push_back(lower(*operands[i], !later_call[i]));
+        return ret;
+    }
+
+    uint32_t FunctionLowering::move_to(
+        uint32_t src, std::optional<uint32_t> dst, size_t size)
+    {
+        if(!dst || *dst == src)
+            return src;
+        emit_compute(&copy_handler, *dst, src, 0, static_cast<uint32_t>(size));
+        return *dst;
+    }
+
+    size_t FunctionLowering::get_value_size(const core::Expr &expr)
+    {
+        auto pointed_size = [&](const core::Type *ptr_type)
+        {
+            return layouts_.get(ptr_type->as<core::Pointer>().pointed).size;
+        };
+
+        return expr.match(
+            [&](const core::Load &e) { return layouts_.get(e.val_type).size; },
+            [&](const core::Immediate &e)
+        {
+            return e.value.match([](auto v) { return sizeof(v); });
+        },
+            [&](const core::ArithmeticCast &e)
+        {
+            return layouts_.get(e.dst_type).size;
+        },
+            [&](const core::DerefClassPointer &e)
+        {
+            return pointed_size(e.class_ptr_type);
+        },
+            [&](const core::DerefArrayPointer &e)
+        {
+            return pointed_size(e.array_ptr_type);
+        },
+            [&](const core::Binary &e)
+        {
+            using Op = core::Binary::Op;
+            if(e.op == Op::Equal || e.op == Op::NotEqual ||
+               e.op == Op::Less || e.op == Op::LessEqual ||
+               e.op == Op::Greater || e.op == Op::GreaterEqual)
+                return sizeof(bool);
+            return layouts_.get(e.lhs_type).size;
+        },
+            [&](const core::Unary &e)
+        {
+            if(e.op == core::Unary::Op::Not)
+                return sizeof(bool);
+            return layouts_.get(e.val_type).size;
+        },
+            [&](const core::CallFunc &e) { return get_call_result_size(e); },
+            [&](const core::Select &e) { return layouts_.get(e.val_type).size; },
+            [&](const core::AtomicOperation &e)
+        {
+            return layouts_.get(e.val_type).size;
+        },
+            [&](const auto &) { return sizeof(void *); });
+    }
+
+    size_t FunctionLowering::get_call_result_size(const core::CallFunc &call)
+    {
+        const core::Func *callee = nullptr;
+        if(call.contextless_func)
+            callee = call.contextless_func.get();
+        else if(call.intrinsic == core::Intrinsic::None)
+            callee = prog_.funcs[call.contexted_func_index].get();
+        else
+        {
+            const std::string_view name = core::intrinsic_name(call.intrinsic);
+            if(name.ends_with("isfinite") || name.ends_with("isinf") ||
+               name.ends_with("isnan"))
+                return sizeof(int32_t);
+            if(name.starts_with("f64"))
+                return sizeof(double);
+            return sizeof(int32_t);
+        }
+        if(callee->return_type.is_reference)
+            return sizeof(void *);
+        return layouts_.get(callee->return_type.type).size;
+    }
+
+    std::optional<uint32_t> FunctionLowering::get_frame_slot(
+        const core::Expr &expr) const
+    {
+        if(auto e = expr.as_if<core::LocalAllocAddr>())
+            return local_offsets_[e->alloc_index];
+        if(auto e = expr.as_if<core::FuncArgAddr>())
+            return arg_offsets_[e->arg_index];
+        return std::nullopt;
+    }
+
+    // ============================ execution ============================
+
+    // frames and call arguments of nested calls on one thread. chunks are
+    // never moved, so callers' frames stay valid when a callee needs a new
+    // chunk. chunks are kept for later calls
+    class FrameStack : public Uncopyable
+    {
+    public:
+
+        uint64_t *push(size_t words)
+        {
+            // empty frames would confuse pop
+            words = (std::max<size_t>)(words, 1);
+            if(chunks_.empty())
+                chunks_.push_back(new_chunk(words));
+            for(;;)
+            {
+                auto &chunk = chunks_[current_];
+                if(chunk.top + words <= chunk.size)
+                {
+                    uint64_t *ret = chunk.words.get() + chunk.top;
+                    chunk.top += words;
+                    return ret;
+                }
+
+                // chunks after the current one are empty
+                const size_t last_size = chunk.size;
+                if(++current_ == chunks_.size())
+                    chunks_.push_back(new_chunk(2 * last_size));
+                if(chunks_[current_].size < words)
+                    chunks_[current_] = new_chunk(words);
+            }
+        }
+
+        void pop(size_t words)
+        {
+            words = (std::max<size_t>)(words, 1);
+            auto &chunk = chunks_[current_];
+            assert(chunk.top >= words);
+            chunk.top -= words;
+            if(!chunk.top && current_ > 0)
+                --current_;
+        }
+
+    private:
+
+        static constexpr size_t MIN_CHUNK_WORDS = 4096;
+
+        struct Chunk
+        {
+            std::unique_ptr<uint64_t[]> words;
+            size_t                      size = 0;
+            size_t                      top  = 0;
+        };
+
+        static Chunk new_chunk(size_t words)
+        {
+            words = (std::max)(words, MIN_CHUNK_WORDS);
+            return Chunk{ std::make_unique<uint64_t[]>(words), words, 0 };
+        }
+
+        std::vector<Chunk> chunks_;
+        size_t             current_ = 0;
+    };
+
+    FrameStack &get_thread_frame_stack()
+    {
+        static thread_local FrameStack stack;
+        return stack;
+    }
+
+} // namespace anonymous
+
+struct Interpreter::InterpreterData
+{
+    std::vector<Box<FunctionCode>> funcs;
+    std::map<std::string, size_t>  name_to_index;
+};
+
+Interpreter::Interpreter(Interpreter &&other) noexcept
+{
+    std::swap(data_, other.data_);
+}
+
+Interpreter &Interpreter::operator=(Interpreter &&other) noexcept
+{
+    std::swap(data_, other.data_);
+    return *this;
+}
+
+Interpreter::~Interpreter()
+{
+    delete data_;
+}
+
+void Interpreter::generate(const dsl::Module &mod)
+{
+    generate(mod._generate_prog());
+}
+
+void Interpreter::generate(const core::Prog &prog)
+{
+    auto data = newBox<InterpreterData>();
+
+    std::map<const core::Func *, size_t> func_indices;
+    for(size_t i = 0; i < prog.funcs.size(); ++i)
+        func_indices.insert({ prog.funcs[i].get(), i });
+
+    TypeLayouts layouts;
+    for(size_t i = 0; i < prog.funcs.size(); ++i)
+    {
+        auto &func = *prog.funcs[i];
+        auto code = newBox<FunctionCode>();
+
+        code->name = func.name;
+        if(code->name.empty())
+            code->name = "_cuj_function_" + std::to_string(i);
+        if(!data->name_to_index.insert({ code->name, i }).second)
+            throw CujException("multiple definitions of function " + code->name);
+
+        FunctionLowering(prog, func_indices, layouts).lower(func, *code);
+        data->funcs.push_back(std::move(code));
+    }
+
+    delete data_;
+    data_ = data.release();
+}
+
+uint64_t Interpreter::get_call_count(const std::string &symbol_name) const
+{
+    const size_t index = find_function(symbol_name);
+    if(index == static_cast<size_t>(-1))
+        return 0;
+    return data_->funcs[index]->call_count;
+}
+
+void Interpreter::call(size_t func_index, void *ret, void *const *args) const
+{
+    assert(data_ && func_index < data_->funcs.size());
+    auto &code = *data_->funcs[func_index];
+    ++code.call_count;
+
+    auto &stack = get_thread_frame_stack();
+    const size_t frame_words = (code.frame_size + 7) / 8;
+    auto frame = reinterpret_cast<std::byte *>(stack.push(frame_words));
+    CUJ_SCOPE_EXIT{ stack.pop(frame_words); };
+
+    // frames are reused, so clear what the last call left
+    std::memcpy(frame, code.frame_init.data(), code.frame_init.size());
+    std::memset(
+        frame + code.frame_init.size(), 0,
+        frame_words * 8 - code.frame_init.size());
+    for(size_t i = 0; i < code.arg_offsets.size(); ++i)
+        std::memcpy(frame + code.arg_offsets[i], args[i], code.arg_sizes[i]);
+
+    size_t pc = 0;
+    for(;;)
+    {
+        auto &inst = code.insts[pc];
+        switch(inst.op)
+        {
+        case OpCode::Compute:
+            inst.handler(inst, frame);
+            ++pc;
+            break;
+        case OpCode::Jump:
+            pc = inst.aux;
+            break;
+        case OpCode::JumpIfFalse:
+            pc = read<bool>(frame, inst.a) ? pc + 1 : inst.aux;
+            break;
+        case OpCode::Switch:
+        {
+            auto &table = code.switch_tables[inst.aux];
+            uint64_t value = 0;
+            std::memcpy(&value, frame + inst.a, table.value_size);
+            pc = table.default_pc;
+            for(auto &[cond, dst] : table.cases)
+            {
+                if(cond == value)
+                {
+                    pc = dst;
+                    break;
+                }
+            }
+            break;
+        }
+        case OpCode::Call:
+        {
+            auto &site = code.call_sites[inst.aux];
+            static_assert(sizeof(void *) <= sizeof(uint64_t));
+            auto call_args = reinterpret_cast<void **>(
+                stack.push(site.args.size()));
+            CUJ_SCOPE_EXIT{ stack.pop(site.args.size()); };
+            for(size_t i = 0; i < site.args.size(); ++i)
+                call_args[i] = frame + site.args[i];
+            call(site.callee, frame + inst.dst, call_args);
+            ++pc;
+            break;
+        }
+        case OpCode::Return:
+            if(code.ret_size)
+                std::memcpy(ret, frame + inst.a, code.ret_size);
+            return;
+        case OpCode::Trap:
+            throw CujException(code.trap_messages[inst.aux]);
+        }
+    }
+}
+
+size_t Interpreter::find_function(const std::string &symbol_name) const
+{
+    if(!data_)
+        return static_cast<size_t>(-1);
+    auto it = data_->name_to_index.find(symbol_name);
+    if(it == data_->name_to_index.end())
+        return static_cast<size_t>(-1);
+    return it->second;
+}
+
+CUJ_NAMESPACE_END(cuj::gen)
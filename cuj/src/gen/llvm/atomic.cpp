@@ -0,0 +1,381 @@
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable: 4141)
+#pragma warning(disable: 4244)
+#pragma warning(disable: 4624)
+#pragma warning(disable: 4626)
+#pragma warning(disable: 4996)
+#endif
+
+#include <functional>
+
+#include <llvm/IR/IntrinsicsNVPTX.h>
+
+#include <cuj/utils/unreachable.h>
+
+#include "atomic.h"
+
+CUJ_NAMESPACE_BEGIN(cuj::gen)
+
+namespace
+{
+
+    using Op     = core::AtomicOperation::Op;
+    using BinOp  = llvm::AtomicRMWInst::BinOp;
+    using IntrID = llvm::Intrinsic::ID;
+
+    llvm::AtomicOrdering to_llvm_ordering(core::MemoryOrder order)
+    {
+        switch(order)
+        {
+        case core::MemoryOrder::Relaxed:
+            return llvm::AtomicOrdering::Monotonic;
+        case core::MemoryOrder::Acquire:
+            return llvm::AtomicOrdering::Acquire;
+        case core::MemoryOrder::Release:
+            return llvm::AtomicOrdering::Release;
+        case core::MemoryOrder::AcqRel:
+            return llvm::AtomicOrdering::AcquireRelease;
+        case core::MemoryOrder::SeqCst:
+            return llvm::AtomicOrdering::SequentiallyConsistent;
+        }
+        unreachable();
+    }
+
+    // failure ordering of cmpxchg can't be release or acq_rel
+    llvm::AtomicOrdering get_failure_ordering(llvm::AtomicOrdering order)
+    {
+        if(order == llvm::AtomicOrdering::Release)
+            return llvm::AtomicOrdering::Monotonic;
+        if(order == llvm::AtomicOrdering::AcquireRelease)
+            return llvm::AtomicOrdering::Acquire;
+        return order;
+    }
+
+    // ptx atomics are emitted as relaxed instructions surrounded by fences.
+    // scoped atomics other than device ones use the nvvm cta/sys intrinsics
+    class AtomicBuilder
+    {
+    public:
+
+        AtomicBuilder(
+            llvm::IRBuilder<>               &ir_builder,
+            bool                             ptx_target,
+            const core::AtomicOperation     &op,
+            std::vector<llvm::BasicBlock *> &new_blocks);
+
+        llvm::Value *build(llvm::Value *ptr, llvm::Value *val, llvm::Value *cmp);
+
+    private:
+
+        bool is_scoped() const;
+
+        void fence();
+
+        llvm::Value *build_operation(
+            llvm::Value *ptr, llvm::Value *val, llvm::Value *cmp);
+
+        llvm::Value *rmw(
+            BinOp        bin_op,
+            IntrID       cta_intrinsic,
+            IntrID       sys_intrinsic,
+            llvm::Value *ptr,
+            llvm::Value *val);
+
+        // on integers. returns the old value
+        llvm::Value *cas(llvm::Value *ptr, llvm::Value *cmp, llvm::Value *val);
+
+        llvm::Value *cas_loop(
+            llvm::Value                                      *ptr,
+            llvm::Type                                       *val_type,
+            const std::function<llvm::Value*(llvm::Value*)> &compute);
+
+        llvm::Type *get_int_type(llvm::Type *type) const;
+
+        llvm::Value *to_int(llvm::Value *val);
+
+        llvm::Value *to_int_ptr(llvm::Value *ptr, llvm::Type *val_type);
+
+        llvm::Value *from_int(llvm::Value *val, llvm::Type *type);
+
+        llvm::IRBuilder<>               &ir_;
+        bool                             ptx_;
+        const core::AtomicOperation     &op_;
+        std::vector<llvm::BasicBlock *> &new_blocks_;
+
+        llvm::AtomicOrdering order_;
+        bool                 is_float_;
+        bool                 is_signed_;
+    };
+
+    AtomicBuilder::AtomicBuilder(
+        llvm::IRBuilder<>               &ir_builder,
+        bool                             ptx_target,
+        const core::AtomicOperation     &op,
+        std::vector<llvm::BasicBlock *> &new_blocks)
+        : ir_(ir_builder), ptx_(ptx_target), op_(op), new_blocks_(new_blocks)
+    {
+        order_ = ptx_ ? llvm::AtomicOrdering::Monotonic :
+                        to_llvm_ordering(op.order);
+        const auto builtin = op.val_type->as<core::Builtin>();
+        is_float_ = is_floating_point(builtin);
+        is_signed_ = is_signed(builtin);
+    }
+
+    llvm::Value *AtomicBuilder::build(
+        llvm::Value *ptr, llvm::Value *val, llvm::Value *cmp)
+    {
+        using core::MemoryOrder;
+
+        const auto order = op_.order;
+        if(ptx_ && order != MemoryOrder::Relaxed && order != MemoryOrder::Acquire)
+            fence();
+        auto ret = build_operation(ptr, val, cmp);
+        if(ptx_ && order != MemoryOrder::Relaxed && order != MemoryOrder::Release)
+            fence();
+        return ret;
+    }
+
+    bool AtomicBuilder::is_scoped() const
+    {
+        return ptx_ && op_.scope != core::MemoryScope::Device;
+    }
+
+    void AtomicBuilder::fence()
+    {
+        switch(op_.scope)
+        {
+        case core::MemoryScope::Block:
+            ir_.CreateIntrinsic(llvm::Intrinsic::nvvm_membar_cta, {}, {});
+            return;
+        case core::MemoryScope::Device:
+            ir_.CreateIntrinsic(llvm::Intrinsic::nvvm_membar_gl, {}, {});
+            return;
+        case core::MemoryScope::System:
+            ir_.CreateIntrinsic(llvm::Intrinsic::nvvm_membar_sys, {}, {});
+            return;
+        }
+        unreachable();
+    }
+
+    llvm::Value *AtomicBuilder::build_operation(
+        llvm::Value *ptr, llvm::Value *val, llvm::Value *cmp)
+    {
+        namespace I = llvm::Intrinsic;
+
+        switch(op_.op)
+        {
+        case Op::Add:
+            if(is_float_)
+            {
+                return rmw(
+                    BinOp::FAdd, I::nvvm_atomic_add_gen_f_cta,
+                    I::nvvm_atomic_add_gen_f_sys, ptr, val);
+            }
+            return rmw(
+                BinOp::Add, I::nvvm_atomic_add_gen_i_cta,
+                I::nvvm_atomic_add_gen_i_sys, ptr, val);
+        case Op::Sub:
+        {
+            if(!is_scoped())
+            {
+                return rmw(
+                    is_float_ ? BinOp::FSub : BinOp::Sub,
+                    I::not_intrinsic, I::not_intrinsic, ptr, val);
+            }
+            // there is no scoped sub intrinsic
+            if(is_float_)
+            {
+                return rmw(
+                    BinOp::FAdd, I::nvvm_atomic_add_gen_f_cta,
+                    I::nvvm_atomic_add_gen_f_sys, ptr, ir_.CreateFNeg(val));
+            }
+            return rmw(
+                BinOp::Add, I::nvvm_atomic_add_gen_i_cta,
+                I::nvvm_atomic_add_gen_i_sys, ptr, ir_.CreateNeg(val));
+        }
+        case Op::Min:
+        case Op::Max:
+        {
+            const bool is_min = op_.op == Op::Min;
+            if(!is_float_ && is_signed_)
+            {
+                return rmw(
+                    is_min ? BinOp::Min : BinOp::Max,
+                    is_min ? I::nvvm_atomic_min_gen_i_cta :
+                             I::nvvm_atomic_max_gen_i_cta,
+                    is_min ? I::nvvm_atomic_min_gen_i_sys :
+                             I::nvvm_atomic_max_gen_i_sys,
+                    ptr, val);
+            }
+            if(!is_float_ && !is_scoped())
+            {
+                return rmw(
+                    is_min ? BinOp::UMin : BinOp::UMax,
+                    I::not_intrinsic, I::not_intrinsic, ptr, val);
+            }
+            // floats, and unsigned integers with scoped intrinsics
+            return cas_loop(ptr, val->getType(), [&](llvm::Value *old)
+            {
+                llvm::Value *replace;
+                if(is_float_)
+                {
+                    replace = is_min ? ir_.CreateFCmpOLT(val, old) :
+                                       ir_.CreateFCmpOGT(val, old);
+                }
+                else
+                {
+                    replace = is_min ? ir_.CreateICmpULT(val, old) :
+                                       ir_.CreateICmpUGT(val, old);
+                }
+                return ir_.CreateSelect(replace, val, old);
+            });
+        }
+        case Op::BitwiseAnd:
+            return rmw(
+                BinOp::And, I::nvvm_atomic_and_gen_i_cta,
+                I::nvvm_atomic_and_gen_i_sys, ptr, val);
+        case Op::BitwiseOr:
+            return rmw(
+                BinOp::Or, I::nvvm_atomic_or_gen_i_cta,
+                I::nvvm_atomic_or_gen_i_sys, ptr, val);
+        case Op::BitwiseXOr:
+            return rmw(
+                BinOp::Xor, I::nvvm_atomic_xor_gen_i_cta,
+                I::nvvm_atomic_xor_gen_i_sys, ptr, val);
+        case Op::Exchange:
+        {
+            auto old = rmw(
+                BinOp::Xchg, I::nvvm_atomic_exch_gen_i_cta,
+                I::nvvm_atomic_exch_gen_i_sys,
+                to_int_ptr(ptr, val->getType()), to_int(val));
+            return from_int(old, val->getType());
+        }
+        case Op::CompareExchange:
+        {
+            auto old = cas(
+                to_int_ptr(ptr, val->getType()), to_int(cmp), to_int(val));
+            return from_int(old, val->getType());
+        }
+        }
+        unreachable();
+    }
+
+    llvm::Value *AtomicBuilder::rmw(
+        BinOp        bin_op,
+        IntrID       cta_intrinsic,
+        IntrID       sys_intrinsic,
+        llvm::Value *ptr,
+        llvm::Value *val)
+    {
+        if(is_scoped())
+        {
+            const auto intrinsic = op_.scope == core::MemoryScope::Block ?
+                                   cta_intrinsic : sys_intrinsic;
+            return ir_.CreateIntrinsic(
+                intrinsic, { val->getType(), ptr->getType() }, { ptr, val });
+        }
+        return ir_.CreateAtomicRMW(bin_op, ptr, val, order_);
+    }
+
+    llvm::Value *AtomicBuilder::cas(
+        llvm::Value *ptr, llvm::Value *cmp, llvm::Value *val)
+    {
+        if(is_scoped())
+        {
+            const auto intrinsic = op_.scope == core::MemoryScope::Block ?
+                                   llvm::Intrinsic::nvvm_atomic_cas_gen_i_cta :
+                                   llvm::Intrinsic::nvvm_atomic_cas_gen_i_sys;
+            return ir_.CreateIntrinsic(
+                intrinsic, { val->getType(), ptr->getType() }, { ptr, cmp, val });
+        }
+        auto inst = ir_.CreateAtomicCmpXchg(
+            ptr, cmp, val, order_, get_failure_ordering(order_));
+        return ir_.CreateExtractValue(inst, 0);
+    }
+
+    llvm::Value *AtomicBuilder::cas_loop(
+        llvm::Value                                      *ptr,
+        llvm::Type                                       *val_type,
+        const std::function<llvm::Value*(llvm::Value*)> &compute)
+    {
+        auto &context = ir_.getContext();
+        auto func = ir_.GetInsertBlock()->getParent();
+        auto int_type = get_int_type(val_type);
+        auto int_ptr = to_int_ptr(ptr, val_type);
+
+        auto init = ir_.CreateLoad(int_type, int_ptr);
+        init->setAtomic(llvm::AtomicOrdering::Monotonic);
+
+        auto entry_block = ir_.GetInsertBlock();
+        auto loop_block = llvm::BasicBlock::Create(context, "atomic_loop", func);
+        auto exit_block = llvm::BasicBlock::Create(context, "atomic_exit", func);
+        new_blocks_.push_back(loop_block);
+        new_blocks_.push_back(exit_block);
+
+        ir_.CreateBr(loop_block);
+        ir_.SetInsertPoint(loop_block);
+
+        auto old_int = ir_.CreatePHI(int_type, 2);
+        old_int->addIncoming(init, entry_block);
+        auto old = from_int(old_int, val_type);
+        auto new_int = to_int(compute(old));
+        auto loaded = cas(int_ptr, old_int, new_int);
+        old_int->addIncoming(loaded, ir_.GetInsertBlock());
+        ir_.CreateCondBr(
+            ir_.CreateICmpEQ(loaded, old_int), exit_block, loop_block);
+
+        ir_.SetInsertPoint(exit_block);
+        return old;
+    }
+
+    llvm::Type *AtomicBuilder::get_int_type(llvm::Type *type) const
+    {
+        if(type->isIntegerTy())
+            return type;
+        return ir_.getIntNTy(type->getPrimitiveSizeInBits());
+    }
+
+    llvm::Value *AtomicBuilder::to_int(llvm::Value *val)
+    {
+        if(val->getType()->isIntegerTy())
+            return val;
+        return ir_.CreateBitCast(val, get_int_type(val->getType()));
+    }
+
+    llvm::Value *AtomicBuilder::to_int_ptr(llvm::Value *ptr, llvm::Type *val_type)
+    {
+        if(val_type->isIntegerTy())
+            return ptr;
+        auto ptr_type = llvm::PointerType::get(
+            get_int_type(val_type), ptr->getType()->getPointerAddressSpace());
+        return ir_.CreatePointerCast(ptr, ptr_type);
+    }
+
+    llvm::Value *AtomicBuilder::from_int(llvm::Value *val, llvm::Type *type)
+    {
+        if(val->getType() == type)
+            return val;
+        return ir_.CreateBitCast(val, type);
+    }
+
+} // namespace anonymous
+
+llvm::Value *process_atomic_operation(
+    llvm::IRBuilder<>               &ir_builder,
+    bool                             ptx_target,
+    const core::AtomicOperation     &op,
+    llvm::Value                     *ptr,
+    llvm::Value                     *val,
+    llvm::Value                     *cmp,
+    std::vector<llvm::BasicBlock *> &new_blocks)
+{
+    AtomicBuilder builder(ir_builder, ptx_target, op, new_blocks);
+    return builder.build(ptr, val, cmp);
+}
+
+CUJ_NAMESPACE_END(cuj::gen)
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
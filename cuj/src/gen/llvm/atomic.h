@@ -0,0 +1,20 @@
+#pragma once
+
+#include <llvm/IR/IRBuilder.h>
+
+#include <cuj/core/expr.h>
+
+CUJ_NAMESPACE_BEGIN(cuj::gen)
+
+// ptr, val and cmp are generated operands of op. cmp is nullptr when op is not
+// a compare exchange. blocks created by cas loops are appended to new_blocks
+llvm::Value *process_atomic_operation(
+    llvm::IRBuilder<>               &ir_builder,
+    bool                             ptx_target,
+    const core::AtomicOperation     &op,
+    llvm::Value                     *ptr,
+    llvm::Value                     *val,
+    llvm::Value                     *cmp,
+    std::vector<llvm::BasicBlock *> &new_blocks);
+
+CUJ_NAMESPACE_END(cuj::gen)
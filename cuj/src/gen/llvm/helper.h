@@ -2,6 +2,7 @@
 
 #include <iostream>
 
+#include <llvm/IR/Constants.h>
 #include <llvm/Support/CodeGen.h>
 #include <llvm/Support/raw_ostream.h>
 
@@ -14,13 +15,28 @@ namespace llvm_helper
 {
 
     template<typename T>
-    void print(const T &obj)
+    std::string to_string(const T &obj)
     {
         std::string ret;
         llvm::raw_string_ostream ss(ret);
         ss << obj;
         ss.flush();
-        std::cerr << ret << std::endl;
+        return ret;
+    }
+
+    template<typename T>
+    void print(const T &obj)
+    {
+        std::cerr << to_string(obj) << std::endl;
+    }
+
+    // returned as ir text when Options::retain_llvm_ir is off
+    inline const std::string &get_ir_not_retained_message()
+    {
+        static const std::string ret =
+            "; llvm ir is not retained. "
+            "set cuj::gen::Options::retain_llvm_ir to keep it\n";
+        return ret;
     }
 
     inline llvm::Type *builtin_to_llvm_type(llvm::LLVMContext *ctx, core::Builtin builtin) {
@@ -90,6 +106,8 @@ namespace llvm_helper
         case OptimizationLevel::O1: return llvm::CodeGenOpt::Less;
         case OptimizationLevel::O2: return llvm::CodeGenOpt::Default;
         case OptimizationLevel::O3: return llvm::CodeGenOpt::Aggressive;
+        case OptimizationLevel::Os: return llvm::CodeGenOpt::Default;
+        case OptimizationLevel::CompileFast: return llvm::CodeGenOpt::None;
         }
         unreachable();
     }
@@ -1,22 +1,20 @@
-#include <cstring>
+#include <string_view>
 
 #include <cuj/common.h>
 
 CUJ_NAMESPACE_BEGIN(cuj::gen::libdev)
 
-const unsigned char LIBDEVICE_10_BITCODE[] = {
+alignas(16) const unsigned char LIBDEVICE_10_BITCODE[] = {
 #include "./libdevice10.inl"
 };
 
 const size_t LIBDEVICE_10_BITCODE_SIZE = sizeof(LIBDEVICE_10_BITCODE);
 
-std::string get_libdevice_str()
+std::string_view get_libdevice_bitcode()
 {
-    std::string libdev_str;
-    libdev_str.resize(LIBDEVICE_10_BITCODE_SIZE);
-    std::memcpy(
-        libdev_str.data(), LIBDEVICE_10_BITCODE, LIBDEVICE_10_BITCODE_SIZE);
-    return libdev_str;
+    return std::string_view(
+        reinterpret_cast<const char *>(LIBDEVICE_10_BITCODE),
+        LIBDEVICE_10_BITCODE_SIZE);
 }
 
 CUJ_NAMESPACE_END(cuj::gen::libdev)
@@ -9,7 +9,6 @@
 
 #include <llvm/Bitcode/BitcodeReader.h>
 #include <llvm/IR/IRBuilder.h>
-#include <llvm/IR/Verifier.h>
 
 #ifdef _MSC_VER
 #pragma warning(pop)
@@ -19,29 +18,47 @@
 
 CUJ_NAMESPACE_BEGIN(cuj::gen::libdev)
 
-std::string get_libdevice_str();
+std::string_view get_libdevice_bitcode();
 
-std::unique_ptr<llvm::Module> new_libdevice10_module(llvm::LLVMContext *context)
+namespace
 {
-    const std::string libdev_str = get_libdevice_str();
 
-    auto parse_result = parseBitcodeFile(
-        llvm::MemoryBufferRef(libdev_str, "libdevice"), *context);
-    if(!parse_result)
+    // context-independent part of the parsed bitcode, shared by all modules
+    const llvm::BitcodeModule &get_libdevice10_bitcode_module()
     {
-        auto err = parse_result.takeError();
-        throw CujException(toString(std::move(err)));
+        static const llvm::BitcodeModule result = []
+        {
+            const auto bitcode = get_libdevice_bitcode();
+            auto parse_result = llvm::getBitcodeModuleList(
+                llvm::MemoryBufferRef(
+                    llvm::StringRef(bitcode.data(), bitcode.size()),
+                    "libdevice"));
+            if(!parse_result)
+            {
+                auto err = parse_result.takeError();
+                throw CujException(llvm::toString(std::move(err)));
+            }
+            if(parse_result->size() != 1)
+                throw CujException("unexpected libdevice bitcode module count");
+            return parse_result->front();
+        }();
+        return result;
     }
 
-    std::unique_ptr<llvm::Module> result;
-    parse_result->swap(result);
+} // namespace anonymous
 
-    std::string err;
-    llvm::raw_string_ostream err_ss(err);
-    if(verifyModule(*result, &err_ss))
-        throw CujException(err);
-
-    return result;
+std::unique_ptr<llvm::Module> new_libdevice10_module(llvm::LLVMContext *context)
+{
+    // BitcodeModule only refers to the bitcode buffer. copy it so that
+    // concurrent generators do not share any reader state
+    auto bitcode_module = get_libdevice10_bitcode_module();
+    auto parse_result = bitcode_module.getLazyModule(*context, false, false);
+    if(!parse_result)
+    {
+        auto err = parse_result.takeError();
+        throw CujException(llvm::toString(std::move(err)));
+    }
+    return std::move(*parse_result);
 }
 
 const char *get_libdevice_function_name(core::Intrinsic intrinsic)
@@ -19,6 +19,8 @@
 
 CUJ_NAMESPACE_BEGIN(cuj::gen::libdev)
 
+// function bodies are not parsed until they are materialized, e.g. by linking
+// with llvm::Linker::LinkOnlyNeeded
 std::unique_ptr<llvm::Module> new_libdevice10_module(llvm::LLVMContext *context);
 
 const char *get_libdevice_function_name(core::Intrinsic);
@@ -7,31 +7,38 @@
 #pragma warning(disable: 4996)
 #endif
 
+#include <chrono>
 #include <stack>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <llvm/IR/BasicBlock.h>
+#include <llvm/IR/CFG.h>
 #include <llvm/IR/Intrinsics.h>
 #include <llvm/IR/IRBuilder.h>
-#include <llvm/IR/LegacyPassManager.h>
 #include <llvm/IR/Verifier.h>
-#include <llvm/Transforms/InstCombine/InstCombine.h>
 #include <llvm/Transforms/IPO/GlobalDCE.h>
-#include <llvm/Transforms/IPO/PassManagerBuilder.h>
-#include <llvm/Transforms/Scalar.h>
-#include <llvm/Transforms/Scalar/GVN.h>
-#include <llvm/Transforms/Utils.h>
-#include <llvm/LinkAllPasses.h>
 
 #include <cuj/gen/llvm.h>
 #include <cuj/utils/scope_guard.h>
 #include <cuj/utils/unreachable.h>
 
+#include "atomic.h"
 #include "helper.h"
 #include "native_intrinsics.h"
+#include "pipeline.h"
 #include "ptx_intrinsics.h"
 
 CUJ_NAMESPACE_BEGIN(cuj::gen)
 
+namespace
+{
+
+    // thread_idx, block_idx and block_dim
+    constexpr unsigned NATIVE_KERNEL_INDEX_ARG_COUNT = 9;
+
+} // namespace anonymous
+
 struct LLVMIRGenerator::LLVMData
 {
     // per module
@@ -39,15 +46,21 @@ struct LLVMIRGenerator::LLVMData
     core::Prog             prog;
     Box<llvm::LLVMContext> context;
 
-    std::map<std::type_index, llvm::Type *>       index_to_llvm_type;
-    std::map<const core::Type *, std::type_index> type_to_index;
+    // types with the same key in different type sets share one llvm type
+    std::unordered_map<const core::Type *, const core::Type *> canonical_types;
+    std::unordered_map<const core::Type *, llvm::Type *>       llvm_types;
 
     Box<llvm::IRBuilder<>> ir_builder;
     Box<llvm::Module>      top_module;
+    Box<llvm::Module>      libdevice_module;
 
     struct FunctionRecord
     {
         llvm::Function *llvm_function;
+
+        // for kernels on the native target, llvm_function runs one thread
+        // and this loops over all threads of a block
+        llvm::Function *native_kernel_entry = nullptr;
     };
 
     std::map<const core::Func *, FunctionRecord> llvm_functions_;
@@ -56,11 +69,29 @@ struct LLVMIRGenerator::LLVMData
 
     llvm::Function *current_function = nullptr;
 
+    bool in_native_kernel = false;
+
     std::vector<llvm::AllocaInst *> local_allocas;
     std::vector<llvm::AllocaInst *> arg_allocas;
 
     std::stack<llvm::BasicBlock *> break_dsts;
     std::stack<llvm::BasicBlock *> continue_dsts;
+
+    // ssa construction of Braun et al., used when direct_ssa_ is set.
+    // var i is local i, var local_allocas.size() + i is argument i.
+    // ssa_var_types[var] is nullptr if var is stored in memory
+
+    using SSADefs = std::unordered_map<llvm::BasicBlock *, llvm::Value *>;
+    using IncompletePhis = std::vector<std::pair<int, llvm::PHINode *>>;
+
+    std::vector<llvm::Type *> ssa_var_types;
+    std::vector<SSADefs>      ssa_defs;
+
+    std::unordered_set<llvm::BasicBlock *>                     sealed_blocks;
+    std::unordered_map<llvm::BasicBlock *, IncompletePhis>     incomplete_phis;
+    std::unordered_set<llvm::PHINode *>                        filling_phis;
+    std::unordered_map<llvm::Value *, llvm::Value *>           replaced_phis;
+    std::vector<llvm::PHINode *>                               removed_phis;
 };
 
 LLVMIRGenerator::~LLVMIRGenerator()
@@ -88,12 +119,44 @@ void LLVMIRGenerator::disable_basic_optimizations()
     basic_optimizations_ = false;
 }
 
+void LLVMIRGenerator::enable_core_optimizations()
+{
+    core_optimizations_ = true;
+}
+
+void LLVMIRGenerator::use_direct_ssa()
+{
+    direct_ssa_ = true;
+}
+
 void LLVMIRGenerator::set_data_layout(llvm::DataLayout *data_layout)
 {
     data_layout_ = data_layout;
 }
 
+void LLVMIRGenerator::set_native_target(
+    std::string triple, std::string cpu, std::string features)
+{
+    native_triple_ = std::move(triple);
+    native_cpu_ = std::move(cpu);
+    native_features_ = std::move(features);
+}
+
 void LLVMIRGenerator::generate(const dsl::Module &mod)
+{
+    generate(mod._generate_prog());
+}
+
+void LLVMIRGenerator::generate(const core::Prog &prog)
+{
+    std::vector<size_t> func_indices(prog.funcs.size());
+    for(size_t i = 0; i < func_indices.size(); ++i)
+        func_indices[i] = i;
+    generate(prog, func_indices);
+}
+
+void LLVMIRGenerator::generate(
+    const core::Prog &prog, const std::vector<size_t> &func_indices)
 {
     assert(!llvm_);
     llvm_ = new LLVMData;
@@ -112,7 +175,7 @@ void LLVMIRGenerator::generate(const dsl::Module &mod)
     if(target_ == Target::PTX)
     {
         llvm_->top_module->setTargetTriple("nvptx64-nvidia-cuda");
-        link_with_libdevice(*llvm_->top_module);
+        llvm_->libdevice_module = new_libdevice_module(*llvm_->top_module);
 
         if(fast_math_)
         {
@@ -120,22 +183,39 @@ void LLVMIRGenerator::generate(const dsl::Module &mod)
                 llvm::Module::Override, "nvvm-reflect-ftz", 1);
         }
     }
+    else if(!native_triple_.empty())
+        llvm_->top_module->setTargetTriple(native_triple_);
 
     if(data_layout_)
         llvm_->top_module->setDataLayout(*data_layout_);
     
-    llvm_->prog = mod._generate_prog();
-    auto &prog = llvm_->prog;
+    if(core_optimizations_)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        core::OptimizationStatistics statistics;
+        llvm_->prog = core::optimize(prog, func_indices, &statistics);
+        const std::chrono::duration<double> duration =
+            std::chrono::steady_clock::now() - start;
+        add_core_pass_statistics(duration.count(), statistics);
+    }
+    else
+        llvm_->prog = prog;
 
     // build llvm types
 
     {
-        auto index_to_type = build_type_to_index(prog);
+        const auto types = collect_canonical_types(llvm_->prog);
 
-        for(auto &[_, type] : index_to_type)
+        for(auto type : types)
             build_llvm_type(type);
 
-        for(auto &[_, type] : index_to_type)
+        for(auto &[type, canonical_type] : llvm_->canonical_types)
+        {
+            if(type != canonical_type)
+                llvm_->llvm_types[type] = llvm_->llvm_types.at(canonical_type);
+        }
+
+        for(auto type : types)
             build_llvm_struct_body(type);
     }
 
@@ -143,31 +223,37 @@ void LLVMIRGenerator::generate(const dsl::Module &mod)
 
     std::set<llvm::Function *> all_functions;
 
-    for(auto &f : prog.funcs)
-        declare_function(f.get());
-
-    for(auto &f : prog.funcs)
-        define_function(f.get());
+    for(auto i : func_indices)
+        declare_function(llvm_->prog.funcs[i].get());
 
-    llvm::legacy::FunctionPassManager fpm(llvm_->top_module.get());
-    fpm.add(llvm::createPromoteMemoryToRegisterPass());
-    fpm.add(llvm::createSROAPass());
+    for(auto i : func_indices)
+        define_function(llvm_->prog.funcs[i].get());
 
-    if(basic_optimizations_)
+    if(llvm_->libdevice_module)
     {
-        fpm.add(llvm::createEarlyCSEPass());
-        fpm.add(llvm::createBasicAAWrapperPass());
-        fpm.add(llvm::createInstructionCombiningPass());
-        fpm.add(llvm::createReassociatePass());
-        fpm.add(llvm::createGVNPass());
-        fpm.add(llvm::createDeadCodeEliminationPass());
-        fpm.add(llvm::createCFGSimplificationPass());
+        link_with_libdevice(
+            *llvm_->top_module, std::move(llvm_->libdevice_module));
     }
 
-    fpm.doInitialization();
+    std::vector<llvm::Function *> generated_functions;
     for(auto &[_, f] : llvm_->llvm_functions_)
-        fpm.run(*f.llvm_function);
-    fpm.doFinalization();
+    {
+        generated_functions.push_back(f.llvm_function);
+        if(f.native_kernel_entry)
+            generated_functions.push_back(f.native_kernel_entry);
+    }
+
+    // with direct ssa, only locals of aggregate or address-taken variables
+    // are left in memory. they are handled by sroa in the later pipeline
+    std::string pipeline = direct_ssa_ ? "" : "mem2reg,sroa";
+    if(basic_optimizations_)
+    {
+        if(direct_ssa_)
+            pipeline = "sroa";
+        pipeline += ",early-cse,instcombine,reassociate,gvn,dce,simplifycfg";
+    }
+    if(!pipeline.empty())
+        run_function_pipeline(generated_functions, pipeline);
 
     if(basic_optimizations_)
     {
@@ -198,16 +284,19 @@ std::string LLVMIRGenerator::get_llvm_string() const
     return result;
 }
 
-std::map<std::type_index, const core::Type *>
-    LLVMIRGenerator::build_type_to_index(const core::Prog &prog)
+std::vector<const core::Type *>
+    LLVMIRGenerator::collect_canonical_types(const core::Prog &prog)
 {
-    std::map<std::type_index, const core::Type *> ret;
+    std::map<core::TypeKey, const core::Type *> key_to_type;
+    std::vector<const core::Type *> ret;
     auto handle_type_set = [&](const core::TypeSet &set)
     {
-        for(auto &[type, index] : set.type_to_index)
+        for(auto &[type, key] : set.type_to_index)
         {
-            llvm_->type_to_index.try_emplace(type, index);
-            ret.try_emplace(index, type);
+            auto [it, inserted] = key_to_type.try_emplace(key, type);
+            if(inserted)
+                ret.push_back(type);
+            llvm_->canonical_types.try_emplace(type, it->second);
         }
     };
 
@@ -223,9 +312,8 @@ std::map<std::type_index, const core::Type *>
 
 llvm::Type *LLVMIRGenerator::build_llvm_type(const core::Type *type)
 {
-    const auto index = llvm_->type_to_index.at(type);
-    if(auto it = llvm_->index_to_llvm_type.find(index);
-       it != llvm_->index_to_llvm_type.end())
+    type = llvm_->canonical_types.at(type);
+    if(auto it = llvm_->llvm_types.find(type); it != llvm_->llvm_types.end())
         return it->second;
 
     auto llvm_type = type->match(
@@ -252,9 +340,15 @@ llvm::Type *LLVMIRGenerator::build_llvm_type(const core::Type *type)
         }
         auto pointed = build_llvm_type(t.pointed);
         return llvm::PointerType::get(pointed, 0);
+    },
+        [&](const core::Vector &t) -> llvm::Type *
+    {
+        auto element = build_llvm_type(t.element);
+        return llvm::FixedVectorType::get(
+            element, static_cast<unsigned>(t.size));
     });
 
-    llvm_->index_to_llvm_type.insert({ index, llvm_type });
+    llvm_->llvm_types.insert({ type, llvm_type });
     return llvm_type;
 }
 
@@ -277,8 +371,7 @@ void LLVMIRGenerator::build_llvm_struct_body(const core::Type *type)
 
 llvm::Type *LLVMIRGenerator::get_llvm_type(const core::Type *type) const
 {
-    const auto index = llvm_->type_to_index.at(type);
-    return llvm_->index_to_llvm_type.at(index);
+    return llvm_->llvm_types.at(type);
 }
 
 llvm::FunctionType *LLVMIRGenerator::get_function_type(const core::Func &func)
@@ -320,19 +413,37 @@ void LLVMIRGenerator::declare_function(const core::Func *func)
             "multiple definitions of function " + symbol_name);
     }
 
+    auto add_target_attributes = [&](llvm::Function *llvm_func)
+    {
+        if(target_ == Target::PTX)
+            llvm_func->addFnAttr("nvptx-f32ftz", "true");
+        else
+        {
+            if(!native_cpu_.empty())
+                llvm_func->addFnAttr("target-cpu", native_cpu_);
+            if(!native_features_.empty())
+                llvm_func->addFnAttr("target-features", native_features_);
+        }
+    };
+
+    if(func->type == core::Func::Kernel && target_ == Target::Native)
+    {
+        declare_native_kernel(func, symbol_name);
+        auto &record = llvm_->llvm_functions_.at(func);
+        add_target_attributes(record.llvm_function);
+        add_target_attributes(record.native_kernel_entry);
+        return;
+    }
+
     auto func_type = get_function_type(*func);
     auto llvm_func = llvm::Function::Create(
         func_type, llvm::GlobalValue::ExternalLinkage,
         symbol_name, llvm_->top_module.get());
-
-    if(target_ == Target::PTX)
-        llvm_func->addFnAttr("nvptx-f32ftz", "true");
+    add_target_attributes(llvm_func);
 
     if(func->type == core::Func::Kernel)
     {
-        if(target_ != Target::PTX)
-            throw CujException("only ptx target supports kernel function");
-
+        assert(target_ == Target::PTX);
         auto one = llvm_helper::llvm_constant_num(*llvm_->context, 1);
         llvm::Metadata *mds[] = {
             llvm::ValueAsMetadata::get(llvm_func),
@@ -349,15 +460,54 @@ void LLVMIRGenerator::declare_function(const core::Func *func)
     llvm_->llvm_functions_.insert({ func, { llvm_func } });
 }
 
+void LLVMIRGenerator::declare_native_kernel(
+    const core::Func *func, const std::string &symbol_name)
+{
+    auto &context = *llvm_->context;
+    auto i32_type = llvm::Type::getInt32Ty(context);
+
+    // the thread function takes kernel arguments followed by
+    // thread_idx, block_idx and block_dim, in the order of core::Intrinsic
+    auto kernel_type = get_function_type(*func);
+    std::vector<llvm::Type *> thread_arg_types(
+        kernel_type->param_begin(), kernel_type->param_end());
+    thread_arg_types.insert(
+        thread_arg_types.end(), NATIVE_KERNEL_INDEX_ARG_COUNT, i32_type);
+    auto thread_type = llvm::FunctionType::get(
+        kernel_type->getReturnType(), thread_arg_types, false);
+
+    auto thread_func = llvm::Function::Create(
+        thread_type, llvm::GlobalValue::InternalLinkage,
+        symbol_name + ".thread", llvm_->top_module.get());
+    thread_func->addFnAttr(llvm::Attribute::AlwaysInline);
+
+    // see gen::NativeKernelEntry
+    auto i8_ptr_type = llvm::Type::getInt8PtrTy(context);
+    auto dim3_ptr_type = llvm::PointerType::get(i32_type, 0);
+    auto entry_type = llvm::FunctionType::get(
+        llvm::Type::getVoidTy(context),
+        { llvm::PointerType::get(i8_ptr_type, 0), dim3_ptr_type, dim3_ptr_type },
+        false);
+
+    auto entry = llvm::Function::Create(
+        entry_type, llvm::GlobalValue::ExternalLinkage,
+        symbol_name, llvm_->top_module.get());
+
+    llvm_->llvm_functions_.insert({ func, { thread_func, entry } });
+}
+
 void LLVMIRGenerator::define_function(const core::Func *func)
 {
     clear_temp_function_data();
-    llvm_->current_function = llvm_->llvm_functions_.at(func).llvm_function;
+    auto &record = llvm_->llvm_functions_.at(func);
+    llvm_->current_function = record.llvm_function;
+    llvm_->in_native_kernel = record.native_kernel_entry != nullptr;
     CUJ_SCOPE_EXIT{ llvm_->current_function = nullptr; };
 
     auto entry_block = llvm::BasicBlock::Create(
         *llvm_->context, "entry", llvm_->current_function);
     llvm_->ir_builder->SetInsertPoint(entry_block);
+    seal_block(entry_block);
 
     generate_local_allocs(func);
 
@@ -365,36 +515,165 @@ void LLVMIRGenerator::define_function(const core::Func *func)
 
     generate_default_ret(func);
 
+    delete_removed_phis();
+
     std::string err_msg;
     llvm::raw_string_ostream err_stream(err_msg);
     if(verifyFunction(*llvm_->current_function, &err_stream))
         throw CujException(err_msg);
+
+    if(record.native_kernel_entry)
+    {
+        generate_native_kernel_entry(func);
+        if(verifyFunction(*record.native_kernel_entry, &err_stream))
+            throw CujException(err_msg);
+    }
+}
+
+void LLVMIRGenerator::generate_native_kernel_entry(const core::Func *func)
+{
+    auto &record = llvm_->llvm_functions_.at(func);
+    auto thread_func = record.llvm_function;
+    auto entry = record.native_kernel_entry;
+
+    auto &context = *llvm_->context;
+    auto &ir_builder = *llvm_->ir_builder;
+    auto i8_ptr_type = llvm::Type::getInt8PtrTy(context);
+    auto i32_type = llvm::Type::getInt32Ty(context);
+    auto zero = llvm::ConstantInt::get(i32_type, 0);
+    auto one = llvm::ConstantInt::get(i32_type, 1);
+
+    ir_builder.SetInsertPoint(
+        llvm::BasicBlock::Create(context, "entry", entry));
+
+    std::vector<llvm::Value *> args;
+    for(size_t i = 0; i < func->argument_types.size(); ++i)
+    {
+        auto arg_type = thread_func->getArg(static_cast<unsigned>(i))->getType();
+        auto arg_ptr = ir_builder.CreateLoad(
+            i8_ptr_type,
+            ir_builder.CreateConstGEP1_64(i8_ptr_type, entry->getArg(0), i));
+        auto typed_arg_ptr = ir_builder.CreatePointerCast(
+            arg_ptr, llvm::PointerType::get(arg_type, 0));
+        args.push_back(ir_builder.CreateLoad(arg_type, typed_arg_ptr));
+    }
+
+    auto load_dim3 = [&](llvm::Value *dim3, llvm::Value **output)
+    {
+        for(int i = 0; i < 3; ++i)
+        {
+            output[i] = ir_builder.CreateLoad(
+                i32_type, ir_builder.CreateConstGEP1_64(i32_type, dim3, i));
+        }
+    };
+
+    llvm::Value *thread_idx[3], *block_idx[3], *block_dim[3];
+    load_dim3(entry->getArg(1), block_idx);
+    load_dim3(entry->getArg(2), block_dim);
+
+    // nested loops over z, y and x. the innermost loop has consecutive
+    // thread indices and is left to the loop vectorizer after inlining
+    auto generate_loop = [&](auto &self, int dim) -> void
+    {
+        if(dim < 0)
+        {
+            auto call_args = args;
+            call_args.insert(call_args.end(), thread_idx, thread_idx + 3);
+            call_args.insert(call_args.end(), block_idx, block_idx + 3);
+            call_args.insert(call_args.end(), block_dim, block_dim + 3);
+            ir_builder.CreateCall(thread_func, call_args);
+            return;
+        }
+
+        auto preheader = ir_builder.GetInsertBlock();
+        auto header = llvm::BasicBlock::Create(context, "thread_loop", entry);
+        auto exit = llvm::BasicBlock::Create(context, "thread_exit", entry);
+        ir_builder.CreateCondBr(
+            ir_builder.CreateICmpSGT(block_dim[dim], zero), header, exit);
+
+        ir_builder.SetInsertPoint(header);
+        auto phi = ir_builder.CreatePHI(i32_type, 2);
+        phi->addIncoming(zero, preheader);
+        thread_idx[dim] = phi;
+
+        self(self, dim - 1);
+
+        auto next = ir_builder.CreateNSWAdd(phi, one);
+        phi->addIncoming(next, ir_builder.GetInsertBlock());
+        ir_builder.CreateCondBr(
+            ir_builder.CreateICmpSLT(next, block_dim[dim]), header, exit);
+
+        ir_builder.SetInsertPoint(exit);
+    };
+    generate_loop(generate_loop, 2);
+
+    ir_builder.CreateRetVoid();
 }
 
 void LLVMIRGenerator::clear_temp_function_data()
 {
     llvm_->current_function = nullptr;
+    llvm_->in_native_kernel = false;
     llvm_->local_allocas.clear();
     llvm_->arg_allocas.clear();
     llvm_->break_dsts = {};
     llvm_->continue_dsts = {};
+    llvm_->ssa_var_types.clear();
+    llvm_->ssa_defs.clear();
+    llvm_->sealed_blocks.clear();
+    llvm_->incomplete_phis.clear();
+    llvm_->filling_phis.clear();
+    llvm_->replaced_phis.clear();
+    delete_removed_phis();
 }
 
 void LLVMIRGenerator::generate_local_allocs(const core::Func *func)
 {
     constexpr int LOCAL_ALLOCA_ADDRESS_SPACE = 0;
 
-    for(size_t i = 0; i < func->local_alloc_types.size(); ++i)
+    core::AddressTakenSlots address_taken;
+    if(direct_ssa_)
+        address_taken = core::find_address_taken_slots(*func);
+
+    auto is_ssa_var = [&](const std::vector<bool> &taken, size_t i, llvm::Type *t)
+    {
+        return direct_ssa_ && !taken[i] &&
+               (t->isIntegerTy() || t->isFloatingPointTy() ||
+                t->isPointerTy() || t->isVectorTy());
+    };
+
+    const size_t local_count = func->local_alloc_types.size();
+    const size_t arg_count = func->argument_types.size();
+    const size_t var_count = local_count + arg_count;
+    llvm_->ssa_var_types.resize(var_count, nullptr);
+    llvm_->ssa_defs.resize(var_count);
+
+    for(size_t i = 0; i < local_count; ++i)
     {
         auto llvm_type = get_llvm_type(func->local_alloc_types[i]);
+        if(is_ssa_var(address_taken.locals, i, llvm_type))
+        {
+            llvm_->ssa_var_types[i] = llvm_type;
+            llvm_->local_allocas.push_back(nullptr);
+            continue;
+        }
         auto alloca_inst = llvm_->ir_builder->CreateAlloca(
             llvm_type, LOCAL_ALLOCA_ADDRESS_SPACE,
             nullptr, "var" + std::to_string(i));
         llvm_->local_allocas.push_back(alloca_inst);
     }
 
-    for(auto &arg : llvm_->current_function->args())
+    for(size_t i = 0; i < arg_count; ++i)
     {
+        auto &arg = *llvm_->current_function->getArg(static_cast<unsigned>(i));
+        if(is_ssa_var(address_taken.args, i, arg.getType()))
+        {
+            const int var = static_cast<int>(local_count + i);
+            llvm_->ssa_var_types[var] = arg.getType();
+            llvm_->arg_allocas.push_back(nullptr);
+            write_ssa_var(var, llvm_->ir_builder->GetInsertBlock(), &arg);
+            continue;
+        }
         auto alloca_inst = llvm_->ir_builder->CreateAlloca(
             arg.getType(), LOCAL_ALLOCA_ADDRESS_SPACE, nullptr);
         llvm_->arg_allocas.push_back(alloca_inst);
@@ -402,6 +681,153 @@ void LLVMIRGenerator::generate_local_allocs(const core::Func *func)
     }
 }
 
+int LLVMIRGenerator::find_ssa_var(const core::Expr &addr) const
+{
+    if(!direct_ssa_)
+        return -1;
+
+    size_t var;
+    if(auto local = addr.as_if<core::LocalAllocAddr>())
+        var = local->alloc_index;
+    else if(auto arg = addr.as_if<core::FuncArgAddr>())
+        var = llvm_->local_allocas.size() + arg->arg_index;
+    else
+        return -1;
+
+    return llvm_->ssa_var_types[var] ? static_cast<int>(var) : -1;
+}
+
+void LLVMIRGenerator::write_ssa_var(
+    int var, llvm::BasicBlock *block, llvm::Value *val)
+{
+    llvm_->ssa_defs[var][block] = val;
+}
+
+llvm::Value *LLVMIRGenerator::read_ssa_var(int var, llvm::BasicBlock *block)
+{
+    auto &defs = llvm_->ssa_defs[var];
+    if(auto it = defs.find(block); it != defs.end())
+        return resolve_ssa_value(it->second);
+    return read_ssa_var_recursive(var, block);
+}
+
+llvm::Value *LLVMIRGenerator::read_ssa_var_recursive(
+    int var, llvm::BasicBlock *block)
+{
+    llvm::Value *val;
+    if(!llvm_->sealed_blocks.contains(block))
+    {
+        // operands are added when block is sealed
+        auto phi = create_ssa_phi(var, block);
+        llvm_->incomplete_phis[block].push_back({ var, phi });
+        val = phi;
+    }
+    else if(auto pred = block->getSinglePredecessor())
+        val = read_ssa_var(var, pred);
+    else if(llvm::pred_empty(block))
+        val = llvm::UndefValue::get(llvm_->ssa_var_types[var]);
+    else
+    {
+        // break cycles by defining the phi before reading operands
+        auto phi = create_ssa_phi(var, block);
+        write_ssa_var(var, block, phi);
+        val = add_ssa_phi_operands(var, phi);
+    }
+    write_ssa_var(var, block, val);
+    return val;
+}
+
+llvm::PHINode *LLVMIRGenerator::create_ssa_phi(int var, llvm::BasicBlock *block)
+{
+    auto type = llvm_->ssa_var_types[var];
+    if(auto first = block->getFirstNonPHI())
+        return llvm::PHINode::Create(type, 2, "", first);
+    return llvm::PHINode::Create(type, 2, "", block);
+}
+
+llvm::Value *LLVMIRGenerator::add_ssa_phi_operands(int var, llvm::PHINode *phi)
+{
+    llvm_->filling_phis.insert(phi);
+    const std::vector<llvm::BasicBlock *> preds(
+        llvm::pred_begin(phi->getParent()), llvm::pred_end(phi->getParent()));
+    for(auto pred : preds)
+        phi->addIncoming(read_ssa_var(var, pred), pred);
+    llvm_->filling_phis.erase(phi);
+    return try_remove_trivial_phi(phi);
+}
+
+llvm::Value *LLVMIRGenerator::try_remove_trivial_phi(llvm::PHINode *phi)
+{
+    llvm::Value *same = nullptr;
+    for(auto &op : phi->incoming_values())
+    {
+        llvm::Value *val = op.get();
+        if(val == same || val == phi)
+            continue;
+        if(same)
+            return phi;
+        same = val;
+    }
+    if(!same)
+        same = llvm::UndefValue::get(phi->getType());
+
+    std::vector<llvm::PHINode *> users;
+    for(auto user : phi->users())
+    {
+        if(auto user_phi = llvm::dyn_cast<llvm::PHINode>(user);
+           user_phi && user_phi != phi)
+            users.push_back(user_phi);
+    }
+
+    // phi may still be recorded as a definition. it is kept alive until
+    // the function is done so that resolve_ssa_value can find its value
+    phi->replaceAllUsesWith(same);
+    phi->dropAllReferences();
+    phi->removeFromParent();
+    llvm_->replaced_phis[phi] = same;
+    llvm_->removed_phis.push_back(phi);
+
+    for(auto user : users)
+    {
+        if(user->getParent() && !llvm_->filling_phis.contains(user))
+            try_remove_trivial_phi(user);
+    }
+
+    return resolve_ssa_value(same);
+}
+
+llvm::Value *LLVMIRGenerator::resolve_ssa_value(llvm::Value *val) const
+{
+    for(auto it = llvm_->replaced_phis.find(val);
+        it != llvm_->replaced_phis.end();
+        it = llvm_->replaced_phis.find(val))
+        val = it->second;
+    return val;
+}
+
+void LLVMIRGenerator::seal_block(llvm::BasicBlock *block)
+{
+    if(!direct_ssa_)
+        return;
+
+    llvm_->sealed_blocks.insert(block);
+    auto it = llvm_->incomplete_phis.find(block);
+    if(it == llvm_->incomplete_phis.end())
+        return;
+
+    auto phis = std::move(it->second);
+    llvm_->incomplete_phis.erase(it);
+    for(auto &[var, phi] : phis)
+        add_ssa_phi_operands(var, phi);
+}
+
+void LLVMIRGenerator::delete_removed_phis()
+{
+    for(auto phi : llvm_->removed_phis)
+        phi->deleteValue();
+    llvm_->removed_phis.clear();
+}
+
 void LLVMIRGenerator::generate_default_ret(const core::Func *func)
 {
     if(func->return_type.is_reference)
@@ -454,6 +880,11 @@ void LLVMIRGenerator::generate_default_ret(const core::Func *func)
             llvm_->ir_builder->CreateRet(
                 llvm::ConstantPointerNull::get(
                     llvm::dyn_cast<llvm::PointerType>(llvm_type)));
+        },
+            [&](const core::Vector &)
+        {
+            llvm_->ir_builder->CreateRet(
+                llvm::Constant::getNullValue(llvm_type));
         });
     }
 }
@@ -465,11 +896,31 @@ void LLVMIRGenerator::generate(const core::Stat &stat)
 
 void LLVMIRGenerator::generate(const core::Store &store)
 {
+    if(auto var = find_ssa_var(store.dst_addr); var >= 0)
+    {
+        write_ssa_var(
+            var, llvm_->ir_builder->GetInsertBlock(), generate(store.val));
+        return;
+    }
+
     auto dst_addr = generate(store.dst_addr);
     auto val = generate(store.val);
     llvm_->ir_builder->CreateStore(val, dst_addr);
 }
 
+void LLVMIRGenerator::generate(const core::VectorStore &store)
+{
+    auto elem_ptr = generate(store.elem_ptr);
+    auto val = generate(store.val);
+    auto mem_type = get_vector_memory_type(store.vector_type);
+    if(mem_type != val->getType())
+        val = llvm_->ir_builder->CreateZExt(val, mem_type);
+    auto vec_ptr = llvm_->ir_builder->CreateBitCast(
+        elem_ptr, mem_type->getPointerTo());
+    llvm_->ir_builder->CreateAlignedStore(
+        val, vec_ptr, get_vector_alignment(store.vector_type, store.aligned));
+}
+
 void LLVMIRGenerator::generate(const core::Block &block)
 {
     for(auto &s : block.stats)
@@ -490,6 +941,7 @@ void LLVMIRGenerator::generate(const core::Return &ret)
     auto block = llvm::BasicBlock::Create(
         *llvm_->context, "after_return", llvm_->current_function);
     llvm_->ir_builder->SetInsertPoint(block);
+    seal_block(block);
 }
 
 void LLVMIRGenerator::generate(const core::If &if_s)
@@ -508,6 +960,7 @@ void LLVMIRGenerator::generate(const core::If &if_s)
 
     llvm_->current_function->getBasicBlockList().push_back(then_block);
     llvm_->ir_builder->SetInsertPoint(then_block);
+    seal_block(then_block);
     generate(*if_s.then_body);
     llvm_->ir_builder->CreateBr(exit_block);
 
@@ -515,12 +968,14 @@ void LLVMIRGenerator::generate(const core::If &if_s)
     {
         llvm_->current_function->getBasicBlockList().push_back(else_block);
         llvm_->ir_builder->SetInsertPoint(else_block);
+        seal_block(else_block);
         generate(*if_s.else_body);
         llvm_->ir_builder->CreateBr(exit_block);
     }
 
     llvm_->current_function->getBasicBlockList().push_back(exit_block);
     llvm_->ir_builder->SetInsertPoint(exit_block);
+    seal_block(exit_block);
 }
 
 void LLVMIRGenerator::generate(const core::Loop &loop)
@@ -537,12 +992,14 @@ void LLVMIRGenerator::generate(const core::Loop &loop)
 
     generate(*loop.body);
     llvm_->ir_builder->CreateBr(body_block);
+    seal_block(body_block);
 
     llvm_->break_dsts.pop();
     llvm_->continue_dsts.pop();
 
     llvm_->current_function->getBasicBlockList().push_back(exit_block);
     llvm_->ir_builder->SetInsertPoint(exit_block);
+    seal_block(exit_block);
 }
 
 void LLVMIRGenerator::generate(const core::Break &break_s)
@@ -554,6 +1011,7 @@ void LLVMIRGenerator::generate(const core::Break &break_s)
         *llvm_->context, "after_break");
     llvm_->current_function->getBasicBlockList().push_back(after_break);
     llvm_->ir_builder->SetInsertPoint(after_break);
+    seal_block(after_break);
 }
 
 void LLVMIRGenerator::generate(const core::Continue &continue_s)
@@ -565,6 +1023,7 @@ void LLVMIRGenerator::generate(const core::Continue &continue_s)
         *llvm_->context, "after_continue");
     llvm_->current_function->getBasicBlockList().push_back(after_continue);
     llvm_->ir_builder->SetInsertPoint(after_continue);
+    seal_block(after_continue);
 }
 
 void LLVMIRGenerator::generate(const core::Switch &switch_s)
@@ -617,6 +1076,7 @@ void LLVMIRGenerator::generate(const core::Switch &switch_s)
         inst->addCase(cond, body_block);
 
         llvm_->ir_builder->SetInsertPoint(body_block);
+        seal_block(body_block);
         generate(*b.body);
 
         llvm::BasicBlock *case_end = end_block;
@@ -631,10 +1091,12 @@ void LLVMIRGenerator::generate(const core::Switch &switch_s)
     if(default_body_block != end_block)
     {
         llvm_->ir_builder->SetInsertPoint(default_body_block);
+        seal_block(default_body_block);
         generate(*switch_s.default_body);
         llvm_->ir_builder->CreateBr(end_block);
     }
     llvm_->ir_builder->SetInsertPoint(end_block);
+    seal_block(end_block);
 }
 
 void LLVMIRGenerator::generate(const core::CallFuncStat &call)
@@ -649,16 +1111,21 @@ llvm::Value *LLVMIRGenerator::generate(const core::Expr &expr)
 
 llvm::Value *LLVMIRGenerator::generate(const core::FuncArgAddr &expr)
 {
+    assert(llvm_->arg_allocas[expr.arg_index]);
     return llvm_->arg_allocas[expr.arg_index];
 }
 
 llvm::Value *LLVMIRGenerator::generate(const core::LocalAllocAddr &expr)
 {
+    assert(llvm_->local_allocas[expr.alloc_index]);
     return llvm_->local_allocas[expr.alloc_index];
 }
 
 llvm::Value *LLVMIRGenerator::generate(const core::Load &expr)
 {
+    if(auto var = find_ssa_var(*expr.src_addr); var >= 0)
+        return read_ssa_var(var, llvm_->ir_builder->GetInsertBlock());
+
     auto ptr = generate(*expr.src_addr);
     return llvm_->ir_builder->CreateLoad(ptr);
 }
@@ -681,8 +1148,8 @@ llvm::Value *LLVMIRGenerator::generate(const core::NullPtr &expr)
 
 llvm::Value *LLVMIRGenerator::generate(const core::ArithmeticCast &expr)
 {
-    auto src_builtin_type = expr.src_type->as<core::Builtin>();
-    auto dst_builtin_type = expr.dst_type->as<core::Builtin>();
+    auto src_builtin_type = core::get_element_builtin(expr.src_type);
+    auto dst_builtin_type = core::get_element_builtin(expr.dst_type);
 
     const bool is_src_int = !is_floating_point(src_builtin_type);
     const bool is_dst_int = !is_floating_point(dst_builtin_type);
@@ -797,8 +1264,8 @@ llvm::Value *LLVMIRGenerator::generate(const core::Binary &expr)
     auto lhs = generate(*expr.lhs);
     auto rhs = generate(*expr.rhs);
 
-    auto lhs_type = expr.lhs_type->as<core::Builtin>();
-    auto rhs_type = expr.rhs_type->as<core::Builtin>();
+    auto lhs_type = core::get_element_builtin(expr.lhs_type);
+    auto rhs_type = core::get_element_builtin(expr.rhs_type);
     assert(lhs_type == rhs_type);
 
     switch(expr.op)
@@ -806,21 +1273,21 @@ llvm::Value *LLVMIRGenerator::generate(const core::Binary &expr)
     case core::Binary::Op::Add:
     {
         assert(lhs_type != core::Builtin::Bool);
-        if(lhs->getType()->isFloatingPointTy())
+        if(lhs->getType()->isFPOrFPVectorTy())
             return llvm_->ir_builder->CreateFAdd(lhs, rhs);
         return llvm_->ir_builder->CreateAdd(lhs, rhs);
     }
     case core::Binary::Op::Sub:
     {
         assert(lhs_type != core::Builtin::Bool);
-        if(lhs->getType()->isFloatingPointTy())
+        if(lhs->getType()->isFPOrFPVectorTy())
             return llvm_->ir_builder->CreateFSub(lhs, rhs);
         return llvm_->ir_builder->CreateSub(lhs, rhs);
     }
     case core::Binary::Op::Mul:
     {
         assert(lhs_type != core::Builtin::Bool);
-        if(lhs->getType()->isFloatingPointTy())
+        if(lhs->getType()->isFPOrFPVectorTy())
             return llvm_->ir_builder->CreateFMul(lhs, rhs);
         return llvm_->ir_builder->CreateMul(lhs, rhs);
     }
@@ -842,19 +1309,19 @@ llvm::Value *LLVMIRGenerator::generate(const core::Binary &expr)
     }
     case core::Binary::Op::Equal:
     {
-        if(lhs->getType()->isFloatingPointTy())
+        if(lhs->getType()->isFPOrFPVectorTy())
             return llvm_->ir_builder->CreateFCmpOEQ(lhs, rhs);
         return llvm_->ir_builder->CreateICmpEQ(lhs, rhs);
     }
     case core::Binary::Op::NotEqual:
     {
-        if(lhs->getType()->isFloatingPointTy())
+        if(lhs->getType()->isFPOrFPVectorTy())
             return llvm_->ir_builder->CreateFCmpONE(lhs, rhs);
         return llvm_->ir_builder->CreateICmpNE(lhs, rhs);
     }
     case core::Binary::Op::Less:
     {
-        if(lhs->getType()->isFloatingPointTy())
+        if(lhs->getType()->isFPOrFPVectorTy())
             return llvm_->ir_builder->CreateFCmpOLT(lhs, rhs);
         if(is_signed(lhs_type))
             return llvm_->ir_builder->CreateICmpSLT(lhs, rhs);
@@ -862,7 +1329,7 @@ llvm::Value *LLVMIRGenerator::generate(const core::Binary &expr)
     }
     case core::Binary::Op::LessEqual:
     {
-        if(lhs->getType()->isFloatingPointTy())
+        if(lhs->getType()->isFPOrFPVectorTy())
             return llvm_->ir_builder->CreateFCmpOLE(lhs, rhs);
         if(is_signed(lhs_type))
             return llvm_->ir_builder->CreateICmpSLE(lhs, rhs);
@@ -870,7 +1337,7 @@ llvm::Value *LLVMIRGenerator::generate(const core::Binary &expr)
     }
     case core::Binary::Op::Greater:
     {
-        if(lhs->getType()->isFloatingPointTy())
+        if(lhs->getType()->isFPOrFPVectorTy())
             return llvm_->ir_builder->CreateFCmpOGT(lhs, rhs);
         if(is_signed(lhs_type))
             return llvm_->ir_builder->CreateICmpSGT(lhs, rhs);
@@ -878,7 +1345,7 @@ llvm::Value *LLVMIRGenerator::generate(const core::Binary &expr)
     }
     case core::Binary::Op::GreaterEqual:
     {
-        if(lhs->getType()->isFloatingPointTy())
+        if(lhs->getType()->isFPOrFPVectorTy())
             return llvm_->ir_builder->CreateFCmpOGE(lhs, rhs);
         if(is_signed(lhs_type))
             return llvm_->ir_builder->CreateICmpSGE(lhs, rhs);
@@ -918,7 +1385,7 @@ llvm::Value *LLVMIRGenerator::generate(const core::Binary &expr)
 llvm::Value *LLVMIRGenerator::generate(const core::Unary &expr)
 {
     auto val = generate(*expr.val);
-    auto val_type = expr.val_type->as<core::Builtin>();
+    auto val_type = core::get_element_builtin(expr.val_type);
 
     switch(expr.op)
     {
@@ -965,17 +1432,193 @@ llvm::Value *LLVMIRGenerator::generate(const core::CallFunc &expr)
     return llvm_->ir_builder->CreateCall(func, args);
 }
 
+llvm::Value *LLVMIRGenerator::generate(const core::Select &expr)
+{
+    auto cond = generate(*expr.cond);
+    auto true_val = generate(*expr.true_val);
+    auto false_val = generate(*expr.false_val);
+    return llvm_->ir_builder->CreateSelect(cond, true_val, false_val);
+}
+
+llvm::Value *LLVMIRGenerator::generate(const core::AtomicOperation &expr)
+{
+    auto ptr = generate(*expr.ptr);
+    auto val = generate(*expr.val);
+    auto cmp = expr.cmp ? generate(*expr.cmp) : nullptr;
+
+    std::vector<llvm::BasicBlock *> new_blocks;
+    auto ret = process_atomic_operation(
+        *llvm_->ir_builder, target_ == Target::PTX,
+        expr, ptr, val, cmp, new_blocks);
+
+    // cas loops are complete once generated
+    for(auto block : new_blocks)
+        seal_block(block);
+    return ret;
+}
+
+llvm::Value *LLVMIRGenerator::generate(const core::VectorBroadcast &expr)
+{
+    auto scalar = generate(*expr.scalar);
+    const auto size = expr.vector_type->as<core::Vector>().size;
+    return llvm_->ir_builder->CreateVectorSplat(
+        static_cast<unsigned>(size), scalar);
+}
+
+llvm::Value *LLVMIRGenerator::generate(const core::VectorExtract &expr)
+{
+    auto vector = generate(*expr.vector);
+    auto index = generate(*expr.index);
+    return llvm_->ir_builder->CreateExtractElement(vector, index);
+}
+
+llvm::Value *LLVMIRGenerator::generate(const core::VectorInsert &expr)
+{
+    auto vector = generate(*expr.vector);
+    auto index = generate(*expr.index);
+    auto element = generate(*expr.element);
+    return llvm_->ir_builder->CreateInsertElement(vector, element, index);
+}
+
+llvm::Value *LLVMIRGenerator::generate(const core::VectorShuffle &expr)
+{
+    auto lhs = generate(*expr.lhs);
+    auto rhs = generate(*expr.rhs);
+    std::vector<int> mask(expr.indices.begin(), expr.indices.end());
+    return llvm_->ir_builder->CreateShuffleVector(lhs, rhs, mask);
+}
+
+llvm::Value *LLVMIRGenerator::generate(const core::VectorReduce &expr)
+{
+    using Op = core::VectorReduce::Op;
+
+    auto builtin = core::get_element_builtin(expr.vector_type);
+    const bool is_float = is_floating_point(builtin);
+    auto &ir = *llvm_->ir_builder;
+
+    auto combine = [&](llvm::Value *a, llvm::Value *b) -> llvm::Value *
+    {
+        switch(expr.op)
+        {
+        case Op::Add:
+            return is_float ? ir.CreateFAdd(a, b) : ir.CreateAdd(a, b);
+        case Op::Mul:
+            return is_float ? ir.CreateFMul(a, b) : ir.CreateMul(a, b);
+        case Op::Min:
+        {
+            auto less = is_float ? ir.CreateFCmpOLT(a, b) :
+                        is_signed(builtin) ? ir.CreateICmpSLT(a, b) :
+                                             ir.CreateICmpULT(a, b);
+            return ir.CreateSelect(less, a, b);
+        }
+        case Op::Max:
+        {
+            auto greater = is_float ? ir.CreateFCmpOGT(a, b) :
+                           is_signed(builtin) ? ir.CreateICmpSGT(a, b) :
+                                                ir.CreateICmpUGT(a, b);
+            return ir.CreateSelect(greater, a, b);
+        }
+        case Op::BitwiseAnd:
+            return ir.CreateAnd(a, b);
+        case Op::BitwiseOr:
+            return ir.CreateOr(a, b);
+        case Op::BitwiseXOr:
+            return ir.CreateXor(a, b);
+        }
+        unreachable();
+    };
+
+    // halve the vector with shuffles while its size is even, then combine
+    // the remaining elements one by one
+    auto vector = generate(*expr.vector);
+    size_t size = expr.vector_type->as<core::Vector>().size;
+    while(size > 1 && size % 2 == 0)
+    {
+        const size_t half = size / 2;
+        std::vector<int> lo_mask(half), hi_mask(half);
+        for(size_t i = 0; i < half; ++i)
+        {
+            lo_mask[i] = static_cast<int>(i);
+            hi_mask[i] = static_cast<int>(i + half);
+        }
+        auto lo = ir.CreateShuffleVector(
+            vector, llvm::UndefValue::get(vector->getType()), lo_mask);
+        auto hi = ir.CreateShuffleVector(
+            vector, llvm::UndefValue::get(vector->getType()), hi_mask);
+        vector = combine(lo, hi);
+        size = half;
+    }
+
+    auto ret = ir.CreateExtractElement(vector, uint64_t(0));
+    for(size_t i = 1; i < size; ++i)
+        ret = combine(ret, ir.CreateExtractElement(vector, uint64_t(i)));
+    return ret;
+}
+
+llvm::Value *LLVMIRGenerator::generate(const core::VectorLoad &expr)
+{
+    auto elem_ptr = generate(*expr.elem_ptr);
+    auto vec_type = get_llvm_type(expr.vector_type);
+    auto mem_type = get_vector_memory_type(expr.vector_type);
+    auto vec_ptr = llvm_->ir_builder->CreateBitCast(
+        elem_ptr, mem_type->getPointerTo());
+    llvm::Value *ret = llvm_->ir_builder->CreateAlignedLoad(
+        mem_type, vec_ptr, get_vector_alignment(expr.vector_type, expr.aligned));
+    if(mem_type != vec_type)
+        ret = llvm_->ir_builder->CreateTrunc(ret, vec_type);
+    return ret;
+}
+
+llvm::Type *LLVMIRGenerator::get_vector_memory_type(
+    const core::Type *vector_type) const
+{
+    auto &vec = vector_type->as<core::Vector>();
+    if(vec.element->as<core::Builtin>() != core::Builtin::Bool)
+        return get_llvm_type(vector_type);
+    return llvm::FixedVectorType::get(
+        llvm::Type::getInt8Ty(*llvm_->context),
+        static_cast<unsigned>(vec.size));
+}
+
+llvm::Align LLVMIRGenerator::get_vector_alignment(
+    const core::Type *vector_type, bool aligned) const
+{
+    auto &vec = vector_type->as<core::Vector>();
+    const uint64_t elem_bytes = std::max<uint64_t>(
+        1, get_llvm_type(vec.element)->getPrimitiveSizeInBits() / 8);
+    if(!aligned)
+        return llvm::Align(elem_bytes);
+    return llvm::Align(llvm::PowerOf2Ceil(elem_bytes * vec.size));
+}
+
 llvm::Value *LLVMIRGenerator::process_intrinsic_call(
     const core::CallFunc &call, const std::vector<llvm::Value*> &args)
 {
     if(target_ == Target::Native)
     {
+        const auto intrinsic = static_cast<int>(call.intrinsic);
+        const auto first_index = static_cast<int>(core::Intrinsic::thread_idx_x);
+        const auto last_index = static_cast<int>(core::Intrinsic::block_dim_z);
+        if(first_index <= intrinsic && intrinsic <= last_index)
+        {
+            if(!llvm_->in_native_kernel)
+            {
+                throw CujException(
+                    std::string(core::intrinsic_name(call.intrinsic)) +
+                    " can only be used in kernel functions");
+            }
+            auto func = llvm_->current_function;
+            return func->getArg(
+                func->arg_size() - NATIVE_KERNEL_INDEX_ARG_COUNT
+                + static_cast<unsigned>(intrinsic - first_index));
+        }
+
         return process_native_intrinsics(
             *llvm_->top_module, *llvm_->ir_builder, call.intrinsic, args);
     }
     assert(target_ == Target::PTX);
     return process_ptx_intrinsics(
-        *llvm_->top_module, *llvm_->ir_builder,
+        *llvm_->top_module, *llvm_->libdevice_module, *llvm_->ir_builder,
         call.intrinsic, args, approx_math_func_);
 }
 
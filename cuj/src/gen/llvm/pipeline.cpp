@@ -0,0 +1,193 @@
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable: 4141)
+#pragma warning(disable: 4244)
+#pragma warning(disable: 4624)
+#pragma warning(disable: 4626)
+#pragma warning(disable: 4996)
+#endif
+
+#include <chrono>
+#include <mutex>
+
+#include <llvm/Config/llvm-config.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Transforms/IPO/AlwaysInliner.h>
+#include <llvm/Transforms/IPO/MergeFunctions.h>
+
+#include "pipeline.h"
+
+CUJ_NAMESPACE_BEGIN(cuj::gen)
+
+namespace
+{
+
+    // cheap cleanups only. no inlining, loop or vectorization passes
+    constexpr char COMPILE_FAST_PIPELINE[] =
+        "function(sroa,early-cse,instcombine,simplifycfg)";
+
+    struct AnalysisManagers
+    {
+        llvm::LoopAnalysisManager     lam;
+        llvm::FunctionAnalysisManager fam;
+        llvm::CGSCCAnalysisManager    cgam;
+        llvm::ModuleAnalysisManager   mam;
+
+        explicit AnalysisManagers(llvm::PassBuilder &pass_builder)
+        {
+            pass_builder.registerModuleAnalyses(mam);
+            pass_builder.registerCGSCCAnalyses(cgam);
+            pass_builder.registerFunctionAnalyses(fam);
+            pass_builder.registerLoopAnalyses(lam);
+            pass_builder.crossRegisterProxies(lam, fam, cgam, mam);
+        }
+    };
+
+    template<typename PassManager>
+    void parse_pipeline(
+        llvm::PassBuilder &pass_builder,
+        PassManager       &pass_manager,
+        const std::string &pipeline)
+    {
+        if(auto err = pass_builder.parsePassPipeline(pass_manager, pipeline))
+        {
+            throw CujException(
+                "invalid llvm pass pipeline '" + pipeline + "': " +
+                llvm::toString(std::move(err)));
+        }
+    }
+
+    struct CompileTimeStatisticsRecord
+    {
+        std::mutex            mutex;
+        CompileTimeStatistics statistics;
+    };
+
+    CompileTimeStatisticsRecord &get_statistics_record()
+    {
+        static CompileTimeStatisticsRecord record;
+        return record;
+    }
+
+} // namespace anonymous
+
+CompileTimeStatistics get_compile_time_statistics()
+{
+    auto &record = get_statistics_record();
+    std::lock_guard lock(record.mutex);
+    return record.statistics;
+}
+
+void clear_compile_time_statistics()
+{
+    auto &record = get_statistics_record();
+    std::lock_guard lock(record.mutex);
+    record.statistics = {};
+}
+
+void add_core_pass_statistics(
+    double seconds, const core::OptimizationStatistics &statistics)
+{
+    auto &record = get_statistics_record();
+    std::lock_guard lock(record.mutex);
+    record.statistics.core_pass_seconds += seconds;
+    record.statistics.merged_exprs      += statistics.merged_exprs;
+    record.statistics.removed_stores    += statistics.removed_stores;
+    record.statistics.removed_stats     += statistics.removed_stats;
+}
+
+void run_optimization_pipeline(
+    llvm::Module        &llvm_module,
+    llvm::TargetMachine *machine,
+    const Options       &opts,
+    bool                 loop_vectorize,
+    bool                 merge_functions)
+{
+    llvm::PipelineTuningOptions tuning_options;
+    tuning_options.LoopVectorization = loop_vectorize;
+    tuning_options.SLPVectorization  = true;
+#if LLVM_VERSION_MAJOR >= 12
+    tuning_options.MergeFunctions    = merge_functions;
+#endif
+
+    llvm::PassBuilder pass_builder(machine, tuning_options);
+#if LLVM_VERSION_MAJOR < 13
+    // newer versions do this in the constructor of PassBuilder
+    if(machine)
+        machine->registerPassBuilderCallbacks(pass_builder, false);
+#endif
+    AnalysisManagers analysis(pass_builder);
+
+    llvm::ModulePassManager passes;
+    if(!opts.llvm_pipeline.empty())
+        parse_pipeline(pass_builder, passes, opts.llvm_pipeline);
+    else
+    {
+        using PassBuilderOptLevel = llvm::PassBuilder::OptimizationLevel;
+        switch(opts.opt_level)
+        {
+        case OptimizationLevel::O0:
+            passes.addPass(llvm::AlwaysInlinerPass());
+            if(merge_functions)
+                passes.addPass(llvm::MergeFunctionsPass());
+            break;
+        case OptimizationLevel::O1:
+            passes = pass_builder.buildPerModuleDefaultPipeline(
+                PassBuilderOptLevel::O1);
+            break;
+        case OptimizationLevel::O2:
+            passes = pass_builder.buildPerModuleDefaultPipeline(
+                PassBuilderOptLevel::O2);
+            break;
+        case OptimizationLevel::O3:
+            passes = pass_builder.buildPerModuleDefaultPipeline(
+                PassBuilderOptLevel::O3);
+            break;
+        case OptimizationLevel::Os:
+            passes = pass_builder.buildPerModuleDefaultPipeline(
+                PassBuilderOptLevel::Os);
+            break;
+        case OptimizationLevel::CompileFast:
+            parse_pipeline(pass_builder, passes, COMPILE_FAST_PIPELINE);
+            break;
+        }
+
+#if LLVM_VERSION_MAJOR < 12
+        // default pipelines have no mergefunc tuning option yet
+        if(merge_functions &&
+           opts.opt_level != OptimizationLevel::O0 &&
+           opts.opt_level != OptimizationLevel::CompileFast)
+            passes.addPass(llvm::MergeFunctionsPass());
+#endif
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    passes.run(llvm_module, analysis.mam);
+    const std::chrono::duration<double> duration =
+        std::chrono::steady_clock::now() - start;
+
+    auto &record = get_statistics_record();
+    std::lock_guard lock(record.mutex);
+    record.statistics.llvm_pass_seconds += duration.count();
+    record.statistics.llvm_pass_modules += 1;
+}
+
+void run_function_pipeline(
+    const std::vector<llvm::Function*> &functions,
+    const std::string                  &pipeline)
+{
+    llvm::PassBuilder pass_builder;
+    AnalysisManagers analysis(pass_builder);
+
+    llvm::FunctionPassManager passes;
+    parse_pipeline(pass_builder, passes, pipeline);
+
+    for(auto f : functions)
+        passes.run(*f, analysis.fam);
+}
+
+CUJ_NAMESPACE_END(cuj::gen)
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
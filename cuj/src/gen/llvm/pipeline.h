@@ -0,0 +1,29 @@
+#pragma once
+
+#include <llvm/IR/Module.h>
+#include <llvm/Target/TargetMachine.h>
+
+#include <cuj/core/optimize.h>
+#include <cuj/gen/option.h>
+
+CUJ_NAMESPACE_BEGIN(cuj::gen)
+
+// run the pipeline selected by opts.opt_level,
+// or opts.llvm_pipeline when it is not empty.
+// merge_functions only applies to the O* levels
+void run_optimization_pipeline(
+    llvm::Module        &llvm_module,
+    llvm::TargetMachine *machine,
+    const Options       &opts,
+    bool                 loop_vectorize,
+    bool                 merge_functions);
+
+// run a textual function pipeline on given functions only
+void run_function_pipeline(
+    const std::vector<llvm::Function*> &functions,
+    const std::string                  &pipeline);
+
+void add_core_pass_statistics(
+    double seconds, const core::OptimizationStatistics &statistics);
+
+CUJ_NAMESPACE_END(cuj::gen)
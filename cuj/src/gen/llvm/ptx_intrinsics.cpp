@@ -16,34 +16,49 @@
 
 CUJ_NAMESPACE_BEGIN(cuj::gen)
 
-void link_with_libdevice(llvm::Module &dest_module)
+std::unique_ptr<llvm::Module> new_libdevice_module(llvm::Module &dest_module)
 {
-    auto &context = dest_module.getContext();
-    auto libdev_module = libdev::new_libdevice10_module(&context);
+    auto libdev_module = libdev::new_libdevice10_module(
+        &dest_module.getContext());
+    libdev_module->setTargetTriple("nvptx64-nvidia-cuda");
+    dest_module.setDataLayout(libdev_module->getDataLayout());
+    return libdev_module;
+}
 
+void link_with_libdevice(
+    llvm::Module &dest_module, std::unique_ptr<llvm::Module> libdevice_module)
+{
+    bool referenced = false;
     std::vector<std::string> libdev_func_names;
-    for(auto &f : *libdev_module)
+    for(auto &f : *libdevice_module)
     {
-        if(!f.isDeclaration())
-            libdev_func_names.push_back(f.getName().str());
+        if(f.isDeclaration())
+            continue;
+        libdev_func_names.push_back(f.getName().str());
+        referenced |= dest_module.getFunction(f.getName()) != nullptr;
     }
+    if(!referenced)
+        return;
 
-    libdev_module->setTargetTriple("nvptx64-nvidia-cuda");
-    dest_module.setDataLayout(libdev_module->getDataLayout());
+    libdevice_module->setDataLayout(dest_module.getDataLayout());
 
-    if(llvm::Linker::linkModules(dest_module, std::move(libdev_module)))
+    // only bodies of referenced functions (and their callees) are
+    // materialized from the bitcode
+    if(llvm::Linker::linkModules(
+        dest_module, std::move(libdevice_module),
+        llvm::Linker::LinkOnlyNeeded))
         throw CujException("failed to link with libdevice");
 
     for(auto &name : libdev_func_names)
     {
-        auto func = dest_module.getFunction(name);
-        assert(func);
-        func->setLinkage(llvm::GlobalValue::InternalLinkage);
+        if(auto func = dest_module.getFunction(name))
+            func->setLinkage(llvm::GlobalValue::InternalLinkage);
     }
 }
 
 llvm::Value *process_ptx_intrinsics(
     llvm::Module                    &top_module,
+    llvm::Module                    &libdevice_module,
     llvm::IRBuilder<>               &ir_builder,
     core::Intrinsic                  intrinsic_type,
     const std::vector<llvm::Value*> &args,
@@ -126,7 +141,15 @@ llvm::Value *process_ptx_intrinsics(
     if(auto func_name = libdev::get_libdevice_function_name(intrinsic_type))
     {
         auto func = top_module.getFunction(func_name);
-        assert(func);
+        if(!func)
+        {
+            auto libdev_func = libdevice_module.getFunction(func_name);
+            assert(libdev_func);
+            func = llvm::Function::Create(
+                libdev_func->getFunctionType(),
+                llvm::GlobalValue::ExternalLinkage, func_name, &top_module);
+            func->setAttributes(libdev_func->getAttributes());
+        }
         if(!func->hasFnAttribute(llvm::Attribute::ReadNone))
             func->addFnAttr(llvm::Attribute::ReadNone);
         return ir_builder.CreateCall(func, args);
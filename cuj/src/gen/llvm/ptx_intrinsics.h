@@ -6,10 +6,17 @@
 
 CUJ_NAMESPACE_BEGIN(cuj::gen)
 
-void link_with_libdevice(llvm::Module &dest_module);
+// lazily loaded libdevice module. called before ir generation so that
+// referenced functions can be declared with matching types
+std::unique_ptr<llvm::Module> new_libdevice_module(llvm::Module &dest_module);
+
+// import referenced libdevice functions into dest_module
+void link_with_libdevice(
+    llvm::Module &dest_module, std::unique_ptr<llvm::Module> libdevice_module);
 
 llvm::Value *process_ptx_intrinsics(
     llvm::Module                    &top_module,
+    llvm::Module                    &libdevice_module,
     llvm::IRBuilder<>               &ir_builder,
     core::Intrinsic                  intrinsic_type,
     const std::vector<llvm::Value*> &args,
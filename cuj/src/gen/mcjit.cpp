@@ -7,23 +7,37 @@
 #pragma warning(disable: 4996)
 #endif
 
-#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
 
-#include <llvm/Analysis/TargetTransformInfo.h>
+#include <llvm/Config/llvm-config.h>
 #include <llvm/ExecutionEngine/ExecutionEngine.h>
+#include <llvm/ExecutionEngine/ObjectCache.h>
+#include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/LegacyPassManager.h>
+#include <llvm/Object/ObjectFile.h>
 #include <llvm/Support/Host.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Process.h>
+#include <llvm/Support/SmallVectorMemoryBuffer.h>
 #include <llvm/Support/TargetRegistry.h>
 #include <llvm/Support/TargetSelect.h>
 #include <llvm/Target/TargetMachine.h>
 #include <llvm/Target/TargetOptions.h>
-#include <llvm/Transforms/IPO/PassManagerBuilder.h>
-#include <llvm/Transforms/IPO.h>
 
+#include <cuj/core/hash.h>
+#include <cuj/core/visit.h>
 #include <cuj/gen/llvm.h>
 #include <cuj/gen/mcjit.h>
 
 #include "llvm/helper.h"
+#include "llvm/pipeline.h"
+#include "native.h"
 
 CUJ_NAMESPACE_BEGIN(cuj::gen)
 
@@ -34,149 +48,959 @@ namespace
     {
         Box<llvm::LLVMContext>  llvm_context;
         Box<llvm::Module>       llvm_module;
-        llvm::TargetMachine    *machine;
+        TargetMachineLease      machine;
+        NativeTarget            native_target;
         llvm::CodeGenOpt::Level codegen_opt;
     };
 
-    llvm::TargetMachine *get_native_target_machine(
-        llvm::CodeGenOpt::Level codegen_opt)
+    LLVMModuleData build_llvm_module(
+        const core::Prog          &prog,
+        const Options             &opts,
+        const std::vector<size_t> *func_indices = nullptr)
     {
-        auto target_triple = llvm::sys::getDefaultTargetTriple();
+        const llvm::CodeGenOpt::Level codegen_opt =
+            llvm_helper::get_codegen_opt_level(opts.opt_level);
+        const auto native_target = get_native_target(opts);
+        auto target_machine = get_native_target_machine(
+            codegen_opt, native_target);
+        auto data_layout = target_machine->createDataLayout();
 
-        std::string err;
-        auto target = llvm::TargetRegistry::lookupTarget(target_triple, err);
-        if(!target)
-            throw CujException(err);
+        LLVMIRGenerator llvm_ir_gen;
+        init_native_ir_generator(
+            llvm_ir_gen, *target_machine.get(), data_layout,
+            native_target, opts);
+        if(func_indices)
+            llvm_ir_gen.generate(prog, *func_indices);
+        else
+            llvm_ir_gen.generate(prog);
+
+        run_optimization_pipeline(
+            *llvm_ir_gen.get_llvm_module(), target_machine.get(), opts,
+            true, should_merge_functions(opts));
 
-        return target->createTargetMachine(
-            target_triple, "generic", {},
-            {}, {}, {}, codegen_opt, true);
+        LLVMModuleData ret;
+        std::tie(ret.llvm_context, ret.llvm_module) =
+            llvm_ir_gen.get_data_ownership();
+        ret.codegen_opt = codegen_opt;
+        ret.native_target = native_target;
+        ret.machine = std::move(target_machine);
+
+        return ret;
     }
 
-    void do_llvm_optimize(
-        llvm::Module *mod, llvm::TargetMachine *tm, const Options &opts)
+    // placeholder module for loading a cached object file.
+    // mcjit requires at least one module to create the execution engine
+    LLVMModuleData build_empty_llvm_module(const Options &opts)
     {
-        llvm::PassManagerBuilder pass_mgr_builder;
-        pass_mgr_builder.OptLevel = static_cast<int>(opts.opt_level);
-        pass_mgr_builder.Inliner = llvm::createFunctionInliningPass(
-            pass_mgr_builder.OptLevel, 0, false);
-        pass_mgr_builder.SLPVectorize = true;
-        pass_mgr_builder.LoopVectorize = true;
-        if(opts.opt_level == OptimizationLevel::O2 ||
-           opts.opt_level == OptimizationLevel::O3)
-            pass_mgr_builder.MergeFunctions = true;
-        else
-            pass_mgr_builder.MergeFunctions = false;
-        tm->adjustPassManager(pass_mgr_builder);
+        LLVMModuleData ret;
+        ret.codegen_opt = llvm_helper::get_codegen_opt_level(opts.opt_level);
+        ret.native_target = get_native_target(opts);
+        ret.machine = get_native_target_machine(
+            ret.codegen_opt, ret.native_target);
+        ret.llvm_context = newBox<llvm::LLVMContext>();
+        ret.llvm_module = newBox<llvm::Module>("cuj", *ret.llvm_context);
+        ret.llvm_module->setDataLayout(ret.machine->createDataLayout());
+        return ret;
+    }
+
+    void hash_codegen_options(core::Hasher &hasher, const Options &opts)
+    {
+        hasher.hash_value(opts.opt_level);
+        hasher.hash_value(opts.fast_math);
+        hasher.hash_value(opts.approx_math_func);
+        hasher.hash_string(opts.llvm_pipeline);
+        hasher.hash_string(opts.native_cpu);
+        hasher.hash_string(opts.native_features);
+    }
 
-        llvm::legacy::FunctionPassManager fp_mgr(mod);
-        pass_mgr_builder.populateFunctionPassManager(fp_mgr);
-        fp_mgr.doInitialization();
-        for(auto &f : mod->functions())
-            fp_mgr.run(f);
-        fp_mgr.doFinalization();
+    // hash names the cache file. hashed_bytes is stored in the file and
+    // compared on load, so that a hash collision is treated as a miss
+    struct ObjectCacheKey
+    {
+        std::string hash;
+        std::string hashed_bytes;
+    };
 
-        llvm::legacy::PassManager passes;
-        passes.add(
-            createTargetTransformInfoWrapperPass(tm->getTargetIRAnalysis()));
-        pass_mgr_builder.populateModulePassManager(passes);
-        passes.run(*mod);
+    ObjectCacheKey get_object_cache_key(
+        const core::Prog &prog, const Options &opts)
+    {
+        ObjectCacheKey ret;
+        core::Hasher hasher;
+        hasher.set_recorder(&ret.hashed_bytes);
+        hasher.hash(prog);
+        hash_codegen_options(hasher, opts);
+        hasher.hash_string(LLVM_VERSION_STRING);
+        hasher.hash_string(llvm::sys::getDefaultTargetTriple());
+        const auto native_target = get_native_target(opts);
+        hasher.hash_string(native_target.cpu);
+        hasher.hash_string(native_target.features);
+        ret.hash = hasher.get_hash_str();
+        return ret;
     }
 
-    LLVMModuleData build_llvm_module(
-        const dsl::Module &mod, const Options &opts)
+    // a cache file holds the size of the hashed bytes as 8 little-endian
+    // bytes, the hashed bytes and then the object file
+    class FileObjectCache : public llvm::ObjectCache
     {
-        std::once_flag init_mcjit;
-        std::call_once(init_mcjit, [] 
+    public:
+
+        FileObjectCache(std::filesystem::path directory, ObjectCacheKey key)
+            : directory_(std::move(directory)), key_(std::move(key))
         {
-            llvm::InitializeNativeTarget();
-            llvm::InitializeNativeTargetAsmPrinter();
-            LLVMLinkInMCJIT();
-        });
 
-        const llvm::CodeGenOpt::Level codegen_opt =
+        }
+
+        bool preload()
+        {
+            auto buffer = llvm::MemoryBuffer::getFile(get_filename().string());
+            if(!buffer)
+                return false;
+
+            const llvm::StringRef data = (*buffer)->getBuffer();
+            if(data.size() < 8)
+                return false;
+            uint64_t key_size = 0;
+            for(int i = 0; i < 8; ++i)
+            {
+                const auto byte = static_cast<uint8_t>(data[i]);
+                key_size |= static_cast<uint64_t>(byte) << (8 * i);
+            }
+            if(key_size != key_.hashed_bytes.size() ||
+               data.size() - 8 < key_size ||
+               data.substr(8, key_size) != key_.hashed_bytes)
+                return false;
+
+            preloaded_ = llvm::MemoryBuffer::getMemBufferCopy(
+                data.substr(8 + key_size), key_.hash);
+            return true;
+        }
+
+        void notifyObjectCompiled(
+            const llvm::Module *m, llvm::MemoryBufferRef obj) override
+        {
+            // failing to write the cache is not an error.
+            // write into a temporary file first so that concurrent readers
+            // never see a partially written object
+            std::error_code ec;
+            std::filesystem::create_directories(directory_, ec);
+            if(ec)
+                return;
+
+            if(m->getModuleIdentifier() != key_.hash)
+                return;
+
+            const auto filename = get_filename();
+            auto tmp_filename = filename;
+            tmp_filename += ".tmp" + std::to_string(
+                llvm::sys::Process::getProcessId()) + "_" + std::to_string(
+                    std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+            {
+                std::ofstream fout(tmp_filename, std::ofstream::binary);
+                if(!fout)
+                    return;
+                const uint64_t key_size = key_.hashed_bytes.size();
+                for(int i = 0; i < 8; ++i)
+                    fout.put(static_cast<char>(key_size >> (8 * i)));
+                fout.write(key_.hashed_bytes.data(), key_.hashed_bytes.size());
+                fout.write(obj.getBufferStart(), obj.getBufferSize());
+                if(!fout)
+                {
+                    fout.close();
+                    std::filesystem::remove(tmp_filename, ec);
+                    return;
+                }
+            }
+
+            std::filesystem::rename(tmp_filename, filename, ec);
+            if(ec)
+                std::filesystem::remove(tmp_filename, ec);
+        }
+
+        std::unique_ptr<llvm::MemoryBuffer> getObject(
+            const llvm::Module *m) override
+        {
+            if(m->getModuleIdentifier() != key_.hash)
+                return nullptr;
+            return std::move(preloaded_);
+        }
+
+    private:
+
+        std::filesystem::path get_filename() const
+        {
+            return directory_ / (key_.hash + ".o");
+        }
+
+        std::filesystem::path directory_;
+        ObjectCacheKey        key_;
+
+        std::unique_ptr<llvm::MemoryBuffer> preloaded_;
+    };
+
+    void add_native_intrinsic_functions(llvm::ExecutionEngine &ee)
+    {
+        for(auto &[name, address] : get_native_intrinsic_symbols())
+            ee.addGlobalMapping(name, reinterpret_cast<uint64_t>(address));
+    }
+
+    int get_compile_thread_count(const Options &opts)
+    {
+        if(opts.compile_threads > 0)
+            return opts.compile_threads;
+        return (std::max)(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+
+    // split functions into at most max_count groups without calls between
+    // groups. functions are weighted by their expression count
+    std::vector<std::vector<size_t>> partition_prog(
+        const core::Prog &prog, int max_count)
+    {
+        const size_t func_count = prog.funcs.size();
+        if(max_count <= 1 || func_count <= 1)
+            return {};
+
+        std::map<const core::Func *, size_t> func_to_index;
+        for(size_t i = 0; i < func_count; ++i)
+            func_to_index.insert({ prog.funcs[i].get(), i });
+
+        std::vector<size_t> parents(func_count);
+        for(size_t i = 0; i < func_count; ++i)
+            parents[i] = i;
+
+        auto find_root = [&](size_t i)
+        {
+            while(parents[i] != i)
+                i = parents[i] = parents[parents[i]];
+            return i;
+        };
+
+        std::vector<size_t> weights(func_count, 0);
+        size_t current_func = 0;
+
+        class WeightVisitor : public core::Visitor<WeightVisitor>
+        {
+        public:
+
+            size_t weight = 0;
+
+            void on_expr(const core::Expr &) { ++weight; }
+        };
+
+        auto on_call_func = [&](const core::CallFunc &call)
+        {
+            size_t callee;
+            if(call.contextless_func)
+                callee = func_to_index.at(call.contextless_func.get());
+            else if(call.intrinsic == core::Intrinsic::None)
+                callee = call.contexted_func_index;
+            else
+                return;
+            parents[find_root(callee)] = find_root(current_func);
+        };
+
+        for(current_func = 0; current_func < func_count; ++current_func)
+        {
+            auto &root_block = *prog.funcs[current_func]->root_block;
+            WeightVisitor weight_visitor;
+            weight_visitor.visit(root_block);
+            weights[current_func] = weight_visitor.weight;
+            core::visit_call_funcs(root_block, on_call_func);
+        }
+
+        // connected components
+
+        std::map<size_t, std::pair<size_t, std::vector<size_t>>> components;
+        for(size_t i = 0; i < func_count; ++i)
+        {
+            auto &component = components[find_root(i)];
+            component.first += weights[i] + 1;
+            component.second.push_back(i);
+        }
+        if(components.size() <= 1)
+            return {};
+
+        std::vector<std::pair<size_t, std::vector<size_t>>> sorted_components;
+        for(auto &[_, component] : components)
+            sorted_components.push_back(std::move(component));
+        std::sort(
+            sorted_components.begin(), sorted_components.end(),
+            [](const auto &a, const auto &b) { return a.first > b.first; });
+
+        // put the heaviest remaining component into the lightest group
+
+        const size_t group_count =
+            (std::min)(static_cast<size_t>(max_count), sorted_components.size());
+        std::vector<std::vector<size_t>> groups(group_count);
+        std::vector<size_t> group_weights(group_count, 0);
+        for(auto &[weight, funcs] : sorted_components)
+        {
+            const size_t group = static_cast<size_t>(std::min_element(
+                group_weights.begin(), group_weights.end()) -
+                group_weights.begin());
+            group_weights[group] += weight;
+            groups[group].insert(groups[group].end(), funcs.begin(), funcs.end());
+        }
+
+        for(auto &g : groups)
+            std::sort(g.begin(), g.end());
+        return groups;
+    }
+
+    llvm::object::OwningBinary<llvm::object::ObjectFile> compile_partition(
+        const core::Prog          &prog,
+        const std::vector<size_t> &func_indices,
+        const Options             &opts,
+        std::string               *llvm_ir)
+    {
+        // each partition uses its own context and leases its own machine
+
+        const auto codegen_opt =
             llvm_helper::get_codegen_opt_level(opts.opt_level);
-        auto target_machine = get_native_target_machine(codegen_opt);
-        auto data_layout = target_machine->createDataLayout();
+        const auto native_target = get_native_target(opts);
+        auto machine = get_native_target_machine(codegen_opt, native_target);
+        auto data_layout = machine->createDataLayout();
 
         LLVMIRGenerator llvm_ir_gen;
-        llvm_ir_gen.disable_basic_optimizations();
-        llvm_ir_gen.set_target(LLVMIRGenerator::Target::Native);
-        if(opts.fast_math)
-            llvm_ir_gen.use_fast_math();
-        if(opts.approx_math_func)
-            llvm_ir_gen.use_approx_math_func();
-        llvm_ir_gen.generate(mod);
+        init_native_ir_generator(
+            llvm_ir_gen, *machine.get(), data_layout, native_target, opts);
+        llvm_ir_gen.generate(prog, func_indices);
 
-        do_llvm_optimize(llvm_ir_gen.get_llvm_module(), target_machine, opts);
+        auto llvm_module = llvm_ir_gen.get_llvm_module();
+        run_optimization_pipeline(
+            *llvm_module, machine.get(), opts,
+            true, should_merge_functions(opts));
 
-        LLVMModuleData ret;
-        std::tie(ret.llvm_context, ret.llvm_module) =
-            llvm_ir_gen.get_data_ownership();
-        ret.codegen_opt = codegen_opt;
-        ret.machine = target_machine;
+        if(llvm_ir)
+            *llvm_ir = llvm_helper::to_string(*llvm_module);
+
+        llvm::SmallVector<char, 0> object_data;
+        llvm::raw_svector_ostream object_stream(object_data);
+        llvm::legacy::PassManager passes;
+        if(machine->addPassesToEmitFile(
+            passes, object_stream, nullptr, llvm::CGFT_ObjectFile))
+            throw CujException("object file emission is not supported");
+        passes.run(*llvm_module);
+
+        auto object_buffer = std::make_unique<llvm::SmallVectorMemoryBuffer>(
+            std::move(object_data));
+        auto object = llvm::object::ObjectFile::createObjectFile(
+            object_buffer->getMemBufferRef());
+        if(!object)
+            throw CujException(llvm::toString(object.takeError()));
 
+        return llvm::object::OwningBinary<llvm::object::ObjectFile>(
+            std::move(*object), std::move(object_buffer));
+    }
+
+    std::vector<llvm::object::OwningBinary<llvm::object::ObjectFile>>
+        compile_partitions(
+            const core::Prog                       &prog,
+            const std::vector<std::vector<size_t>> &partitions,
+            const Options                          &opts,
+            std::string                            *llvm_ir)
+    {
+        const size_t partition_count = partitions.size();
+        std::vector<llvm::object::OwningBinary<llvm::object::ObjectFile>>
+            objects(partition_count);
+        std::vector<std::string>        partition_irs(partition_count);
+        std::vector<std::exception_ptr> exceptions(partition_count);
+
+        std::atomic<size_t> next_partition = 0;
+        auto worker = [&]
+        {
+            for(;;)
+            {
+                const size_t i = next_partition++;
+                if(i >= partition_count)
+                    return;
+                try
+                {
+                    objects[i] = compile_partition(
+                        prog, partitions[i], opts,
+                        llvm_ir ? &partition_irs[i] : nullptr);
+                }
+                catch(...)
+                {
+                    exceptions[i] = std::current_exception();
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for(size_t i = 1; i < partition_count; ++i)
+            threads.emplace_back(worker);
+        worker();
+        for(auto &t : threads)
+            t.join();
+
+        for(auto &e : exceptions)
+        {
+            if(e)
+                std::rethrow_exception(e);
+        }
+
+        if(llvm_ir)
+        {
+            for(auto &ir : partition_irs)
+                *llvm_ir += ir;
+        }
+        return objects;
+    }
+
+    struct CompiledModule
+    {
+        Box<FileObjectCache>       object_cache;
+        Box<llvm::LLVMContext>     llvm_context;
+        Box<llvm::ExecutionEngine> exec_engine;
+    };
+
+    llvm::ExecutionEngine *create_execution_engine(LLVMModuleData &llvm_mod)
+    {
+        std::string err;
+        llvm::EngineBuilder engine_builder(std::move(llvm_mod.llvm_module));
+        engine_builder.setErrorStr(&err);
+        engine_builder.setOptLevel(llvm_mod.codegen_opt);
+
+        // the engine destroys its machine, so it gets a new one instead of
+        // llvm_mod.machine, which goes back to the cache
+        auto engine_machine = create_native_target_machine(
+            llvm_mod.codegen_opt, llvm_mod.native_target);
+        auto exec_engine = engine_builder.create(engine_machine.release());
+        if(!exec_engine)
+            throw CujException(err);
+        return exec_engine;
+    }
+
+    // compiles prog.funcs[i] for i in func_indices, or all functions when
+    // func_indices is null. functions outside the subset must not be called
+    // from it
+    RC<CompiledModule> compile_prog(
+        const core::Prog          &prog,
+        const Options             &opts,
+        std::string               *llvm_ir,
+        const std::vector<size_t> *func_indices = nullptr)
+    {
+        auto ret = newRC<CompiledModule>();
+
+        // the object cache is keyed by whole programs
+        std::string cache_key;
+        if(!opts.object_cache_directory.empty() && !func_indices)
+        {
+            auto key = get_object_cache_key(prog, opts);
+            cache_key = key.hash;
+            ret->object_cache = newBox<FileObjectCache>(
+                opts.object_cache_directory, std::move(key));
+        }
+
+        // parallel compilation doesn't go through the object cache
+        std::vector<std::vector<size_t>> partitions;
+        if(!ret->object_cache)
+            partitions = partition_prog(prog, get_compile_thread_count(opts));
+
+        // no call leaves the subset, so neither does it leave a partition
+        if(func_indices)
+        {
+            std::vector<bool> in_subset(prog.funcs.size(), false);
+            for(auto i : *func_indices)
+                in_subset[i] = true;
+            std::vector<std::vector<size_t>> subset_partitions;
+            for(auto &partition : partitions)
+            {
+                std::vector<size_t> subset_partition;
+                for(auto i : partition)
+                {
+                    if(in_subset[i])
+                        subset_partition.push_back(i);
+                }
+                if(!subset_partition.empty())
+                    subset_partitions.push_back(std::move(subset_partition));
+            }
+            partitions = std::move(subset_partitions);
+        }
+
+        LLVMModuleData llvm_mod;
+        std::vector<llvm::object::OwningBinary<llvm::object::ObjectFile>> objects;
+        if(ret->object_cache && ret->object_cache->preload())
+            llvm_mod = build_empty_llvm_module(opts);
+        else if(partitions.size() > 1)
+        {
+            objects = compile_partitions(prog, partitions, opts, llvm_ir);
+            llvm_mod = build_empty_llvm_module(opts);
+        }
+        else
+        {
+            llvm_mod = build_llvm_module(prog, opts, func_indices);
+            if(llvm_ir)
+                *llvm_ir = llvm_helper::to_string(*llvm_mod.llvm_module);
+        }
+
+        if(!cache_key.empty())
+            llvm_mod.llvm_module->setModuleIdentifier(cache_key);
+        ret->llvm_context = std::move(llvm_mod.llvm_context);
+
+        auto exec_engine = create_execution_engine(llvm_mod);
+        ret->exec_engine.reset(exec_engine);
+
+        if(ret->object_cache)
+            exec_engine->setObjectCache(ret->object_cache.get());
+
+        for(auto &object : objects)
+            exec_engine->addObjectFile(std::move(object));
+
+        add_native_intrinsic_functions(*exec_engine);
+
+        exec_engine->finalizeObject();
         return ret;
     }
 
-    void add_native_intrinsic_functions(llvm::ExecutionEngine &ee)
+    struct CompileCacheKey
+    {
+        uint64_t    hash;
+        std::string hashed_bytes;
+    };
+
+    struct CompileCache
+    {
+        // hashed_bytes is compared on lookup, so that a hash collision is
+        // treated as a miss
+        struct Entry
+        {
+            std::string        hashed_bytes;
+            void              *address;
+            RC<CompiledModule> compiled_module;
+        };
+
+        std::mutex                    mutex;
+        std::map<uint64_t, Entry>     entries;
+        MCJIT::CompileCacheStatistics statistics;
+    };
+
+    CompileCache &get_compile_cache()
+    {
+        static CompileCache cache;
+        return cache;
+    }
+
+    std::vector<CompileCacheKey> get_compile_cache_keys(
+        const core::Prog &prog, const Options &opts)
+    {
+        std::vector<CompileCacheKey> ret(prog.funcs.size());
+        for(size_t i = 0; i < prog.funcs.size(); ++i)
+        {
+            core::Hasher hasher;
+            hasher.set_recorder(&ret[i].hashed_bytes);
+            hasher.hash_canonical(prog, i);
+            hash_codegen_options(hasher, opts);
+            ret[i].hash = hasher.get_hash();
+        }
+        return ret;
+    }
+
+    std::vector<size_t> get_reachable_funcs(
+        const core::Prog &prog, const std::vector<size_t> &roots)
+    {
+        std::map<const core::Func *, size_t> func_to_index;
+        for(size_t i = 0; i < prog.funcs.size(); ++i)
+            func_to_index.insert({ prog.funcs[i].get(), i });
+
+        std::vector<bool> visited(prog.funcs.size(), false);
+        std::vector<size_t> ret;
+        auto add = [&](size_t i)
+        {
+            if(!visited[i])
+            {
+                visited[i] = true;
+                ret.push_back(i);
+            }
+        };
+
+        auto on_call_func = [&](const core::CallFunc &call)
+        {
+            if(call.contextless_func)
+                add(func_to_index.at(call.contextless_func.get()));
+            else if(call.intrinsic == core::Intrinsic::None)
+                add(call.contexted_func_index);
+        };
+
+        for(auto i : roots)
+            add(i);
+        for(size_t i = 0; i < ret.size(); ++i)
+            core::visit_call_funcs(*prog.funcs[ret[i]]->root_block, on_call_func);
+
+        std::sort(ret.begin(), ret.end());
+        return ret;
+    }
+
+    std::string get_tier_slot_name(const std::string &func_name)
+    {
+        return "__cuj_tier_slot_" + func_name;
+    }
+
+    std::string get_tier_counter_name(const std::string &func_name)
+    {
+        return "__cuj_tier_counter_" + func_name;
+    }
+
+    constexpr const char *TIER_UP_NOTIFY_FUNC_NAME = "__cuj_tier_up_notify";
+    constexpr const char *TIER_UP_NOTIFY_ARG_NAME  = "__cuj_tier_up_notify_arg";
+
+    // rename each function to its tier-0 body and create a trampoline with
+    // the original name, which calls whatever its slot currently points to.
+    // calls between tier-0 bodies go through the trampolines as well, so that
+    // they are counted and reach promoted code. with a positive call_threshold,
+    // the call reaching it invokes the tier-up notify function
+    void add_tier_trampolines(
+        llvm::Module &llvm_module, const core::Prog &prog,
+        uint64_t call_threshold)
+    {
+        auto &context = llvm_module.getContext();
+        auto i64_type = llvm::Type::getInt64Ty(context);
+        auto i8_ptr_type = llvm::Type::getInt8PtrTy(context);
+        auto notify_type = llvm::FunctionType::get(
+            llvm::Type::getVoidTy(context), { i8_ptr_type }, false);
+        auto notify_ptr_type = notify_type->getPointerTo();
+
+        // filled after the module is finalized
+        llvm::GlobalVariable *notify_func = nullptr, *notify_arg = nullptr;
+        if(call_threshold)
+        {
+            notify_func = new llvm::GlobalVariable(
+                llvm_module, notify_ptr_type, false,
+                llvm::GlobalValue::ExternalLinkage,
+                llvm::ConstantPointerNull::get(notify_ptr_type),
+                TIER_UP_NOTIFY_FUNC_NAME);
+            notify_arg = new llvm::GlobalVariable(
+                llvm_module, i8_ptr_type, false,
+                llvm::GlobalValue::ExternalLinkage,
+                llvm::ConstantPointerNull::get(i8_ptr_type),
+                TIER_UP_NOTIFY_ARG_NAME);
+        }
+
+        for(auto &func : prog.funcs)
+        {
+            auto body = llvm_module.getFunction(func->name);
+            body->setName("__cuj_tier0_" + func->name);
+
+            auto func_type = body->getFunctionType();
+            auto trampoline = llvm::Function::Create(
+                func_type, llvm::GlobalValue::ExternalLinkage,
+                func->name, &llvm_module);
+            trampoline->copyAttributesFrom(body);
+            body->replaceAllUsesWith(trampoline);
+
+            auto slot = new llvm::GlobalVariable(
+                llvm_module, body->getType(), false,
+                llvm::GlobalValue::ExternalLinkage, body,
+                get_tier_slot_name(func->name));
+
+            llvm::IRBuilder<> ir_builder(
+                llvm::BasicBlock::Create(context, "entry", trampoline));
+
+            if(call_threshold)
+            {
+                auto counter = new llvm::GlobalVariable(
+                    llvm_module, i64_type, false,
+                    llvm::GlobalValue::ExternalLinkage,
+                    llvm::ConstantInt::get(i64_type, 0),
+                    get_tier_counter_name(func->name));
+                auto old_count = ir_builder.CreateAtomicRMW(
+                    llvm::AtomicRMWInst::Add, counter,
+                    llvm::ConstantInt::get(i64_type, 1),
+                    llvm::AtomicOrdering::Monotonic);
+
+                auto notify_block =
+                    llvm::BasicBlock::Create(context, "notify", trampoline);
+                auto call_block =
+                    llvm::BasicBlock::Create(context, "call", trampoline);
+                auto last_count =
+                    llvm::ConstantInt::get(i64_type, call_threshold - 1);
+                auto reached = ir_builder.CreateICmpEQ(old_count, last_count);
+                ir_builder.CreateCondBr(reached, notify_block, call_block);
+
+                ir_builder.SetInsertPoint(notify_block);
+                ir_builder.CreateCall(
+                    notify_type,
+                    ir_builder.CreateLoad(notify_ptr_type, notify_func),
+                    { ir_builder.CreateLoad(i8_ptr_type, notify_arg) });
+                ir_builder.CreateBr(call_block);
+
+                ir_builder.SetInsertPoint(call_block);
+            }
+
+            auto target = ir_builder.CreateLoad(body->getType(), slot);
+            target->setAtomic(llvm::AtomicOrdering::Acquire);
+
+            std::vector<llvm::Value *> args;
+            for(auto &arg : trampoline->args())
+                args.push_back(&arg);
+            auto call = ir_builder.CreateCall(func_type, target, args);
+            call->setTailCallKind(llvm::CallInst::TCK_MustTail);
+
+            if(func_type->getReturnType()->isVoidTy())
+                ir_builder.CreateRetVoid();
+            else
+                ir_builder.CreateRet(call);
+        }
+    }
+
+    struct TieredFunction
+    {
+        std::string name;
+        void      **slot     = nullptr;
+        uint64_t   *counter  = nullptr;
+        bool        promoted = false;
+    };
+
+    // globals read by trampolines when a call threshold is reached
+    struct TierUpNotifier
+    {
+        void (**func)(void *) = nullptr;
+        void  **arg           = nullptr;
+    };
+
+    // recompiles functions of a tier-0 module in background
+    // and redirects their trampolines
+    class TierUpWorker : public Uncopyable
+    {
+    public:
+
+        TierUpWorker(
+            core::Prog                  prog,
+            Options                     opts,
+            std::vector<TieredFunction> funcs,
+            const TierUpNotifier       &notifier)
+            : prog_(std::move(prog)), opts_(std::move(opts)),
+              funcs_(std::move(funcs))
+        {
+            if(notifier.func)
+            {
+                *notifier.func = &notify;
+                *notifier.arg = this;
+            }
+            thread_ = std::thread([this] { run(); });
+        }
+
+        ~TierUpWorker()
+        {
+            {
+                std::lock_guard lock(mutex_);
+                stop_ = true;
+            }
+            cv_.notify_one();
+            thread_.join();
+        }
+
+        size_t get_promoted_count() const
+        {
+            return promoted_count_;
+        }
+
+        std::string get_error() const
+        {
+            std::lock_guard lock(mutex_);
+            return error_;
+        }
+
+    private:
+
+        static void notify(void *worker)
+        {
+            auto self = static_cast<TierUpWorker *>(worker);
+            {
+                std::lock_guard lock(self->mutex_);
+                self->notified_ = true;
+            }
+            self->cv_.notify_one();
+        }
+
+        void set_error(std::string error)
+        {
+            std::lock_guard lock(mutex_);
+            error_ = std::move(error);
+        }
+
+        bool is_hot(const TieredFunction &func) const
+        {
+            if(!opts_.tier_up_call_threshold)
+                return true;
+            const uint64_t count = std::atomic_ref<uint64_t>(*func.counter)
+                .load(std::memory_order_relaxed);
+            return count >= opts_.tier_up_call_threshold;
+        }
+
+        void run()
+        {
+            for(;;)
+            {
+                std::vector<size_t> hot_funcs;
+                for(size_t i = 0; i < funcs_.size(); ++i)
+                {
+                    if(!funcs_[i].promoted && is_hot(funcs_[i]))
+                        hot_funcs.push_back(i);
+                }
+
+                if(!hot_funcs.empty())
+                {
+                    // tier-0 code keeps running if recompilation fails
+                    try
+                    {
+                        promote(get_reachable_funcs(prog_, hot_funcs));
+                    }
+                    catch(const std::exception &e)
+                    {
+                        set_error(e.what());
+                        return;
+                    }
+                    catch(...)
+                    {
+                        set_error("unknown error");
+                        return;
+                    }
+                }
+
+                if(promoted_count_ == funcs_.size())
+                    return;
+
+                // woken by trampolines reaching the call threshold
+                std::unique_lock lock(mutex_);
+                cv_.wait(lock, [&] { return stop_ || notified_; });
+                if(stop_)
+                    return;
+                notified_ = false;
+            }
+        }
+
+        void promote(const std::vector<size_t> &func_indices)
+        {
+            auto llvm_mod = build_llvm_module(prog_, opts_, &func_indices);
+
+            auto compiled_module = newRC<CompiledModule>();
+            compiled_module->llvm_context = std::move(llvm_mod.llvm_context);
+            compiled_module->exec_engine.reset(
+                create_execution_engine(llvm_mod));
+            auto &exec_engine = *compiled_module->exec_engine;
+            add_native_intrinsic_functions(exec_engine);
+            exec_engine.finalizeObject();
+
+            for(auto i : func_indices)
+            {
+                auto &func = funcs_[i];
+                if(func.promoted)
+                    continue;
+                auto address = reinterpret_cast<void *>(
+                    exec_engine.getFunctionAddress(func.name));
+                std::atomic_ref<void *>(*func.slot)
+                    .store(address, std::memory_order_release);
+                func.promoted = true;
+                ++promoted_count_;
+            }
+
+            compiled_modules_.push_back(std::move(compiled_module));
+        }
+
+        core::Prog                  prog_;
+        Options                     opts_;
+        std::vector<TieredFunction> funcs_;
+
+        std::vector<RC<CompiledModule>> compiled_modules_;
+        std::atomic<size_t>             promoted_count_ = 0;
+
+        mutable std::mutex      mutex_;
+        std::condition_variable cv_;
+        bool                    stop_     = false;
+        bool                    notified_ = false;
+        std::string             error_;
+
+        std::thread thread_;
+    };
+
+    RC<CompiledModule> compile_tier0_prog(
+        const core::Prog            &prog,
+        const Options               &opts,
+        std::string                 *llvm_ir,
+        std::vector<TieredFunction> &tiered_funcs,
+        TierUpNotifier              &notifier)
     {
-#define ADD_GLOBAL_FUNC(NAME, FUNC) \
-        ee.addGlobalMapping(#NAME, reinterpret_cast<uint64_t>(FUNC))
-
-        auto *f32_exp10    = +[](float x)            { return std::pow(10.0f, x); };
-        auto *f32_rsqrt    = +[](float x)            { return 1 / std::sqrt(x); };
-        auto *f32_isfinite = +[](float x) -> int32_t { return std::isfinite(x); };
-        auto *f32_isinf    = +[](float x) -> int32_t { return std::isinf(x); };
-        auto *f32_isnan    = +[](float x) -> int32_t { return std::isnan(x); };
-        
-        auto *f64_exp10    = +[](double x)            { return std::pow(10.0, x); };
-        auto *f64_rsqrt    = +[](double x)            { return 1 / std::sqrt(x); };
-        auto *f64_isfinite = +[](double x) -> int32_t { return std::isfinite(x); };
-        auto *f64_isinf    = +[](double x) -> int32_t { return std::isinf(x); };
-        auto *f64_isnan    = +[](double x) -> int32_t { return std::isnan(x); };
-
-        ADD_GLOBAL_FUNC(__cuj_intrinsic_f32_mod,      &::fmodf);
-        ADD_GLOBAL_FUNC(__cuj_intrinsic_f32_rem,      &::remainderf);
-        ADD_GLOBAL_FUNC(__cuj_intrinsic_f32_exp10,    f32_exp10);
-        ADD_GLOBAL_FUNC(__cuj_intrinsic_f32_rsqrt,    f32_rsqrt);
-        ADD_GLOBAL_FUNC(__cuj_intrinsic_f32_tan,      &::tanf);
-        ADD_GLOBAL_FUNC(__cuj_intrinsic_f32_asin,     &::asinf);
-        ADD_GLOBAL_FUNC(__cuj_intrinsic_f32_acos,     &::acosf);
-        ADD_GLOBAL_FUNC(__cuj_intrinsic_f32_atan,     &::atanf);
-        ADD_GLOBAL_FUNC(__cuj_intrinsic_f32_atan2,    &::atan2f);
-        ADD_GLOBAL_FUNC(__cuj_intrinsic_f32_isfinite, f32_isfinite);
-        ADD_GLOBAL_FUNC(__cuj_intrinsic_f32_isinf,    f32_isinf);
-        ADD_GLOBAL_FUNC(__cuj_intrinsic_f32_isnan,    f32_isnan);
-
-        using DD  = double(*)(double);
-        using DDD = double(*)(double, double);
-
-        ADD_GLOBAL_FUNC(__cuj_intrinsic_f64_mod,      static_cast<DDD>(&::fmod));
-        ADD_GLOBAL_FUNC(__cuj_intrinsic_f64_rem,      static_cast<DDD>(&::remainder));
-        ADD_GLOBAL_FUNC(__cuj_intrinsic_f64_exp10,    f64_exp10);
-        ADD_GLOBAL_FUNC(__cuj_intrinsic_f64_rsqrt,    f64_rsqrt);
-        ADD_GLOBAL_FUNC(__cuj_intrinsic_f64_tan,      static_cast<DD>(&::tan));
-        ADD_GLOBAL_FUNC(__cuj_intrinsic_f64_asin,     static_cast<DD>(&::asin));
-        ADD_GLOBAL_FUNC(__cuj_intrinsic_f64_acos,     static_cast<DD>(&::acos));
-        ADD_GLOBAL_FUNC(__cuj_intrinsic_f64_atan,     static_cast<DD>(&::atan));
-        ADD_GLOBAL_FUNC(__cuj_intrinsic_f64_atan2,    static_cast<DDD>(&::atan2));
-        ADD_GLOBAL_FUNC(__cuj_intrinsic_f64_isfinite, f64_isfinite);
-        ADD_GLOBAL_FUNC(__cuj_intrinsic_f64_isinf,    f64_isinf);
-        ADD_GLOBAL_FUNC(__cuj_intrinsic_f64_isnan,    f64_isnan);
-
-#undef ADD_GLOBAL_FUNC
+        auto tier0_opts = opts;
+        tier0_opts.opt_level = OptimizationLevel::O0;
+        tier0_opts.llvm_pipeline = {};
+        tier0_opts.direct_ssa = true;
+
+        const bool count_calls = opts.tier_up_call_threshold > 0;
+        auto llvm_mod = build_llvm_module(prog, tier0_opts);
+        add_tier_trampolines(
+            *llvm_mod.llvm_module, prog, opts.tier_up_call_threshold);
+        if(llvm_ir)
+            *llvm_ir = llvm_helper::to_string(*llvm_mod.llvm_module);
+
+        auto ret = newRC<CompiledModule>();
+        ret->llvm_context = std::move(llvm_mod.llvm_context);
+        ret->exec_engine.reset(create_execution_engine(llvm_mod));
+        auto &exec_engine = *ret->exec_engine;
+        add_native_intrinsic_functions(exec_engine);
+        exec_engine.finalizeObject();
+
+        for(auto &func : prog.funcs)
+        {
+            TieredFunction tiered_func;
+            tiered_func.name = func->name;
+            tiered_func.slot = reinterpret_cast<void **>(
+                exec_engine.getGlobalValueAddress(
+                    get_tier_slot_name(func->name)));
+            if(count_calls)
+            {
+                tiered_func.counter = reinterpret_cast<uint64_t *>(
+                    exec_engine.getGlobalValueAddress(
+                        get_tier_counter_name(func->name)));
+            }
+            tiered_funcs.push_back(std::move(tiered_func));
+        }
+
+        if(count_calls)
+        {
+            notifier.func = reinterpret_cast<void (**)(void *)>(
+                exec_engine.getGlobalValueAddress(TIER_UP_NOTIFY_FUNC_NAME));
+            notifier.arg = reinterpret_cast<void **>(
+                exec_engine.getGlobalValueAddress(TIER_UP_NOTIFY_ARG_NAME));
+        }
+
+        return ret;
     }
 
 } // namespace anonymous
 
 struct MCJIT::MCJITData
 {
-    std::string                llvm_ir;
-    Box<llvm::LLVMContext>     llvm_context;
-    Box<llvm::ExecutionEngine> exec_engine;
+    // empty when machine code is reused from caches
+    bool               retain_llvm_ir = false;
+    std::string        llvm_ir;
+    RC<CompiledModule> compiled_module;
+
+    // filled when compile cache is enabled
+    std::vector<RC<CompiledModule>> cached_modules;
+    std::map<std::string, void *>   function_addresses;
+
+    // destroyed before compiled_module
+    Box<TierUpWorker> tier_up_worker;
 };
 
+MCJIT::CompileCacheStatistics MCJIT::get_compile_cache_statistics()
+{
+    auto &cache = get_compile_cache();
+    std::lock_guard lock(cache.mutex);
+    return cache.statistics;
+}
+
+void MCJIT::clear_compile_cache()
+{
+    // compiled modules still referenced by mcjit instances are kept alive
+    auto &cache = get_compile_cache();
+    std::lock_guard lock(cache.mutex);
+    cache.entries.clear();
+    cache.statistics = {};
+}
+
 MCJIT::MCJIT(MCJIT &&other) noexcept
 {
     std::swap(opts_, other.opts_);
@@ -201,41 +1025,130 @@ void MCJIT::set_options(const Options &opts)
 }
 
 void MCJIT::generate(const dsl::Module &mod)
+{
+    generate(mod._generate_prog());
+}
+
+void MCJIT::generate(const core::Prog &prog)
 {
     delete llvm_data_;
     llvm_data_ = new MCJITData;
-    
-    auto llvm_mod = build_llvm_module(mod, opts_);
-    llvm_data_->llvm_context = std::move(llvm_mod.llvm_context);
 
-    llvm::raw_string_ostream ss(llvm_data_->llvm_ir);
-    ss << *llvm_mod.llvm_module;
-    ss.flush();
+    llvm_data_->retain_llvm_ir = opts_.retain_llvm_ir;
+    auto llvm_ir = opts_.retain_llvm_ir ? &llvm_data_->llvm_ir : nullptr;
+
+    if(opts_.tiered_compilation)
+    {
+        std::vector<TieredFunction> tiered_funcs;
+        TierUpNotifier notifier;
+        llvm_data_->compiled_module = compile_tier0_prog(
+            prog, opts_, llvm_ir, tiered_funcs, notifier);
+        llvm_data_->tier_up_worker = newBox<TierUpWorker>(
+            prog, opts_, std::move(tiered_funcs), notifier);
+        return;
+    }
+
+    if(!opts_.enable_compile_cache)
+    {
+        llvm_data_->compiled_module = compile_prog(
+            prog, opts_, llvm_ir);
+        return;
+    }
+
+    // functions found in the cache reuse their machine code. the others are
+    // compiled together with their callees, as the callees' code in earlier
+    // modules can't be called from a new module
+
+    auto &cache = get_compile_cache();
+    auto keys = get_compile_cache_keys(prog, opts_);
+
+    std::vector<size_t> missing_funcs;
+    {
+        std::lock_guard lock(cache.mutex);
+        for(size_t i = 0; i < keys.size(); ++i)
+        {
+            auto it = cache.entries.find(keys[i].hash);
+            if(it == cache.entries.end() ||
+               it->second.hashed_bytes != keys[i].hashed_bytes)
+            {
+                missing_funcs.push_back(i);
+                continue;
+            }
+            llvm_data_->function_addresses[prog.funcs[i]->name] =
+                it->second.address;
+            llvm_data_->cached_modules.push_back(it->second.compiled_module);
+        }
+        cache.statistics.hits += keys.size() - missing_funcs.size();
+        cache.statistics.misses += missing_funcs.size();
+    }
+
+    if(missing_funcs.empty())
+        return;
 
-    std::string err;
-    llvm::EngineBuilder engine_builder(std::move(llvm_mod.llvm_module));
-    engine_builder.setErrorStr(&err);
-    engine_builder.setOptLevel(llvm_mod.codegen_opt);
+    std::vector<size_t> compiled_funcs;
+    if(missing_funcs.size() < keys.size())
+        compiled_funcs = get_reachable_funcs(prog, missing_funcs);
+    llvm_data_->compiled_module = compile_prog(
+        prog, opts_, llvm_ir,
+        compiled_funcs.empty() ? nullptr : &compiled_funcs);
 
-    auto exec_engine = engine_builder.create(llvm_mod.machine);
-    if(!exec_engine)
-        throw CujException(err);
-    llvm_data_->exec_engine.reset(exec_engine);
+    std::vector<void *> addresses;
+    for(auto i : missing_funcs)
+    {
+        auto &name = prog.funcs[i]->name;
+        auto address = reinterpret_cast<void *>(
+            llvm_data_->compiled_module->exec_engine
+                ->getFunctionAddress(name));
+        llvm_data_->function_addresses[name] = address;
+        addresses.push_back(address);
+    }
+
+    std::lock_guard lock(cache.mutex);
+    for(size_t j = 0; j < missing_funcs.size(); ++j)
+    {
+        auto &key = keys[missing_funcs[j]];
+        cache.entries.try_emplace(
+            key.hash, std::move(key.hashed_bytes),
+            addresses[j], llvm_data_->compiled_module);
+    }
+}
 
-    add_native_intrinsic_functions(*llvm_data_->exec_engine);
+size_t MCJIT::get_promoted_function_count() const
+{
+    if(!llvm_data_ || !llvm_data_->tier_up_worker)
+        return 0;
+    return llvm_data_->tier_up_worker->get_promoted_count();
+}
 
-    llvm_data_->exec_engine->finalizeObject();
+std::string MCJIT::get_tier_up_error() const
+{
+    if(!llvm_data_ || !llvm_data_->tier_up_worker)
+        return {};
+    return llvm_data_->tier_up_worker->get_error();
 }
 
 const std::string &MCJIT::get_llvm_string() const
 {
+    if(!llvm_data_->retain_llvm_ir)
+        return llvm_helper::get_ir_not_retained_message();
     return llvm_data_->llvm_ir;
 }
 
 void *MCJIT::get_function_impl(const std::string &symbol_name) const
 {
-    return reinterpret_cast<void *>(
-        llvm_data_->exec_engine->getFunctionAddress(symbol_name));
+    if(auto it = llvm_data_->function_addresses.find(symbol_name);
+       it != llvm_data_->function_addresses.end())
+        return it->second;
+    if(!llvm_data_->compiled_module)
+        return nullptr;
+    return reinterpret_cast<void *>(llvm_data_->compiled_module
+        ->exec_engine->getFunctionAddress(symbol_name));
+}
+
+NativeKernelEntry *MCJIT::get_kernel(const std::string &symbol_name) const
+{
+    return reinterpret_cast<NativeKernelEntry *>(
+        get_function_impl(symbol_name));
 }
 
 CUJ_NAMESPACE_END(cuj::gen)
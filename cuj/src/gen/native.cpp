@@ -0,0 +1,199 @@
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable: 4141)
+#pragma warning(disable: 4244)
+#pragma warning(disable: 4624)
+#pragma warning(disable: 4626)
+#pragma warning(disable: 4996)
+#endif
+
+#include <algorithm>
+#include <cmath>
+
+#include <llvm/Support/Host.h>
+
+#include "native.h"
+
+CUJ_NAMESPACE_BEGIN(cuj::gen)
+
+namespace
+{
+
+    // host queries are not cheap, and the result never changes
+    const NativeTarget &get_host_target()
+    {
+        static const NativeTarget ret = []
+        {
+            NativeTarget host;
+            host.cpu = llvm::sys::getHostCPUName().str();
+
+            llvm::StringMap<bool> host_features;
+            if(llvm::sys::getHostCPUFeatures(host_features))
+            {
+                // sort features for stable cache keys
+                std::vector<std::string> features;
+                for(auto &f : host_features)
+                {
+                    features.push_back(
+                        (f.second ? "+" : "-") + f.first().str());
+                }
+                std::sort(features.begin(), features.end());
+
+                for(auto &f : features)
+                {
+                    if(!host.features.empty())
+                        host.features += ",";
+                    host.features += f;
+                }
+            }
+            return host;
+        }();
+        return ret;
+    }
+
+    TargetMachineKey get_native_target_machine_key(
+        llvm::CodeGenOpt::Level codegen_opt, const NativeTarget &native_target)
+    {
+        static const std::string target_triple =
+            llvm::sys::getDefaultTargetTriple();
+
+        TargetMachineKey key;
+        key.triple    = target_triple;
+        key.cpu       = native_target.cpu;
+        key.features  = native_target.features;
+        key.opt_level = codegen_opt;
+        return key;
+    }
+
+    llvm::TargetMachine *create_target_machine(const TargetMachineKey &key)
+    {
+        return lookup_target(key.triple).createTargetMachine(
+            key.triple, key.cpu, key.features, {}, {}, {}, key.opt_level, true);
+    }
+
+} // namespace anonymous
+
+NativeTarget get_native_target(const Options &opts)
+{
+    NativeTarget ret;
+    ret.cpu = opts.native_cpu;
+    ret.features = opts.native_features;
+
+    if(ret.cpu.empty())
+    {
+        auto &host = get_host_target();
+        ret.cpu = host.cpu;
+        if(ret.features.empty())
+            ret.features = host.features;
+    }
+
+    return ret;
+}
+
+bool should_merge_functions(const Options &opts)
+{
+    return opts.opt_level == OptimizationLevel::O2 ||
+           opts.opt_level == OptimizationLevel::O3;
+}
+
+TargetMachineLease get_native_target_machine(
+    llvm::CodeGenOpt::Level codegen_opt, const NativeTarget &native_target)
+{
+    init_native_target();
+    return acquire_target_machine(
+        get_native_target_machine_key(codegen_opt, native_target),
+        &create_target_machine);
+}
+
+Box<llvm::TargetMachine> create_native_target_machine(
+    llvm::CodeGenOpt::Level codegen_opt, const NativeTarget &native_target)
+{
+    init_native_target();
+    Box<llvm::TargetMachine> ret(create_target_machine(
+        get_native_target_machine_key(codegen_opt, native_target)));
+    if(!ret)
+        throw CujException("failed to create llvm target machine");
+    return ret;
+}
+
+void init_native_ir_generator(
+    LLVMIRGenerator     &generator,
+    llvm::TargetMachine &machine,
+    llvm::DataLayout    &data_layout,
+    const NativeTarget  &native_target,
+    const Options       &opts)
+{
+    generator.disable_basic_optimizations();
+    generator.set_target(LLVMIRGenerator::Target::Native);
+    generator.set_data_layout(&data_layout);
+    generator.set_native_target(
+        machine.getTargetTriple().str(),
+        native_target.cpu, native_target.features);
+    if(opts.fast_math)
+        generator.use_fast_math();
+    if(opts.approx_math_func)
+        generator.use_approx_math_func();
+    if(opts.core_optimizations)
+        generator.enable_core_optimizations();
+    if(opts.direct_ssa)
+        generator.use_direct_ssa();
+}
+
+std::vector<std::pair<std::string, void *>> get_native_intrinsic_symbols()
+{
+    std::vector<std::pair<std::string, void *>> ret;
+
+#define ADD_GLOBAL_FUNC(NAME, FUNC) \
+    ret.push_back({ #NAME, reinterpret_cast<void *>(FUNC) })
+
+    auto *f32_exp10    = +[](float x)            { return std::pow(10.0f, x); };
+    auto *f32_rsqrt    = +[](float x)            { return 1 / std::sqrt(x); };
+    auto *f32_isfinite = +[](float x) -> int32_t { return std::isfinite(x); };
+    auto *f32_isinf    = +[](float x) -> int32_t { return std::isinf(x); };
+    auto *f32_isnan    = +[](float x) -> int32_t { return std::isnan(x); };
+    
+    auto *f64_exp10    = +[](double x)            { return std::pow(10.0, x); };
+    auto *f64_rsqrt    = +[](double x)            { return 1 / std::sqrt(x); };
+    auto *f64_isfinite = +[](double x) -> int32_t { return std::isfinite(x); };
+    auto *f64_isinf    = +[](double x) -> int32_t { return std::isinf(x); };
+    auto *f64_isnan    = +[](double x) -> int32_t { return std::isnan(x); };
+
+    ADD_GLOBAL_FUNC(__cuj_intrinsic_f32_mod,      &::fmodf);
+    ADD_GLOBAL_FUNC(__cuj_intrinsic_f32_rem,      &::remainderf);
+    ADD_GLOBAL_FUNC(__cuj_intrinsic_f32_exp10,    f32_exp10);
+    ADD_GLOBAL_FUNC(__cuj_intrinsic_f32_rsqrt,    f32_rsqrt);
+    ADD_GLOBAL_FUNC(__cuj_intrinsic_f32_tan,      &::tanf);
+    ADD_GLOBAL_FUNC(__cuj_intrinsic_f32_asin,     &::asinf);
+    ADD_GLOBAL_FUNC(__cuj_intrinsic_f32_acos,     &::acosf);
+    ADD_GLOBAL_FUNC(__cuj_intrinsic_f32_atan,     &::atanf);
+    ADD_GLOBAL_FUNC(__cuj_intrinsic_f32_atan2,    &::atan2f);
+    ADD_GLOBAL_FUNC(__cuj_intrinsic_f32_isfinite, f32_isfinite);
+    ADD_GLOBAL_FUNC(__cuj_intrinsic_f32_isinf,    f32_isinf);
+    ADD_GLOBAL_FUNC(__cuj_intrinsic_f32_isnan,    f32_isnan);
+
+    using DD  = double(*)(double);
+    using DDD = double(*)(double, double);
+
+    ADD_GLOBAL_FUNC(__cuj_intrinsic_f64_mod,      static_cast<DDD>(&::fmod));
+    ADD_GLOBAL_FUNC(__cuj_intrinsic_f64_rem,      static_cast<DDD>(&::remainder));
+    ADD_GLOBAL_FUNC(__cuj_intrinsic_f64_exp10,    f64_exp10);
+    ADD_GLOBAL_FUNC(__cuj_intrinsic_f64_rsqrt,    f64_rsqrt);
+    ADD_GLOBAL_FUNC(__cuj_intrinsic_f64_tan,      static_cast<DD>(&::tan));
+    ADD_GLOBAL_FUNC(__cuj_intrinsic_f64_asin,     static_cast<DD>(&::asin));
+    ADD_GLOBAL_FUNC(__cuj_intrinsic_f64_acos,     static_cast<DD>(&::acos));
+    ADD_GLOBAL_FUNC(__cuj_intrinsic_f64_atan,     static_cast<DD>(&::atan));
+    ADD_GLOBAL_FUNC(__cuj_intrinsic_f64_atan2,    static_cast<DDD>(&::atan2));
+    ADD_GLOBAL_FUNC(__cuj_intrinsic_f64_isfinite, f64_isfinite);
+    ADD_GLOBAL_FUNC(__cuj_intrinsic_f64_isinf,    f64_isinf);
+    ADD_GLOBAL_FUNC(__cuj_intrinsic_f64_isnan,    f64_isnan);
+
+#undef ADD_GLOBAL_FUNC
+
+    return ret;
+}
+
+CUJ_NAMESPACE_END(cuj::gen)
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <llvm/IR/DataLayout.h>
+#include <llvm/Target/TargetMachine.h>
+
+#include <cuj/gen/llvm.h>
+#include <cuj/gen/option.h>
+
+#include "target.h"
+
+CUJ_NAMESPACE_BEGIN(cuj::gen)
+
+// shared by native jit backends
+
+struct NativeTarget
+{
+    std::string cpu;
+    std::string features;
+};
+
+NativeTarget get_native_target(const Options &opts);
+
+// initializes native target and leases a cached machine
+TargetMachineLease get_native_target_machine(
+    llvm::CodeGenOpt::Level codegen_opt, const NativeTarget &native_target);
+
+// a new machine bypassing the cache, for owners that destroy it themselves.
+// llvm::ExecutionEngine is the only one, so each mcjit engine creates one
+Box<llvm::TargetMachine> create_native_target_machine(
+    llvm::CodeGenOpt::Level codegen_opt, const NativeTarget &native_target);
+
+// like the legacy pipeline, identical functions are merged at O2 and O3
+bool should_merge_functions(const Options &opts);
+
+// data_layout must outlive the generation
+void init_native_ir_generator(
+    LLVMIRGenerator     &generator,
+    llvm::TargetMachine &machine,
+    llvm::DataLayout    &data_layout,
+    const NativeTarget  &native_target,
+    const Options       &opts);
+
+// addresses of functions called by native intrinsics
+std::vector<std::pair<std::string, void *>> get_native_intrinsic_symbols();
+
+CUJ_NAMESPACE_END(cuj::gen)
@@ -0,0 +1,22 @@
+#include <cuj/gen/native_kernel.h>
+
+CUJ_NAMESPACE_BEGIN(cuj::gen)
+
+void launch_native_kernel_impl(
+    NativeKernelEntry *entry,
+    const Dim3        &grid_dim,
+    const Dim3        &block_dim,
+    void             **kernel_args)
+{
+    Dim3 block_idx;
+    for(block_idx.z = 0; block_idx.z < grid_dim.z; ++block_idx.z)
+    {
+        for(block_idx.y = 0; block_idx.y < grid_dim.y; ++block_idx.y)
+        {
+            for(block_idx.x = 0; block_idx.x < grid_dim.x; ++block_idx.x)
+                entry(kernel_args, &block_idx, &block_dim);
+        }
+    }
+}
+
+CUJ_NAMESPACE_END(cuj::gen)
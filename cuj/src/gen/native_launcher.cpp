@@ -0,0 +1,274 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <cuj/gen/native_launcher.h>
+
+CUJ_NAMESPACE_BEGIN(cuj::gen)
+
+namespace
+{
+
+    constexpr int64_t CHUNKS_PER_THREAD = 16;
+
+    // remaining blocks [begin, end) of one thread
+    struct alignas(64) BlockRange
+    {
+        std::mutex mutex;
+        int64_t    begin = 0;
+        int64_t    end   = 0;
+    };
+
+    void pin_current_thread(int thread_index)
+    {
+#ifdef __linux__
+        cpu_set_t usable_cpus;
+        CPU_ZERO(&usable_cpus);
+        if(sched_getaffinity(0, sizeof(usable_cpus), &usable_cpus) != 0)
+            return;
+
+        std::vector<int> cpus;
+        for(int i = 0; i < CPU_SETSIZE; ++i)
+        {
+            if(CPU_ISSET(i, &usable_cpus))
+                cpus.push_back(i);
+        }
+        if(cpus.empty())
+            return;
+
+        cpu_set_t cpu;
+        CPU_ZERO(&cpu);
+        CPU_SET(cpus[thread_index % cpus.size()], &cpu);
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu), &cpu);
+#else
+        (void)thread_index;
+#endif
+    }
+
+} // namespace anonymous
+
+struct NativeLauncher::LauncherData
+{
+    // ranges[0] belongs to the thread calling launch
+    std::vector<BlockRange>  ranges;
+    std::vector<std::thread> threads;
+
+    std::mutex              mutex;
+    std::condition_variable start_cv;
+    std::condition_variable finish_cv;
+    uint64_t                generation     = 0;
+    int                     active_threads = 0;
+    bool                    stop           = false;
+
+    // current launch
+
+    NativeKernelEntry *entry       = nullptr;
+    Dim3               grid_dim;
+    Dim3               block_dim;
+    void             **kernel_args = nullptr;
+    int64_t            chunk_size  = 1;
+
+    std::atomic<int64_t> steal_count = 0;
+
+    explicit LauncherData(int thread_count)
+        : ranges(thread_count)
+    {
+
+    }
+};
+
+NativeLauncher::NativeLauncher(int thread_count, bool pin_threads)
+{
+    if(thread_count <= 0)
+        thread_count = static_cast<int>(std::thread::hardware_concurrency());
+    thread_count = (std::max)(thread_count, 1);
+
+    data_ = new LauncherData(thread_count);
+    for(int i = 1; i < thread_count; ++i)
+    {
+        data_->threads.emplace_back([this, i, pin_threads]
+        {
+            if(pin_threads)
+                pin_current_thread(i);
+
+            uint64_t generation = 0;
+            for(;;)
+            {
+                {
+                    std::unique_lock lock(data_->mutex);
+                    data_->start_cv.wait(lock, [&]
+                    {
+                        return data_->stop || data_->generation != generation;
+                    });
+                    if(data_->stop)
+                        return;
+                    generation = data_->generation;
+                }
+
+                run_thread(i);
+
+                std::lock_guard lock(data_->mutex);
+                if(--data_->active_threads == 0)
+                    data_->finish_cv.notify_one();
+            }
+        });
+    }
+}
+
+NativeLauncher::~NativeLauncher()
+{
+    {
+        std::lock_guard lock(data_->mutex);
+        data_->stop = true;
+    }
+    data_->start_cv.notify_all();
+    for(auto &t : data_->threads)
+        t.join();
+    delete data_;
+}
+
+int NativeLauncher::get_thread_count() const
+{
+    return static_cast<int>(data_->ranges.size());
+}
+
+void NativeLauncher::set_chunk_size(int64_t block_count)
+{
+    chunk_size_ = (std::max<int64_t>)(block_count, 0);
+}
+
+NativeLauncher::LaunchStatistics NativeLauncher::launch_impl(
+    NativeKernelEntry *entry,
+    const Dim3        &grid_dim,
+    const Dim3        &block_dim,
+    void             **kernel_args)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    LaunchStatistics statistics;
+    statistics.block_count =
+        static_cast<int64_t>((std::max)(grid_dim.x, 0)) *
+        static_cast<int64_t>((std::max)(grid_dim.y, 0)) *
+        static_cast<int64_t>((std::max)(grid_dim.z, 0));
+    if(statistics.block_count == 0)
+        return statistics;
+
+    // split blocks evenly so that each thread starts with neighboring blocks
+
+    const int64_t thread_count = get_thread_count();
+    for(int64_t i = 0; i < thread_count; ++i)
+    {
+        auto &range = data_->ranges[i];
+        std::lock_guard lock(range.mutex);
+        range.begin = statistics.block_count * i / thread_count;
+        range.end = statistics.block_count * (i + 1) / thread_count;
+    }
+
+    data_->entry = entry;
+    data_->grid_dim = grid_dim;
+    data_->block_dim = block_dim;
+    data_->kernel_args = kernel_args;
+    data_->chunk_size = chunk_size_ > 0 ? chunk_size_ : (std::max<int64_t>)(
+        statistics.block_count / (thread_count * CHUNKS_PER_THREAD), 1);
+    data_->steal_count = 0;
+
+    {
+        std::lock_guard lock(data_->mutex);
+        data_->active_threads = static_cast<int>(thread_count - 1);
+        ++data_->generation;
+    }
+    data_->start_cv.notify_all();
+
+    run_thread(0);
+
+    {
+        std::unique_lock lock(data_->mutex);
+        data_->finish_cv.wait(lock, [&] { return data_->active_threads == 0; });
+    }
+
+    const std::chrono::duration<double> duration =
+        std::chrono::steady_clock::now() - start;
+    statistics.seconds = duration.count();
+    statistics.steal_count = data_->steal_count;
+    return statistics;
+}
+
+void NativeLauncher::run_thread(int thread_index)
+{
+    const auto &grid_dim = data_->grid_dim;
+    const int64_t grid_xy =
+        static_cast<int64_t>(grid_dim.x) * static_cast<int64_t>(grid_dim.y);
+
+    for(;;)
+    {
+        int64_t begin, end;
+        if(!take_chunk(thread_index, begin, end))
+        {
+            if(!steal_range(thread_index))
+                return;
+            continue;
+        }
+
+        for(int64_t i = begin; i < end; ++i)
+        {
+            const int64_t xy = i % grid_xy;
+            const Dim3 block_idx = {
+                static_cast<int32_t>(xy % grid_dim.x),
+                static_cast<int32_t>(xy / grid_dim.x),
+                static_cast<int32_t>(i / grid_xy)
+            };
+            data_->entry(data_->kernel_args, &block_idx, &data_->block_dim);
+        }
+    }
+}
+
+bool NativeLauncher::take_chunk(int thread_index, int64_t &begin, int64_t &end)
+{
+    auto &range = data_->ranges[thread_index];
+    std::lock_guard lock(range.mutex);
+    if(range.begin == range.end)
+        return false;
+    begin = range.begin;
+    end = (std::min)(begin + data_->chunk_size, range.end);
+    range.begin = end;
+    return true;
+}
+
+bool NativeLauncher::steal_range(int thread_index)
+{
+    const int thread_count = get_thread_count();
+    for(int i = 1; i < thread_count; ++i)
+    {
+        int64_t begin, end;
+        {
+            auto &victim = data_->ranges[(thread_index + i) % thread_count];
+            std::lock_guard lock(victim.mutex);
+            if(victim.begin == victim.end)
+                continue;
+
+            // the victim keeps the first half, which it will run next
+            end = victim.end;
+            begin = victim.begin + (victim.end - victim.begin) / 2;
+            victim.end = begin;
+        }
+
+        ++data_->steal_count;
+        auto &range = data_->ranges[thread_index];
+        std::lock_guard lock(range.mutex);
+        range.begin = begin;
+        range.end = end;
+        return true;
+    }
+    return false;
+}
+
+CUJ_NAMESPACE_END(cuj::gen)
@@ -0,0 +1,208 @@
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable: 4141)
+#pragma warning(disable: 4244)
+#pragma warning(disable: 4624)
+#pragma warning(disable: 4626)
+#pragma warning(disable: 4996)
+#endif
+
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/Support/Host.h>
+
+#include <cuj/gen/llvm.h>
+#include <cuj/gen/orc.h>
+
+#include "llvm/helper.h"
+#include "llvm/pipeline.h"
+#include "native.h"
+
+CUJ_NAMESPACE_BEGIN(cuj::gen)
+
+namespace
+{
+
+    void check_llvm_error(llvm::Error err)
+    {
+        if(err)
+            throw CujException(llvm::toString(std::move(err)));
+    }
+
+    template<typename T>
+    T check_llvm_error(llvm::Expected<T> value)
+    {
+        if(!value)
+            throw CujException(llvm::toString(value.takeError()));
+        return std::move(*value);
+    }
+
+    std::vector<std::string> split_features(const std::string &features)
+    {
+        std::vector<std::string> ret;
+        size_t beg = 0;
+        while(beg < features.size())
+        {
+            size_t end = features.find(',', beg);
+            if(end == std::string::npos)
+                end = features.size();
+            if(end > beg)
+                ret.push_back(features.substr(beg, end - beg));
+            beg = end + 1;
+        }
+        return ret;
+    }
+
+} // namespace anonymous
+
+struct OrcJIT::OrcJITData
+{
+    bool                          retain_llvm_ir = false;
+    std::string                   llvm_ir;
+    TargetMachineLease            machine;
+    Box<llvm::orc::LLLazyJIT>     jit;
+};
+
+OrcJIT::OrcJIT(OrcJIT &&other) noexcept
+{
+    std::swap(opts_, other.opts_);
+    std::swap(orc_data_, other.orc_data_);
+}
+
+OrcJIT &OrcJIT::operator=(OrcJIT &&other) noexcept
+{
+    std::swap(opts_, other.opts_);
+    std::swap(orc_data_, other.orc_data_);
+    return *this;
+}
+
+OrcJIT::~OrcJIT()
+{
+    delete orc_data_;
+}
+
+void OrcJIT::set_options(const Options &opts)
+{
+    opts_ = opts;
+}
+
+void OrcJIT::generate(const dsl::Module &mod)
+{
+    delete orc_data_;
+    orc_data_ = new OrcJITData;
+
+    init_native_target();
+
+    const auto codegen_opt =
+        llvm_helper::get_codegen_opt_level(opts_.opt_level);
+    const auto native_target = get_native_target(opts_);
+
+    // used for generating and optimizing ir
+
+    orc_data_->machine = get_native_target_machine(codegen_opt, native_target);
+    auto data_layout = orc_data_->machine->createDataLayout();
+
+    // create jit
+
+    llvm::orc::JITTargetMachineBuilder machine_builder(
+        orc_data_->machine->getTargetTriple());
+    machine_builder.setCPU(native_target.cpu);
+    machine_builder.addFeatures(split_features(native_target.features));
+    machine_builder.setCodeGenOptLevel(codegen_opt);
+
+    orc_data_->jit = check_llvm_error(
+        llvm::orc::LLLazyJITBuilder()
+            .setJITTargetMachineBuilder(std::move(machine_builder))
+            .create());
+    auto &jit = *orc_data_->jit;
+
+    // symbols of native intrinsics and the host process
+
+    auto &main_dylib = jit.getMainJITDylib();
+
+    llvm::orc::SymbolMap intrinsic_symbols;
+    for(auto &[name, address] : get_native_intrinsic_symbols())
+    {
+        intrinsic_symbols[jit.mangleAndIntern(name)] = llvm::JITEvaluatedSymbol(
+            llvm::pointerToJITTargetAddress(address),
+            llvm::JITSymbolFlags::Exported);
+    }
+    check_llvm_error(main_dylib.define(
+        llvm::orc::absoluteSymbols(std::move(intrinsic_symbols))));
+
+    main_dylib.addGenerator(check_llvm_error(
+        llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+            data_layout.getGlobalPrefix())));
+
+    // modules given to the transform layer contain only the functions
+    // being materialized, so optimization is deferred as well.
+    // materialization may happen on any thread, so each transform leases
+    // its own target machine
+
+    jit.getIRTransformLayer().setTransform(
+        [codegen_opt, native_target, opts = opts_](
+            llvm::orc::ThreadSafeModule tsm, auto &)
+                -> llvm::Expected<llvm::orc::ThreadSafeModule>
+    {
+        try
+        {
+            auto machine =
+                get_native_target_machine(codegen_opt, native_target);
+            tsm.withModuleDo([&](llvm::Module &m)
+            {
+                run_optimization_pipeline(
+                    m, machine.get(), opts,
+                    true, should_merge_functions(opts));
+            });
+        }
+        catch(const CujException &e)
+        {
+            return llvm::make_error<llvm::StringError>(
+                e.what(), llvm::inconvertibleErrorCode());
+        }
+        return std::move(tsm);
+    });
+
+    // generate ir
+
+    LLVMIRGenerator llvm_ir_gen;
+    init_native_ir_generator(
+        llvm_ir_gen, *orc_data_->machine.get(), data_layout,
+        native_target, opts_);
+    llvm_ir_gen.generate(mod);
+
+    orc_data_->retain_llvm_ir = opts_.retain_llvm_ir;
+    if(opts_.retain_llvm_ir)
+    {
+        orc_data_->llvm_ir =
+            llvm_helper::to_string(*llvm_ir_gen.get_llvm_module());
+    }
+
+    auto [llvm_context, llvm_module] = llvm_ir_gen.get_data_ownership();
+    check_llvm_error(jit.addLazyIRModule(llvm::orc::ThreadSafeModule(
+        std::move(llvm_module), std::move(llvm_context))));
+}
+
+const std::string &OrcJIT::get_llvm_string() const
+{
+    if(!orc_data_->retain_llvm_ir)
+        return llvm_helper::get_ir_not_retained_message();
+    return orc_data_->llvm_ir;
+}
+
+void *OrcJIT::get_function_impl(const std::string &symbol_name) const
+{
+    auto symbol = orc_data_->jit->lookup(symbol_name);
+    if(!symbol)
+    {
+        llvm::consumeError(symbol.takeError());
+        return nullptr;
+    }
+    return reinterpret_cast<void *>(symbol->getAddress());
+}
+
+CUJ_NAMESPACE_END(cuj::gen)
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
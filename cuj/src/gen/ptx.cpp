@@ -13,16 +13,16 @@
 #include <llvm/CodeGen/TargetPassConfig.h>
 #include <llvm/IR/LegacyPassManager.h>
 #include <llvm/IR/Module.h>
-#include <llvm/Support/TargetRegistry.h>
-#include <llvm/Support/TargetSelect.h>
 #include <llvm/Target/TargetMachine.h>
 #include <llvm/Target/TargetOptions.h>
-#include <llvm/Transforms/IPO/PassManagerBuilder.h>
-#include <llvm/Transforms/IPO.h>
 
 #include <cuj/gen/llvm.h>
 #include <cuj/gen/ptx.h>
 
+#include "llvm/helper.h"
+#include "llvm/pipeline.h"
+#include "target.h"
+
 CUJ_NAMESPACE_BEGIN(cuj::gen)
 
 namespace
@@ -32,46 +32,45 @@ namespace
     {
         Box<llvm::LLVMContext> llvm_context;
         Box<llvm::Module>      llvm_module;
-        llvm::TargetMachine    *machine;
+        TargetMachineLease     machine;
     };
 
     IntermediateModule construct_intermediate_module(
         const dsl::Module &mod, const Options opts)
     {
-        static std::once_flag init_nvptx_target_flag;
-        std::call_once(init_nvptx_target_flag, [] 
-        {
-            LLVMInitializeNVPTXTargetInfo();
-            LLVMInitializeNVPTXTarget();
-            LLVMInitializeNVPTXTargetMC();
-            LLVMInitializeNVPTXAsmPrinter();
-        });
-
-        std::string err;
-        const char *target_triple = "nvptx64-nvidia-cuda";
-        auto target = llvm::TargetRegistry::lookupTarget(target_triple, err);
-        if(!target)
-            throw CujException(err);
-
-        llvm::TargetOptions options;
-        if(opts.fast_math)
-        {
-            options.AllowFPOpFusion = llvm::FPOpFusion::Fast;
-            options.UnsafeFPMath = 1;
-            options.NoInfsFPMath = 1;
-            options.NoNaNsFPMath = 1;
-        }
-        else
+        init_nvptx_target();
+
+        TargetMachineKey key;
+        key.triple    = "nvptx64-nvidia-cuda";
+        key.cpu       = "sm_60";
+        key.features  = "+ptx63";
+        key.opt_level = llvm::CodeGenOpt::Aggressive;
+        key.fast_math = opts.fast_math;
+
+        auto create = [](const TargetMachineKey &k)
         {
-            options.AllowFPOpFusion = llvm::FPOpFusion::Strict;
-            options.UnsafeFPMath = 0;
-            options.NoInfsFPMath = 0;
-            options.NoNaNsFPMath = 0;
-        }
-
-        auto machine = target->createTargetMachine(
-            target_triple, "sm_60", "+ptx63", options, llvm::Reloc::PIC_,
-            llvm::CodeModel::Small, llvm::CodeGenOpt::Aggressive);
+            llvm::TargetOptions options;
+            if(k.fast_math)
+            {
+                options.AllowFPOpFusion = llvm::FPOpFusion::Fast;
+                options.UnsafeFPMath = 1;
+                options.NoInfsFPMath = 1;
+                options.NoNaNsFPMath = 1;
+            }
+            else
+            {
+                options.AllowFPOpFusion = llvm::FPOpFusion::Strict;
+                options.UnsafeFPMath = 0;
+                options.NoInfsFPMath = 0;
+                options.NoNaNsFPMath = 0;
+            }
+
+            return lookup_target(k.triple).createTargetMachine(
+                k.triple, k.cpu, k.features, options, llvm::Reloc::PIC_,
+                llvm::CodeModel::Small, k.opt_level);
+        };
+
+        auto machine = acquire_target_machine(key, create);
         auto data_layout = machine->createDataLayout();
 
         LLVMIRGenerator ir_gen;
@@ -79,54 +78,27 @@ namespace
             ir_gen.use_fast_math();
         if(opts.approx_math_func)
             ir_gen.use_approx_math_func();
+        if(opts.core_optimizations)
+            ir_gen.enable_core_optimizations();
+        if(opts.direct_ssa)
+            ir_gen.use_direct_ssa();
         ir_gen.disable_basic_optimizations();
         ir_gen.set_target(LLVMIRGenerator::Target::PTX);
         ir_gen.set_data_layout(&data_layout);
         ir_gen.generate(mod);
 
         auto llvm_module = ir_gen.get_llvm_module();
-        llvm_module->setTargetTriple(target_triple);
+        llvm_module->setTargetTriple(key.triple);
         llvm_module->setDataLayout(data_layout);
 
-        llvm::PassManagerBuilder pass_mgr_builder;
-        switch(opts.opt_level)
-        {
-        case OptimizationLevel::O0: pass_mgr_builder.OptLevel = 0; break;
-        case OptimizationLevel::O1: pass_mgr_builder.OptLevel = 1; break;
-        case OptimizationLevel::O2: pass_mgr_builder.OptLevel = 2; break;
-        case OptimizationLevel::O3: pass_mgr_builder.OptLevel = 3; break;
-        }
-        pass_mgr_builder.Inliner = llvm::createFunctionInliningPass(
-            pass_mgr_builder.OptLevel, 0, false);
-        pass_mgr_builder.SLPVectorize   = true;
-        pass_mgr_builder.LoopVectorize  = false;
-        pass_mgr_builder.MergeFunctions = true;
-
-        machine->adjustPassManager(pass_mgr_builder);
-
-        {
-            llvm::legacy::FunctionPassManager fp_mgr(llvm_module);
-            fp_mgr.add(createTargetTransformInfoWrapperPass(
-                machine->getTargetIRAnalysis()));
-            pass_mgr_builder.populateFunctionPassManager(fp_mgr);
-            fp_mgr.doInitialization();
-            for(auto &f : llvm_module->functions())
-                fp_mgr.run(f);
-            fp_mgr.doFinalization();
-        }
-
-        {
-            llvm::legacy::PassManager passes;
-            passes.add(createTargetTransformInfoWrapperPass(
-                machine->getTargetIRAnalysis()));
-            pass_mgr_builder.populateModulePassManager(passes);
-            passes.run(*llvm_module);
-        }
+        // mergefunc was always on for ptx with the legacy pipeline
+        run_optimization_pipeline(
+            *llvm_module, machine.get(), opts, false, true);
 
         IntermediateModule result;
         std::tie(result.llvm_context, result.llvm_module) =
             ir_gen.get_data_ownership();
-        result.machine = machine;
+        result.machine = std::move(machine);
 
         return result;
     }
@@ -142,10 +114,10 @@ void PTXGenerator::generate(const dsl::Module &mod)
 {
     auto im = construct_intermediate_module(mod, opts_);
 
-    llvm_ir_ = {};
-    llvm::raw_string_ostream ir_stream(llvm_ir_);
-    ir_stream << *im.llvm_module;
-    ir_stream.flush();
+    if(opts_.retain_llvm_ir)
+        llvm_ir_ = llvm_helper::to_string(*im.llvm_module);
+    else
+        llvm_ir_ = llvm_helper::get_ir_not_retained_message();
 
     llvm::legacy::PassManager passes;
     llvm::SmallString<8> output_buf;
@@ -0,0 +1,147 @@
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable: 4141)
+#pragma warning(disable: 4244)
+#pragma warning(disable: 4624)
+#pragma warning(disable: 4626)
+#pragma warning(disable: 4996)
+#endif
+
+#include <map>
+#include <mutex>
+
+#include <llvm/ExecutionEngine/MCJIT.h>
+#include <llvm/Support/TargetSelect.h>
+
+#include "target.h"
+
+CUJ_NAMESPACE_BEGIN(cuj::gen)
+
+namespace
+{
+
+    struct TargetRegistry
+    {
+        std::mutex mutex;
+
+        std::map<std::string, const llvm::Target *> targets;
+
+        std::map<TargetMachineKey, std::vector<Box<llvm::TargetMachine>>>
+            idle_machines;
+    };
+
+    TargetRegistry &get_target_registry()
+    {
+        static TargetRegistry registry;
+        return registry;
+    }
+
+} // namespace anonymous
+
+void init_native_target()
+{
+    static std::once_flag init_flag;
+    std::call_once(init_flag, []
+    {
+        llvm::InitializeNativeTarget();
+        llvm::InitializeNativeTargetAsmPrinter();
+        LLVMLinkInMCJIT();
+    });
+}
+
+void init_nvptx_target()
+{
+    static std::once_flag init_flag;
+    std::call_once(init_flag, []
+    {
+        LLVMInitializeNVPTXTargetInfo();
+        LLVMInitializeNVPTXTarget();
+        LLVMInitializeNVPTXTargetMC();
+        LLVMInitializeNVPTXAsmPrinter();
+    });
+}
+
+const llvm::Target &lookup_target(const std::string &triple)
+{
+    auto &registry = get_target_registry();
+    std::lock_guard lock(registry.mutex);
+
+    if(auto it = registry.targets.find(triple); it != registry.targets.end())
+        return *it->second;
+
+    std::string err;
+    auto target = llvm::TargetRegistry::lookupTarget(triple, err);
+    if(!target)
+        throw CujException(err);
+
+    registry.targets.insert({ triple, target });
+    return *target;
+}
+
+TargetMachineLease::TargetMachineLease(
+    TargetMachineKey key, Box<llvm::TargetMachine> machine)
+    : key_(std::move(key)), machine_(std::move(machine))
+{
+
+}
+
+TargetMachineLease::TargetMachineLease(TargetMachineLease &&other) noexcept
+{
+    std::swap(key_, other.key_);
+    std::swap(machine_, other.machine_);
+}
+
+TargetMachineLease &TargetMachineLease::operator=(
+    TargetMachineLease &&other) noexcept
+{
+    std::swap(key_, other.key_);
+    std::swap(machine_, other.machine_);
+    return *this;
+}
+
+TargetMachineLease::~TargetMachineLease()
+{
+    if(!machine_)
+        return;
+    auto &registry = get_target_registry();
+    std::lock_guard lock(registry.mutex);
+    registry.idle_machines[key_].push_back(std::move(machine_));
+}
+
+llvm::TargetMachine *TargetMachineLease::get() const
+{
+    return machine_.get();
+}
+
+llvm::TargetMachine *TargetMachineLease::operator->() const
+{
+    return machine_.get();
+}
+
+TargetMachineLease acquire_target_machine(
+    const TargetMachineKey &key, const TargetMachineFactory &create)
+{
+    auto &registry = get_target_registry();
+
+    {
+        std::lock_guard lock(registry.mutex);
+        if(auto it = registry.idle_machines.find(key);
+           it != registry.idle_machines.end() && !it->second.empty())
+        {
+            auto machine = std::move(it->second.back());
+            it->second.pop_back();
+            return TargetMachineLease(key, std::move(machine));
+        }
+    }
+
+    Box<llvm::TargetMachine> machine(create(key));
+    if(!machine)
+        throw CujException("failed to create llvm target machine");
+    return TargetMachineLease(key, std::move(machine));
+}
+
+CUJ_NAMESPACE_END(cuj::gen)
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
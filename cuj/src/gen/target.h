@@ -0,0 +1,69 @@
+#pragma once
+
+#include <compare>
+#include <functional>
+
+#include <llvm/Support/TargetRegistry.h>
+#include <llvm/Target/TargetMachine.h>
+
+#include <cuj/common.h>
+#include <cuj/utils/uncopyable.h>
+
+CUJ_NAMESPACE_BEGIN(cuj::gen)
+
+// initialize llvm targets once per process. thread safe
+
+void init_native_target();
+
+void init_nvptx_target();
+
+// throws when the target is not registered
+const llvm::Target &lookup_target(const std::string &triple);
+
+struct TargetMachineKey
+{
+    std::string             triple;
+    std::string             cpu;
+    std::string             features;
+    llvm::CodeGenOpt::Level opt_level = llvm::CodeGenOpt::Default;
+    bool                    fast_math = false;
+
+    auto operator<=>(const TargetMachineKey &) const = default;
+};
+
+// llvm::TargetMachine is not thread safe, so cached machines are leased
+// exclusively and returned to the cache when the lease is destroyed.
+// machines owned by mcjit execution engines can't be returned and are not
+// cached. see create_native_target_machine
+class TargetMachineLease : public Uncopyable
+{
+public:
+
+    TargetMachineLease() = default;
+
+    TargetMachineLease(TargetMachineKey key, Box<llvm::TargetMachine> machine);
+
+    TargetMachineLease(TargetMachineLease &&other) noexcept;
+
+    TargetMachineLease &operator=(TargetMachineLease &&other) noexcept;
+
+    ~TargetMachineLease();
+
+    llvm::TargetMachine *get() const;
+
+    llvm::TargetMachine *operator->() const;
+
+private:
+
+    TargetMachineKey         key_;
+    Box<llvm::TargetMachine> machine_;
+};
+
+using TargetMachineFactory =
+    std::function<llvm::TargetMachine *(const TargetMachineKey &)>;
+
+// reuses an idle machine created with the same key, or calls create
+TargetMachineLease acquire_target_machine(
+    const TargetMachineKey &key, const TargetMachineFactory &create);
+
+CUJ_NAMESPACE_END(cuj::gen)
@@ -262,6 +262,15 @@ void Printer::print(TextBuilder &b, const core::CallFuncStat &call)
     b.new_line();
 }
 
+void Printer::print(TextBuilder &b, const core::VectorStore &store)
+{
+    b.append(store.aligned ? "store_aligned(" : "store(");
+    print(b, store.elem_ptr);
+    b.append(", ");
+    print(b, store.val);
+    b.appendl(")");
+}
+
 void Printer::print(TextBuilder &b, const core::Expr &e)
 {
     e.match([&](auto &_e) { print(b, _e); });
@@ -302,7 +311,7 @@ void Printer::print(TextBuilder &b, const core::NullPtr &null_ptr)
 void Printer::print(TextBuilder &b, const core::ArithmeticCast &cast)
 {
     b.append("cast<");
-    print(b, cast.dst_type->as<core::Builtin>());
+    print(b, *cast.dst_type);
     b.append(">(");
     print(b, *cast.src_val);
     b.append(")");
@@ -388,6 +397,132 @@ void Printer::print(TextBuilder &b, const core::CallFunc &call)
     b.append(")");
 }
 
+void Printer::print(TextBuilder &b, const core::Select &select)
+{
+    b.append("select(");
+    print(b, *select.cond);
+    b.append(", ");
+    print(b, *select.true_val);
+    b.append(", ");
+    print(b, *select.false_val);
+    b.append(")");
+}
+
+void Printer::print(TextBuilder &b, const core::VectorBroadcast &broadcast)
+{
+    b.append("broadcast<");
+    print(b, *broadcast.vector_type);
+    b.append(">(");
+    print(b, *broadcast.scalar);
+    b.append(")");
+}
+
+void Printer::print(TextBuilder &b, const core::VectorExtract &extract)
+{
+    print(b, *extract.vector);
+    b.append("[");
+    print(b, *extract.index);
+    b.append("]");
+}
+
+void Printer::print(TextBuilder &b, const core::VectorInsert &insert)
+{
+    b.append("insert(");
+    print(b, *insert.vector);
+    b.append(", ");
+    print(b, *insert.index);
+    b.append(", ");
+    print(b, *insert.element);
+    b.append(")");
+}
+
+void Printer::print(TextBuilder &b, const core::VectorShuffle &shuffle)
+{
+    b.append("shuffle(");
+    print(b, *shuffle.lhs);
+    b.append(", ");
+    print(b, *shuffle.rhs);
+    b.append(", {");
+    for(size_t i = 0; i < shuffle.indices.size(); ++i)
+        b.append(i > 0 ? ", " : "", shuffle.indices[i]);
+    b.append("})");
+}
+
+void Printer::print(TextBuilder &b, const core::VectorReduce &reduce)
+{
+    const char *name = "";
+    switch(reduce.op)
+    {
+    case core::VectorReduce::Op::Add:        name = "add"; break;
+    case core::VectorReduce::Op::Mul:        name = "mul"; break;
+    case core::VectorReduce::Op::Min:        name = "min"; break;
+    case core::VectorReduce::Op::Max:        name = "max"; break;
+    case core::VectorReduce::Op::BitwiseAnd: name = "and"; break;
+    case core::VectorReduce::Op::BitwiseOr:  name = "or";  break;
+    case core::VectorReduce::Op::BitwiseXOr: name = "xor"; break;
+    }
+    b.append("reduce_", name, "(");
+    print(b, *reduce.vector);
+    b.append(")");
+}
+
+void Printer::print(TextBuilder &b, const core::VectorLoad &load)
+{
+    b.append(load.aligned ? "load_aligned<" : "load<");
+    print(b, *load.vector_type);
+    b.append(">(");
+    print(b, *load.elem_ptr);
+    b.append(")");
+}
+
+void Printer::print(TextBuilder &b, const core::AtomicOperation &atomic)
+{
+    using Op = core::AtomicOperation::Op;
+
+    const char *name = "";
+    switch(atomic.op)
+    {
+    case Op::Add:             name = "add";              break;
+    case Op::Sub:             name = "sub";              break;
+    case Op::Min:             name = "min";              break;
+    case Op::Max:             name = "max";              break;
+    case Op::BitwiseAnd:      name = "and";              break;
+    case Op::BitwiseOr:       name = "or";               break;
+    case Op::BitwiseXOr:      name = "xor";              break;
+    case Op::Exchange:        name = "exchange";         break;
+    case Op::CompareExchange: name = "compare_exchange"; break;
+    }
+
+    const char *order = "";
+    switch(atomic.order)
+    {
+    case core::MemoryOrder::Relaxed: order = "relaxed"; break;
+    case core::MemoryOrder::Acquire: order = "acquire"; break;
+    case core::MemoryOrder::Release: order = "release"; break;
+    case core::MemoryOrder::AcqRel:  order = "acq_rel"; break;
+    case core::MemoryOrder::SeqCst:  order = "seq_cst"; break;
+    }
+
+    const char *scope = "";
+    switch(atomic.scope)
+    {
+    case core::MemoryScope::Block:  scope = "block";  break;
+    case core::MemoryScope::Device: scope = "device"; break;
+    case core::MemoryScope::System: scope = "system"; break;
+    }
+
+    b.append("atomic_", name, "<", order, ", ", scope, ">(");
+    print(b, *atomic.ptr);
+    if(atomic.cmp)
+    {
+        b.append(", ");
+        print(b, *atomic.cmp);
+    }
+    b.append(", ");
+    print(b, *atomic.val);
+    b.append(")");
+}
+
 void Printer::print(TextBuilder &b, const core::Type &type)
 {
     type.match([&](auto &t) { print(b, t); });
@@ -424,4 +559,10 @@ void Printer::print(TextBuilder &b, const core::Pointer &p)
     b.append(">");
 }
 
+void Printer::print(TextBuilder &b, const core::Vector &v)
+{
+    print(b, *v.element);
+    b.append("x", v.size);
+}
+
 CUJ_NAMESPACE_END(cuj)
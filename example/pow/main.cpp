@@ -11,6 +11,7 @@ int main()
     std::cin >> n;
 
     ScopedModule mod;
+    mod.set_constant_folding(true);
 
     Function pow_n = [n](i32 x) mutable
     {
@@ -27,6 +28,7 @@ int main()
     };
 
     MCJIT mcjit;
+    mcjit.set_options(Options{ .retain_llvm_ir = true });
     mcjit.generate(mod);
 
     std::cout << "============================= llvm ir =============================" << std::endl;
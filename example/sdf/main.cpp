@@ -284,6 +284,15 @@ std::string generate_ptx()
               << std::chrono::duration_cast<std::chrono::milliseconds>(
                     end_record_time - start_time).count()
               << "ms" << std::endl;
+
+    size_t ir_node_count = 0, ir_bytes = 0;
+    for(auto &func : mod._generate_prog().funcs)
+    {
+        ir_node_count += func->arena->get_node_count();
+        ir_bytes += func->arena->get_reserved_bytes();
+    }
+    std::cout << "recorded ir nodes: " << ir_node_count
+              << " (" << ir_bytes / 1024 << "KB)" << std::endl;
     
     std::cout << "compile time: "
               << std::chrono::duration_cast<std::chrono::milliseconds>(
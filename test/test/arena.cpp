@@ -0,0 +1,59 @@
+#include <array>
+
+#include <cuj/core/arena.h>
+
+#include "test.h"
+
+TEST_CASE("arena")
+{
+    SECTION("destruction")
+    {
+        auto counter = newRC<int>(0);
+        {
+            core::Arena arena;
+            for(int i = 0; i < 1000; ++i)
+                arena.create<RC<int>>(counter);
+            REQUIRE(counter.use_count() == 1001);
+            REQUIRE(arena.get_node_count() == 1000);
+        }
+        REQUIRE(counter.use_count() == 1);
+    }
+
+    SECTION("alignment")
+    {
+        struct alignas(64) Aligned { char data[64]; };
+
+        core::Arena arena;
+        arena.create<char>('a');
+        for(int i = 0; i < 300; ++i)
+        {
+            auto p = arena.create<Aligned>();
+            REQUIRE(reinterpret_cast<uintptr_t>(p) % 64 == 0);
+        }
+    }
+
+    SECTION("big node")
+    {
+        core::Arena arena;
+        auto small = arena.create<int>(1);
+        auto big = arena.create<std::array<char, 100000>>();
+        auto next = arena.create<int>(2);
+        big->fill('x');
+        REQUIRE(*small == 1);
+        REQUIRE(*next == 2);
+        REQUIRE(arena.get_reserved_bytes() >= 100000);
+    }
+
+    SECTION("recorded function")
+    {
+        ScopedModule mod;
+        function([](i32 a, i32 b) { return a * b + a; });
+        auto core_func = mod._generate_prog().funcs[0];
+        REQUIRE(core_func->arena->get_node_count() > 0);
+
+        with_mcjit([](i32 a, i32 b) { return a * b + a; }, [](auto c_func)
+        {
+            REQUIRE(c_func(3, 4) == 15);
+        });
+    }
+}
@@ -0,0 +1,163 @@
+#include "test.h"
+
+TEST_CASE("atomic")
+{
+    SECTION("operations")
+    {
+        with_mcjit([](
+            ptr<i32> a, ptr<u32> b, ptr<f32> c,
+            ptr<i32> a_old, ptr<u32> b_old, ptr<f32> c_old)
+        {
+            a_old[0] = cstd::atomic_add(a, 5);
+            a_old[1] = cstd::atomic_sub(a, 2);
+            a_old[2] = cstd::atomic_min(a, -7);
+            a_old[3] = cstd::atomic_max(a, 4);
+            a_old[4] = cstd::atomic_and(a, 6);
+            a_old[5] = cstd::atomic_or(a, 9, cstd::MemoryOrder::Relaxed);
+            a_old[6] = cstd::atomic_xor(a, 3, cstd::MemoryOrder::Release);
+            a_old[7] = cstd::atomic_exchange(a, 20, cstd::MemoryOrder::Acquire);
+            a_old[8] = cstd::atomic_compare_exchange(a, 19, 30);
+            a_old[9] = cstd::atomic_compare_exchange(
+                a, 20, 40, cstd::MemoryOrder::AcqRel);
+
+            b_old[0] = cstd::atomic_max(b, 7u);
+            b_old[1] = cstd::atomic_min(b, 3u);
+            b_old[2] = cstd::atomic_max(b, 0xffffffffu);
+
+            c_old[0] = cstd::atomic_add(c, 2.0f);
+            c_old[1] = cstd::atomic_sub(c, 0.5f);
+            c_old[2] = cstd::atomic_max(c, -1.0f);
+            c_old[3] = cstd::atomic_min(c, -1.0f);
+            c_old[4] = cstd::atomic_exchange(c, 8.0f);
+            c_old[5] = cstd::atomic_compare_exchange(c, 8.0f, 2.5f);
+        }, [](auto c_func)
+        {
+            int32_t a = 10, a_old[10];
+            uint32_t b = 5, b_old[3];
+            float c = 1.5f, c_old[6];
+            c_func(&a, &b, &c, a_old, b_old, c_old);
+
+            const int32_t expected_a_old[] = {
+                10, 15, 13, -7, 4, 4, 13, 14, 20, 20
+            };
+            for(int i = 0; i < 10; ++i)
+                REQUIRE(a_old[i] == expected_a_old[i]);
+            REQUIRE(a == 40);
+
+            REQUIRE(b_old[0] == 5);
+            REQUIRE(b_old[1] == 7);
+            REQUIRE(b_old[2] == 3);
+            REQUIRE(b == 0xffffffffu);
+
+            const float expected_c_old[] = { 1.5f, 3.5f, 3, 3, -1, 8 };
+            for(int i = 0; i < 6; ++i)
+                REQUIRE(c_old[i] == expected_c_old[i]);
+            REQUIRE(c == 2.5f);
+        });
+    }
+
+    SECTION("native kernel")
+    {
+        ScopedModule mod;
+        auto histogram = kernel("histogram", [](
+            ptr<i32> data, i32 n, ptr<i32> bins, ptr<f32> sum, ptr<u32> max_val)
+        {
+            i32 i = cstd::block_idx_x() * cstd::block_dim_x() + cstd::thread_idx_x();
+            $if(i < n)
+            {
+                i32 v = data[i];
+                cstd::atomic_add(bins + v % 16, 1);
+                cstd::atomic_add(sum, f32(v) * 0.5f, cstd::MemoryOrder::Relaxed);
+                cstd::atomic_max(max_val, u32(v));
+            };
+        });
+
+        MCJIT mcjit;
+        mcjit.generate(mod);
+        auto entry = mcjit.get_kernel(histogram);
+        REQUIRE(entry);
+
+        constexpr int32_t n = 10000;
+        std::vector<int32_t> data(n);
+        for(int32_t i = 0; i < n; ++i)
+            data[i] = (i * 7919) % 997;
+
+        std::vector<int32_t> bins(16, 0);
+        float sum = 0;
+        uint32_t max_val = 0;
+
+        NativeLauncher launcher(4);
+        launcher.set_chunk_size(1);
+        launcher.launch(
+            entry, Dim3{ (n + 63) / 64, 1, 1 }, Dim3{ 64, 1, 1 },
+            data.data(), n, bins.data(), &sum, &max_val);
+
+        std::vector<int32_t> expected_bins(16, 0);
+        float expected_sum = 0;
+        uint32_t expected_max = 0;
+        for(int32_t v : data)
+        {
+            ++expected_bins[v % 16];
+            expected_sum += static_cast<float>(v) * 0.5f;
+            expected_max = (std::max)(expected_max, static_cast<uint32_t>(v));
+        }
+        REQUIRE(bins == expected_bins);
+        REQUIRE(sum == expected_sum);
+        REQUIRE(max_val == expected_max);
+    }
+
+    SECTION("direct ssa")
+    {
+        ScopedModule mod;
+        auto func = function([](ptr<f32> dst, ptr<f32> vals, i32 n)
+        {
+            // cas loops of float max add blocks between reads of i and prev
+            i32 i = 0;
+            f32 prev = 0;
+            $while(i < n)
+            {
+                prev = prev + cstd::atomic_max(dst, vals[i]);
+                i = i + 1;
+            };
+            return prev;
+        });
+
+        Options opts;
+        opts.direct_ssa = true;
+        MCJIT mcjit;
+        mcjit.set_options(opts);
+        mcjit.generate(mod);
+        auto c_func = mcjit.get_function(func);
+        REQUIRE(c_func);
+
+        float dst = 0, vals[] = { 1, 3, 2, 5 };
+        REQUIRE(c_func(&dst, vals, 4) == 0 + 1 + 3 + 3);
+        REQUIRE(dst == 5);
+    }
+
+    SECTION("ptx")
+    {
+        ScopedModule mod;
+        kernel("scoped", [](ptr<i32> a, ptr<u32> b, ptr<f32> c)
+        {
+            cstd::atomic_add(
+                a, 1, cstd::MemoryOrder::Relaxed, cstd::MemoryScope::Block);
+            cstd::atomic_sub(
+                a, 2, cstd::MemoryOrder::SeqCst, cstd::MemoryScope::System);
+            cstd::atomic_max(
+                b, 3u, cstd::MemoryOrder::AcqRel, cstd::MemoryScope::Block);
+            cstd::atomic_min(c, 4.0f);
+            cstd::atomic_compare_exchange(
+                a, 5, 6, cstd::MemoryOrder::Relaxed, cstd::MemoryScope::Block);
+        });
+
+        PTXGenerator ptx_gen;
+        ptx_gen.generate(mod);
+        const auto &ptx = ptx_gen.get_ptx();
+        REQUIRE(ptx.find("atom.cta.add") != std::string::npos);
+        REQUIRE(ptx.find("atom.sys.add") != std::string::npos);
+        REQUIRE(ptx.find("atom.cta.cas") != std::string::npos);
+        REQUIRE(ptx.find("membar.cta") != std::string::npos);
+        REQUIRE(ptx.find("membar.sys") != std::string::npos);
+    }
+}
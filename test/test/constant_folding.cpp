@@ -0,0 +1,111 @@
+#include "test.h"
+
+namespace
+{
+
+    template<typename F>
+    size_t count_nodes(bool constant_folding, F &&f)
+    {
+        ScopedModule mod;
+        mod.set_constant_folding(constant_folding);
+        function(std::forward<F>(f));
+        return mod._generate_prog().funcs[0]->arena->get_node_count();
+    }
+
+    template<typename F, typename Action>
+    void with_folding_mcjit(F &&f, Action &&action)
+    {
+        ScopedModule mod;
+        mod.set_constant_folding(true);
+        auto func = function(std::forward<F>(f));
+        MCJIT mcjit;
+        mcjit.generate(mod);
+        auto c_func = mcjit.get_function(func);
+        REQUIRE(c_func);
+        if(c_func)
+            std::forward<Action>(action)(c_func);
+    }
+
+} // namespace anonymous
+
+TEST_CASE("constant folding")
+{
+    SECTION("fewer nodes")
+    {
+        auto body = [](i32 x)
+        {
+            i32 a = 2, b = 3;
+            i32 c = (a * b + 4) << 1;
+            return x * (c - 19) + (x - x * 0) * 1 + 0;
+        };
+        REQUIRE(count_nodes(true, body) < count_nodes(false, body));
+
+        with_folding_mcjit(body, [](auto f)
+        {
+            REQUIRE(f(0) == 0);
+            REQUIRE(f(5) == 10);
+            REQUIRE(f(-7) == -14);
+        });
+    }
+
+    SECTION("arithmetic")
+    {
+        with_folding_mcjit([]
+        {
+            i32 a = 7, b = -2;
+            u32 m = 0xffffffff;
+            f32 nan = std::numeric_limits<float>::quiet_NaN();
+            i32 ret = 0;
+            $if(a / b != -3)  { ret = ret | 1; };
+            $if(a % b != 1)   { ret = ret | 2; };
+            $if(m + 1u != 0u) { ret = ret | 4; };
+            $if(-b != 2)      { ret = ret | 8; };
+            $if(nan != nan)   { ret = ret | 16; };
+            $if(i64(b) != -2) { ret = ret | 32; };
+            $if(!(a > b))     { ret = ret | 64; };
+            return ret;
+        }, [](auto f)
+        {
+            REQUIRE(f() == 0);
+        });
+    }
+
+    SECTION("control flow")
+    {
+        with_folding_mcjit([](i32 n)
+        {
+            i32 sum = 0, i = 0;
+            $while(i < n)
+            {
+                sum = sum + i;
+                i = i + 1;
+            };
+            i32 x = 1;
+            $if(n > 3)
+            {
+                x = 2;
+            };
+            return sum * 10 + x;
+        }, [](auto f)
+        {
+            REQUIRE(f(0) == 1);
+            REQUIRE(f(3) == 31);
+            REQUIRE(f(5) == 102);
+        });
+    }
+
+    SECTION("address taken")
+    {
+        with_folding_mcjit([](i32 y)
+        {
+            i32 x = 1;
+            ref<i32> rx = x;
+            rx = y;
+            return x + 0;
+        }, [](auto f)
+        {
+            REQUIRE(f(4) == 4);
+            REQUIRE(f(-3) == -3);
+        });
+    }
+}
@@ -0,0 +1,309 @@
+#include "test.h"
+
+namespace
+{
+
+    struct Vec2
+    {
+        float x;
+        float y;
+    };
+
+    CUJ_CLASS(Vec2, x, y);
+
+    template<typename F, typename Action>
+    void with_interpreter(F &&f, Action &&action)
+    {
+        ScopedModule mod;
+        auto func = function(std::forward<F>(f));
+        Interpreter interpreter;
+        interpreter.generate(mod);
+        auto c_func = interpreter.get_function(func);
+        REQUIRE(c_func);
+        if(c_func)
+            std::forward<Action>(action)(c_func);
+    }
+
+} // namespace anonymous
+
+TEST_CASE("interpreter")
+{
+    SECTION("arithmetic")
+    {
+        with_interpreter([](i32 a, i32 b)
+        {
+            i32 ret = (a * b + a - b * 2) * (a + 1) / (b - 3);
+            return ret + a % b;
+        }, [](auto f)
+        {
+            REQUIRE(f(5, 7) == 44);
+            REQUIRE(f(-4, 9) == 25);
+        });
+
+        with_interpreter([](u8 a, u8 b)
+        {
+            u8 c = a + b;
+            u32 d = u32(c) << 3;
+            return d ^ (u32(a) >> 1);
+        }, [](auto f)
+        {
+            REQUIRE(f(200, 100) == ((44u << 3) ^ 100u));
+        });
+
+        with_interpreter([](f64 x, i64 y)
+        {
+            f32 ret = f32(x) * 2.0f;
+            $if(-x < 0.0)
+            {
+                $if(!(y > 5))
+                {
+                    ret = ret + f32(y);
+                };
+            };
+            return ret;
+        }, [](auto f)
+        {
+            REQUIRE(f(1.5, 2) == 5.0f);
+            REQUIRE(f(1.5, 7) == 3.0f);
+            REQUIRE(f(-1.5, 2) == -3.0f);
+        });
+    }
+
+    SECTION("control flow")
+    {
+        with_interpreter([](i32 n)
+        {
+            i32 ret = 0, i = 0;
+            $loop
+            {
+                i = i + 1;
+                $if(i > n)
+                {
+                    $break;
+                };
+                $if(i % 3 == 0)
+                {
+                    $continue;
+                };
+                $switch(i % 4)
+                {
+                    $case(0) { ret = ret + 100; };
+                    $case(1) { ret = ret + 10; $fallthrough; };
+                    $case(2) { ret = ret + 1; };
+                    $default { ret = ret - 1000; };
+                };
+            };
+            return ret;
+        }, [](auto f)
+        {
+            // i = 1, 2, 4, 5, 7, 8, 10
+            REQUIRE(f(10) == 11 + 1 + 100 + 11 - 1000 + 100 + 1);
+            REQUIRE(f(0) == 0);
+        });
+    }
+
+    SECTION("calls")
+    {
+        ScopedModule mod;
+
+        auto fib = declare<i32(i32)>();
+        fib.define([&](i32 i)
+        {
+            i32 ret;
+            $if(i <= 1)
+            {
+                $return(i);
+            }
+            $else
+            {
+                $return(ret = fib(i - 1) + fib(i - 2));
+            };
+        });
+
+        auto bump = function("bump", [](ref<i32> x)
+        {
+            x = x + 1;
+            return x;
+        });
+
+        auto sum_fib = function("sum_fib", [&](i32 n)
+        {
+            i32 i = 0, ret = 0;
+            $while(i < n)
+            {
+                ret = ret + fib(bump(i) - 1);
+            };
+            return ret;
+        });
+
+        Interpreter interpreter;
+        interpreter.generate(mod);
+
+        auto fib_c = interpreter.get_function(fib);
+        REQUIRE(fib_c);
+        REQUIRE(fib_c(10) == 55);
+
+        auto sum_fib_c = interpreter.get_function(sum_fib);
+        REQUIRE(sum_fib_c(6) == 0 + 1 + 1 + 2 + 3 + 5);
+        REQUIRE(interpreter.get_call_count("sum_fib") == 1);
+        REQUIRE(interpreter.get_call_count("bump") == 6);
+
+        int32_t x = 41;
+        auto bump_c = interpreter.get_function(bump);
+        REQUIRE(bump_c(&x) == 42);
+        REQUIRE(x == 42);
+
+        REQUIRE(!interpreter.get_function<int32_t(int32_t)>("not_a_function"));
+    }
+
+    SECTION("deep calls")
+    {
+        ScopedModule mod;
+
+        // frames of a few thousand calls span several frame stack chunks
+        auto deep = declare<i32(i32, boolean)>();
+        deep.define([&](i32 i, boolean fail)
+        {
+            arr<i32, 64> pad;
+            $if(i == 0)
+            {
+                // unsupported by the interpreter, so it traps
+                $if(fail)
+                {
+                    $return(cstd::thread_idx_x());
+                };
+                $return(i32(0));
+            };
+            pad[i % 64] = i;
+            $return(pad[i % 64] + deep(i - 1, fail));
+        });
+
+        Interpreter interpreter;
+        interpreter.generate(mod);
+
+        auto deep_c = interpreter.get_function(deep);
+        REQUIRE(deep_c(3000, false) == 3000 * 3001 / 2);
+        REQUIRE_THROWS_AS(deep_c(3000, true), CujException);
+        REQUIRE(deep_c(3000, false) == 3000 * 3001 / 2);
+        REQUIRE(deep_c(10, false) == 55);
+    }
+
+    SECTION("memory")
+    {
+        with_interpreter([](ptr<cxx<Vec2>> vs, i32 n)
+        {
+            cxx<Vec2> sum;
+            sum.x = 0;
+            sum.y = 0;
+            arr<f32, 2> weights;
+            weights[0] = 1;
+            weights[1] = -1;
+            i32 i = 0;
+            $while(i < n)
+            {
+                sum.x = sum.x + vs[i].x * weights[i % 2];
+                sum.y = sum.y + vs[i].y;
+                vs[i].x = 0;
+                i = i + 1;
+            };
+            return sum;
+        }, [](auto f)
+        {
+            Vec2 vs[3] = { { 1, 2 }, { 3, 4 }, { 5, 6 } };
+            const Vec2 sum = f(vs, 3);
+            REQUIRE(sum.x == 1 - 3 + 5);
+            REQUIRE(sum.y == 2 + 4 + 6);
+            REQUIRE(vs[1].x == 0);
+        });
+    }
+
+    SECTION("intrinsics")
+    {
+        with_interpreter([](f32 x, f64 y)
+        {
+            return f64(cstd::sqrt(x) + cstd::max(x, 1.0f)) + cstd::floor(y);
+        }, [](auto f)
+        {
+            REQUIRE(f(4.0f, 2.5) == Approx(2 + 4 + 2));
+            REQUIRE(f(0.25f, -0.5) == Approx(0.5 + 1 - 1));
+        });
+    }
+
+    SECTION("select")
+    {
+        with_interpreter([](ptr<cxx<Vec2>> vs, i32 n)
+        {
+            // keeps the vector with the largest x
+            cxx<Vec2> best = vs[0];
+            i32 i = 1;
+            $while(i < n)
+            {
+                cxx<Vec2> v = vs[i];
+                best = cstd::select(v.x > best.x, v, best);
+                i = i + 1;
+            };
+            return cstd::select(best.y > 0.0f, best.x, best.y);
+        }, [](auto f)
+        {
+            Vec2 vs[4] = { { 1, 2 }, { 7, -4 }, { 3, 4 }, { 5, 6 } };
+            REQUIRE(f(vs, 4) == -4.0f);
+            REQUIRE(f(vs, 1) == 1.0f);
+        });
+    }
+
+    SECTION("atomic")
+    {
+        with_interpreter([](ptr<i32> a, ptr<f32> b, ptr<i32> old)
+        {
+            old[0] = cstd::atomic_add(a, 5);
+            old[1] = cstd::atomic_min(a, -3);
+            old[2] = cstd::atomic_xor(a, 6);
+            old[3] = cstd::atomic_compare_exchange(a, 1, 9);
+            old[4] = cstd::atomic_compare_exchange(a, -5, 9);
+            f32 b_old = cstd::atomic_max(b, 2.5f);
+            return b_old + cstd::atomic_exchange(b, 1.0f);
+        }, [](auto f)
+        {
+            int32_t a = 4, old[5];
+            float b = 0.5f;
+            REQUIRE(f(&a, &b, old) == 0.5f + 2.5f);
+            const int32_t expected_old[] = { 4, 9, -3, -5, -5 };
+            for(int i = 0; i < 5; ++i)
+                REQUIRE(old[i] == expected_old[i]);
+            REQUIRE(a == 9);
+            REQUIRE(b == 1.0f);
+        });
+    }
+
+    SECTION("same results as mcjit")
+    {
+        ScopedModule mod;
+        auto func = function([](i32 a, u32 b, f32 c)
+        {
+            i32 x = a, i = 0;
+            $while(i < 10)
+            {
+                x = x * 3 + i32(b % 7u) - i32(c);
+                i = i + 1;
+            };
+            return f64(x) / f64(c) + f64(u8(a)) + f64(i8(b));
+        });
+
+        Interpreter interpreter;
+        interpreter.generate(mod);
+        MCJIT mcjit;
+        mcjit.generate(mod);
+
+        auto f = interpreter.get_function(func);
+        auto g = mcjit.get_function(func);
+        REQUIRE((f && g));
+        for(int32_t a : { -300, -1, 0, 7, 999 })
+        {
+            for(uint32_t b : { 0u, 5u, 200u, 0xfffffff0u })
+            {
+                for(float c : { 1.0f, 2.5f, -3.75f })
+                    REQUIRE(f(a, b, c) == g(a, b, c));
+            }
+        }
+    }
+}
@@ -1,5 +1,13 @@
+#include <cuj/core/hash.h>
+
 #include "test.h"
 
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+
 #define CHECK_C_FUNC_TYPE_DEFAULT(TYPE, FUNC)                                   \
     do {                                                                        \
         ScopedModule mod;                                                       \
@@ -56,3 +64,365 @@ TEST_CASE("mcjit")
     CHECK_C_FUNC_TYPE(const A * (A *),    [](ptr<cxx<A>> a) { return 1 + a; });
     CHECK_C_FUNC_TYPE(void * (const A *), [](ref<cxx<A>> a) { return a.address(); });
 }
+
+TEST_CASE("mcjit llvm ir retention")
+{
+    auto build = [&](bool retain_llvm_ir)
+    {
+        ScopedModule mod;
+        function("add", [](i32 a, i32 b) { return a + b; });
+        MCJIT mcjit;
+        mcjit.set_options(Options{ .retain_llvm_ir = retain_llvm_ir });
+        mcjit.generate(mod);
+        return mcjit.get_llvm_string();
+    };
+
+    REQUIRE(build(true).find("define") != std::string::npos);
+    REQUIRE(build(false).find("define") == std::string::npos);
+    REQUIRE(build(false).find("retain_llvm_ir") != std::string::npos);
+}
+
+TEST_CASE("mcjit object cache")
+{
+    const auto cache_dir =
+        std::filesystem::temp_directory_path() / "cuj_test_object_cache";
+    std::filesystem::remove_all(cache_dir);
+    CUJ_SCOPE_EXIT{ std::filesystem::remove_all(cache_dir); };
+
+    auto build = [&](MCJIT &mcjit)
+    {
+        ScopedModule mod;
+        auto func = function("add", [](i32 a, i32 b) { return a + b; });
+        mcjit.set_options(Options{
+            .object_cache_directory = cache_dir.string(),
+            .retain_llvm_ir         = true
+        });
+        mcjit.generate(mod);
+        return mcjit.get_function(func);
+    };
+
+    MCJIT mcjit_a;
+    auto func_a = build(mcjit_a);
+    REQUIRE(func_a);
+    REQUIRE(func_a(1, 2) == 3);
+    REQUIRE(!mcjit_a.get_llvm_string().empty());
+    REQUIRE(!std::filesystem::is_empty(cache_dir));
+
+    MCJIT mcjit_b;
+    auto func_b = build(mcjit_b);
+    REQUIRE(func_b);
+    REQUIRE(func_b(3, 4) == 7);
+    REQUIRE(mcjit_b.get_llvm_string().empty());
+
+    // a file with the same name but other hashed bytes, like a colliding
+    // program would write, is not used
+    for(auto &entry : std::filesystem::directory_iterator(cache_dir))
+    {
+        std::fstream file(
+            entry.path(), std::ios::in | std::ios::out | std::ios::binary);
+        file.seekg(8);
+        const char c = static_cast<char>(file.get());
+        file.seekp(8);
+        file.put(static_cast<char>(c ^ 1));
+    }
+
+    MCJIT mcjit_c;
+    auto func_c = build(mcjit_c);
+    REQUIRE(func_c);
+    REQUIRE(func_c(5, 6) == 11);
+    REQUIRE(!mcjit_c.get_llvm_string().empty());
+
+    MCJIT mcjit_d;
+    auto func_d = build(mcjit_d);
+    REQUIRE(func_d);
+    REQUIRE(func_d(7, 8) == 15);
+    REQUIRE(mcjit_d.get_llvm_string().empty());
+}
+
+TEST_CASE("mcjit compile cache")
+{
+    MCJIT::clear_compile_cache();
+
+    auto build = [&](MCJIT &mcjit)
+    {
+        ScopedModule mod;
+        auto add = function([](i32 a, i32 b) { return a + b; });
+        auto func = function([&](i32 a, i32 b) { return add(a, b) * 2; });
+        mcjit.set_options(Options{ .enable_compile_cache = true });
+        mcjit.generate(mod);
+        return mcjit.get_function(func);
+    };
+
+    MCJIT mcjit_a;
+    auto func_a = build(mcjit_a);
+    REQUIRE(func_a);
+    REQUIRE(func_a(1, 2) == 6);
+    REQUIRE(MCJIT::get_compile_cache_statistics().hits == 0);
+    REQUIRE(MCJIT::get_compile_cache_statistics().misses == 2);
+
+    MCJIT mcjit_b;
+    auto func_b = build(mcjit_b);
+    REQUIRE(func_b == func_a);
+    REQUIRE(func_b(3, 4) == 14);
+    REQUIRE(MCJIT::get_compile_cache_statistics().hits == 2);
+    REQUIRE(MCJIT::get_compile_cache_statistics().misses == 2);
+
+    // only the new function is compiled, together with its callee
+    MCJIT mcjit_c;
+    {
+        ScopedModule mod;
+        auto add = function([](i32 a, i32 b) { return a + b; });
+        auto func = function([&](i32 a, i32 b) { return add(a, b) * 2; });
+        auto sub_add = function([&](i32 a, i32 b) { return add(a, -b) + 1; });
+        mcjit_c.set_options(Options{ .enable_compile_cache = true });
+        mcjit_c.generate(mod);
+
+        auto func_c = mcjit_c.get_function(func);
+        REQUIRE(func_c == func_a);
+        auto sub_add_c = mcjit_c.get_function(sub_add);
+        REQUIRE(sub_add_c);
+        REQUIRE(sub_add_c(7, 3) == 5);
+        REQUIRE(MCJIT::get_compile_cache_statistics().hits == 4);
+        REQUIRE(MCJIT::get_compile_cache_statistics().misses == 3);
+    }
+
+    MCJIT::clear_compile_cache();
+    REQUIRE(func_b(5, 6) == 22);
+}
+
+TEST_CASE("mcjit compile cache key")
+{
+    // created without a module, so calls to it are context-less
+    auto twice = function([](i32 x) { return x * 2; });
+
+    auto get_key = [&](bool add_unrelated_func)
+    {
+        ScopedModule mod;
+        if(add_unrelated_func)
+            function([](i32 x) { return x - 1; });
+        function([&](i32 x) { return twice(x) + 1; });
+
+        // context-less functions are placed after all contexted ones
+        const auto prog = mod._generate_prog();
+        REQUIRE(prog.funcs.size() == (add_unrelated_func ? 3 : 2));
+        core::Hasher hasher;
+        hasher.hash_canonical(prog, prog.funcs.size() - 2);
+        return hasher.get_hash();
+    };
+
+    REQUIRE(get_key(false) == get_key(true));
+}
+
+TEST_CASE("mcjit native target")
+{
+    auto build = [&](Options opts)
+    {
+        opts.retain_llvm_ir = true;
+
+        ScopedModule mod;
+        auto func = function([](ptr<f32> a, ptr<f32> b, i32 n)
+        {
+            var i = 0;
+            $while(i < n)
+            {
+                a[i] = a[i] + b[i];
+                i = i + 1;
+            };
+        });
+        MCJIT mcjit;
+        mcjit.set_options(opts);
+        mcjit.generate(mod);
+        auto c_func = mcjit.get_function(func);
+        REQUIRE(c_func);
+
+        std::vector<float> a(37), b(37);
+        for(int i = 0; i < 37; ++i)
+        {
+            a[i] = static_cast<float>(i);
+            b[i] = static_cast<float>(2 * i);
+        }
+        c_func(a.data(), b.data(), 37);
+        for(int i = 0; i < 37; ++i)
+            REQUIRE(a[i] == static_cast<float>(3 * i));
+
+        return mcjit.get_llvm_string();
+    };
+
+    SECTION("host")
+    {
+        auto ir = build(Options{});
+        REQUIRE(ir.find("\"target-cpu\"") != std::string::npos);
+    }
+
+    SECTION("generic")
+    {
+        auto ir = build(Options{ .native_cpu = "generic" });
+        REQUIRE(ir.find("\"target-cpu\"=\"generic\"") != std::string::npos);
+    }
+}
+
+TEST_CASE("mcjit pipeline")
+{
+    auto build = [&](const Options &opts)
+    {
+        ScopedModule mod;
+        auto func = function([](i32 n)
+        {
+            var sum = 0, i = 0;
+            $while(i < n)
+            {
+                sum = sum + i;
+                i = i + 1;
+            };
+            return sum;
+        });
+        MCJIT mcjit;
+        mcjit.set_options(opts);
+        mcjit.generate(mod);
+        auto c_func = mcjit.get_function(func);
+        REQUIRE(c_func);
+        REQUIRE(c_func(10) == 45);
+    };
+
+    SECTION("opt levels")
+    {
+        for(auto level : {
+            OptimizationLevel::O0, OptimizationLevel::O1,
+            OptimizationLevel::O2, OptimizationLevel::O3,
+            OptimizationLevel::Os, OptimizationLevel::CompileFast })
+            build(Options{ .opt_level = level });
+    }
+
+    SECTION("custom pipeline")
+    {
+        build(Options{ .llvm_pipeline = "function(instcombine,simplifycfg)" });
+        REQUIRE_THROWS_AS(
+            build(Options{ .llvm_pipeline = "not-a-pass" }), CujException);
+    }
+}
+
+TEST_CASE("mcjit parallel compilation")
+{
+    ScopedModule mod;
+
+    std::vector<Function<i32(i32)>> funcs;
+    for(int i = 0; i < 16; ++i)
+    {
+        auto helper = function([i](i32 x) { return x * i; });
+        funcs.push_back(function([&, i](i32 x) { return helper(x) + i; }));
+    }
+    auto sum = function([](i32 a, i32 b) { return a + b; });
+
+    MCJIT mcjit;
+    mcjit.set_options(Options{ .compile_threads = 4, .retain_llvm_ir = true });
+    mcjit.generate(mod);
+
+    // one llvm module per partition
+    const auto &ir = mcjit.get_llvm_string();
+    size_t module_count = 0;
+    for(size_t pos = ir.find("; ModuleID"); pos != std::string::npos;
+        pos = ir.find("; ModuleID", pos + 1))
+        ++module_count;
+    REQUIRE(module_count == 4);
+
+    for(int i = 0; i < 16; ++i)
+    {
+        auto c_func = mcjit.get_function(funcs[i]);
+        REQUIRE(c_func);
+        REQUIRE(c_func(3) == 3 * i + i);
+    }
+
+    auto c_sum = mcjit.get_function(sum);
+    REQUIRE(c_sum);
+    REQUIRE(c_sum(1, 2) == 3);
+}
+
+TEST_CASE("mcjit tiered compilation")
+{
+    auto wait_for_promotion = [](const MCJIT &mcjit, size_t count)
+    {
+        const auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::seconds(60);
+        while(mcjit.get_promoted_function_count() < count &&
+              std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        return mcjit.get_promoted_function_count() >= count;
+    };
+
+    SECTION("promote all")
+    {
+        ScopedModule mod;
+        auto square = function([](i32 x) { return x * x; });
+        auto func = function([&](i32 x) { return square(x) + 1; });
+
+        MCJIT mcjit;
+        mcjit.set_options(Options{ .tiered_compilation = true });
+        mcjit.generate(mod);
+
+        auto c_func = mcjit.get_function(func);
+        REQUIRE(c_func);
+        REQUIRE(c_func(3) == 10);
+
+        REQUIRE(wait_for_promotion(mcjit, 2));
+        REQUIRE(mcjit.get_tier_up_error().empty());
+        REQUIRE(mcjit.get_function(func) == c_func);
+        REQUIRE(c_func(4) == 17);
+    }
+
+    SECTION("call threshold")
+    {
+        ScopedModule mod;
+        auto hot = function([](i32 x) { return x + 1; });
+        auto cold = function([](i32 x) { return x - 1; });
+
+        MCJIT mcjit;
+        mcjit.set_options(Options{
+            .tiered_compilation     = true,
+            .tier_up_call_threshold = 10
+        });
+        mcjit.generate(mod);
+
+        auto c_hot = mcjit.get_function(hot);
+        auto c_cold = mcjit.get_function(cold);
+        REQUIRE(c_cold(1) == 0);
+        for(int i = 0; i < 10; ++i)
+            REQUIRE(c_hot(i) == i + 1);
+
+        REQUIRE(wait_for_promotion(mcjit, 1));
+        REQUIRE(mcjit.get_tier_up_error().empty());
+        REQUIRE(c_hot(5) == 6);
+        REQUIRE(c_cold(5) == 4);
+        REQUIRE(mcjit.get_promoted_function_count() == 1);
+    }
+
+    SECTION("calls between functions")
+    {
+        // hot is only reached through cold, which is called once
+        ScopedModule mod;
+        auto hot = function([](i32 x) { return x * 2; });
+        auto cold = function([&](i32 n)
+        {
+            i32 sum = 0, i = 0;
+            $while(i < n)
+            {
+                sum = sum + hot(i);
+                i = i + 1;
+            };
+            return sum;
+        });
+
+        MCJIT mcjit;
+        mcjit.set_options(Options{
+            .tiered_compilation     = true,
+            .tier_up_call_threshold = 10
+        });
+        mcjit.generate(mod);
+
+        auto c_cold = mcjit.get_function(cold);
+        REQUIRE(c_cold(10) == 90);
+
+        REQUIRE(wait_for_promotion(mcjit, 1));
+        REQUIRE(mcjit.get_promoted_function_count() == 1);
+        REQUIRE(c_cold(4) == 12);
+    }
+}
@@ -0,0 +1,157 @@
+#include "test.h"
+
+TEST_CASE("native kernel")
+{
+    SECTION("1d grid")
+    {
+        ScopedModule mod;
+        auto add = kernel("add", [](ptr<i32> a, ptr<i32> b, ptr<i32> out, i32 n)
+        {
+            i32 i = cstd::block_idx_x() * cstd::block_dim_x()
+                  + cstd::thread_idx_x();
+            $if(i < n)
+            {
+                out[i] = a[i] + b[i];
+            };
+        });
+
+        MCJIT mcjit;
+        mcjit.generate(mod);
+        auto entry = mcjit.get_kernel(add);
+        REQUIRE(entry);
+
+        int32_t a[100], b[100], out[100] = {};
+        for(int32_t i = 0; i < 100; ++i)
+        {
+            a[i] = i * i;
+            b[i] = 7 - 3 * i;
+        }
+
+        // the last block is partially out of range
+        launch_native_kernel(
+            entry, { 4, 1, 1 }, { 32, 1, 1 }, &a[0], &b[0], &out[0], 90);
+        for(int32_t i = 0; i < 90; ++i)
+            REQUIRE(out[i] == a[i] + b[i]);
+        for(int32_t i = 90; i < 100; ++i)
+            REQUIRE(out[i] == 0);
+    }
+
+    SECTION("3d grid with divergent loops")
+    {
+        constexpr int32_t width = 12, height = 10, depth = 3;
+
+        auto expected = [](int32_t x, int32_t y, int32_t z)
+        {
+            int32_t sum = 0;
+            for(int32_t i = 0; i < x + y; ++i)
+                sum += i % 3 == 0 ? i : 1;
+            return sum + z * 1000;
+        };
+
+        auto run = [&](const Options &opts)
+        {
+            ScopedModule mod;
+            kernel("fill", [](ptr<i32> out, i32 w, i32 h)
+            {
+                i32 x = cstd::block_idx_x() * cstd::block_dim_x()
+                      + cstd::thread_idx_x();
+                i32 y = cstd::block_idx_y() * cstd::block_dim_y()
+                      + cstd::thread_idx_y();
+                i32 z = cstd::block_idx_z() * cstd::block_dim_z()
+                      + cstd::thread_idx_z();
+                i32 sum = 0, i = 0;
+                $while(i < x + y)
+                {
+                    $if(i % 3 == 0)
+                    {
+                        sum = sum + i;
+                    }
+                    $else
+                    {
+                        sum = sum + 1;
+                    };
+                    i = i + 1;
+                };
+                out[(z * h + y) * w + x] = sum + z * 1000;
+            });
+
+            MCJIT mcjit;
+            mcjit.set_options(opts);
+            mcjit.generate(mod);
+            auto entry = mcjit.get_kernel("fill");
+            REQUIRE(entry);
+
+            std::vector<int32_t> out(width * height * depth, -1);
+            launch_native_kernel(
+                entry, { 3, 2, 3 }, { 4, 5, 1 }, out.data(), width, height);
+            for(int32_t z = 0; z < depth; ++z)
+            {
+                for(int32_t y = 0; y < height; ++y)
+                {
+                    for(int32_t x = 0; x < width; ++x)
+                    {
+                        REQUIRE(out[(z * height + y) * width + x] ==
+                                expected(x, y, z));
+                    }
+                }
+            }
+        };
+
+        run(Options{});
+
+        Options opts;
+        opts.opt_level = OptimizationLevel::O0;
+        opts.direct_ssa = true;
+        run(opts);
+    }
+
+    SECTION("vectorized thread loop")
+    {
+        // threads of a block run in a scalar loop. straight-line kernels
+        // and $if turned into selects get simd lanes from the loop vectorizer
+        ScopedModule mod;
+        auto scale = kernel("scale", [](ptr<f32> a, ptr<f32> b, ptr<f32> out)
+        {
+            i32 i = cstd::block_idx_x() * cstd::block_dim_x()
+                  + cstd::thread_idx_x();
+            f32 v = a[i];
+            $if(v < 0.0f)
+            {
+                v = -v;
+            };
+            out[i] = v * 2.0f + b[i];
+        });
+
+        MCJIT mcjit;
+        mcjit.set_options(Options{ .retain_llvm_ir = true });
+        mcjit.generate(mod);
+        const auto &llvm_ir = mcjit.get_llvm_string();
+        REQUIRE(llvm_ir.find("vector.body") != std::string::npos);
+        REQUIRE(llvm_ir.find("x float>") != std::string::npos);
+
+        auto entry = mcjit.get_kernel(scale);
+        REQUIRE(entry);
+
+        float a[64], b[64], out[64];
+        for(int i = 0; i < 64; ++i)
+        {
+            a[i] = static_cast<float>(i % 7) - 3.0f;
+            b[i] = static_cast<float>(i);
+        }
+        launch_native_kernel(
+            entry, { 2, 1, 1 }, { 32, 1, 1 }, &a[0], &b[0], &out[0]);
+        for(int i = 0; i < 64; ++i)
+            REQUIRE(out[i] == std::abs(a[i]) * 2.0f + b[i]);
+    }
+
+    SECTION("thread index outside kernel")
+    {
+        ScopedModule mod;
+        function("not_a_kernel", [](ptr<i32> out)
+        {
+            *out = cstd::thread_idx_x();
+        });
+        MCJIT mcjit;
+        REQUIRE_THROWS_AS(mcjit.generate(mod), CujException);
+    }
+}
@@ -0,0 +1,86 @@
+#include "test.h"
+
+TEST_CASE("native launcher")
+{
+    ScopedModule mod;
+    auto fill = kernel("fill", [](ptr<i32> out, i32 width, i32 height)
+    {
+        i32 x = cstd::block_idx_x() * cstd::block_dim_x() + cstd::thread_idx_x();
+        i32 y = cstd::block_idx_y() * cstd::block_dim_y() + cstd::thread_idx_y();
+        $if(x < width & y < height)
+        {
+            // uneven work per block
+            i32 sum = 0, i = 0;
+            $while(i < x * y % 50)
+            {
+                sum = sum + i;
+                i = i + 1;
+            };
+            out[y * width + x] = out[y * width + x] + sum;
+        };
+    });
+
+    MCJIT mcjit;
+    mcjit.generate(mod);
+    auto entry = mcjit.get_kernel(fill);
+    REQUIRE(entry);
+
+    constexpr int32_t width = 203, height = 97;
+    const Dim3 block_dim = { 8, 4, 1 };
+    const Dim3 grid_dim = {
+        (width + block_dim.x - 1) / block_dim.x,
+        (height + block_dim.y - 1) / block_dim.y,
+        1
+    };
+
+    auto check = [&](const std::vector<int32_t> &out, int32_t launch_count)
+    {
+        for(int32_t y = 0; y < height; ++y)
+        {
+            for(int32_t x = 0; x < width; ++x)
+            {
+                const int32_t n = x * y % 50;
+                REQUIRE(out[y * width + x] == launch_count * n * (n - 1) / 2);
+            }
+        }
+    };
+
+    SECTION("thread counts")
+    {
+        for(int thread_count : { 1, 3, 8 })
+        {
+            NativeLauncher launcher(thread_count);
+            REQUIRE(launcher.get_thread_count() == thread_count);
+
+            std::vector<int32_t> out(width * height, 0);
+            auto statistics = launcher.launch(
+                entry, grid_dim, block_dim, out.data(), width, height);
+            REQUIRE(statistics.block_count == grid_dim.x * grid_dim.y);
+            REQUIRE(statistics.seconds >= 0);
+            check(out, 1);
+        }
+    }
+
+    SECTION("chunk size and pinning")
+    {
+        NativeLauncher launcher(4, true);
+        std::vector<int32_t> out(width * height, 0);
+        for(int64_t chunk_size : { 1, 5, 1000 })
+        {
+            launcher.set_chunk_size(chunk_size);
+            launcher.launch(
+                entry, grid_dim, block_dim, out.data(), width, height);
+        }
+        check(out, 3);
+    }
+
+    SECTION("empty grid")
+    {
+        NativeLauncher launcher(2);
+        std::vector<int32_t> out(width * height, 0);
+        auto statistics = launcher.launch(
+            entry, { 0, 1, 1 }, block_dim, out.data(), width, height);
+        REQUIRE(statistics.block_count == 0);
+        check(out, 0);
+    }
+}
@@ -0,0 +1,118 @@
+#include <cuj/core/hash.h>
+#include <cuj/core/optimize.h>
+
+#include "test.h"
+
+namespace
+{
+
+    uint64_t hash_prog(const core::Prog &prog)
+    {
+        core::Hasher hasher;
+        hasher.hash(prog);
+        return hasher.get_hash();
+    }
+
+} // namespace anonymous
+
+TEST_CASE("optimize")
+{
+    ScopedModule mod;
+
+    auto add_to = function("add_to", [](ref<i32> x, i32 y)
+    {
+        x = x + y;
+    });
+
+    auto func = function<i32>("func", [&](i32 a, i32 b, i32 c)
+    {
+        i32 unused = 0;
+        unused = a;
+
+        i32 x = a * b + c;
+        i32 y = a * b + c;
+        i32 sum = x * y;
+
+        i32 i = 0;
+        $while(i < 4)
+        {
+            // a * b is unchanged in the loop
+            sum = sum + (a * b - i);
+            $if(i == 2)
+            {
+                add_to(c, 1);
+                sum = sum + c * 2;
+                i = i + 1;
+                $continue;
+                sum = 0;
+            };
+            i = i + 1;
+            sum = sum + c * 2;
+        };
+
+        $switch(a % 3)
+        {
+            $case(0) { sum = sum + b * c; };
+            $case(1) { sum = sum - b * c; $fallthrough; };
+            $default { sum = sum ^ (b * c); };
+        };
+
+        $return(sum);
+        sum = 0;
+    });
+
+    const auto prog = mod._generate_prog();
+    const uint64_t hash_before = hash_prog(prog);
+
+    SECTION("statistics")
+    {
+        core::OptimizationStatistics statistics;
+        const auto optimized = core::optimize(prog, &statistics);
+        REQUIRE(hash_prog(prog) == hash_before);
+        REQUIRE(hash_prog(optimized) != hash_before);
+        REQUIRE(optimized.funcs.size() == prog.funcs.size());
+        REQUIRE(statistics.merged_exprs >= 2);
+        REQUIRE(statistics.removed_stores >= 1);
+        REQUIRE(statistics.removed_stats == 2);
+    }
+
+    SECTION("same results")
+    {
+        const auto optimized = core::optimize(prog);
+
+        MCJIT mcjit;
+        mcjit.generate(prog);
+
+        gen::clear_compile_time_statistics();
+        Options opts;
+        opts.core_optimizations = true;
+        MCJIT optimized_mcjit;
+        optimized_mcjit.set_options(opts);
+        optimized_mcjit.generate(prog);
+
+        const auto statistics = gen::get_compile_time_statistics();
+        REQUIRE(statistics.merged_exprs >= 2);
+        REQUIRE(statistics.core_pass_seconds > 0);
+        REQUIRE(statistics.llvm_pass_seconds > 0);
+
+        Interpreter interpreter;
+        interpreter.generate(optimized);
+
+        auto f = mcjit.get_function(func);
+        auto g = optimized_mcjit.get_function(func);
+        auto h = interpreter.get_function(func);
+        REQUIRE((f && g && h));
+        for(int32_t a : { -7, 0, 1, 5, 12 })
+        {
+            for(int32_t b : { -3, 2, 9 })
+            {
+                for(int32_t c : { -1, 0, 4 })
+                {
+                    const int32_t expected = f(a, b, c);
+                    REQUIRE(g(a, b, c) == expected);
+                    REQUIRE(h(a, b, c) == expected);
+                }
+            }
+        }
+    }
+}
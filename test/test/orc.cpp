@@ -0,0 +1,77 @@
+#include "test.h"
+
+TEST_CASE("orc jit")
+{
+    SECTION("call")
+    {
+        ScopedModule mod;
+        auto add = function("add", [](i32 a, i32 b) { return a + b; });
+        auto mul = function("mul", [](i32 a, i32 b) { return a * b; });
+        auto fma = function("fma", [&](i32 a, i32 b, i32 c)
+        {
+            return add(mul(a, b), c);
+        });
+
+        OrcJIT jit;
+        jit.generate(mod);
+
+        auto c_fma = jit.get_function(fma);
+        REQUIRE(c_fma);
+        REQUIRE(c_fma(2, 3, 4) == 10);
+
+        auto c_add = jit.get_function(add);
+        REQUIRE(c_add);
+        REQUIRE(c_add(5, 6) == 11);
+
+        REQUIRE(!jit.get_function<int32_t(int32_t)>("not_a_function"));
+    }
+
+    SECTION("lazy compilation")
+    {
+        ScopedModule mod;
+        auto used = function([](i32 x) { return x + 1; });
+        auto unused = function([](i32 x) { return x * 3; });
+
+        auto get_optimized_modules = []
+        {
+            return gen::get_compile_time_statistics().llvm_pass_modules;
+        };
+
+        gen::clear_compile_time_statistics();
+        OrcJIT jit;
+        jit.generate(mod);
+        REQUIRE(get_optimized_modules() == 0);
+
+        auto c_used = jit.get_function(used);
+        auto c_unused = jit.get_function(unused);
+        REQUIRE(c_used);
+        REQUIRE(c_unused);
+        REQUIRE(c_used(1) == 2);
+
+        const auto count = get_optimized_modules();
+        REQUIRE(count > 0);
+        REQUIRE(c_used(2) == 3);
+        REQUIRE(get_optimized_modules() == count);
+
+        REQUIRE(c_unused(2) == 6);
+        REQUIRE(get_optimized_modules() > count);
+    }
+
+    SECTION("intrinsic")
+    {
+        ScopedModule mod;
+        auto func = function([](f32 x, f32 y)
+        {
+            return cstd::tan(x) + cstd::atan2(y, x);
+        });
+
+        OrcJIT jit;
+        jit.set_options(Options{ .opt_level = OptimizationLevel::O2 });
+        jit.generate(mod);
+
+        auto c_func = jit.get_function(func);
+        REQUIRE(c_func);
+        REQUIRE(c_func(0.5f, 2.0f) ==
+            Approx(std::tan(0.5f) + std::atan2(2.0f, 0.5f)));
+    }
+}
@@ -0,0 +1,103 @@
+#include <cuj/core/hash.h>
+
+#include "test.h"
+
+namespace
+{
+
+    constexpr size_t TASK_COUNT = 48;
+
+    // records two functions per task. the second one calls the first one and
+    // a shared function recorded before
+    void record_task(size_t i, Function<i32(i32)> &shared)
+    {
+        const int32_t k = static_cast<int32_t>(i);
+
+        auto helper = function<i32>(
+            "helper" + std::to_string(i), [&](i32 x)
+        {
+            i32 ret = x, j = 0;
+            $while(j < k % 5)
+            {
+                ret = ret * 2 + j;
+                j = j + 1;
+            };
+            $return(ret);
+        });
+
+        function<i32>("func" + std::to_string(i), [&](i32 x, f32 y)
+        {
+            f32 t = y * f32(k);
+            $return(helper(x) + shared(x) + i32(t));
+        });
+    }
+
+    uint64_t hash_prog(const core::Prog &prog)
+    {
+        core::Hasher hasher;
+        hasher.hash(prog);
+        return hasher.get_hash();
+    }
+
+} // namespace anonymous
+
+TEST_CASE("parallel recording")
+{
+    auto record = [](int thread_count)
+    {
+        auto mod = newBox<Module>();
+        Module::set_current_module(mod.get());
+        CUJ_SCOPE_EXIT{ Module::set_current_module(nullptr); };
+
+        auto shared = function("shared", [](i32 x) { return x + 1; });
+        if(thread_count > 0)
+        {
+            mod->record_parallel(TASK_COUNT, [&](size_t i)
+            {
+                record_task(i, shared);
+            }, thread_count);
+        }
+        else
+        {
+            for(size_t i = 0; i < TASK_COUNT; ++i)
+                record_task(i, shared);
+        }
+        return mod;
+    };
+
+    auto sequential = record(0);
+    auto parallel = record(4);
+
+    const auto sequential_prog = sequential->_generate_prog();
+    const auto parallel_prog = parallel->_generate_prog();
+    REQUIRE(parallel_prog.funcs.size() == 1 + 2 * TASK_COUNT);
+    for(size_t i = 0; i < parallel_prog.funcs.size(); ++i)
+        REQUIRE(parallel_prog.funcs[i]->name == sequential_prog.funcs[i]->name);
+    REQUIRE(hash_prog(parallel_prog) == hash_prog(sequential_prog));
+
+    MCJIT mcjit;
+    mcjit.generate(parallel_prog);
+    for(size_t i = 0; i < TASK_COUNT; ++i)
+    {
+        auto f = mcjit.get_function<int32_t(int32_t, float)>(
+            "func" + std::to_string(i));
+        REQUIRE(f);
+
+        const int32_t k = static_cast<int32_t>(i);
+        int32_t expected = 3;
+        for(int32_t j = 0; j < k % 5; ++j)
+            expected = expected * 2 + j;
+        expected += 4 + static_cast<int32_t>(0.5f * static_cast<float>(k));
+        REQUIRE(f(3, 0.5f) == expected);
+    }
+
+    SECTION("exception")
+    {
+        ScopedModule mod;
+        REQUIRE_THROWS_AS(mod.record_parallel(8, [](size_t i)
+        {
+            if(i == 5)
+                throw CujException("task failed");
+        }, 2), CujException);
+    }
+}
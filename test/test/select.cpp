@@ -0,0 +1,87 @@
+#include "test.h"
+
+namespace
+{
+
+    struct Color
+    {
+        float r;
+        float g;
+        float b;
+    };
+
+    CUJ_CLASS(Color, r, g, b);
+
+} // namespace anonymous
+
+TEST_CASE("select")
+{
+    SECTION("arithmetic")
+    {
+        mcjit_require([](i32 a, i32 b)
+        {
+            return cstd::select(a < b, a, b) * 2;
+        }, 3, 5, 6);
+
+        mcjit_require([](f32 a, f32 b)
+        {
+            return cstd::select(a < b, a, b);
+        }, 3.5f, -2.0f, -2.0f);
+    }
+
+    SECTION("pointer")
+    {
+        with_mcjit([](ptr<i32> a, ptr<i32> b, boolean first)
+        {
+            return *cstd::select(first, a, b);
+        }, [](auto f)
+        {
+            int32_t a = 7, b = 9;
+            REQUIRE(f(&a, &b, true) == 7);
+            REQUIRE(f(&a, &b, false) == 9);
+        });
+    }
+
+    SECTION("class and array")
+    {
+        with_mcjit([](ptr<cxx<Color>> out, ptr<arr<i32, 3>> out_arr, f32 t)
+        {
+            cxx<Color> hot, cold;
+            hot.r = 1.0f; hot.g = 0.5f; hot.b = 0.0f;
+            cold.r = 0.0f; cold.g = 0.25f; cold.b = 1.0f;
+            *out = cstd::select(t > 0.5f, hot, cold);
+
+            arr<i32, 3> a, b;
+            a[0] = 1; a[1] = 2; a[2] = 3;
+            b[0] = 4; b[1] = 5; b[2] = 6;
+            *out_arr = cstd::select(t > 0.5f, a, b);
+        }, [](auto f)
+        {
+            Color color = {};
+            int32_t a[3] = {};
+            f(&color, &a, 0.7f);
+            REQUIRE((color.r == 1.0f && color.g == 0.5f && color.b == 0.0f));
+            REQUIRE((a[0] == 1 && a[1] == 2 && a[2] == 3));
+            f(&color, &a, 0.2f);
+            REQUIRE((color.r == 0.0f && color.g == 0.25f && color.b == 1.0f));
+            REQUIRE((a[0] == 4 && a[1] == 5 && a[2] == 6));
+        });
+    }
+
+    SECTION("no branch")
+    {
+        ScopedModule mod;
+        function("min3", [](i32 a, i32 b, i32 c)
+        {
+            i32 m = cstd::select(a < b, a, b);
+            return cstd::select(m < c, m, c);
+        });
+
+        LLVMIRGenerator gen;
+        gen.disable_basic_optimizations();
+        gen.generate(mod);
+        const auto ir = gen.get_llvm_string();
+        REQUIRE(ir.find(" select ") != std::string::npos);
+        REQUIRE(ir.find(" br ") == std::string::npos);
+    }
+}
@@ -0,0 +1,221 @@
+#include <functional>
+
+#include <cuj/core/hash.h>
+#include <cuj/core/serialize.h>
+#include <cuj/core/visit.h>
+
+#include "test.h"
+
+namespace
+{
+
+    struct Node
+    {
+        int32_t value;
+        Node   *next;
+    };
+
+    CUJ_CLASS(Node, value, next);
+
+    uint64_t hash_prog(const core::Prog &prog)
+    {
+        core::Hasher hasher;
+        hasher.hash(prog);
+        return hasher.get_hash();
+    }
+
+    class ExprCorrupter : public core::Rewriter<ExprCorrupter>
+    {
+    public:
+
+        std::function<void(core::Expr &)> corrupt;
+
+        void rewrite_expr(core::Expr &expr)
+        {
+            corrupt(expr);
+        }
+    };
+
+    // loads data, breaks the program with corrupt and writes it again
+    std::vector<uint8_t> corrupt_prog(
+        const std::vector<uint8_t> &data,
+        const std::function<void(core::Prog &)> &corrupt)
+    {
+        auto prog = core::deserialize(data.data(), data.size());
+        corrupt(prog);
+        return core::serialize(prog);
+    }
+
+    std::vector<uint8_t> corrupt_exprs(
+        const std::vector<uint8_t> &data,
+        std::function<void(core::Expr &)> corrupt)
+    {
+        return corrupt_prog(data, [&](core::Prog &prog)
+        {
+            ExprCorrupter corrupter;
+            corrupter.corrupt = std::move(corrupt);
+            for(auto &f : prog.funcs)
+                corrupter.rewrite(const_cast<core::Func &>(*f));
+        });
+    }
+
+} // namespace anonymous
+
+TEST_CASE("serialize")
+{
+    ScopedModule mod;
+
+    auto square = function("square", [](i32 x) { return x * x; });
+
+    function("sum_squares", [&](i32 n)
+    {
+        i32 sum = 0, i = 0;
+        $while(i < n)
+        {
+            $if(i % 2 == 0)
+            {
+                sum = sum + square(i);
+            }
+            $else
+            {
+                sum = sum - 1;
+            };
+            i = i + 1;
+        };
+        return sum;
+    });
+
+    function("classify", [](f64 x)
+    {
+        i32 ret = 0;
+        $switch(i32(x))
+        {
+            $case(0) { ret = 10; };
+            $case(1) { ret = 20; };
+            $default { ret = -1; };
+        };
+        return ret;
+    });
+
+    function("list_sum", [](ptr<cxx<Node>> head, i32 count)
+    {
+        i32 sum = 0;
+        arr<i32, 2> weights;
+        weights[0] = 1;
+        weights[1] = 2;
+        $while(count > 0)
+        {
+            count = count - 1;
+            sum = sum + head->value * weights[head->value % 2];
+            head = head->next;
+        };
+        return sum;
+    });
+
+    function("fetch_add", [](ptr<i32> p, i32 v)
+    {
+        return cstd::atomic_add(
+            p, v, cstd::MemoryOrder::AcqRel, cstd::MemoryScope::Block);
+    });
+
+    const auto prog = mod._generate_prog();
+    const auto data = core::serialize(prog);
+
+    SECTION("round trip")
+    {
+        const auto loaded = core::deserialize(data.data(), data.size());
+        REQUIRE(loaded.funcs.size() == prog.funcs.size());
+        REQUIRE(hash_prog(loaded) == hash_prog(prog));
+        REQUIRE(core::serialize(loaded) == data);
+
+        MCJIT mcjit;
+        mcjit.generate(loaded);
+
+        auto sum_squares =
+            mcjit.get_function<int32_t(int32_t)>("sum_squares");
+        REQUIRE(sum_squares);
+        REQUIRE(sum_squares(5) == 0 + 4 + 16 - 2);
+
+        auto classify = mcjit.get_function<int32_t(double)>("classify");
+        REQUIRE(classify);
+        REQUIRE(classify(0.5) == 10);
+        REQUIRE(classify(1.0) == 20);
+        REQUIRE(classify(7.0) == -1);
+
+        auto list_sum =
+            mcjit.get_function<int32_t(Node *, int32_t)>("list_sum");
+        REQUIRE(list_sum);
+        Node c = { 3, nullptr }, b = { 2, &c }, a = { 1, &b };
+        REQUIRE(list_sum(&a, 3) == 1 * 2 + 2 * 1 + 3 * 2);
+
+        auto fetch_add =
+            mcjit.get_function<int32_t(int32_t *, int32_t)>("fetch_add");
+        REQUIRE(fetch_add);
+        int32_t x = 3;
+        REQUIRE(fetch_add(&x, 4) == 3);
+        REQUIRE(x == 7);
+    }
+
+    SECTION("invalid data")
+    {
+        REQUIRE_THROWS_AS(core::deserialize(data.data(), 3), CujException);
+
+        auto bad_version = data;
+        bad_version[4] ^= 0xff;
+        REQUIRE_THROWS_AS(
+            core::deserialize(bad_version.data(), bad_version.size()),
+            CujException);
+
+        REQUIRE_THROWS_AS(
+            core::deserialize(data.data(), data.size() - 1), CujException);
+
+        auto require_invalid = [](const std::vector<uint8_t> &bad_data)
+        {
+            REQUIRE_THROWS_AS(
+                core::deserialize(bad_data.data(), bad_data.size()),
+                CujException);
+        };
+
+        // addresses of arguments and local allocs beyond the declared ones
+        for(auto clear_decls : {
+            +[](core::Func &f) { f.argument_types.clear(); },
+            +[](core::Func &f) { f.local_alloc_types.clear(); } })
+        {
+            require_invalid(corrupt_prog(data, [&](core::Prog &prog)
+            {
+                for(auto &f : prog.funcs)
+                    clear_decls(const_cast<core::Func &>(*f));
+            }));
+        }
+
+        require_invalid(corrupt_exprs(data, [](core::Expr &expr)
+        {
+            if(auto e = expr.as_if<core::ClassPointerToMemberPointer>())
+                e->member_index = 2;
+        }));
+
+        require_invalid(corrupt_exprs(data, [](core::Expr &expr)
+        {
+            auto e = expr.as_if<core::CallFunc>();
+            if(e && !e->contextless_func && e->intrinsic == core::Intrinsic::None)
+                e->contexted_func_index = 1000;
+        }));
+
+        require_invalid(corrupt_exprs(data, [](core::Expr &expr)
+        {
+            if(auto e = expr.as_if<core::CallFunc>())
+                e->intrinsic = static_cast<core::Intrinsic>(1 << 20);
+        }));
+
+        // Node containing itself by value
+        require_invalid(corrupt_prog(data, [](core::Prog &prog)
+        {
+            auto &types = const_cast<core::TypeSet &>(*prog.global_type_set);
+            for(auto &[key, type] : types.index_to_type)
+            {
+                if(auto s = type->as_if<core::Struct>())
+                    s->members.push_back(type.get());
+            }
+        }));
+    }
+}
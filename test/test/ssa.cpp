@@ -0,0 +1,96 @@
+#include "test.h"
+
+TEST_CASE("direct ssa")
+{
+    ScopedModule mod;
+
+    auto add_to = function("add_to", [](ref<i32> x, i32 y)
+    {
+        x = x + y;
+    });
+
+    auto fib = function<i32>("fib", [](i32 n)
+    {
+        i32 a = 0, b = 1;
+        $while(n > 0)
+        {
+            i32 t = a + b;
+            a = b;
+            b = t;
+            n = n - 1;
+        };
+        $return(a);
+    });
+
+    auto func = function<i32>("func", [&](i32 a, i32 b, f32 c)
+    {
+        i32 sum = 0;
+        f32 acc = c;
+        i32 i = 0;
+        $loop
+        {
+            $if(i >= a)
+            {
+                $break;
+            };
+            i = i + 1;
+            $if(i % 3 == 0)
+            {
+                acc = acc * 0.5f;
+                $continue;
+            }
+            $else
+            {
+                acc = acc + 1.0f;
+            };
+            $switch(i % 4)
+            {
+                $case(0) { sum = sum + b; };
+                $case(1) { sum = sum - 1; $fallthrough; };
+                $case(2) { sum = sum * 2; };
+                $default { add_to(sum, fib(i % 10)); };
+            };
+        };
+        $if(b < 0)
+        {
+            $return(sum - i32(acc));
+        };
+        $return(sum + i32(acc));
+    });
+
+    auto build = [&](bool direct_ssa)
+    {
+        Options opts;
+        opts.opt_level = OptimizationLevel::O0;
+        opts.direct_ssa = direct_ssa;
+        opts.retain_llvm_ir = true;
+        auto mcjit = newBox<MCJIT>();
+        mcjit->set_options(opts);
+        mcjit->generate(mod);
+        return mcjit;
+    };
+
+    auto mcjit_memory = build(false);
+    auto mcjit_ssa = build(true);
+
+    const std::string ir = mcjit_ssa->get_llvm_string();
+    REQUIRE(ir.find("phi") != std::string::npos);
+
+    auto fib_memory = mcjit_memory->get_function(fib);
+    auto fib_ssa = mcjit_ssa->get_function(fib);
+    auto f_memory = mcjit_memory->get_function(func);
+    auto f_ssa = mcjit_ssa->get_function(func);
+    REQUIRE((fib_memory && fib_ssa && f_memory && f_ssa));
+
+    for(int32_t n : { 0, 1, 2, 7, 20 })
+        REQUIRE(fib_ssa(n) == fib_memory(n));
+
+    for(int32_t a : { -1, 0, 1, 5, 13, 40 })
+    {
+        for(int32_t b : { -4, 3 })
+        {
+            for(float c : { -2.5f, 0.0f, 7.0f })
+                REQUIRE(f_ssa(a, b, c) == f_memory(a, b, c));
+        }
+    }
+}
@@ -0,0 +1,104 @@
+#include <optional>
+#include <vector>
+
+#include "test.h"
+
+TEST_CASE("temp value")
+{
+    SECTION("fewer locals")
+    {
+        ScopedModule mod;
+        function([](i32 a, i32 b)
+        {
+            return (a * b + a - b * 2) * (a + 1) / (b - 3);
+        });
+        auto core_func = mod._generate_prog().funcs[0];
+        REQUIRE(core_func->local_alloc_types.size() <= 2);
+    }
+
+    SECTION("reassigned in loop")
+    {
+        mcjit_require([](i32 n)
+        {
+            i32 sum = 0, i = 1;
+            i32 step = i + 1;
+            $while(i <= n)
+            {
+                sum = sum + i;
+                i = i + step - 1;
+            };
+            return sum + step;
+        }, 4, 12);
+    }
+
+    SECTION("used after side effects")
+    {
+        mcjit_require([](i32 x)
+        {
+            i32 y = x + 1;
+            i32 z = y * 2;
+            x = 100;
+            y = y + x;
+            return y + z + x;
+        }, 3, 212);
+    }
+
+    SECTION("used in nested blocks")
+    {
+        mcjit_require([](i32 x)
+        {
+            i32 a = x * 3;
+            i32 ret = 0;
+            $if(x > 0)
+            {
+                ret = a + 1;
+            }
+            $else
+            {
+                ret = a - 1;
+            };
+            x = 0;
+            return ret + a;
+        }, 2, 13);
+    }
+
+    SECTION("materialized out of order")
+    {
+        mcjit_require([](i32 x)
+        {
+            // stores of the temps are inserted between the updates of y
+            std::vector<i32> temps;
+            i32 y = 0;
+            for(int i = 0; i < 200; ++i)
+            {
+                temps.emplace_back(x + y + i);
+                if(i % 10 == 9)
+                    y = y + 1;
+            }
+            x = x * 2;
+            i32 sum = 0;
+            for(int i = 199; i >= 0; --i)
+                sum = sum + temps[i];
+            return sum + x;
+        }, 3, 200 * 3 + 10 * (0 + 19) * 20 / 2 + 199 * 200 / 2 + 6);
+    }
+
+    SECTION("outlives its block")
+    {
+        mcjit_require([](i32 x)
+        {
+            std::optional<i32> saved;
+            i32 ret = 0;
+            $if(x > 0)
+            {
+                saved.emplace(x * 5);
+                x = 1;
+            };
+            $if(x > 0)
+            {
+                ret = *saved;
+            };
+            return ret;
+        }, 2, 10);
+    }
+}
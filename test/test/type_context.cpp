@@ -0,0 +1,45 @@
+#include "test.h"
+
+namespace
+{
+
+    struct Pair
+    {
+        int32_t a;
+        float   b;
+    };
+
+    CUJ_CLASS(Pair, a, b);
+
+} // namespace anonymous
+
+TEST_CASE("type context")
+{
+    dsl::TypeContext ctx_a(newRC<core::TypeSet>());
+    dsl::TypeContext ctx_b(newRC<core::TypeSet>());
+
+    auto i32_a = ctx_a.get_type<i32>();
+    auto i32_b = ctx_b.get_type<i32>();
+    REQUIRE(i32_a != i32_b);
+    REQUIRE(*i32_a == *i32_b);
+
+    // alternate between contexts to invalidate the cached type
+    REQUIRE(ctx_a.get_type<i32>() == i32_a);
+    REQUIRE(ctx_b.get_type<i32>() == i32_b);
+    REQUIRE(ctx_a.get_type<i32>() == i32_a);
+
+    auto ctx_c = ctx_a;
+    REQUIRE(ctx_c.get_type<i32>() == i32_a);
+
+    auto pair_type = ctx_b.get_type<cxx<Pair>>();
+    auto &members = pair_type->as<core::Struct>().members;
+    REQUIRE(members.size() == 2);
+    REQUIRE(members[0] == i32_b);
+    REQUIRE(members[1] == ctx_b.get_type<f32>());
+    REQUIRE(ctx_b.get_type<ptr<cxx<Pair>>>()->as<core::Pointer>().pointed
+            == pair_type);
+
+    REQUIRE(ctx_a.get_type_index(i32_a) ==
+            core::TypeKey(std::type_index(typeid(i32))));
+    REQUIRE(ctx_a.get_all_types().size() == 1);
+}
@@ -0,0 +1,231 @@
+#include <algorithm>
+
+#include "test.h"
+
+TEST_CASE("vector")
+{
+    SECTION("arithmetic")
+    {
+        with_mcjit([](ptr<f32> a, ptr<f32> b, ptr<f32> out, f32 s)
+        {
+            f32x4 x = f32x4::load(a);
+            f32x4 y = f32x4::load(b);
+            f32x4 z = (x + y) * s - x / f32x4(2.0f);
+            z = -z + 1.0f;
+            z.store(out);
+        }, [](auto c_func)
+        {
+            float a[] = { 1, 2, 3, 4 }, b[] = { 5, -6, 7, 0.5f };
+            float out[4];
+            c_func(a, b, out, 3.0f);
+            for(int i = 0; i < 4; ++i)
+                REQUIRE(out[i] == Approx(-((a[i] + b[i]) * 3 - a[i] / 2) + 1));
+        });
+    }
+
+    SECTION("integer and elements")
+    {
+        with_mcjit([](ptr<i32> a, ptr<i32> out, i32 k)
+        {
+            i32x8 x = i32x8::load(a);
+            i32x8 y = (x * 3 + k) % 7;
+            y = y ^ (x & 6);
+            y.set(k, y[0] + y[7]);
+            y.store(out);
+        }, [](auto c_func)
+        {
+            int32_t a[] = { 1, -2, 3, 14, 5, 6, -7, 8 };
+            int32_t expected[8], out[8];
+            for(int i = 0; i < 8; ++i)
+                expected[i] = ((a[i] * 3 + 2) % 7) ^ (a[i] & 6);
+            expected[2] = expected[0] + expected[7];
+            c_func(a, out, 2);
+            for(int i = 0; i < 8; ++i)
+                REQUIRE(out[i] == expected[i]);
+        });
+    }
+
+    SECTION("aligned load and store")
+    {
+        with_mcjit([](ptr<f32> a, ptr<f32> out)
+        {
+            f32x8 x = f32x8::load_aligned(a);
+            (x * x).store_aligned(out);
+        }, [](auto c_func)
+        {
+            alignas(32) float a[8], out[8];
+            for(int i = 0; i < 8; ++i)
+                a[i] = static_cast<float>(i) - 2.5f;
+            c_func(a, out);
+            for(int i = 0; i < 8; ++i)
+                REQUIRE(out[i] == a[i] * a[i]);
+        });
+    }
+
+    SECTION("mask and select")
+    {
+        with_mcjit([](ptr<f32> a, ptr<f32> b, ptr<f32> out, ptr<i32> count)
+        {
+            f32x4 x = f32x4::load(a);
+            f32x4 y = f32x4::load(b);
+            boolx4 less = x < y;
+            select(less, x, y).store(out);
+            *count = select(
+                less & !(x == f32x4(0.0f)), i32x4(1), i32x4(0)).reduce_add();
+        }, [](auto c_func)
+        {
+            float a[] = { 1, 9, 0, -4 }, b[] = { 2, 3, 4, -5 };
+            float out[4];
+            int32_t count = 0;
+            c_func(a, b, out, &count);
+            for(int i = 0; i < 4; ++i)
+                REQUIRE(out[i] == (std::min)(a[i], b[i]));
+            REQUIRE(count == 1);
+        });
+    }
+
+    SECTION("masks in memory")
+    {
+        with_mcjit([](ptr<f32> a, ptr<f32> b, ptr<boolean> mask, ptr<i32> count)
+        {
+            (f32x4::load(a) < f32x4::load(b)).store(mask);
+            i32 n = 0;
+            for(int i = 0; i < 4; ++i)
+            {
+                $if(mask[i])
+                {
+                    n = n + 1;
+                };
+            }
+            *count = n;
+            (!boolx4::load(mask)).store(mask + 4);
+        }, [](auto c_func)
+        {
+            float a[] = { 1, 9, 0, -4 }, b[] = { 2, 3, 4, -5 };
+            bool mask[8];
+            int32_t count = 0;
+            c_func(a, b, mask, &count);
+            for(int i = 0; i < 4; ++i)
+            {
+                REQUIRE(mask[i] == (a[i] < b[i]));
+                REQUIRE(mask[i + 4] == !(a[i] < b[i]));
+            }
+            REQUIRE(count == 2);
+        });
+    }
+
+    SECTION("shuffle")
+    {
+        with_mcjit([](ptr<i32> a, ptr<i32> b, ptr<i32> out)
+        {
+            i32x4 x = i32x4::load(a);
+            i32x4 y = i32x4::load(b);
+            x.shuffle<3, 2, 1, 0>().store(out);
+            x.shuffle<0, 4, 1, 5, 2, 6, 3, 7>(y).store(out + 4);
+            x.shuffle<1, 1>().store(out + 12);
+        }, [](auto c_func)
+        {
+            int32_t a[] = { 1, 2, 3, 4 }, b[] = { 5, 6, 7, 8 };
+            const int32_t expected[] = {
+                4, 3, 2, 1, 1, 5, 2, 6, 3, 7, 4, 8, 2, 2
+            };
+            int32_t out[14];
+            c_func(a, b, out);
+            for(int i = 0; i < 14; ++i)
+                REQUIRE(out[i] == expected[i]);
+        });
+    }
+
+    SECTION("reduction")
+    {
+        with_mcjit([](ptr<i32> a, ptr<i32> out)
+        {
+            i32x8 x = i32x8::load(a);
+            out[0] = x.reduce_add();
+            out[1] = x.reduce_mul();
+            out[2] = x.reduce_min();
+            out[3] = x.reduce_max();
+            out[4] = x.reduce_and();
+            out[5] = x.reduce_or();
+            out[6] = x.reduce_xor();
+
+            // odd sizes are reduced element by element
+            vec<int32_t, 3> y = x.shuffle<1, 2, 3>();
+            out[7] = y.reduce_add();
+        }, [](auto c_func)
+        {
+            int32_t a[] = { 3, -1, 7, 2, 5, 6, -4, 15 };
+            int32_t out[8];
+            c_func(a, out);
+
+            int32_t sum = 0, prod = 1, and_v = -1, or_v = 0, xor_v = 0;
+            for(auto v : a)
+            {
+                sum += v;
+                prod *= v;
+                and_v &= v;
+                or_v |= v;
+                xor_v ^= v;
+            }
+            REQUIRE(out[0] == sum);
+            REQUIRE(out[1] == prod);
+            REQUIRE(out[2] == *std::min_element(std::begin(a), std::end(a)));
+            REQUIRE(out[3] == *std::max_element(std::begin(a), std::end(a)));
+            REQUIRE(out[4] == and_v);
+            REQUIRE(out[5] == or_v);
+            REQUIRE(out[6] == xor_v);
+            REQUIRE(out[7] == a[1] + a[2] + a[3]);
+        });
+    }
+
+    SECTION("conversion and loop")
+    {
+        with_mcjit([](ptr<i32> a, i32 n)
+        {
+            // sums blocks of 4 elements as floats
+            f32x4 acc = 0.0f;
+            i32 i = 0;
+            $while(i + 4 <= n)
+            {
+                acc = acc + i32x4::load(a + i).as<float>();
+                i = i + 4;
+            };
+            return acc.reduce_add().as<i32>();
+        }, [](auto c_func)
+        {
+            int32_t a[12];
+            for(int i = 0; i < 12; ++i)
+                a[i] = i * i;
+            REQUIRE(c_func(a, 12) == 506);
+            REQUIRE(c_func(a, 7) == 14);
+        });
+    }
+
+    SECTION("direct ssa")
+    {
+        ScopedModule mod;
+        auto func = function([](ptr<f32> a, i32 n)
+        {
+            f32x4 acc = 1.0f;
+            i32 i = 0;
+            $while(i < n)
+            {
+                acc = acc * f32x4::load(a);
+                i = i + 1;
+            };
+            return acc.reduce_max();
+        });
+
+        Options opts;
+        opts.direct_ssa = true;
+        MCJIT mcjit;
+        mcjit.set_options(opts);
+        mcjit.generate(mod);
+        auto c_func = mcjit.get_function(func);
+        REQUIRE(c_func);
+
+        float a[] = { 0.5f, 2, -3, 1 };
+        REQUIRE(c_func(a, 0) == 1.0f);
+        REQUIRE(c_func(a, 3) == 8.0f);
+    }
+}
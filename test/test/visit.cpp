@@ -0,0 +1,102 @@
+#include <cuj/core/visit.h>
+
+#include "test.h"
+
+namespace
+{
+
+    class NodeCounter : public core::Visitor<NodeCounter>
+    {
+    public:
+
+        int stores    = 0;
+        int calls     = 0;
+        int loops     = 0;
+        int immediate = 0;
+
+        void on_store    (const core::Store     &) { ++stores;    }
+        void on_call_func(const core::CallFunc  &) { ++calls;     }
+        void on_loop     (const core::Loop      &) { ++loops;     }
+        void on_immediate(const core::Immediate &) { ++immediate; }
+    };
+
+    class ConstantRewriter : public core::Rewriter<ConstantRewriter>
+    {
+    public:
+
+        // replace immediate 5 with 6, and remove stores of 100
+        void rewrite_expr(core::Expr &expr)
+        {
+            auto imm = expr.as_if<core::Immediate>();
+            if(imm && imm->value == core::Immediate::Value(int32_t(5)))
+                expr = core::Immediate{ int32_t(6) };
+        }
+
+        void rewrite_stat(core::Stat &stat)
+        {
+            auto store = stat.as_if<core::Store>();
+            if(!store)
+                return;
+            auto imm = store->val.as_if<core::Immediate>();
+            if(imm && imm->value == core::Immediate::Value(int32_t(100)))
+                stat = core::Block{};
+        }
+    };
+
+} // namespace anonymous
+
+TEST_CASE("visit")
+{
+    ScopedModule mod;
+
+    auto add_one = function("add_one", [](i32 x) { return x + 1; });
+
+    auto func = function("func", [&](i32 n)
+    {
+        i32 ret = 0, i = 0;
+        $while(i < n)
+        {
+            ret = ret + add_one(i) * 5;
+            i = i + 1;
+        };
+        ret = 100;
+        return ret;
+    });
+
+    auto prog = mod._generate_prog();
+    auto &core_func = const_cast<core::Func &>(
+        *func._get_context()->get_core_func());
+
+    SECTION("visitor")
+    {
+        NodeCounter counter;
+        counter.visit(*core_func.root_block);
+        REQUIRE(counter.calls == 1);
+        REQUIRE(counter.loops == 1);
+        REQUIRE(counter.stores >= 5);
+        REQUIRE(counter.immediate >= 4);
+
+        int calls = 0;
+        core::visit_call_funcs(
+            *core_func.root_block, [&](const core::CallFunc &) { ++calls; });
+        REQUIRE(calls == 1);
+    }
+
+    SECTION("rewriter")
+    {
+        NodeCounter before;
+        before.visit(*core_func.root_block);
+
+        ConstantRewriter().rewrite(core_func);
+
+        NodeCounter after;
+        after.visit(*core_func.root_block);
+        REQUIRE(after.stores == before.stores - 1);
+
+        MCJIT mcjit;
+        mcjit.generate(prog);
+        auto c_func = mcjit.get_function(func);
+        REQUIRE(c_func);
+        REQUIRE(c_func(3) == (1 + 2 + 3) * 6);
+    }
+}